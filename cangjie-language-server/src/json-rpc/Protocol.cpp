@@ -154,6 +154,18 @@ bool FetchTextDocument(const nlohmann::json &textDocument, InitializeParams &rep
     }
     if (textDocument.contains("completion") && textDocument["completion"].is_object()) {
         if (textDocument["completion"]["completionItem"].is_null()) { return false; }
+        nlohmann::json resolveSupport = textDocument["completion"]["completionItem"]["resolveSupport"];
+        if (resolveSupport.is_object() && resolveSupport["properties"].is_array()) {
+            std::set<std::string> properties;
+            for (auto &property : resolveSupport["properties"]) {
+                if (property.is_string()) {
+                    (void)properties.insert(property.get<std::string>());
+                }
+            }
+            reply.capabilities.textDocumentClientCapabilities.completionResolveCapabilities =
+                properties.count("detail") && properties.count("documentation") &&
+                properties.count("additionalTextEdits");
+        }
     }
     if (textDocument.contains("hover") && textDocument["hover"].is_object()) {
             // Hover feature is not tested. Therefore, set this parameter to false to disable it.
@@ -184,6 +196,26 @@ bool FromJSON(const nlohmann::json &params, TrackCompletionParams &reply)
     return true;
 }
 
+bool FromJSON(const nlohmann::json &params, CompletionResolveParams &reply)
+{
+    if (!params.is_object()) {
+        return false;
+    }
+    reply.item = params;
+    reply.label = params.value("label", "");
+    // an item without our data keeps generation 0, which no completion list has, and comes back as it is
+    if (!params.contains("data") || !params["data"].is_object()) {
+        return true;
+    }
+    nlohmann::json data = params["data"];
+    if (!data["generation"].is_number_unsigned() || !data["index"].is_number_unsigned()) {
+        return true;
+    }
+    reply.generation = data.value("generation", static_cast<uint64_t>(0));
+    reply.index = data.value("index", static_cast<size_t>(0));
+    return true;
+}
+
 bool FromJSON(const nlohmann::json &params, CompletionContext &reply)
 {
     if (!params.contains("triggerKind") || params["triggerKind"].is_null()) {
@@ -456,6 +488,75 @@ bool FromJSON(const nlohmann::json &params, DocumentLinkParams &reply)
     return true;
 }
 
+namespace {
+bool FromJSON(const nlohmann::json &params, FormattingOptions &reply)
+{
+    if (!params.is_object()) {
+        return false;
+    }
+    reply.tabSize = params.value("tabSize", reply.tabSize);
+    reply.insertSpaces = params.value("insertSpaces", reply.insertSpaces);
+    return true;
+}
+
+bool FromJSON(const nlohmann::json &params, Cangjie::Position &reply)
+{
+    if (!params.is_object() || params["line"].is_null() || params["character"].is_null()) {
+        return false;
+    }
+    reply.line = params.value("line", -1);
+    reply.column = params.value("character", -1);
+    return true;
+}
+} // namespace
+
+bool FromJSON(const nlohmann::json &params, DocumentFormattingParams &reply)
+{
+    if (!FromJSON(params["textDocument"], reply.textDocument)) {
+        return false;
+    }
+    return FromJSON(params["options"], reply.options);
+}
+
+bool FromJSON(const nlohmann::json &params, DocumentRangeFormattingParams &reply)
+{
+    if (!FromJSON(params["textDocument"], reply.textDocument) || !params["range"].is_object()) {
+        return false;
+    }
+    nlohmann::json range = params["range"];
+    if (!FromJSON(range["start"], reply.range.start) || !FromJSON(range["end"], reply.range.end)) {
+        return false;
+    }
+    return FromJSON(params["options"], reply.options);
+}
+
+bool FromJSON(const nlohmann::json &params, DocumentOnTypeFormattingParams &reply)
+{
+    if (!FromJSON(params["textDocument"], reply.textDocument) || !FromJSON(params["position"], reply.position)) {
+        return false;
+    }
+    if (!params["ch"].is_string()) {
+        return false;
+    }
+    reply.ch = params.value("ch", "");
+    return FromJSON(params["options"], reply.options);
+}
+
+bool ToJSON(const std::vector<TextEdit> &edits, nlohmann::json &reply)
+{
+    reply = nlohmann::json::array();
+    for (auto &iter : edits) {
+        nlohmann::json temp;
+        temp["range"]["start"]["line"] = iter.range.start.line;
+        temp["range"]["start"]["character"] = iter.range.start.column;
+        temp["range"]["end"]["line"] = iter.range.end.line;
+        temp["range"]["end"]["character"] = iter.range.end.column;
+        temp["newText"] = iter.newText;
+        (void) reply.push_back(temp);
+    }
+    return true;
+}
+
 bool FromJSON(const nlohmann::json &params, DidChangeWatchedFilesParam &reply)
 {
     for (int i = 0; i < static_cast<int>(params["changes"].size()); i++) {
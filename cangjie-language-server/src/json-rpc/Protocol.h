@@ -30,7 +30,8 @@ enum class ErrorCode {
     SERVER_NOT_INITIALIZED = -32002,
     UNKNOWN_ERROR_CODE = -32001,
     // Customized error code. (>= -31999 or <= -32900)
-    INVALID_RENAME_FOR_MACRO_CALL_FILE = -31999
+    INVALID_RENAME_FOR_MACRO_CALL_FILE = -31999,
+    INVALID_RENAME_FOR_STALE_INDEX = -31998
 };
 
 class MessageErrorDetail {
@@ -252,9 +253,26 @@ struct SignatureHelpParams : public TextDocumentPositionParams {
 bool FromJSON(const nlohmann::json &params, SignatureHelpContext &reply);
 
 struct CompletionList {
+    // true when the list was cut to the best items, the client has to ask again while typing
+    bool isIncomplete = false;
+
     std::vector<CompletionItem> items{};
 };
 
+// completionItem/resolve only needs the "data" we attached to the item when it was sent.
+struct CompletionResolveParams {
+    // the item as the client sent it, it is returned unchanged when it can not be resolved
+    nlohmann::json item;
+
+    std::string label;
+
+    uint64_t generation = 0;
+
+    size_t index = 0;
+};
+
+bool FromJSON(const nlohmann::json &params, CompletionResolveParams &reply);
+
 enum class FileChangeType {
     // The instruction file was created.
     CREATED = 1,
@@ -459,6 +477,9 @@ struct TextDocumentClientCapabilities {
     bool documentLinkClientCapabilities = false;
 
     bool typeHierarchyCapabilities = false;
+
+    // client can fetch detail, documentation and additionalTextEdits lazily via completionItem/resolve
+    bool completionResolveCapabilities = false;
 };
 
 struct ClientCapabilities {
@@ -580,6 +601,45 @@ struct DocumentLinkParams {
 
 bool FromJSON(const nlohmann::json &params, DocumentLinkParams &reply);
 
+// Options of a formatting request, the members besides these are left to the project configuration.
+struct FormattingOptions {
+    int tabSize = 4;
+
+    bool insertSpaces = true;
+};
+
+struct DocumentFormattingParams {
+    TextDocumentIdentifier textDocument;
+
+    FormattingOptions options;
+};
+
+bool FromJSON(const nlohmann::json &params, DocumentFormattingParams &reply);
+
+struct DocumentRangeFormattingParams {
+    TextDocumentIdentifier textDocument;
+
+    Range range;
+
+    FormattingOptions options;
+};
+
+bool FromJSON(const nlohmann::json &params, DocumentRangeFormattingParams &reply);
+
+struct DocumentOnTypeFormattingParams {
+    TextDocumentIdentifier textDocument;
+
+    Cangjie::Position position;
+
+    std::string ch;
+
+    FormattingOptions options;
+};
+
+bool FromJSON(const nlohmann::json &params, DocumentOnTypeFormattingParams &reply);
+
+bool ToJSON(const std::vector<TextEdit> &edits, nlohmann::json &reply);
+
 struct DocumentSymbolParams {
     TextDocumentIdentifier textDocument;
 };
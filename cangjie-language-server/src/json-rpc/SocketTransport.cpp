@@ -0,0 +1,408 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "SocketTransport.h"
+#ifndef _WIN32
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <csignal>
+#include <cstring>
+#include <vector>
+#include "../languageserver/capabilities/shutdown/Shutdown.h"
+#include "../languageserver/logger/Logger.h"
+
+namespace ark {
+namespace {
+const std::string UNIX_SOCKET_PREFIX = "unix:";
+const std::string DEFAULT_HOST = "127.0.0.1";
+
+#ifndef _WIN32
+// How often the accepting thread checks whether it has to stop.
+const int ACCEPT_POLL_MS = 200;
+
+// Split "host:port" or "port" into host and port, the host defaults to loopback.
+void SplitHostPort(const std::string &address, std::string &host, std::string &port)
+{
+    auto pos = address.rfind(':');
+    if (pos == std::string::npos) {
+        host = DEFAULT_HOST;
+        port = address;
+        return;
+    }
+    host = pos == 0 ? DEFAULT_HOST : address.substr(0, pos);
+    port = address.substr(pos + 1);
+}
+
+int OpenUnixSocket(const std::string &path, bool listen)
+{
+    sockaddr_un addr {};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "unix socket path is too long: " + path);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    (void)strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int ret;
+    if (listen) {
+        (void)unlink(path.c_str());
+        ret = bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        if (ret == 0) {
+            ret = ::listen(fd, SOMAXCONN);
+        }
+    } else {
+        ret = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    }
+    if (ret != 0) {
+        (void)close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int OpenTcpSocket(const std::string &address, bool listen)
+{
+    std::string host;
+    std::string port;
+    SplitHostPort(address, host, port);
+    addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen ? AI_PASSIVE : 0;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "can not resolve address: " + address);
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo *info = result; info != nullptr; info = info->ai_next) {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int ret;
+        if (listen) {
+            int reuse = 1;
+            (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            ret = bind(fd, info->ai_addr, info->ai_addrlen);
+            if (ret == 0) {
+                ret = ::listen(fd, SOMAXCONN);
+            }
+        } else {
+            ret = connect(fd, info->ai_addr, info->ai_addrlen);
+        }
+        if (ret == 0) {
+            break;
+        }
+        (void)close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+int OpenSocket(const std::string &address, bool listen, std::string &unixPath)
+{
+    if (address.rfind(UNIX_SOCKET_PREFIX, 0) == 0) {
+        unixPath = address.substr(UNIX_SOCKET_PREFIX.size());
+        return OpenUnixSocket(unixPath, listen);
+    }
+    return OpenTcpSocket(address, listen);
+}
+#endif
+} // namespace
+
+
+SocketTransport::~SocketTransport()
+{
+    StopAccepting();
+    RemoveClients();
+#ifndef _WIN32
+    if (listenFd >= 0) {
+        (void)close(listenFd);
+        listenFd = -1;
+    }
+    if (!unixSocketPath.empty()) {
+        (void)unlink(unixSocketPath.c_str());
+    }
+#endif
+}
+
+bool SocketTransport::Listen(const std::string &address)
+{
+#ifdef _WIN32
+    Logger::Instance().LogMessage(MessageType::MSG_WARNING, "socket transport is not supported on Windows");
+    return false;
+#else
+    // A client gone in the middle of a write must not end the server with SIGPIPE.
+    (void)signal(SIGPIPE, SIG_IGN);
+    listenFd = OpenSocket(address, true, unixSocketPath);
+    if (listenFd < 0) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "can not listen on " + address);
+        return false;
+    }
+    Logger::Instance().LogMessage(MessageType::MSG_INFO, "listening on " + address);
+    return true;
+#endif
+}
+
+bool SocketTransport::Connect(const std::string &address)
+{
+#ifdef _WIN32
+    Logger::Instance().LogMessage(MessageType::MSG_WARNING, "socket transport is not supported on Windows");
+    return false;
+#else
+    (void)signal(SIGPIPE, SIG_IGN);
+    std::string unixPath;
+    int fd = OpenSocket(address, false, unixPath);
+    if (fd < 0) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "can not connect to " + address);
+        return false;
+    }
+    return AddClient(fd);
+#endif
+}
+
+int SocketTransport::CurrentClient() const
+{
+    return currentClient;
+}
+
+size_t SocketTransport::ClientCount() const
+{
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    return clients.size();
+}
+
+void SocketTransport::Notify(std::string method, ValueOrError params)
+{
+    nlohmann::json message = NotifyMessage(method, std::move(params));
+    // window/ notifications may come before the reply to initialize, the others may not
+    bool beforeInitialized = method.rfind("window/", 0) == 0;
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (auto &client : clients) {
+        if (client.second->initialized || beforeInitialized) {
+            SendMsg(client.second->out, message);
+        }
+    }
+}
+
+void SocketTransport::Reply(nlohmann::json id, ValueOrError result)
+{
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto call = id.is_number_integer() ? pendingCalls.find(id.get<int64_t>()) : pendingCalls.end();
+    if (call == pendingCalls.end()) {
+        Logger::Instance().LogMessage(MessageType::MSG_INFO, "drop the reply to a request of a client which is gone");
+        return;
+    }
+    PendingCall pending = std::move(call->second);
+    (void)pendingCalls.erase(call);
+    auto client = clients.find(pending.client);
+    if (client == clients.end()) {
+        return;
+    }
+    if (pending.method == "initialize" && result.type == ValueOrErrorCheck::VALUE) {
+        client->second->initialized = true;
+    }
+    SendMsg(client->second->out, ReplyMessage(std::move(pending.id), std::move(result)));
+}
+
+LSPRet SocketTransport::Loop(MessageHandler &handler)
+{
+    StartAccepting();
+    LSPRet ret = Serve(handler);
+    StopAccepting();
+    RemoveClients();
+    return ret;
+}
+
+LSPRet SocketTransport::Serve(MessageHandler &handler)
+{
+    for (;;) {
+        Event event;
+        {
+            std::unique_lock<std::mutex> lock(eventsMutex);
+            eventReady.wait(lock, [this] { return !events.empty(); });
+            event = std::move(events.front());
+            events.pop_front();
+        }
+        {
+            // the messages a client sent after exit, and the end of its reader, come after it was removed
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            if (clients.find(event.client) == clients.end()) {
+                continue;
+            }
+        }
+        if (!event.message.empty()) {
+            LSPRet ret = Dispatch(event, handler);
+            if (ret != LSPRet::NORMAL_EXIT && ret != LSPRet::ABNORMAL_EXIT) {
+                continue;
+            }
+            // exit ends the server once shutdown was requested, or with its last client, otherwise only the client
+            if (ShutdownRequested() || ClientCount() <= 1) {
+                return ret;
+            }
+        }
+        std::string client = std::to_string(event.client);
+        Logger::Instance().LogMessage(MessageType::MSG_INFO, "client " + client + " disconnected");
+        handler.OnClientDisconnect(event.client);
+        RemoveClient(event.client);
+        // The other clients, and the next ones in listen mode, keep using the compiled workspace.
+        if (listenFd < 0 || ShutdownRequested()) {
+            return LSPRet::ERR_IO;
+        }
+    }
+}
+
+LSPRet SocketTransport::Dispatch(const Event &event, MessageHandler &handler)
+{
+    nlohmann::json message;
+    if (!ParseMessage(event.message, message)) {
+        return LSPRet::SUCCESS;
+    }
+    // Clients number their requests independently, a request gets an id of the server until it is replied to.
+    if (message.is_object() && message.contains("method") && message.contains("id") && !message["id"].is_null()) {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        int64_t callId = nextCallId++;
+        std::string method = message["method"].is_string() ? message["method"].get<std::string>() : "";
+        pendingCalls[callId] = PendingCall{event.client, std::move(message["id"]), std::move(method)};
+        message["id"] = callId;
+    }
+    currentClient = event.client;
+    return HandleMessage(std::move(message), handler);
+}
+
+void SocketTransport::Post(int client, std::string message)
+{
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.push_back(Event{client, std::move(message)});
+    }
+    eventReady.notify_one();
+}
+
+void SocketTransport::ReadClient(int client, std::FILE *in)
+{
+    while (!feof(in) && !ferror(in)) {
+        std::string message = ReadStandardMessage(in);
+        if (!message.empty()) {
+            Post(client, std::move(message));
+        }
+    }
+    Post(client, "");
+}
+
+bool SocketTransport::AddClient(int fd)
+{
+#ifdef _WIN32
+    return false;
+#else
+    // Reading and writing use separate FILE streams so their buffers do not interfere.
+    int writeFd = dup(fd);
+    std::FILE *in = fdopen(fd, "rb");
+    std::FILE *out = writeFd < 0 ? nullptr : fdopen(writeFd, "wb");
+    if (in == nullptr || out == nullptr) {
+        if (in != nullptr) {
+            (void)fclose(in);
+        } else {
+            (void)close(fd);
+        }
+        if (out != nullptr) {
+            (void)fclose(out);
+        } else if (writeFd >= 0) {
+            (void)close(writeFd);
+        }
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    int id = nextClient++;
+    auto client = std::make_unique<Client>();
+    client->in = in;
+    client->out = out;
+    client->reader = std::thread(&SocketTransport::ReadClient, this, id, in);
+    clients[id] = std::move(client);
+    Logger::Instance().LogMessage(MessageType::MSG_INFO, "client " + std::to_string(id) + " connected");
+    return true;
+#endif
+}
+
+void SocketTransport::RemoveClient(int client)
+{
+    std::unique_ptr<Client> removed;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        auto found = clients.find(client);
+        if (found == clients.end()) {
+            return;
+        }
+        removed = std::move(found->second);
+        (void)clients.erase(found);
+        for (auto call = pendingCalls.begin(); call != pendingCalls.end();) {
+            call = call->second.client == client ? pendingCalls.erase(call) : std::next(call);
+        }
+    }
+#ifndef _WIN32
+    // A client which sent exit may still be connected, wake its reader up.
+    (void)::shutdown(fileno(removed->in), SHUT_RDWR);
+#endif
+    if (removed->reader.joinable()) {
+        removed->reader.join();
+    }
+    (void)fclose(removed->in);
+    (void)fclose(removed->out);
+}
+
+void SocketTransport::RemoveClients()
+{
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto &client : clients) {
+            ids.push_back(client.first);
+        }
+    }
+    for (int id : ids) {
+        RemoveClient(id);
+    }
+}
+
+void SocketTransport::StartAccepting()
+{
+#ifndef _WIN32
+    if (listenFd < 0) {
+        return;
+    }
+    accepting = true;
+    acceptor = std::thread([this] {
+        while (accepting) {
+            pollfd pending {listenFd, POLLIN, 0};
+            if (poll(&pending, 1, ACCEPT_POLL_MS) <= 0 || !accepting) {
+                continue;
+            }
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd >= 0) {
+                (void)AddClient(fd);
+            }
+        }
+    });
+#endif
+}
+
+void SocketTransport::StopAccepting()
+{
+    accepting = false;
+    if (acceptor.joinable()) {
+        acceptor.join();
+    }
+}
+} // namespace ark
@@ -0,0 +1,119 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef LSPSERVER_SOCKETTRANSPORT_H
+#define LSPSERVER_SOCKETTRANSPORT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "StdioTransport.h"
+
+namespace ark {
+/**
+ * @class SocketTransport
+ * @brief Speaks the same Content-Length framed JSON-RPC as StdioTransport, over a TCP or Unix domain socket.
+ *
+ * Addresses are "host:port", "port" or "unix:/path/to/socket". In listen mode the server serves every client
+ * that connects, at the same time, over the one compiled workspace, so a second editor window does not pay the
+ * full compilation again, and it outlives the clients that go away without sending exit.
+ * Each client has a reader thread, the messages of all clients are handled one at a time on the thread running
+ * Loop. Request ids are replaced by ids unique to the server, so a reply goes back to the client of the request
+ * whatever thread sends it. Notifications go to every initialized client.
+ */
+class SocketTransport : public StdioTransport {
+public:
+    static SocketTransport& Instance()
+    {
+        static SocketTransport instance {};
+        return instance;
+    }
+
+    // Bind to the address, clients are accepted once Loop runs.
+    bool Listen(const std::string &address);
+
+    // Connect to a client which is listening on the address.
+    bool Connect(const std::string &address);
+
+    void Notify(std::string method, ValueOrError params) override;
+
+    void Reply(nlohmann::json id, ValueOrError result) override;
+
+    LSPRet Loop(MessageHandler &handler) override;
+
+    int CurrentClient() const override;
+
+    size_t ClientCount() const override;
+
+    ~SocketTransport() override;
+private:
+    struct Client {
+        std::FILE *in = nullptr;
+        std::FILE *out = nullptr;
+        std::thread reader {};
+        // whether the reply to its initialize was sent, notifications are held back until then
+        bool initialized = false;
+    };
+
+    // A request waiting for its reply: the client it came from, the id the client gave it and its method.
+    struct PendingCall {
+        int client;
+        nlohmann::json id;
+        std::string method;
+    };
+
+    // A message read from a client, an empty message tells the client is gone.
+    struct Event {
+        int client;
+        std::string message;
+    };
+
+    SocketTransport() = default;
+    SocketTransport(const SocketTransport &);
+    const SocketTransport &operator=(const SocketTransport &);
+
+    bool AddClient(int fd);
+
+    void ReadClient(int client, std::FILE *in);
+
+    void Post(int client, std::string message);
+
+    LSPRet Serve(MessageHandler &handler);
+
+    LSPRet Dispatch(const Event &event, MessageHandler &handler);
+
+    void RemoveClient(int client);
+
+    void RemoveClients();
+
+    void StartAccepting();
+
+    void StopAccepting();
+
+    int listenFd = -1;
+    std::string unixSocketPath {};
+
+    mutable std::mutex clientsMutex {};
+    std::map<int, std::unique_ptr<Client>> clients {};
+    std::map<int64_t, PendingCall> pendingCalls {};
+    int nextClient = 0;
+    int64_t nextCallId = 1;
+    std::atomic<int> currentClient {0};
+
+    std::mutex eventsMutex {};
+    std::condition_variable eventReady {};
+    std::deque<Event> events {};
+
+    std::atomic<bool> accepting {false};
+    std::thread acceptor {};
+};
+} // namespace ark
+#endif // LSPSERVER_SOCKETTRANSPORT_H
@@ -17,13 +17,51 @@ nlohmann::json EncodeError(const MessageErrorDetail &errorInfo)
     return root;
 }
 
+StdioTransport::~StdioTransport()
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (pRecordFile != nullptr) {
+        (void)fclose(pRecordFile);
+        pRecordFile = nullptr;
+    }
+}
+
+bool StdioTransport::StartRecording(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (pRecordFile != nullptr) {
+        (void)fclose(pRecordFile);
+    }
+    pRecordFile = std::fopen(path.c_str(), "wb");
+    if (pRecordFile == nullptr) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "can not open trace file: " + path);
+        return false;
+    }
+    recordStart = std::chrono::steady_clock::now();
+    return true;
+}
+
+void StdioTransport::Record(const char *direction, const std::string &body)
+{
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (pRecordFile == nullptr) {
+        return;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - recordStart).count();
+    // body is already valid JSON, embed it as is instead of parsing and dumping it again
+    (void)fprintf(pRecordFile, "{\"time\":%lld,\"direction\":\"%s\",\"message\":%s}\n",
+        static_cast<long long>(elapsed), direction, body.c_str());
+    (void)fflush(pRecordFile);
+}
+
 void StdioTransport::SetIO(std::FILE *in, std::FILE *out)
 {
     pFileIn = in;
     pFileOut = out;
 }
 
-void StdioTransport::Notify(std::string method, ValueOrError params)
+nlohmann::json StdioTransport::NotifyMessage(std::string method, ValueOrError params)
 {
     nlohmann::json root;
     root["jsonrpc"] = "2.0";
@@ -33,10 +71,10 @@ void StdioTransport::Notify(std::string method, ValueOrError params)
     } else {
         root["error"] = EncodeError(params.errorInfo);
     }
-    SendMsg(root);
+    return root;
 }
 
-void StdioTransport::Reply(nlohmann::json id, ValueOrError result)
+nlohmann::json StdioTransport::ReplyMessage(nlohmann::json id, ValueOrError result)
 {
     nlohmann::json root;
     root["jsonrpc"] = "2.0";
@@ -46,27 +84,43 @@ void StdioTransport::Reply(nlohmann::json id, ValueOrError result)
     } else {
         root["error"] = EncodeError(result.errorInfo);
     }
-    SendMsg(root);
+    return root;
 }
 
-LSPRet StdioTransport::Loop(MessageHandler &handler)
+void StdioTransport::Notify(std::string method, ValueOrError params)
+{
+    SendMsg(pFileOut, NotifyMessage(std::move(method), std::move(params)));
+}
+
+void StdioTransport::Reply(nlohmann::json id, ValueOrError result)
+{
+    SendMsg(pFileOut, ReplyMessage(std::move(id), std::move(result)));
+}
+
+bool StdioTransport::ParseMessage(const std::string &json, nlohmann::json &doc)
 {
     Logger &logger = Logger::Instance();
     std::stringstream log;
+    CleanAndLog(log, "receive message body:" + json);
+    logger.LogMessage(MessageType::MSG_INFO, log.str());
+    logger.CollectMessageInfo(logger.LogInfo(MessageType::MSG_INFO, json));
+    try {
+        doc = nlohmann::json::parse(json);
+    } catch (nlohmann::detail::parse_error &errs) {
+        CleanAndLog(log, errs.what());
+        logger.LogMessage(MessageType::MSG_WARNING, log.str());
+        return false;
+    }
+    Record("recv", json);
+    return true;
+}
+
+LSPRet StdioTransport::Loop(MessageHandler &handler)
+{
     while (!feof(pFileIn)) {
         auto json = ReadRawMessage();
-        if (!json.empty()) {
-            CleanAndLog(log, "receive message body:" + json);
-            logger.LogMessage(MessageType::MSG_INFO, log.str());
-            logger.CollectMessageInfo(logger.LogInfo(MessageType::MSG_INFO, json));
-            nlohmann::json doc;
-            try {
-                doc = nlohmann::json::parse(json);
-            } catch (nlohmann::detail::parse_error &errs) {
-                CleanAndLog(log, errs.what());
-                logger.LogMessage(MessageType::MSG_WARNING, log.str());
-                continue;
-            }
+        nlohmann::json doc;
+        if (!json.empty() && ParseMessage(json, doc)) {
             LSPRet ret = HandleMessage(std::move(doc), handler);
             if (ret == LSPRet::NORMAL_EXIT || ret == LSPRet::ABNORMAL_EXIT) {
                 return ret;
@@ -76,22 +130,23 @@ LSPRet StdioTransport::Loop(MessageHandler &handler)
     return LSPRet::ERR_IO;
 }
 
-void StdioTransport::SendMsg(const nlohmann::json &message)
+void StdioTransport::SendMsg(std::FILE *out, const nlohmann::json &message)
 {
     std::stringstream log;
     std::ostringstream os;
     // "-1", no indentation format
     os << message.dump(-1, ' ', false, nlohmann::json::error_handler_t::ignore);
-    (void)fprintf(pFileOut, "Content-Length:%d%s%s",
+    (void)fprintf(out, "Content-Length:%d%s%s",
                    static_cast<int>(os.str().size()), MessageHeaderEndOfLine::GetEol().c_str(), os.str().c_str());
-    (void)fflush(pFileOut);
+    (void)fflush(out);
+    Record("send", os.str());
     CleanAndLog(log, "send message body:" + os.str());
     Logger::Instance().LogMessage(MessageType::MSG_INFO, log.str());
 }
 
 std::string StdioTransport::ReadRawMessage()
 {
-    return ReadStandardMessage();
+    return ReadStandardMessage(pFileIn);
 }
 
 bool ReadLine(std::FILE *in, std::string &out)
@@ -125,13 +180,13 @@ void Trim(std::string &s)
     (void)s.erase(s.find_last_not_of(' ') + 1);
 }
 
-std::string StdioTransport::ReadStandardMessage()
+std::string StdioTransport::ReadStandardMessage(std::FILE *in)
 {
     unsigned long long contentLength = 0;
     std::string line;
     Logger &logger = Logger::Instance();
     for (;;) {
-        if (feof(pFileIn) || ferror(pFileIn) || !ReadLine(pFileIn, line)) { return ""; }
+        if (feof(in) || ferror(in) || !ReadLine(in, line)) { return ""; }
 
         if (line.front() == '#') { continue; }
         Trim(line);
@@ -162,15 +217,15 @@ std::string StdioTransport::ReadStandardMessage()
     size_t read;
     size_t pos = 0;
     while (pos < contentLength) {
-        read = RetryAfterSignalUnlessShutdown(0, [&json, &pos, &contentLength, this] {
-            return std::fread(&json[pos], 1, contentLength - pos, pFileIn);
+        read = RetryAfterSignalUnlessShutdown(0, [&json, &pos, &contentLength, in] {
+            return std::fread(&json[pos], 1, contentLength - pos, in);
         });
         if (read == 0) {
             logger.LogMessage(MessageType::MSG_WARNING, "Input was aborted.");
             return "";
         }
 
-        clearerr(pFileIn);
+        clearerr(in);
         pos += read;
     }
     return std::move(json);
@@ -7,6 +7,7 @@
 #ifndef LSPSERVER_STDIOTRANSPORT_H
 #define LSPSERVER_STDIOTRANSPORT_H
 
+#include <chrono>
 #include <iostream>
 #include <sstream>
 
@@ -31,24 +32,40 @@ public:
 
     LSPRet Loop(MessageHandler &handler) override ;
 
+    // Append every message received and sent to a trace file, one JSON object per line, for replaying later.
+    bool StartRecording(const std::string &path);
+
     std::mutex stdoutMutex {};
 
-    ~StdioTransport() override {}
-private:
+    ~StdioTransport() override;
+protected:
     StdioTransport(): pFileIn(nullptr), pFileOut(nullptr)  {}
     StdioTransport(const StdioTransport &);
     const StdioTransport &operator=(const StdioTransport &);
 
+    static nlohmann::json NotifyMessage(std::string method, ValueOrError params);
+
+    static nlohmann::json ReplyMessage(nlohmann::json id, ValueOrError result);
+
+    // Log, parse and record a message body read from a client.
+    bool ParseMessage(const std::string &json, nlohmann::json &doc);
+
     LSPRet HandleMessage(nlohmann::json message, MessageHandler &handler);
 
-    void SendMsg(const nlohmann::json &message);
+    void SendMsg(std::FILE *out, const nlohmann::json &message);
 
-    std::string ReadRawMessage();
+    std::string ReadStandardMessage(std::FILE *in);
+
+    void Record(const char *direction, const std::string &body);
 
-    std::string ReadStandardMessage();
+private:
+    std::string ReadRawMessage();
 
     std::FILE *pFileIn = nullptr;
     std::FILE *pFileOut = nullptr;
+    std::FILE *pRecordFile = nullptr;
+    std::mutex recordMutex {};
+    std::chrono::steady_clock::time_point recordStart {};
 };
 }
 #endif // LSPSERVER_STDIOTRANSPORT_H
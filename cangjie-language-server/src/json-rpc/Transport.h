@@ -134,10 +134,24 @@ public:
         virtual LSPRet OnCall(std::string, nlohmann::json, nlohmann::json) = 0;
 
         virtual LSPRet OnReply(nlohmann::json, ValueOrError) = 0;
+
+        // The client went away, what it had open is closed for it.
+        virtual void OnClientDisconnect(int) {}
     };
 
     virtual LSPRet Loop(MessageHandler &) = 0;
 
+    // The client the message being handled comes from, a transport serving a single client only has client 0.
+    virtual int CurrentClient() const
+    {
+        return 0;
+    }
+
+    virtual size_t ClientCount() const
+    {
+        return 1;
+    }
+
     virtual ~Transport() {}
 
     std::mutex transpWriter{};
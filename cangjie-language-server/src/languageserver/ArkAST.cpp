@@ -8,6 +8,7 @@
 #include "logger/Logger.h"
 #include "common/Utils.h"
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,12 @@ namespace {
 }
 
 namespace ark {
+uint64_t ArkAST::NextGeneration()
+{
+    static std::atomic<uint64_t> generations{0};
+    return ++generations;
+}
+
 #ifdef THIS
 #define LIB_THIS THIS
 #undef THIS
@@ -149,6 +149,11 @@ struct ArkAST {
     SourceManager *sourceManager{nullptr};
     ArkAST *semaCache = nullptr;
     unsigned int fileID = 0;
+    // unique per ArkAST, a file gets a new ArkAST each time its package is compiled again
+    const uint64_t generation = NextGeneration();
+
+private:
+    static uint64_t NextGeneration();
 };
 } // namespace ark
 
@@ -16,11 +16,22 @@ namespace {
 // The files of cjlibs only support SemanticTokens and Definition.
 std::set<std::string> cjlibSupportFeatures = {"SemanticTokens", "Definition"};
 std::set<std::string> hierarchyIgnoreRequest = {"SubTypes", "SuperTypes", "OnIncomingCalls", "OnOutgoingCalls"};
+// These requests only read the AST and index, so they can run concurrently once the AST is up to date.
+// Anything else (Update, Rename, DocumentLink, ChangeWatchedFiles...) may change compiler state and stays serial.
+std::set<std::string> readOnlyRequests = {"Hover", "Definition", "Highlights", "References", "DocumentSymbol",
+    "SemanticTokens", "Symbol", "PrepareRename", "TypeHierarchy", "SuperTypes", "SubTypes", "CallHierarchy",
+    "OnIncomingCalls", "OnOutgoingCalls", "FindBreakpoints", "FindCodeLens"};
+
+bool IsReadOnlyRequest(const std::string &name)
+{
+    return readOnlyRequests.find(name) != readOnlyRequests.end();
+}
 }
 namespace ark {
-ArkASTWorker *ArkASTWorker::Create(AsyncTaskRunner &asyncTaskRunner, Semaphore &semaphore, Callbacks *c)
+ArkASTWorker *ArkASTWorker::Create(AsyncTaskRunner &asyncTaskRunner, Semaphore &semaphore, Callbacks *c,
+                                   ThrdPool *readers)
 {
-    auto worker = new (std::nothrow) ArkASTWorker(semaphore, c);
+    auto worker = new (std::nothrow) ArkASTWorker(semaphore, c, readers);
     if (worker == nullptr) {
         return nullptr;
     }
@@ -30,7 +41,8 @@ ArkASTWorker *ArkASTWorker::Create(AsyncTaskRunner &asyncTaskRunner, Semaphore &
     return worker;
 }
 
-ArkASTWorker::ArkASTWorker(Semaphore &semaphore, Callbacks *c) : barrier(semaphore), done(false), callback(c) {}
+ArkASTWorker::ArkASTWorker(Semaphore &semaphore, Callbacks *c, ThrdPool *readers)
+    : barrier(semaphore), done(false), callback(c), readerPool(readers) {}
 
 ArkASTWorker::~ArkASTWorker() {}
 
@@ -67,6 +79,8 @@ void ArkASTWorker::Run()
             std::unique_lock<std::mutex> lock(mutex);
             for (auto dl = ScheduleLocked(); !dl.Expired(); dl = ScheduleLocked()) {
                 if (done && requests.empty()) {
+                    lock.unlock();
+                    WaitForReaders();
                     return;
                 }
                 Wait(lock, requestsCV, dl);
@@ -80,6 +94,10 @@ void ArkASTWorker::Run()
             if (!sLock.owns_lock()) {
                 sLock.lock();
             }
+            // Mutating requests must not change the AST under a reader still running on the pool.
+            if (!currentRequest.readOnly) {
+                WaitForReaders();
+            }
             currentRequest.action();
         }
     }
@@ -133,7 +151,7 @@ void ArkASTWorker::Stop() noexcept
     }
 }
 
-void ArkASTWorker::StartTask(std::string name, std::function<void()> task, NeedDiagnostics needDiag)
+void ArkASTWorker::StartTask(std::string name, std::function<void()> task, NeedDiagnostics needDiag, bool syntaxOnly)
 {
     {
         std::lock_guard<std::mutex> lock(mutex);
@@ -147,11 +165,37 @@ void ArkASTWorker::StartTask(std::string name, std::function<void()> task, NeedD
         );
 
         // Allow this request to be cancelled if invalidated.
-        requests.push_back({std::move(task), std::move(name), needDiag});
+        bool readOnly = syntaxOnly || (readerPool != nullptr && IsReadOnlyRequest(name));
+        requests.push_back({std::move(task), std::move(name), needDiag, readOnly});
     }
     requestsCV.notify_all();
 }
 
+void ArkASTWorker::RunOnReaderPool(std::function<void()> read)
+{
+    {
+        std::lock_guard<std::mutex> lock(readerMutex);
+        ++activeReaders;
+    }
+    uint64_t taskId = readerTaskId++;
+    auto task = [this, taskId, read = std::move(read)]() {
+        Logger::Instance().CleanKernelLog(std::this_thread::get_id());
+        read();
+        readerPool->TaskCompleted(taskId);
+        std::lock_guard<std::mutex> lock(readerMutex);
+        if (--activeReaders == 0) {
+            readersDone.notify_all();
+        }
+    };
+    readerPool->AddTask(taskId, {}, task);
+}
+
+void ArkASTWorker::WaitForReaders()
+{
+    std::unique_lock<std::mutex> lock(readerMutex);
+    readersDone.wait(lock, [this] { return activeReaders == 0; });
+}
+
 void ArkASTWorker::RunWithAST(const std::string &name,
     const std::string &file,
     std::function<void(InputsAndAST)> action,
@@ -167,6 +211,7 @@ void ArkASTWorker::RunWithAST(const std::string &name,
     }
 
     auto task = [this, file, action = std::move(action), name]() mutable {
+        bool readOnly = readerPool != nullptr && IsReadOnlyRequest(name);
         bool needReParser = this->callback->NeedReParser(file);
         bool useASTCache = true;
         ParseInputs inputs;
@@ -174,6 +219,9 @@ void ArkASTWorker::RunWithAST(const std::string &name,
         inputs.contents = this->callback->GetContentsByFile(file);
         inputs.version = this->callback->GetVersionByFile(file);
         if (needReParser) {
+            if (readOnly) {
+                WaitForReaders();
+            }
             std::vector<TextDocumentContentChangeEvent> contentChanges;
             // Do incremental build for defined file first
             if (this->callback->isRenameDefined && this->callback->NeedReParser(this->callback->path) &&
@@ -194,6 +242,9 @@ void ArkASTWorker::RunWithAST(const std::string &name,
         if (hierarchyIgnoreRequest.find(name) == hierarchyIgnoreRequest.end() &&
             (!CompilerCangjieProject::GetInstance()->FileHasSemaCache(file) ||
                 CompilerCangjieProject::GetInstance()->CheckNeedCompiler(file))) {
+            if (readOnly) {
+                WaitForReaders();
+            }
             CompilerCangjieProject::GetInstance()->IncrementOnePkgCompile(file, inputs.contents);
             std::vector<DiagnosticToken> diagnostics = callback->GetDiagsOfCurFile(file);
             callback->ReadyForDiagnostics(file, inputs.version, diagnostics);
@@ -206,6 +257,14 @@ void ArkASTWorker::RunWithAST(const std::string &name,
             std::unique_lock<std::mutex> lock(editMutex);
             curOnEditName = this->onEditName;
         }
+        if (readOnly) {
+            // The AST is now up to date, answer from it on the pool and let the worker move on.
+            auto read = [inputs, ast, curOnEditName, useASTCache, action = std::move(action)]() {
+                action(InputsAndAST{inputs, ast, curOnEditName, useASTCache});
+            };
+            RunOnReaderPool(std::move(read));
+            return;
+        }
         Logger::Instance().CleanKernelLog(std::this_thread::get_id());
         action(InputsAndAST{inputs, ast, curOnEditName, useASTCache});
     };
@@ -287,6 +346,15 @@ void ArkASTWorker::RunWithASTCache(
     }
 }
 
+void ArkASTWorker::RunWithoutAST(const std::string &name, const std::string &file, std::function<void()> action)
+{
+    auto task = [action = std::move(action)]() {
+        Logger::Instance().CleanKernelLog(std::this_thread::get_id());
+        action();
+    };
+    StartTask(name + " " + file, std::move(task), NeedDiagnostics::YES, true);
+}
+
 AsyncTaskRunner::AsyncTaskRunner() : inFlightTasks(0) {}
 
 AsyncTaskRunner::~AsyncTaskRunner() noexcept { Wait(); }
@@ -7,12 +7,16 @@
 #ifndef LSPSERVER_ARKASTWORKER_H
 #define LSPSERVER_ARKASTWORKER_H
 
+#include <atomic>
 #include <queue>
 #include <vector>
 #include <map>
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 #include "ArkThreading.h"
 #include "ArkAST.h"
+#include "ThrdPool.h"
 #include "CompilerCangjieProject.h"
 #include "capabilities/semanticHighlight/SemanticHighlightImpl.h"
 #include "common/Callbacks.h"
@@ -38,8 +42,9 @@ struct ThreadData {
 
 class ArkASTWorker {
 public:
-    ArkASTWorker(Semaphore &semaphore, Callbacks *c);
-    static ArkASTWorker* Create(AsyncTaskRunner &asyncTaskRunner, Semaphore &semaphore, Callbacks *c);
+    ArkASTWorker(Semaphore &semaphore, Callbacks *c, ThrdPool *readers = nullptr);
+    static ArkASTWorker* Create(AsyncTaskRunner &asyncTaskRunner, Semaphore &semaphore, Callbacks *c,
+                                ThrdPool *readers = nullptr);
     ~ArkASTWorker();
 
     void Update(const ParseInputs &inputs, NeedDiagnostics needDiag);
@@ -55,6 +60,9 @@ public:
     void RunWithASTCache(
         const std::string &name, const std::string &file, Position pos, std::function<void(InputsAndAST)> action);
 
+    // Queue action behind the edits already received, for requests that only need the text of file.
+    void RunWithoutAST(const std::string &name, const std::string &file, std::function<void()> action);
+
     void Stop() noexcept;
 
 private:
@@ -64,12 +72,20 @@ private:
 
     bool ShouldSkipHeadLocked() const;
 
-    void StartTask(std::string name, std::function<void()> task, NeedDiagnostics needDiag);
+    // syntaxOnly tasks use neither the AST nor compiler state, they do not wait for readers either.
+    void StartTask(std::string name, std::function<void()> task, NeedDiagnostics needDiag, bool syntaxOnly = false);
+
+    // Run a read-only action on the reader pool, the worker keeps the AST unchanged until it finishes.
+    void RunOnReaderPool(std::function<void()> read);
+
+    // Block the worker thread until all in-flight read-only actions are finished.
+    void WaitForReaders();
 
     struct Request {
         std::function<void()> action;
         std::string name;
         NeedDiagnostics updateType = NeedDiagnostics::AUTO;
+        bool readOnly = false;
     };
 
     Semaphore &barrier;
@@ -91,6 +107,13 @@ private:
     bool isCompleteRunning = false;
     mutable std::mutex completionMtx;
     std::function<void()> waitingCompletionTask = nullptr;
+
+    // Read-only requests are dispatched here, nullptr means all requests run on the worker thread.
+    ThrdPool *readerPool = nullptr;
+    std::atomic<uint64_t> readerTaskId {0};
+    std::mutex readerMutex;
+    std::condition_variable readersDone;
+    std::size_t activeReaders = 0; /* GUARDED_BY(readerMutex) */
 };
 
 class AsyncTaskRunner {
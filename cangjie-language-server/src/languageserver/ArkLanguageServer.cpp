@@ -5,6 +5,7 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "ArkLanguageServer.h"
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <set>
@@ -12,18 +13,27 @@
 #include <utility>
 #include "capabilities/semanticHighlight/SemanticTokensAdaptor.h"
 #include "capabilities/shutdown/Shutdown.h"
+#include "capabilities/formatting/FormattingImpl.h"
 
 namespace ark {
 using namespace Cangjie;
 using namespace Cangjie::FileUtil;
 using namespace CONSTANTS;
+namespace {
+// A queued task is replaced by a later one of the same name, every formatting request must get its reply.
+std::string FormattingTaskName(const std::string &kind, const nlohmann::json &id)
+{
+    return kind + " " + id.dump();
+}
+} // namespace
+
 // MessageHandler dispatches incoming LSP messages.
 // It handles cross-cutting concerns:
 //  - serialize/deserialize protocol objects to JSON
 //  - logging of inbound messages
 //  - cancellation handling
 //  - basic call tracing
-// MessageHandler ensures that initialize() is called before any other handler.
+// MessageHandler ensures that initialize() is called before any other handler, by each client.
 class ArkLanguageServer::MessageHandler : public Transport::MessageHandler {
 public:
     explicit MessageHandler(ArkLanguageServer &server) : server(server) {}
@@ -33,12 +43,13 @@ public:
     {
         std::stringstream log;
         Logger& logger = Logger::Instance();
-        if (!getInitialize || (!isInitialized && method != "initialized")) {
+        ClientState &client = CurrentClient();
+        if (!client.getInitialize || (!client.isInitialized && method != "initialized")) {
             CleanAndLog(log, "Initialization is needed before Notification:" + method);
             logger.LogMessage(MessageType::MSG_WARNING, log.str());
             return LSPRet::SUCCESS;
         }
-        if (ShutdownRequested()) {
+        if (ShutdownRequested() || client.shutdown) {
             logger.LogMessage(MessageType::MSG_WARNING, "server already shutdown");
             return LSPRet::SUCCESS;
         }
@@ -66,7 +77,8 @@ public:
     {
         std::stringstream log;
         Logger& logger = Logger::Instance();
-        if (!isInitialized && method != "initialize") {
+        ClientState &client = CurrentClient();
+        if (!client.isInitialized && method != "initialize") {
             CleanAndLog(log, "initialize is necessary before call:" + method + ", and reply error to client.");
             logger.LogMessage(MessageType::MSG_WARNING, log.str());
             std::lock_guard<std::mutex> lock(server.transp.transpWriter);
@@ -76,7 +88,7 @@ public:
                                                                         ErrorCode::SERVER_NOT_INITIALIZED))));
             return LSPRet::SUCCESS;
         }
-        if (ShutdownRequested()) {
+        if (ShutdownRequested() || client.shutdown) {
             std::lock_guard<std::mutex> lock(server.transp.transpWriter);
             server.transp.Reply(id, ValueOrError(ValueOrErrorCheck::ERR,
                                         MessageErrorDetail("server already shutdown",
@@ -190,21 +202,45 @@ public:
         };
     }
 
-    bool WhetherGetInitialized() const
+    bool WhetherGetInitialized()
     {
-        return this->isInitialized;
+        return CurrentClient().isInitialized;
     }
 
     void SetInitialize(bool getInit)
     {
-        this->getInitialize = getInit;
+        CurrentClient().getInitialize = getInit;
     }
     void SetInitialized(bool beInitialized)
     {
-        this->isInitialized = beInitialized;
+        CurrentClient().isInitialized = beInitialized;
+    }
+
+    // The other clients keep the server running, only the current one is done.
+    void SetClientShutdown()
+    {
+        CurrentClient().shutdown = true;
+    }
+
+    // The workspace stays compiled for the other clients and the next ones.
+    void OnClientDisconnect(int client) override
+    {
+        server.CloseDocsOfClient(client);
+        (void)clients.erase(client);
     }
 
 private:
+    // How far a client went through the protocol, messages are handled one at a time so no lock is needed.
+    struct ClientState {
+        bool getInitialize = false;
+        bool isInitialized = false;
+        bool shutdown = false;
+    };
+
+    ClientState &CurrentClient()
+    {
+        return clients[server.transp.CurrentClient()];
+    }
 
     std::map<std::string, std::function<void(const nlohmann::json &)>> notifications;
     std::map<std::string, std::function<void(const nlohmann::json &, const nlohmann::json &)>> calls;
@@ -213,8 +249,7 @@ private:
     // RequestID and ReplyHandler
     std::deque<std::pair<int, Callback<nlohmann::json>>> replyCallbacks {};
 
-    bool getInitialize = false;
-    bool isInitialized = false;
+    std::map<int, ClientState> clients;
     ArkLanguageServer &server;
 };
 
@@ -246,12 +281,16 @@ ArkLanguageServer::ArkLanguageServer(Transport &transport, Environment environme
     MsgHandler->Bind("textDocument/signatureHelp", &ArkLanguageServer::OnSignatureHelp);
     MsgHandler->Bind("textDocument/hover", &ArkLanguageServer::OnHover);
     MsgHandler->Bind("textDocument/completion", &ArkLanguageServer::OnCompletion);
+    MsgHandler->Bind("completionItem/resolve", &ArkLanguageServer::OnCompletionResolve);
     MsgHandler->Bind("textDocument/prepareRename", &ArkLanguageServer::OnPrepareRename);
     MsgHandler->Bind("textDocument/rename", &ArkLanguageServer::OnRename);
     MsgHandler->Bind("workspace/symbol", &ArkLanguageServer::OnWorkspaceSymbol);
     MsgHandler->Bind("workspace/didChangeWatchedFiles", &ArkLanguageServer::OnDidChangeWatchedFiles);
     MsgHandler->Bind("textDocument/documentSymbol", &ArkLanguageServer::OnDocumentSymbol);
     MsgHandler->Bind("textDocument/breakpoints", &ArkLanguageServer::OnBreakpoints);
+    MsgHandler->Bind("textDocument/formatting", &ArkLanguageServer::OnDocumentFormatting);
+    MsgHandler->Bind("textDocument/rangeFormatting", &ArkLanguageServer::OnDocumentRangeFormatting);
+    MsgHandler->Bind("textDocument/onTypeFormatting", &ArkLanguageServer::OnDocumentOnTypeFormatting);
     if (!MessageHeaderEndOfLine::GetIsDeveco()) {
         MsgHandler->Bind("textDocument/codeLens", &ArkLanguageServer::OnCodeLens);
     }
@@ -289,8 +328,15 @@ nlohmann::json GetServerCapabilities(int syncKind)
     serverCapabilities["typeHierarchyProvider"] = true;
     serverCapabilities["callHierarchyProvider"] = true;
     serverCapabilities["documentLinkProvider"]["resolveProvider"] = true;
-    serverCapabilities["completionProvider"]["resolveProvider"] = false;
+    serverCapabilities["completionProvider"]["resolveProvider"] = true;
     serverCapabilities["breakpointsProvider"] = true;
+    serverCapabilities["documentFormattingProvider"] = true;
+    serverCapabilities["documentRangeFormattingProvider"] = true;
+    serverCapabilities["documentOnTypeFormattingProvider"]["firstTriggerCharacter"] = "}";
+    std::set<std::string> onTypeFormattingTriggerCharacters = {";", "\n"};
+    for (const std::string &item : onTypeFormattingTriggerCharacters) {
+        (void)serverCapabilities["documentOnTypeFormattingProvider"]["moreTriggerCharacter"].push_back(item);
+    }
     if (!MessageHeaderEndOfLine::GetIsDeveco()) {
         serverCapabilities["codeLensProvider"] = true;
     }
@@ -339,7 +385,17 @@ void ArkLanguageServer::OnInitialize(const InitializeParams &params, nlohmann::j
         return;
     }
 
-    bool success = PerformCompiler(params);
+    // A client connecting over a socket reuses the workspace compiled for the first one.
+    bool success = true;
+    if (compiledRoot.empty()) {
+        success = PerformCompiler(params);
+        compiledRoot = success ? params.rootUri.file : "";
+    } else if (compiledRoot != params.rootUri.file) {
+        std::lock_guard<std::mutex> lock(transp.transpWriter);
+        transp.Reply(std::move(id), ValueOrError(ValueOrErrorCheck::ERR,
+            MessageErrorDetail("server is serving another workspace: " + compiledRoot, ErrorCode::INVALID_REQUEST)));
+        return;
+    }
     if (!success) {
         transp.Reply(std::move(id), std::move(ValueOrError(ValueOrErrorCheck::ERR,
                                         MessageErrorDetail("initialize fail",
@@ -348,6 +404,8 @@ void ArkLanguageServer::OnInitialize(const InitializeParams &params, nlohmann::j
     }
     MsgHandler->SetInitialize(true);
     clientCapabilities = params.capabilities;
+    Server->SetCompletionResolveSupport(
+        clientCapabilities.textDocumentClientCapabilities.completionResolveCapabilities);
     ValueOrError result = ReplyInitialize(static_cast<int>(syncKind));
     std::lock_guard<std::mutex> lock(transp.transpWriter);
     transp.Reply(std::move(id), result);
@@ -398,7 +456,14 @@ void ArkLanguageServer::AddDocWhenInitCompile(const std::string &file)
 
 void ArkLanguageServer::OnShutdown(nlohmann::json id)
 {
-    RequestShutdown();
+    if (transp.ClientCount() > 1) {
+        MsgHandler->SetClientShutdown();
+    } else {
+        RequestShutdown();
+    }
+    if (auto project = CompilerCangjieProject::GetInstance()) {
+        project->FlushUsage();
+    }
     nlohmann::json value;
     ValueOrError result(ValueOrErrorCheck::VALUE, value);
     std::lock_guard<std::mutex> lock(transp.transpWriter);
@@ -411,6 +476,7 @@ void ArkLanguageServer::OnDocumentDidOpen(const DidOpenTextDocumentParams &param
     if (!CheckFileInCangjieProject(file)) {
         return;
     }
+    openDocs[transp.CurrentClient()][file] = params.textDocument.uri.file;
     DocCache::Doc doc = DocMgr.GetDoc(file);
     const std::string &contents = params.textDocument.text;
     bool reBuild = false;
@@ -447,8 +513,48 @@ void ArkLanguageServer::OnDocumentDidClose(const DidCloseTextDocumentParams &par
     if (!CheckFileInCangjieProject(file)) {
         return;
     }
+    (void)openDocs[transp.CurrentClient()].erase(file);
+    // clients share the document, it stays open as long as one of them has it open
+    if (IsOpenByAnyClient(file)) {
+        return;
+    }
+    CloseDoc(file, params.textDocument.uri.file);
+}
+
+bool ArkLanguageServer::IsOpenByAnyClient(const std::string &file) const
+{
+    return std::any_of(openDocs.begin(), openDocs.end(), [&file](const auto &docs) {
+        return docs.second.count(file) > 0;
+    });
+}
+
+void ArkLanguageServer::CloseDocsOfClient(int client)
+{
+    auto found = openDocs.find(client);
+    if (found == openDocs.end()) {
+        return;
+    }
+    auto docs = std::move(found->second);
+    (void)openDocs.erase(found);
+    for (auto &[file, uri] : docs) {
+        if (IsOpenByAnyClient(file)) {
+            continue;
+        }
+        // the edits the client did not save go away with it
+        DocCache::Doc doc = DocMgr.GetDoc(file);
+        std::string onDisk = GetFileContents(file);
+        if (FileUtil::FileExist(file) && doc.contents != onDisk) {
+            int64_t version = DocMgr.AddDoc(file, doc.version, onDisk);
+            Server->AddDoc(file, onDisk, version, ark::NeedDiagnostics::YES, true);
+        }
+        CloseDoc(file, uri);
+    }
+}
+
+void ArkLanguageServer::CloseDoc(const std::string &file, const std::string &uri)
+{
     PublishDiagnosticsParams notification;
-    notification.uri.file = params.textDocument.uri.file;
+    notification.uri.file = uri;
     PublishDiagnostics(notification);
     if (Options::GetInstance().GetLSPFlag("enableParallel").has_value()) {
         if (!Options::GetInstance().GetLSPFlag("enableParallel").value()) {
@@ -726,6 +832,14 @@ void ArkLanguageServer::OnDidChangeWatchedFiles(const DidChangeWatchedFilesParam
     Logger& logger = Logger::Instance();
     logger.LogMessage(MessageType::MSG_LOG, "ArkLanguageServer::OnDidChangeWatchedFiles in.");
 
+    // C files are not part of the project, they only feed the index of the functions foreign funcs bind to
+    auto cFunctionIndex = CompilerCangjieProject::GetInstance()->GetCFunctionIndex();
+    for (auto &event : params.changes) {
+        std::string file = FileStore::NormalizePath(URI::Resolve(event.textDocument.uri.file));
+        if (cFunctionIndex && lsp::CFunctionIndex::IsCFile(file)) {
+            cFunctionIndex->UpdateFile(file, event.type == FileChangeType::DELETED);
+        }
+    }
     std::vector<FileWatchedEvent> changes;
     WrapClientWatchedFiles(changes, params);
     for (auto &event : changes) {
@@ -884,6 +998,18 @@ void ArkLanguageServer::OnCompletion(const CompletionParams &params, nlohmann::j
     Server->FindCompletion(params, file, std::move(reply));
 }
 
+void ArkLanguageServer::OnCompletionResolve(const CompletionResolveParams &params, nlohmann::json id)
+{
+    Logger &logger = Logger::Instance();
+    logger.LogMessage(MessageType::MSG_LOG, "ArkLanguageServer::OnCompletionResolve in.");
+
+    auto reply = [id, this](ValueOrError result) mutable {
+        std::lock_guard<std::mutex> lock(transp.transpWriter);
+        transp.Reply(std::move(id), std::move(result));
+    };
+    Server->ResolveCompletion(params, std::move(reply));
+}
+
 void ArkLanguageServer::OnSemanticTokens(const SemanticTokensParams &params, nlohmann::json id)
 {
     // on textDocument/semanticTokens message
@@ -994,6 +1120,96 @@ void ArkLanguageServer::OnCodeLens(const TextDocumentParams &params, nlohmann::j
     Server->FindCodeLens(file, std::move(reply));
 }
 
+void ArkLanguageServer::OnDocumentFormatting(const DocumentFormattingParams &params, nlohmann::json id)
+{
+    Logger& logger = Logger::Instance();
+    logger.LogMessage(MessageType::MSG_LOG, "ArkLanguageServer::OnDocumentFormatting in");
+    std::string file = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
+    if (!CheckFileInCangjieProject(file)) {
+        ReplyError(id);
+        return;
+    }
+    DocCache::Doc doc = DocMgr.GetDoc(file);
+    if (doc.version == -1) {
+        std::stringstream log;
+        CleanAndLog(log, "No didopen was received before OnDocumentFormatting, file:" + file);
+        logger.LogMessage(MessageType::MSG_WARNING, log.str());
+        ReplyError(id);
+        return;
+    }
+
+    // formatted on the worker after the edits received before, the edits apply to the snapshot the request was for
+    auto format = [file, contents = std::move(doc.contents), options = params.options]() {
+        std::vector<TextEdit> edits;
+        (void)FormattingImpl::FormatDocument(file, contents, options, edits);
+        return edits;
+    };
+    auto name = FormattingTaskName("DocumentFormatting", id);
+    Server->RunFormatting(name, file, std::move(format), ReplyTo(std::move(id)));
+}
+
+void ArkLanguageServer::OnDocumentRangeFormatting(const DocumentRangeFormattingParams &params, nlohmann::json id)
+{
+    Logger& logger = Logger::Instance();
+    logger.LogMessage(MessageType::MSG_LOG, "ArkLanguageServer::OnDocumentRangeFormatting in");
+    std::string file = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
+    if (!CheckFileInCangjieProject(file)) {
+        ReplyError(id);
+        return;
+    }
+    DocCache::Doc doc = DocMgr.GetDoc(file);
+    if (doc.version == -1) {
+        std::stringstream log;
+        CleanAndLog(log, "No didopen was received before OnDocumentRangeFormatting, file:" + file);
+        logger.LogMessage(MessageType::MSG_WARNING, log.str());
+        ReplyError(id);
+        return;
+    }
+
+    auto format = [file, contents = std::move(doc.contents), range = params.range, options = params.options]() {
+        std::vector<TextEdit> edits;
+        (void)FormattingImpl::FormatRange(file, contents, range, options, edits);
+        return edits;
+    };
+    auto name = FormattingTaskName("RangeFormatting", id);
+    Server->RunFormatting(name, file, std::move(format), ReplyTo(std::move(id)));
+}
+
+void ArkLanguageServer::OnDocumentOnTypeFormatting(const DocumentOnTypeFormattingParams &params, nlohmann::json id)
+{
+    Logger& logger = Logger::Instance();
+    logger.LogMessage(MessageType::MSG_LOG, "ArkLanguageServer::OnDocumentOnTypeFormatting in");
+    std::string file = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
+    if (!CheckFileInCangjieProject(file)) {
+        ReplyError(id);
+        return;
+    }
+    DocCache::Doc doc = DocMgr.GetDoc(file);
+    if (doc.version == -1) {
+        std::stringstream log;
+        CleanAndLog(log, "No didopen was received before OnDocumentOnTypeFormatting, file:" + file);
+        logger.LogMessage(MessageType::MSG_WARNING, log.str());
+        ReplyError(id);
+        return;
+    }
+
+    auto format = [file, contents = std::move(doc.contents), params]() {
+        std::vector<TextEdit> edits;
+        (void)FormattingImpl::FormatOnType(file, contents, params.position, params.ch, params.options, edits);
+        return edits;
+    };
+    auto name = FormattingTaskName("OnTypeFormatting", id);
+    Server->RunFormatting(name, file, std::move(format), ReplyTo(std::move(id)));
+}
+
+Callback<ValueOrError> ArkLanguageServer::ReplyTo(nlohmann::json id)
+{
+    return [id = std::move(id), this](ValueOrError result) mutable {
+        std::lock_guard<std::mutex> lock(transp.transpWriter);
+        transp.Reply(std::move(id), std::move(result));
+    };
+}
+
 std::vector<DiagnosticToken> ArkLanguageServer::GetDiagsOfCurFile(std::string file)
 {
     std::vector<DiagnosticToken> value;
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <map>
 #include <memory>
 #include <atomic>
 #include <vector>
@@ -78,6 +79,13 @@ private:
 
     void OnDocumentDidClose(const DidCloseTextDocumentParams &params);
 
+    bool IsOpenByAnyClient(const std::string &file) const;
+
+    // Close the documents only the client had open, it is gone.
+    void CloseDocsOfClient(int client);
+
+    void CloseDoc(const std::string &file, const std::string &uri);
+
     void OnTrackCompletion(const TrackCompletionParams &params);
 
     void OnDocumentHighlight(const TextDocumentPositionParams &params, nlohmann::json documentHighlightId);
@@ -94,6 +102,8 @@ private:
 
     void OnCompletion(const CompletionParams &params, nlohmann::json id);
 
+    void OnCompletionResolve(const CompletionResolveParams &params, nlohmann::json id);
+
     void OnPrepareRename(const TextDocumentPositionParams &params, nlohmann::json id);
 
     void OnRename(const RenameParams &params, nlohmann::json id);
@@ -102,6 +112,12 @@ private:
 
     void OnCodeLens(const TextDocumentParams &params, nlohmann::json id);
 
+    void OnDocumentFormatting(const DocumentFormattingParams &params, nlohmann::json id);
+
+    void OnDocumentRangeFormatting(const DocumentRangeFormattingParams &params, nlohmann::json id);
+
+    void OnDocumentOnTypeFormatting(const DocumentOnTypeFormattingParams &params, nlohmann::json id);
+
     void OnWorkspaceSymbol(const WorkspaceSymbolParams &params, nlohmann::json id);
 
     void Notify(const std::string &method, const ValueOrError &params);
@@ -144,6 +160,9 @@ private:
         transp.Reply(std::move(id), ValueOrError(ValueOrErrorCheck::VALUE, result));
     }
 
+    // Replies to the request id with the result it is called with, from any thread.
+    Callback<ValueOrError> ReplyTo(nlohmann::json id);
+
     std::mutex fixItsMutex {};
 
     std::unordered_map<std::string, std::set<DiagnosticToken, DiagnosticCompare>> fixItsMap {};
@@ -163,6 +182,12 @@ private:
     Environment envs;
 
     TextDocumentSyncKind syncKind {TextDocumentSyncKind::SK_NONE};
+
+    // root uri of the workspace which has been compiled, shared by all clients of a socket transport
+    std::string compiledRoot {};
+
+    // uri of the documents each client has open, by path
+    std::map<int, std::map<std::string, std::string>> openDocs {};
 };
 } // namespace ark
 
@@ -8,8 +8,11 @@
 #include "common/BasicHelper.h"
 
 namespace ark {
-    ArkScheduler::ArkScheduler(Callbacks *c) : barrier(1), workerThreads(new AsyncTaskRunner()), callback(c),
-                                               worker(ArkASTWorker::Create(*workerThreads, barrier, callback)) {}
+ArkScheduler::ArkScheduler(Callbacks *c, std::size_t readerThreads)
+    : barrier(1), workerThreads(new AsyncTaskRunner()), callback(c),
+      readerPool(readerThreads > 0 ? std::make_unique<ThrdPool>(readerThreads) : nullptr),
+      syntaxWorker(std::make_unique<ArkSyntaxWorker>(c)),
+      worker(ArkASTWorker::Create(*workerThreads, barrier, callback, readerPool.get())) {}
 
 ArkScheduler::~ArkScheduler() noexcept
 {
@@ -38,4 +41,20 @@ void ArkScheduler::RunWithASTCache(
 {
     worker->RunWithASTCache(name, file, pos, std::move(action));
 }
+
+void ArkScheduler::RunWithSyntax(const std::string &file, std::function<void(const SyntaxSnapshot &)> action) const
+{
+    syntaxWorker->RunWithSyntax(file, std::move(action));
+}
+
+void ArkScheduler::RunWithoutAST(const std::string &name, const std::string &file,
+                                 std::function<void()> action) const
+{
+    worker->RunWithoutAST(name, file, std::move(action));
+}
+
+void ArkScheduler::ForgetSyntax(const std::string &file) const
+{
+    syntaxWorker->ForgetSyntax(file);
+}
 } // namespace ark
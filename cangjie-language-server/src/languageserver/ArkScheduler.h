@@ -10,11 +10,13 @@
 #include <map>
 #include "ArkThreading.h"
 #include "ArkASTWorker.h"
+#include "ArkSyntaxWorker.h"
 
 namespace ark {
 class ArkScheduler {
 public:
-    explicit ArkScheduler(Callbacks *c);
+    // readerThreads > 0 lets read-only requests run concurrently on a bounded pool of that size.
+    explicit ArkScheduler(Callbacks *c, std::size_t readerThreads = 0);
     ~ArkScheduler() noexcept;
 
     void Update(const ParseInputs &inputs, NeedDiagnostics needDiag) const;
@@ -24,11 +26,23 @@ public:
     void RunWithASTCache(
         const std::string &name, const std::string &file, Position pos, std::function<void(InputsAndAST)> action) const;
 
+    // Run action with the parse of the current text of file, it never waits for the AST worker.
+    void RunWithSyntax(const std::string &file, std::function<void(const SyntaxSnapshot &)> action) const;
+
+    void RunWithoutAST(const std::string &name, const std::string &file, std::function<void()> action) const;
+
+    void ForgetSyntax(const std::string &file) const;
+
 private:
     Semaphore barrier;
     AsyncTaskRunner *workerThreads = nullptr;
     Callbacks *callback = nullptr;
 
+    // must outlive the worker, it is destroyed after workerThreads has been joined
+    std::unique_ptr<ThrdPool> readerPool;
+
+    std::unique_ptr<ArkSyntaxWorker> syntaxWorker;
+
     // worker will be freed after polling thread exit
     // we call worker->stop to free worker
     ArkASTWorker *worker = nullptr;
@@ -5,8 +5,11 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "ArkServer.h"
+#include <algorithm>
+#include <queue>
 #include <utility>
 #include <string>
+#include <thread>
 #include <cangjie/Utils/FileUtil.h>
 #include <cangjie/Utils/ConstantsUtils.h>
 #include "capabilities/semanticHighlight/SemanticTokensAdaptor.h"
@@ -27,7 +30,78 @@ bool Contains(const Cangjie::StringPart &str, Cangjie::Position pos)
 };
 
 namespace ark {
+namespace {
+// The documentation of an indexed symbol is read from the index, it was extracted when the symbol was indexed.
+void FillDocumentation(CompletionItem &item, lsp::SymbolID id)
+{
+    if (id == lsp::INVALID_SYMBOL_ID) {
+        return;
+    }
+    if (auto doc = CompilerCangjieProject::GetInstance()->GetMemIndex()->FindDoc(id)) {
+        item.documentation = std::move(*doc);
+    }
+}
+
+void ReplyCodeLens(const std::vector<CodeLens> &result, const Callback<ValueOrError> &reply)
+{
+    nlohmann::json jsonValue;
+    if (result.empty()) {
+        jsonValue = nullptr;
+    }
+    for (auto &codeLens : result) {
+        nlohmann::json temp;
+        (void) ToJSON(codeLens, temp);
+        (void) jsonValue.push_back(temp);
+    }
+    ValueOrError value(ValueOrErrorCheck::VALUE, jsonValue);
+    reply(value);
+}
+
+nlohmann::json OutlineToJSON(const std::vector<DocumentSymbol> &outline)
+{
+    nlohmann::json jsonValue;
+    for (auto &documentSymbol: outline) {
+        nlohmann::json temp;
+        if (!ToJSON(documentSymbol, temp)) {
+            continue;
+        }
+        (void)jsonValue.push_back(temp);
+    }
+    return jsonValue;
+}
+
+void ReplyBreakpoints(const std::set<BreakpointLocation> &result, const Callback<ValueOrError> &reply)
+{
+    nlohmann::json jsonValue;
+    if (result.empty()) {
+        jsonValue = nullptr;
+    }
+    for (auto &breakpointLocation : result) {
+        nlohmann::json temp;
+        (void) ToJSON(breakpointLocation, temp);
+        (void) jsonValue.push_back(temp);
+    }
+    nlohmann::json ret;
+    ret["breakpointLocation"] = jsonValue;
+    ValueOrError value(ValueOrErrorCheck::VALUE, ret);
+    reply(value);
+}
+} // namespace
+
 using namespace Cangjie;
+// Upper bound of threads answering read-only requests (hover, definition, references...) concurrently.
+const std::size_t MAX_READER_THREAD_COUNT = 4;
+
+std::size_t GetReaderThreadCount()
+{
+    // keep every request on the worker thread in UT so that results are deterministic
+    if (Options::GetInstance().IsOptionSet("test")) {
+        return 0;
+    }
+    const std::size_t quarter = std::thread::hardware_concurrency() >> 2;
+    return std::max<std::size_t>(1, std::min(quarter, MAX_READER_THREAD_COUNT));
+}
+
 bool CompareCallHierarchyOutgoingCall(const CallHierarchyOutgoingCall &letf, const CallHierarchyOutgoingCall &right)
 {
     return letf.fromRanges[0].start < right.fromRanges[0].start;
@@ -35,7 +109,7 @@ bool CompareCallHierarchyOutgoingCall(const CallHierarchyOutgoingCall &letf, con
 
 ArkServer::ArkServer(Callbacks *callbacks) : callback(callbacks)
 {
-    arkScheduler = std::make_unique<ark::ArkScheduler>(callback);
+    arkScheduler = std::make_unique<ark::ArkScheduler>(callback, GetReaderThreadCount());
     arkSchedulerOfComplete = std::make_unique<ark::ArkScheduler>(callback);
     arkSchedulerOfSignature = std::make_unique<ark::ArkScheduler>(callback);
 }
@@ -381,6 +455,15 @@ void ArkServer::LocateSymbolAt(const std::string &file,
                     for (auto &item: message.functionParameters) {
                         (void) Value["functionParameters"].push_back(item);
                     }
+                    for (auto &definition: message.definitions) {
+                        nlohmann::json location;
+                        location["uri"] = definition.uri.file;
+                        location["range"]["start"]["line"] = definition.range.start.line;
+                        location["range"]["start"]["character"] = definition.range.start.column;
+                        location["range"]["end"]["line"] = definition.range.end.line;
+                        location["range"]["end"]["character"] = definition.range.end.column;
+                        (void) Value["definitions"].push_back(location);
+                    }
                     (void) jsonValue["crossMessage"].push_back(Value);
                 }
             }
@@ -452,7 +535,7 @@ void ArkServer::FindCompletion(const CompletionParams &params, const std::string
         params.position.column
     };
 
-    auto action = [reply, nullValueReply, params, pos](const InputsAndAST &input) {
+    auto action = [this, reply, nullValueReply, params, pos](const InputsAndAST &input) {
         CompletionResult result;
         std::string prefix;
         if (input.ast == nullptr) {
@@ -460,30 +543,111 @@ void ArkServer::FindCompletion(const CompletionParams &params, const std::string
             return;
         }
         CompletionImpl::CodeComplete(*(input.ast), pos, result, prefix);
-        CompilerCangjieProject::GetInstance()->ClearParseCache();
+        // Keep the best MAX_COMPLETION_ITEMS candidates in a heap whose top is the worst of them,
+        // only those are rendered and serialised. Rendering resolves the details from the parsed nodes,
+        // so the parse cache is cleared after it.
+        using ScoredIndex = std::pair<double, size_t>;
+        auto better = [&result](const ScoredIndex &left, const ScoredIndex &right) {
+            if (left.first != right.first) {
+                return left.first > right.first;
+            }
+            return result.completions[left.second].label < result.completions[right.second].label;
+        };
+        std::priority_queue<ScoredIndex, std::vector<ScoredIndex>, decltype(better)> topItems(better);
+        auto rankingContext = CompilerCangjieProject::GetInstance()->GetRankingContext(result.curPkgName);
+        size_t matched = 0;
+        bool afterDot = !prefix.empty() && prefix.back() == '.';
+        for (size_t i = 0; i < result.completions.size(); ++i) {
+            auto &iter = result.completions[i];
+            if (!afterDot && !IsMatchingCompletion(prefix, iter.name)) { continue; }
+            if (iter.name.find(BOX_DECL_PREFIX) != std::string::npos) { continue; }
+            ++matched;
+            auto score = CompilerCangjieProject::GetInstance()->CalculateScore(iter, prefix, result.cursorDepth,
+                rankingContext);
+            if (topItems.size() < CONSTANTS::MAX_COMPLETION_ITEMS) {
+                topItems.push({score, i});
+            } else if (better({score, i}, topItems.top())) {
+                topItems.pop();
+                topItems.push({score, i});
+            }
+        }
+        std::vector<ScoredIndex> selected;
+        selected.reserve(topItems.size());
+        while (!topItems.empty()) {
+            selected.push_back(topItems.top());
+            topItems.pop();
+        }
+        // keep the order in which the completers produced the items
+        std::sort(selected.begin(), selected.end(),
+            [](const ScoredIndex &left, const ScoredIndex &right) { return left.second < right.second; });
+
         CompletionList completionList;
-        for (auto &iter : result.completions) {
-            if (prefix.back() == '.' || IsMatchingCompletion(prefix, iter.name)) {
-                if (iter.name.find(BOX_DECL_PREFIX) != std::string::npos) { continue; }
-                auto score = CompilerCangjieProject::GetInstance()->CalculateScore(iter, prefix, result.cursorDepth);
-                completionList.items.push_back(iter.Render(GetSortText(score), prefix));
+        completionList.isIncomplete = matched > selected.size();
+        std::vector<lsp::SymbolID> ids;
+        for (auto &[score, index] : selected) {
+            completionList.items.push_back(result.completions[index].Render(GetSortText(score), prefix));
+            ids.push_back(result.completions[index].id);
+            if (!completionResolveSupport) {
+                FillDocumentation(completionList.items.back(), ids.back());
             }
         }
+        CompilerCangjieProject::GetInstance()->ClearParseCache();
 
+        uint64_t generation = 0;
+        if (completionResolveSupport) {
+            std::lock_guard<std::mutex> lock(completionCacheMtx);
+            generation = ++completionGeneration;
+            lastCompletionItems = completionList.items;
+            lastCompletionIds = std::move(ids);
+        }
         nlohmann::json jsonItems;
-        for (auto &iter : completionList.items) {
+        for (size_t i = 0; i < completionList.items.size(); ++i) {
             nlohmann::json value;
-            if (!ToJSON(iter, value)) { continue; }
+            if (!ToJSON(completionList.items[i], value)) { continue; }
+            if (completionResolveSupport) {
+                // the heavy fields are sent on completionItem/resolve for the item the user selects
+                (void)value.erase("detail");
+                (void)value.erase("documentation");
+                (void)value.erase("additionalTextEdits");
+                value["data"]["generation"] = generation;
+                value["data"]["index"] = i;
+            }
             (void)jsonItems.push_back(value);
         }
+        if (completionList.isIncomplete) {
+            nlohmann::json jsonList;
+            jsonList["isIncomplete"] = true;
+            jsonList["items"] = std::move(jsonItems);
+            jsonItems = std::move(jsonList);
+        }
         ValueOrError val(ValueOrErrorCheck::VALUE, jsonItems);
         reply(val);
-        CompilerCangjieProject::GetInstance()->ClearParseCache();
     };
 
     arkSchedulerOfComplete->RunWithASTCache("Completion", file, pos, action);
 }
 
+void ArkServer::ResolveCompletion(const CompletionResolveParams &params, const Callback<ValueOrError> &reply) const
+{
+    CompletionItem item;
+    lsp::SymbolID id = lsp::INVALID_SYMBOL_ID;
+    {
+        std::lock_guard<std::mutex> lock(completionCacheMtx);
+        if (params.generation != completionGeneration || params.index >= lastCompletionItems.size() ||
+            lastCompletionItems[params.index].label != params.label) {
+            // the item belongs to an older completion list, nothing more to add, the client keeps it as it is
+            reply(ValueOrError(ValueOrErrorCheck::VALUE, params.item));
+            return;
+        }
+        item = lastCompletionItems[params.index];
+        id = lastCompletionIds[params.index];
+    }
+    FillDocumentation(item, id);
+    nlohmann::json value;
+    (void)ToJSON(item, value);
+    reply(ValueOrError(ValueOrErrorCheck::VALUE, value));
+}
+
 void ArkServer::FindSignatureHelp(const SignatureHelpParams &params, const std::string &file,
                                   const Callback<ValueOrError> &reply) const
 {
@@ -597,7 +761,12 @@ void ArkServer::Rename(const std::string &file, const RenameParams &params,
 
         auto newName = params.newName;
         std::vector<TextDocumentEdit> result;
-        std::string path = RenameImpl::Rename(*(inputAST.ast), result, pos, newName, *callback);
+        MessageErrorDetail errorInfo;
+        std::string path = RenameImpl::Rename(*(inputAST.ast), result, pos, newName, *callback, errorInfo);
+        if (!errorInfo.message.empty()) {
+            reply(ValueOrError(ValueOrErrorCheck::ERR, errorInfo));
+            return;
+        }
         nlohmann::json jsonValue;
         if (result.empty()) {
             jsonValue = nullptr;
@@ -621,6 +790,31 @@ void ArkServer::Rename(const std::string &file, const RenameParams &params,
 
 void ArkServer::FindBreakpoints(const std::string &file, const Callback<ValueOrError> &reply) const
 {
+    bool analysed = false;
+    {
+        auto project = CompilerCangjieProject::GetInstance();
+        std::unique_lock<std::recursive_mutex> lock(project->fileCacheMtx);
+        analysed = project->GetArkAST(file) && !project->CheckNeedCompiler(file);
+    }
+    // A debugger asks for the breakpoints of many files at session start. Those whose lines are known for the
+    // current text are replied without compiling. Until the file is analysed, those of a parse alone are used,
+    // parsed on the syntax thread, which never waits for the compilations queued on the AST worker.
+    size_t hash = std::hash<std::string>{}(callback->GetContentsByFile(file));
+    bool parsedOnly = !analysed || callback->NeedReParser(file);
+    std::set<BreakpointLocation> known;
+    if (BreakpointsImpl::FindBreakpoints(file, hash, parsedOnly, known)) {
+        ReplyBreakpoints(known, reply);
+        return;
+    }
+    if (parsedOnly) {
+        auto replyParsed = [file, reply](const SyntaxSnapshot &snapshot) {
+            std::set<BreakpointLocation> result;
+            BreakpointsImpl::ToBreakpoints(file, snapshot.breakpointLines, result);
+            ReplyBreakpoints(result, reply);
+        };
+        arkScheduler->RunWithSyntax(file, replyParsed);
+        return;
+    }
     auto action = [file, reply = std::move(reply)](const InputsAndAST &inputAST) mutable {
         auto nullValueReply = [reply]() {
             ValueOrError value(ValueOrErrorCheck::VALUE, nullptr);
@@ -631,26 +825,27 @@ void ArkServer::FindBreakpoints(const std::string &file, const Callback<ValueOrE
             return;
         }
         std::set<BreakpointLocation> result;
-        BreakpointsImpl::Breakpoints(*(inputAST.ast), result);
-        nlohmann::json jsonValue;
-        if (result.empty()) {
-            jsonValue = nullptr;
-        }
-        for (auto &breakpointLocation : result) {
-            nlohmann::json temp;
-            (void) ToJSON(breakpointLocation, temp);
-            (void) jsonValue.push_back(temp);
-        }
-        nlohmann::json ret;
-        ret["breakpointLocation"] = jsonValue;
-        ValueOrError value(ValueOrErrorCheck::VALUE, ret);
-        reply(value);
+        BreakpointsImpl::Breakpoints(*(inputAST.ast), std::hash<std::string>{}(inputAST.inputs.contents), result);
+        ReplyBreakpoints(result, reply);
     };
     arkScheduler->RunWithAST("FindBreakpoints", file, action);
 }
 
 void ArkServer::FindCodeLens(const std::string &file, const Callback<ValueOrError> &reply) const
 {
+    bool analysed = false;
+    {
+        auto project = CompilerCangjieProject::GetInstance();
+        std::unique_lock<std::recursive_mutex> lock(project->fileCacheMtx);
+        analysed = project->GetArkAST(file) && !project->CheckNeedCompiler(file);
+    }
+    if (!analysed || callback->NeedReParser(file)) {
+        // Finding tests needs the syntax only, answer from a parse instead of waiting for the package to be
+        // compiled and its macros expanded. Once it is, lenses come from the expanded AST.
+        auto replyParsed = [reply](const SyntaxSnapshot &snapshot) { ReplyCodeLens(snapshot.lenses, reply); };
+        arkScheduler->RunWithSyntax(file, replyParsed);
+        return;
+    }
     auto action = [file, reply = std::move(reply)](const InputsAndAST &inputAST) mutable {
         auto nullValueReply = [reply]() {
             ValueOrError value(ValueOrErrorCheck::VALUE, nullptr);
@@ -662,23 +857,22 @@ void ArkServer::FindCodeLens(const std::string &file, const Callback<ValueOrErro
         }
         std::vector<CodeLens> result;
         CodeLensImpl::GetCodeLens(*(inputAST.ast), result);
-        nlohmann::json jsonValue;
-        if (result.empty()) {
-            jsonValue = nullptr;
-        }
-        for (auto &codeLens : result) {
-            nlohmann::json temp;
-            (void) ToJSON(codeLens, temp);
-            (void) jsonValue.push_back(temp);
-        }
-        nlohmann::json ret;
-        ret = jsonValue;
-        ValueOrError value(ValueOrErrorCheck::VALUE, ret);
-        reply(value);
+        ReplyCodeLens(result, reply);
     };
     arkScheduler->RunWithAST("FindCodeLens", file, action);
 }
 
+void ArkServer::RunFormatting(const std::string &name, const std::string &file,
+                              std::function<std::vector<TextEdit>()> format, const Callback<ValueOrError> &reply) const
+{
+    auto action = [format = std::move(format), reply]() {
+        nlohmann::json value;
+        (void)ToJSON(format(), value);
+        reply(ValueOrError(ValueOrErrorCheck::VALUE, value));
+    };
+    arkScheduler->RunWithoutAST(name, file, std::move(action));
+}
+
 void ArkServer::ChangeWatchedFiles(const std::string &file, FileChangeType type, DocCache *docMgr) const
 {
     auto action = [this, file, type, docMgr](const InputsAndAST &input) {
@@ -697,6 +891,12 @@ void ArkServer::ChangeWatchedFiles(const std::string &file, FileChangeType type,
             Logger::Instance().LogMessage(MessageType::MSG_INFO, "delete the file:  " + file);
             CompilerCangjieProject::GetInstance()->IncrementForFileDelete(file);
             this->callback->RemoveDocByFile(input.inputs.fileName);
+            {
+                std::lock_guard<std::mutex> lock(outlineCacheMtx);
+                (void)outlineCache.erase(file);
+            }
+            arkScheduler->ForgetSyntax(file);
+            BreakpointsImpl::ForgetBreakpoints(file);
         }
         if (!FileUtil::FileExist(input.onEditFile)) {
             return;
@@ -720,31 +920,86 @@ void ArkServer::AddDoc(const std::string &file, const std::string &contents,
     arkScheduler->Update(parseInputs, needDiagnostics);
 }
 
+bool ArkServer::FindCachedOutline(const std::string &file, int64_t version, uint64_t generation,
+                                  const Callback<ValueOrError> &reply) const
+{
+    nlohmann::json outline;
+    {
+        std::lock_guard<std::mutex> lock(outlineCacheMtx);
+        auto found = outlineCache.find(file);
+        if (found == outlineCache.end() || found->second.version != version ||
+            (generation != 0 && found->second.generation != generation)) {
+            return false;
+        }
+        outline = found->second.outline;
+    }
+    ValueOrError value(ValueOrErrorCheck::VALUE, outline);
+    reply(value);
+    return true;
+}
+
 void ArkServer::FindDocumentSymbol(const DocumentSymbolParams &params, const Callback<ValueOrError> &reply) const
 {
-    auto action = [params, reply](const InputsAndAST &inputAST) mutable {
+    std::string file = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
+    // Outline, breadcrumbs and sticky scroll ask again on every cursor move. While the document and its analysis
+    // are unchanged the last outline is replied at once instead of queueing behind the AST worker.
+    bool analysed = false;
+    uint64_t generation = 0;
+    {
+        auto project = CompilerCangjieProject::GetInstance();
+        std::unique_lock<std::recursive_mutex> lock(project->fileCacheMtx);
+        auto ast = project->GetArkAST(file);
+        analysed = ast != nullptr;
+        // a package waiting to be compiled again may change the types shown even if this file did not change
+        if (ast && !project->CheckNeedCompiler(file)) {
+            generation = ast->generation;
+        }
+    }
+    int64_t version = callback->GetVersionByFile(file);
+    if (generation != 0 && FindCachedOutline(file, version, generation, reply)) {
+        return;
+    }
+    if (analysed && (generation == 0 || callback->NeedReParser(file))) {
+        // Sema is pending after an edit or for the package. Until it is done the outline of the same text, from
+        // an older analysis or else from a parse alone, is replied rather than waiting for the compilation. The
+        // first analysis of a file is waited for.
+        if (Cangjie::FileUtil::HasExtension(file, CONSTANTS::CANGJIE_MACRO_FILE_EXTENSION)) {
+            ValueOrError value(ValueOrErrorCheck::VALUE, nullptr);
+            reply(value);
+            return;
+        }
+        if (FindCachedOutline(file, version, 0, reply)) {
+            return;
+        }
+        auto replyParsed = [reply](const SyntaxSnapshot &snapshot) {
+            ValueOrError value(ValueOrErrorCheck::VALUE, OutlineToJSON(snapshot.outline));
+            reply(value);
+        };
+        arkScheduler->RunWithSyntax(file, replyParsed);
+        return;
+    }
+    auto action = [file, reply, this](const InputsAndAST &inputAST) mutable {
         std::vector<DocumentSymbol> result;
-        auto filePath = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
         // To avoid queue task in runWithAST crashing
-        if (inputAST.ast == nullptr || !CompilerCangjieProject::GetInstance()->FileHasSemaCache(filePath)
-            || Cangjie::FileUtil::HasExtension(filePath, CONSTANTS::CANGJIE_MACRO_FILE_EXTENSION)) {
+        if (inputAST.ast == nullptr || !CompilerCangjieProject::GetInstance()->FileHasSemaCache(file)
+            || Cangjie::FileUtil::HasExtension(file, CONSTANTS::CANGJIE_MACRO_FILE_EXTENSION)) {
             ValueOrError value(ValueOrErrorCheck::VALUE, nullptr);
             reply(value);
             return;
         }
+        // an earlier request in the queue may have computed it already
+        if (FindCachedOutline(file, inputAST.inputs.version, inputAST.ast->generation, reply)) {
+            return;
+        }
         DocumentSymbolImpl::FindDocumentSymbols(*(inputAST.ast), result);
-        nlohmann::json jsonValue;
-        for (auto &documentSymbol: result) {
-            nlohmann::json temp;
-            if (!ToJSON(documentSymbol, temp)) {
-                continue;
-            }
-            (void)jsonValue.push_back(temp);
+        nlohmann::json jsonValue = OutlineToJSON(result);
+        {
+            std::lock_guard<std::mutex> lock(outlineCacheMtx);
+            outlineCache[file] = {inputAST.inputs.version, inputAST.ast->generation, jsonValue};
         }
         ValueOrError value(ValueOrErrorCheck::VALUE, jsonValue);
         reply(value);
     };
-    std::string file = FileStore::NormalizePath(URI::Resolve(params.textDocument.uri.file));
     arkScheduler->RunWithAST("DocumentSymbol", file, action);
 }
 
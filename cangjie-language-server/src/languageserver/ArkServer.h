@@ -74,6 +74,14 @@ public:
     void FindCompletion(const CompletionParams &params, const std::string &file,
                         const Callback <ValueOrError> &reply) const;
 
+    // Fill in detail, documentation and import edits left out of the last completion reply.
+    void ResolveCompletion(const CompletionResolveParams &params, const Callback<ValueOrError> &reply) const;
+
+    void SetCompletionResolveSupport(bool support)
+    {
+        completionResolveSupport = support;
+    }
+
     void PrepareRename(const std::string &file,
                        const TextDocumentPositionParams &params, const Callback<ValueOrError> &reply) const;
 
@@ -87,6 +95,10 @@ public:
 
     void FindCodeLens(const std::string &file, const Callback <ValueOrError> &reply) const;
 
+    // Runs format on the worker of file after the edits received before it and replies with the edits it returns.
+    void RunFormatting(const std::string &name, const std::string &file,
+                       std::function<std::vector<TextEdit>()> format, const Callback<ValueOrError> &reply) const;
+
     void FindWorkspaceSymbols(const std::string &query, const Callback<ValueOrError> &reply) const;
 
     // Get hover for a given position.
@@ -109,6 +121,26 @@ private:
     std::unique_ptr<ark::ArkScheduler> arkScheduler;
     std::unique_ptr<ark::ArkScheduler> arkSchedulerOfComplete;
     std::unique_ptr<ark::ArkScheduler> arkSchedulerOfSignature;
+
+    // Items of the last completion reply, completionItem/resolve is answered from here.
+    mutable std::mutex completionCacheMtx;
+    mutable uint64_t completionGeneration = 0;
+    mutable std::vector<CompletionItem> lastCompletionItems;
+    // symbol of each item, 0 if it has none
+    mutable std::vector<lsp::SymbolID> lastCompletionIds;
+    bool completionResolveSupport = false;
+
+    // Last outline replied for each file, valid while the file version and its ArkAST stay the same.
+    struct OutlineCache {
+        int64_t version = 0;
+        uint64_t generation = 0;
+        nlohmann::json outline;
+    };
+    mutable std::mutex outlineCacheMtx;
+    mutable std::unordered_map<std::string, OutlineCache> outlineCache;
+
+    bool FindCachedOutline(const std::string &file, int64_t version, uint64_t generation,
+                           const Callback<ValueOrError> &reply) const;
 };
 } // namespace ark
 
@@ -0,0 +1,203 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "ArkSyntaxWorker.h"
+#include <set>
+#include <string_view>
+#include "cangjie/Parse/Parser.h"
+#include "capabilities/breakpoints/BreakpointsImpl.h"
+#include "capabilities/codeLens/CodeLensImpl.h"
+#include "capabilities/documentSymbol/DocumentSymbolImpl.h"
+#include "common/Utils.h"
+#include "logger/Logger.h"
+
+using namespace Cangjie;
+using namespace Cangjie::AST;
+
+namespace {
+void ShiftLines(std::vector<ark::DocumentSymbol> &symbols, int delta)
+{
+    for (auto &symbol : symbols) {
+        symbol.range.start.line += delta;
+        symbol.range.end.line += delta;
+        symbol.selectionRange.start.line += delta;
+        symbol.selectionRange.end.line += delta;
+        ShiftLines(symbol.children, delta);
+    }
+}
+
+void ShiftLines(std::vector<ark::CodeLens> &lenses, int delta)
+{
+    for (auto &lens : lenses) {
+        lens.range.start.line += delta;
+        lens.range.end.line += delta;
+        std::set<ark::ExecutableRange> arguments;
+        for (auto argument : lens.command.arguments) {
+            argument.range.start.line += delta;
+            argument.range.end.line += delta;
+            (void)arguments.insert(std::move(argument));
+        }
+        lens.command.arguments = std::move(arguments);
+    }
+}
+} // namespace
+
+namespace ark {
+ArkSyntaxWorker::ArkSyntaxWorker(Callbacks *c) : callback(c), thread([this] { Run(); }) {}
+
+ArkSyntaxWorker::~ArkSyntaxWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    jobReady.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void ArkSyntaxWorker::RunWithSyntax(const std::string &file, std::function<void(const SyntaxSnapshot &)> action)
+{
+    if (IsInCjlibDir(file)) {
+        return;
+    }
+    // read on the message thread, so the text parsed is the one the request was made against
+    int64_t version = callback->GetVersionByFile(file);
+    if (auto snapshot = GetSyntaxSnapshot(file, version)) {
+        action(*snapshot);
+        return;
+    }
+    std::string contents = callback->GetContentsByFile(file);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto job = jobs.find(file);
+        if (job == jobs.end()) {
+            queue.push_back(file);
+            job = jobs.emplace(file, Job{}).first;
+        }
+        // a parse of an older version not started yet is not needed any more, its requests get the newer text
+        if (job->second.actions.empty() || job->second.version != version) {
+            job->second.version = version;
+            job->second.contents = std::move(contents);
+        }
+        job->second.actions.push_back(std::move(action));
+    }
+    jobReady.notify_one();
+}
+
+std::shared_ptr<const SyntaxSnapshot> ArkSyntaxWorker::GetSyntaxSnapshot(const std::string &file,
+                                                                         int64_t version) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = snapshots.find(file);
+    if (found == snapshots.end() || found->second->version != version) {
+        return nullptr;
+    }
+    return found->second;
+}
+
+void ArkSyntaxWorker::ForgetSyntax(const std::string &file)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    (void)snapshots.erase(file);
+}
+
+void ArkSyntaxWorker::Run()
+{
+    for (;;) {
+        std::string file;
+        Job job;
+        std::shared_ptr<const SyntaxSnapshot> previous;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [this] { return done || !queue.empty(); });
+            if (done) {
+                return;
+            }
+            file = std::move(queue.front());
+            queue.pop_front();
+            auto found = jobs.find(file);
+            job = std::move(found->second);
+            (void)jobs.erase(found);
+            auto last = snapshots.find(file);
+            if (last != snapshots.end()) {
+                previous = last->second;
+            }
+        }
+        auto snapshot = Parse(file, job, previous.get());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshots[file] = snapshot;
+        }
+        Logger::Instance().CleanKernelLog(std::this_thread::get_id());
+        for (auto &action : job.actions) {
+            action(*snapshot);
+        }
+    }
+}
+
+std::shared_ptr<const SyntaxSnapshot> ArkSyntaxWorker::Parse(const std::string &file, const Job &job,
+                                                             const SyntaxSnapshot *previous) const
+{
+    size_t hash = std::hash<std::string>{}(job.contents);
+    ExecutableRange testRange = CodeLensImpl::GetFileTestRange(file);
+    if (previous && previous->hash == hash && previous->testPackage == testRange.packageName) {
+        auto same = std::make_shared<SyntaxSnapshot>(*previous);
+        same->version = job.version;
+        return same;
+    }
+    auto snapshot = std::make_shared<SyntaxSnapshot>();
+    snapshot->version = job.version;
+    snapshot->hash = hash;
+    snapshot->testPackage = testRange.packageName;
+    SourceManager sm;
+    DiagnosticEngine diag;
+    diag.SetSourceManager(&sm);
+    auto fileID = sm.AddSource(file, job.contents);
+    auto parsed = Parser(fileID, job.contents, diag, sm).ParseTopLevel();
+    if (!parsed) {
+        return snapshot;
+    }
+    ArkAST ast({file, job.contents}, parsed.get(), diag, nullptr, &sm);
+    std::unordered_map<std::string_view, const DeclSyntax *> unchanged;
+    bool samePackage = previous && previous->testPackage == snapshot->testPackage;
+    if (previous) {
+        for (auto &decl : previous->decls) {
+            (void)unchanged.emplace(decl.text, &decl);
+        }
+    }
+    for (auto &toplevelDecl : parsed->decls) {
+        if (!toplevelDecl) {
+            continue;
+        }
+        DeclSyntax decl;
+        decl.line = toplevelDecl->begin.line;
+        decl.text = sm.GetContentBetween(Position(fileID, decl.line, 1), toplevelDecl->end);
+        auto found = unchanged.find(decl.text);
+        if (found != unchanged.end()) {
+            decl.outline = found->second->outline;
+            ShiftLines(decl.outline, decl.line - found->second->line);
+        } else {
+            DocumentSymbolImpl::FindDocumentSymbol(ast, toplevelDecl.get(), decl.outline);
+        }
+        if (found != unchanged.end() && samePackage) {
+            decl.lenses = found->second->lenses;
+            ShiftLines(decl.lenses, decl.line - found->second->line);
+        } else {
+            CodeLensImpl::GetCodeLensByParse(testRange, ast, toplevelDecl.get(), decl.lenses);
+        }
+        snapshot->outline.insert(snapshot->outline.end(), decl.outline.begin(), decl.outline.end());
+        snapshot->decls.push_back(std::move(decl));
+    }
+    for (auto decl = snapshot->decls.rbegin(); decl != snapshot->decls.rend(); ++decl) {
+        snapshot->lenses.insert(snapshot->lenses.end(), decl->lenses.begin(), decl->lenses.end());
+    }
+    BreakpointsImpl::LinesByParse(parsed.get(), ast.tokens, snapshot->breakpointLines);
+    BreakpointsImpl::KeepParsedLines(file, hash, snapshot->breakpointLines);
+    return snapshot;
+}
+} // namespace ark
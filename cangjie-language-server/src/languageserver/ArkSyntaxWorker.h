@@ -0,0 +1,90 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef LSPSERVER_ARKSYNTAXWORKER_H
+#define LSPSERVER_ARKSYNTAXWORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ArkAST.h"
+#include "common/Callbacks.h"
+
+namespace ark {
+// What a top-level declaration gave, kept to be reused while its text is unchanged. The text runs from the start
+// of the first line of the declaration, the columns of its entries depend on what precedes it on that line.
+struct DeclSyntax {
+    std::string text;
+    int line = 0;
+    std::vector<DocumentSymbol> outline;
+    // last position first
+    std::vector<CodeLens> lenses;
+};
+
+// What the parse of one version of a file found, for requests that need its syntax only.
+// Sema has not run on it: types, inferred or not, are missing.
+struct SyntaxSnapshot {
+    int64_t version = 0;
+    // of the text parsed, a version with the same text takes the whole parse
+    size_t hash = 0;
+    // the package tests are run in, lenses are not reused once it changed
+    std::string testPackage;
+    std::vector<DocumentSymbol> outline;
+    std::vector<CodeLens> lenses;
+    // lines a breakpoint can be set on
+    std::vector<int> breakpointLines;
+    std::vector<DeclSyntax> decls;
+};
+
+// Parses files on a thread of its own, so that the requests needing the syntax only never wait for the compilations
+// queued on the AST worker. A file is parsed once per document version and text, and the outline and test lenses
+// of the top-level declarations whose text did not change are taken from the previous parse instead of being
+// built again.
+class ArkSyntaxWorker {
+public:
+    explicit ArkSyntaxWorker(Callbacks *c);
+    ~ArkSyntaxWorker();
+
+    // Run action with the parse of the current text of file, on the parsing thread unless it is already parsed.
+    void RunWithSyntax(const std::string &file, std::function<void(const SyntaxSnapshot &)> action);
+
+    // The parse of file if it was already parsed at version, nullptr otherwise.
+    std::shared_ptr<const SyntaxSnapshot> GetSyntaxSnapshot(const std::string &file, int64_t version) const;
+
+    void ForgetSyntax(const std::string &file);
+
+private:
+    struct Job {
+        int64_t version = 0;
+        std::string contents;
+        std::vector<std::function<void(const SyntaxSnapshot &)>> actions;
+    };
+
+    void Run();
+
+    std::shared_ptr<const SyntaxSnapshot> Parse(const std::string &file, const Job &job,
+                                                const SyntaxSnapshot *previous) const;
+
+    Callbacks *callback = nullptr;
+    mutable std::mutex mutex;
+    std::condition_variable jobReady;
+    bool done = false; /* GUARDED_BY(mutex) */
+    // files to parse in the order they were asked for, one job each, GUARDED_BY(mutex)
+    std::deque<std::string> queue;
+    std::unordered_map<std::string, Job> jobs;
+    // latest parse of each file, replaced when a newer version is parsed, GUARDED_BY(mutex)
+    std::unordered_map<std::string, std::shared_ptr<const SyntaxSnapshot>> snapshots;
+    std::thread thread;
+};
+} // namespace ark
+
+#endif // LSPSERVER_ARKSYNTAXWORKER_H
@@ -236,6 +236,9 @@ void CompilerCangjieProject::IncrementCompile(const std::string &filePath, const
     if (cycles.second) {
         ReportCircularDeps(cycles.first);
     }
+    if (cFunctionIndex) {
+        cFunctionIndex->Refresh();
+    }
     Trace::Log("Finish incremental compilation for package: ", fullPkgName);
 }
 
@@ -1038,7 +1041,7 @@ void CompilerCangjieProject::EraseOtherCache(const std::string &fullPkgName)
 void CompilerCangjieProject::FullCompilation()
 {
     if (MessageHeaderEndOfLine::GetIsDeveco() && lsp::CjdIndexer::GetInstance() != nullptr) {
-        lsp::CjdIndexer::GetInstance()->Build();
+        lsp::CjdIndexer::GetInstance()->Build(*thrdPool);
     }
     // Construct a dummy instance to load the CJO.
     BuildIndexFromCjo();
@@ -1074,6 +1077,10 @@ void CompilerCangjieProject::FullCompilation()
     }
     thrdPool->WaitUntilAllTasksComplete();
     Trace::Log("All tasks are completed in full compilation");
+    // C sources change along with the foreign funcs bound to them, the index follows the compilations
+    if (cFunctionIndex) {
+        cFunctionIndex->Refresh();
+    }
 }
 
 bool CompilerCangjieProject::LoadASTCache(const std::string &package)
@@ -1147,6 +1154,11 @@ bool CompilerCangjieProject::Compiler(const std::string &moduleUri,
     this->cacheManager = std::make_unique<lsp::CacheManager>(cachePath);
 #ifndef TEST_FLAG
     cacheManager->InitDir();
+    model->LoadUsage(FileUtil::JoinPath(FileUtil::JoinPath(cachePath, ".cache"), COMPLETION_USAGE_FILE));
+    cFunctionIndex = std::make_unique<lsp::CFunctionIndex>(
+        workspace, FileUtil::JoinPath(FileUtil::JoinPath(cachePath, ".cache"), C_FUNCTION_INDEX_FILE));
+#else
+    cFunctionIndex = std::make_unique<lsp::CFunctionIndex>(workspace, "");
 #endif
 
     // get condition compile from initializationOptions
@@ -1651,7 +1663,8 @@ void CompilerCangjieProject::BuildIndex(const std::unique_ptr<LSPCompilerInstanc
     // Need to rebuild index
     lsp::SymbolCollector sc = lsp::SymbolCollector(*ci->typeManager, ci->importManager, false);
     sc.SetArkAstMap(std::move(astMap));
-    sc.Build(*packages[0]);
+    // the threads of the compile pool which are free help with large packages
+    sc.Build(*packages[0], thrdPool.get());
 #ifndef TEST_FLAG
     if (isFullCompilation) {
         std::string sourceCodePath;
@@ -1681,9 +1694,10 @@ void CompilerCangjieProject::BuildIndex(const std::unique_ptr<LSPCompilerInstanc
     // Merge index to memory
     {
         std::unique_lock<std::mutex> indexLock(indexMtx);
-        (void) memIndex->pkgSymsMap.insert_or_assign(curPkgName, *sc.GetSymbolMap());
+        memIndex->UpdatePkgSymbols(curPkgName, *sc.GetSymbolMap());
         (void) memIndex->pkgRefsMap.insert_or_assign(curPkgName, *sc.GetReferenceMap());
-        (void) memIndex->pkgRelationsMap.insert_or_assign(curPkgName, *sc.GetRelations());
+        model->UpdateRefCounts(curPkgName, *sc.GetReferenceMap());
+        memIndex->UpdatePkgRelations(curPkgName, *sc.GetRelations());
         (void) memIndex->pkgExtendsMap.insert_or_assign(curPkgName, *sc.GetSymbolExtendMap());
         indexLock.unlock();
     }
@@ -1781,9 +1795,10 @@ void CompilerCangjieProject::BuildIndexFromCjo()
 
         // Merge index to memory
         {
-            (void)memIndex->pkgSymsMap.insert_or_assign(cjoPkgName, *sc.GetSymbolMap());
+            memIndex->UpdatePkgSymbols(cjoPkgName, *sc.GetSymbolMap());
             (void)memIndex->pkgRefsMap.insert_or_assign(cjoPkgName, *sc.GetReferenceMap());
-            (void)memIndex->pkgRelationsMap.insert_or_assign(cjoPkgName, *sc.GetRelations());
+            model->UpdateRefCounts(cjoPkgName, *sc.GetReferenceMap());
+            memIndex->UpdatePkgRelations(cjoPkgName, *sc.GetRelations());
             (void)memIndex->pkgExtendsMap.insert_or_assign(cjoPkgName, *sc.GetSymbolExtendMap());
         }
     }
@@ -1803,9 +1818,10 @@ void CompilerCangjieProject::BuildIndexFromCache(const std::string &package) {
         }
         {
             std::unique_lock<std::mutex> indexLock(mtx);
-            (void) memIndex->pkgSymsMap.insert_or_assign(package, indexCache->get()->symbols);
+            memIndex->UpdatePkgSymbols(package, std::move(indexCache->get()->symbols));
             (void) memIndex->pkgRefsMap.insert_or_assign(package, indexCache->get()->refs);
-            (void) memIndex->pkgRelationsMap.insert_or_assign(package, indexCache->get()->relations);
+            model->UpdateRefCounts(package, indexCache->get()->refs);
+            memIndex->UpdatePkgRelations(package, indexCache->get()->relations);
             (void) memIndex->pkgExtendsMap.insert_or_assign(package, indexCache->get()->extends);
         }
 }
@@ -1820,14 +1836,14 @@ std::unordered_set<std::string> CompilerCangjieProject::GetOneModuleDeps(const s
     return res;
 }
 
-std::unordered_set<std::string> CompilerCangjieProject::GetOneModuleDirectDeps(const std::string &curModule)
+bool CompilerCangjieProject::IsRequiredModule(const std::string &curModule, const std::string &module) const
 {
-    std::unordered_set<std::string> res;
-    auto found = moduleManager->requirePackages.find(curModule);
-    if (found != moduleManager->requirePackages.end()) {
-        return found->second;
-    }
-    return res;
+    return moduleManager->IsModuleRequired(curModule, module);
+}
+
+bool CompilerCangjieProject::IsDirectlyRequiredModule(const std::string &curModule, const std::string &module) const
+{
+    return moduleManager->IsModuleDirectlyRequired(curModule, module);
 }
 
 } // namespace ark
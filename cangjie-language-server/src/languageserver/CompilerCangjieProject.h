@@ -28,6 +28,7 @@
 #include "common/Callbacks.h"
 #include "common/FileStore.h"
 #include "common/LRUCache/LRUCache.h"
+#include "index/CFunctionIndex.h"
 #include "index/IndexStorage.h"
 #include "index/MemIndex.h"
 #include "logger/Logger.h"
@@ -353,6 +354,11 @@ public:
         return memIndex.get();
     }
 
+    lsp::CFunctionIndex *GetCFunctionIndex() const
+    {
+        return cFunctionIndex.get();
+    }
+
     CjoManager *GetCjoManager() const
     {
         return cjoManager.get();
@@ -363,9 +369,22 @@ public:
         return graph.get();
     }
 
-    double CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth) const
+    double CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth,
+        const RankingContext &context = {}) const
     {
-        return model->CalculateScore(item, prefix, cursorDepth);
+        return model->CalculateScore(item, prefix, cursorDepth, context);
+    }
+
+    RankingContext GetRankingContext(const std::string &curPkgName) const
+    {
+        RankingContext context;
+        context.curPkgName = curPkgName;
+        if (!curPkgName.empty()) {
+            context.directDeps = graph->GetDependencies(curPkgName);
+            context.allDeps = graph->FindAllDependencies(curPkgName);
+        }
+        model->SnapshotUsage(context);
+        return context;
     }
 
     void UpdateUsageFrequency(const std::string &item)
@@ -373,6 +392,11 @@ public:
         return model->UpdateUsageFrequency(item);
     }
 
+    void FlushUsage()
+    {
+        model->FlushUsage();
+    }
+
     bool CheckNeedCompiler(const std::string &fileName);
 
     void SubmitTasksToPool(const std::unordered_set<std::string> &tasks);
@@ -397,7 +421,9 @@ public:
 
     std::unordered_set<std::string> GetOneModuleDeps(const std::string &curModule);
 
-    std::unordered_set<std::string> GetOneModuleDirectDeps(const std::string &curModule);
+    bool IsRequiredModule(const std::string &curModule, const std::string &module) const;
+
+    bool IsDirectlyRequiredModule(const std::string &curModule, const std::string &module) const;
 
     std::string GetWorkSpace()
     {
@@ -502,6 +528,7 @@ private:
     std::unique_ptr<CjoManager> cjoManager = std::make_unique<CjoManager>();
     std::unique_ptr<DependencyGraph> graph = std::make_unique<DependencyGraph>();
     std::unique_ptr<lsp::MemIndex> memIndex = std::make_unique<lsp::MemIndex>();
+    std::unique_ptr<lsp::CFunctionIndex> cFunctionIndex;
     std::unique_ptr<SortModel> model = std::make_unique<SortModel>();
 
     std::unordered_map<std::string, std::string> fullPkgNameToPath;  // key: fullPkgName
@@ -64,10 +64,8 @@ void LSPCompilerInstance::UpdateUpstreamPkgs()
     }
 
     std::string curModule;
-    std::unordered_set<std::string> depends;
     if (!pkgNameForPath.empty()) {
         curModule = SplitQualifiedName(pkgNameForPath).front();
-        depends = ark::CompilerCangjieProject::GetInstance()->GetOneModuleDeps(curModule);
     }
 
     std::set<std::string> depPkgs;
@@ -89,7 +87,8 @@ void LSPCompilerInstance::UpdateUpstreamPkgs()
                 continue;
             }
             auto realModule = SplitQualifiedName(realDep).front();
-            if (curModule != realModule && depends.count(realModule) == 0) {
+            if (curModule != realModule &&
+                !ark::CompilerCangjieProject::GetInstance()->IsRequiredModule(curModule, realModule)) {
                 continue;
             }
             depPkgs.insert(realDep);
@@ -234,11 +233,7 @@ bool LSPCompilerInstance::ToImportPackage(const std::string &curModuleName,
     if (curModuleName.empty()) {
         return true;
     }
-    auto found = moduleManger->requireAllPackages.find(curModuleName);
-    if (found != moduleManger->requireAllPackages.end() && found->second.count(cjoModuleName)) {
-        return true;
-    }
-    return false;
+    return moduleManger->IsModuleRequired(curModuleName, cjoModuleName);
 }
 
 void LSPCompilerInstance::ImportUsrPackage(const std::string &curModuleName)
@@ -121,6 +121,9 @@ private:
         optionDescriptions["-h, --help"] = "Display this help information";
         optionDescriptions["-V, --verbose"] = "Record the crash logs when the cjpls crashes";
         optionDescriptions["--test"] = "For the execution of UT";
+        optionDescriptions["--listen=<addr>"] = "Serve many clients on a socket, <addr> is [host:]port or unix:<path>";
+        optionDescriptions["--connect=<addr>"] = "Connect to a client listening on [host:]port or unix:<path>";
+        optionDescriptions["--record=<file>"] = "Record the JSON-RPC traffic into <file> for replaying";
         // Add more options and their description here
         // ...
         // Add intenral flag for cj language server
@@ -94,6 +94,26 @@ public:
         }
     }
 
+    // Run func once a thread is free, it has no id and no dependencies and needs no TaskCompleted.
+    void AddTask(Task func)
+    {
+        std::unique_lock<std::mutex> lock(queueMu);
+        ++tasksRemaining;
+        readyTasks.push([this, func = std::move(func)]() {
+            func();
+            std::unique_lock<std::mutex> doneLock(queueMu);
+            if (--tasksRemaining == 0) {
+                completionCv.notify_all();
+            }
+        });
+        cv.notify_one();
+    }
+
+    size_t Size() const
+    {
+        return workers.size();
+    }
+
     void TaskCompleted(const uint64_t taskId)
     {
         std::unique_lock<std::mutex> lock(queueMu);
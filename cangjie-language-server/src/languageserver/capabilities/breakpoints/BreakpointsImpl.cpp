@@ -5,16 +5,27 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "BreakpointsImpl.h"
+#include <mutex>
 
 namespace ark {
-std::string BreakpointsImpl::curFilePath = "";
+namespace {
+// Lines a breakpoint can be set on, per file, for the text of the hash. They are found in the analysed AST of the
+// text or else in a parse alone, which replies before the first compilation ends.
+struct LineTable {
+    size_t hash = 0;
+    bool analysed = false;
+    std::vector<int> lines;
+};
+std::mutex g_lineTablesMtx;
+std::unordered_map<std::string, LineTable> g_lineTables;
+} // namespace
 
-void HandlePos(std::set<BreakpointLocation> &result, const ArkAST &ast, Position pos, const Node &token)
+void HandleBlockExit(std::set<int> &lines, Ptr<const Block> block, const std::vector<Token> &tokens);
+
+void HandlePos(std::set<int> &lines, const std::vector<Token> &tokens, Position pos, const Node &token)
 {
-    const std::string uri = URI::URIFromAbsolutePath(BreakpointsImpl::curFilePath).ToString();
-    PositionUTF8ToIDE(ast.tokens, pos, token);
-    const Range range = {{pos.fileID, pos.line - 1, 0}, {pos.fileID, pos.line - 1, 0}};
-    (void) result.insert({uri, range});
+    PositionUTF8ToIDE(tokens, pos, token);
+    (void) lines.insert(pos.line - 1);
 }
 
 bool containExpr(const Block &funcBody)
@@ -29,7 +40,7 @@ bool containExpr(const Block &funcBody)
     return false;
 }
 
-void HandleReturnExpr(std::set<BreakpointLocation> &result, const ArkAST &ast)
+void HandleReturnExpr(std::set<int> &lines, const ArkAST &ast)
 {
     if (!ast.packageInstance->ctx || !ast.packageInstance->ctx->searcher) {
         return;
@@ -44,72 +55,77 @@ void HandleReturnExpr(std::set<BreakpointLocation> &result, const ArkAST &ast)
         auto *retExpr = dynamic_cast<const ReturnExpr*>(symbol->node.get());
         if (!retExpr) { continue; }
         if (retExpr->refFuncBody && containExpr(*retExpr->refFuncBody->body)) {
-            HandlePos(result, ast, symbol->node->begin, *symbol->node);
+            HandlePos(lines, ast.tokens, symbol->node->begin, *symbol->node);
         }
     }
 }
 
-void HandleIfExpr(std::set<BreakpointLocation> &result, const Node &expr)
+void HandleIfExpr(std::set<int> &lines, const Node &expr, const std::vector<Token> &tokens)
 {
     auto *ifExpr = dynamic_cast<const IfExpr*>(&expr);
     if (!ifExpr) { return; }
-    BreakpointsImpl::HandleBlockExit(result, ifExpr->thenBody.get());
+    HandleBlockExit(lines, ifExpr->thenBody.get(), tokens);
     auto elseExpr = ifExpr->elseBody.get();
     if (!elseExpr) { return; }
     if (elseExpr->astKind == ASTKind::IF_EXPR) {
-        HandleIfExpr(result, *elseExpr);
+        HandleIfExpr(lines, *elseExpr, tokens);
     }
     if (elseExpr->astKind == ASTKind::BLOCK) {
         auto *elseBlock = dynamic_cast<const Block*>(elseExpr.get());
         if (!elseBlock) { return; }
-        BreakpointsImpl::HandleBlockExit(result, elseBlock);
+        HandleBlockExit(lines, elseBlock, tokens);
     }
 }
 
-void HandleMatchExpr(std::set<BreakpointLocation> &result, const Node &expr)
+void HandleMatchExpr(std::set<int> &lines, const Node &expr, const std::vector<Token> &tokens)
 {
     auto *matchExpr = dynamic_cast<const MatchExpr*>(&expr);
     if (!matchExpr) { return; }
     for (auto &matchCase : matchExpr->matchCases) {
         if (!matchCase) { continue; }
         auto matchBlock = matchCase->exprOrDecls.get();
-        BreakpointsImpl::HandleBlockExit(result, matchBlock);
+        HandleBlockExit(lines, matchBlock, tokens);
     }
     for (auto &matchCaseOther : matchExpr->matchCaseOthers) {
         if (!matchCaseOther) { continue; }
         auto matchOtherBlock = matchCaseOther->exprOrDecls.get();
-        BreakpointsImpl::HandleBlockExit(result, matchOtherBlock);
+        HandleBlockExit(lines, matchOtherBlock, tokens);
         if (matchCaseOther->matchExpr) {
-            HandleMatchExpr(result, *matchCaseOther->matchExpr);
+            HandleMatchExpr(lines, *matchCaseOther->matchExpr, tokens);
         }
     }
 }
 
-void HandleTryExpr(std::set<BreakpointLocation> &result, const Node &expr)
+void HandleTryExpr(std::set<int> &lines, const Node &expr, const std::vector<Token> &tokens)
 {
     auto *tryExpr = dynamic_cast<const TryExpr*>(&expr);
     if (!tryExpr) { return; }
-    BreakpointsImpl::HandleBlockExit(result, tryExpr->tryBlock.get());
+    HandleBlockExit(lines, tryExpr->tryBlock.get(), tokens);
     for (auto &catchBlock : tryExpr->catchBlocks) {
         if (!catchBlock) { continue; }
-        BreakpointsImpl::HandleBlockExit(result, catchBlock.get());
+        HandleBlockExit(lines, catchBlock.get(), tokens);
     }
-    BreakpointsImpl::HandleBlockExit(result, tryExpr->finallyBlock.get());
+    HandleBlockExit(lines, tryExpr->finallyBlock.get(), tokens);
 }
 
-void HandleSynchronizedExpr(std::set<BreakpointLocation> &result, const Node &expr)
+void HandleSynchronizedExpr(std::set<int> &lines, const Node &expr, const std::vector<Token> &tokens)
 {
     auto *synchronizedExpr = dynamic_cast<const SynchronizedExpr*>(&expr);
-    if (!synchronizedExpr || !synchronizedExpr->desugarExpr) { return; }
+    if (!synchronizedExpr) { return; }
+    if (!synchronizedExpr->desugarExpr) {
+        // not desugared before sema, the body is what becomes the try block
+        HandleBlockExit(lines, synchronizedExpr->body.get(), tokens);
+        return;
+    }
     const auto deSugarExpr = dynamic_cast<const Block*>(synchronizedExpr->desugarExpr.get().get());
     if (!deSugarExpr) { return; }
     const auto deSugarBlock = dynamic_cast<const TryExpr*>(deSugarExpr->GetLastExprOrDecl().get());
     if (!deSugarBlock) { return; }
-    BreakpointsImpl::HandleBlockExit(result, deSugarBlock->tryBlock.get());
+    HandleBlockExit(lines, deSugarBlock->tryBlock.get(), tokens);
 }
 
-void HandleFuncBodyEntryAndExit(std::set<BreakpointLocation> &result, const Block &funcBody, const ArkAST &ast,
-                                const Type &retType)
+void HandleFuncBodyEntryAndExit(std::set<int> &lines, const Block &funcBody, const std::vector<Token> &tokens,
+                                bool returnsUnit)
 {
     bool firstExpr = false;
     size_t implicitSuperNum = 0;
@@ -133,16 +149,21 @@ void HandleFuncBodyEntryAndExit(std::set<BreakpointLocation> &result, const Bloc
         return;
     }
     // handle func entry
-    HandlePos(result, ast, funcBody.body[implicitSuperNum]->begin, *funcBody.body[implicitSuperNum]);
+    HandlePos(lines, tokens, funcBody.body[implicitSuperNum]->begin, *funcBody.body[implicitSuperNum]);
     // handle func exit
-    if (retType.ty && retType.ty->kind == TypeKind::TYPE_UNIT) {
-        HandlePos(result, ast, funcBody.end, funcBody);
+    if (returnsUnit) {
+        HandlePos(lines, tokens, funcBody.end, funcBody);
         return;
     }
-    BreakpointsImpl::HandleBlockExit(result, &funcBody);
+    HandleBlockExit(lines, &funcBody, tokens);
+}
+
+bool ReturnsUnit(const Type &retType)
+{
+    return retType.ty && retType.ty->kind == TypeKind::TYPE_UNIT;
 }
 
-void HandleLambda(std::set<BreakpointLocation> &result, const ArkAST &ast)
+void HandleLambda(std::set<int> &lines, const ArkAST &ast)
 {
     if (!ast.packageInstance->ctx || !ast.packageInstance->ctx->searcher) {
         return;
@@ -158,12 +179,12 @@ void HandleLambda(std::set<BreakpointLocation> &result, const ArkAST &ast)
         if (bodyEmpty) {
             continue;
         }
-        HandleFuncBodyEntryAndExit(result, *lambdaExpr->funcBody->body, ast,
-                                   *lambdaExpr->funcBody->retType);
+        HandleFuncBodyEntryAndExit(lines, *lambdaExpr->funcBody->body, ast.tokens,
+                                   ReturnsUnit(*lambdaExpr->funcBody->retType));
     }
 }
 
-void HandleFuncDecl(std::set<BreakpointLocation> &result, const ArkAST &ast)
+void HandleFuncDecl(std::set<int> &lines, const ArkAST &ast)
 {
     if (!ast.packageInstance->ctx || !ast.packageInstance->ctx->searcher) {
         return;
@@ -184,42 +205,107 @@ void HandleFuncDecl(std::set<BreakpointLocation> &result, const ArkAST &ast)
             funcDecl->outerDecl->identifier.Begin() == funcDecl->begin) {
             continue;
         }
-        HandleFuncBodyEntryAndExit(result, *funcDecl->funcBody->body, ast, *funcDecl->funcBody->retType);
+        HandleFuncBodyEntryAndExit(lines, *funcDecl->funcBody->body, ast.tokens,
+                                   ReturnsUnit(*funcDecl->funcBody->retType));
     }
 }
 
-void BreakpointsImpl::HandleBlockExit(std::set<BreakpointLocation> &result, Ptr<const Block> block)
+void HandleBlockExit(std::set<int> &lines, Ptr<const Block> block, const std::vector<Token> &tokens)
 {
     if (!block) { return; }
     const auto lastMember = block->GetLastExprOrDecl();
     if (!lastMember) { return; }
     if (lastMember->astKind == ASTKind::IF_EXPR) {
-        HandleIfExpr(result, *lastMember);
+        HandleIfExpr(lines, *lastMember, tokens);
         return;
     }
     if (lastMember->astKind == ASTKind::MATCH_EXPR) {
-        HandleMatchExpr(result, *lastMember);
+        HandleMatchExpr(lines, *lastMember, tokens);
         return;
     }
     if (lastMember->astKind == ASTKind::TRY_EXPR) {
-        HandleTryExpr(result, *lastMember);
+        HandleTryExpr(lines, *lastMember, tokens);
         return;
     }
     if (lastMember->astKind == ASTKind::SYNCHRONIZED_EXPR) {
-        HandleSynchronizedExpr(result, *lastMember);
+        HandleSynchronizedExpr(lines, *lastMember, tokens);
         return;
     }
     if (lastMember->astKind == ASTKind::RETURN_EXPR) {
         return;
     }
-    const ArkAST *arkAst = CompilerCangjieProject::GetInstance()->GetArkAST(curFilePath);
-    if (!arkAst) {
-        return;
+    HandlePos(lines, tokens, lastMember->begin, *lastMember);
+}
+
+// Before sema a missing return type is not inferred yet, a func without one is taken as returning Unit while a
+// lambda without one is taken as returning its last expression.
+bool ReturnsUnitByParse(const FuncBody &funcBody, bool isLambda)
+{
+    if (!funcBody.retType) {
+        return !isLambda;
+    }
+    auto *primitiveType = dynamic_cast<const PrimitiveType*>(funcBody.retType.get().get());
+    return primitiveType && primitiveType->kind == TypeKind::TYPE_UNIT;
+}
+
+void CollectByParse(std::set<int> &lines, Ptr<Node> root, const std::vector<Token> &tokens)
+{
+    // bodies of the funcs and lambdas enclosing the visited node, a return belongs to the innermost one
+    std::vector<Ptr<const Block>> funcBodies;
+    auto getFuncBody = [](Ptr<Node> node) -> Ptr<FuncBody> {
+        if (auto *funcDecl = DynamicCast<FuncDecl*>(node.get())) {
+            return funcDecl->funcBody.get();
+        }
+        if (auto *lambdaExpr = DynamicCast<LambdaExpr*>(node.get())) {
+            return lambdaExpr->funcBody.get();
+        }
+        return nullptr;
+    };
+    auto visitPre = [&](Ptr<Node> node) {
+        if (auto *macroExpandDecl = DynamicCast<MacroExpandDecl*>(node.get())) {
+            // annotated decls are not expanded before sema, their funcs are inside the invocation
+            if (macroExpandDecl->GetInvocation() && macroExpandDecl->GetInvocation()->decl) {
+                CollectByParse(lines, macroExpandDecl->GetInvocation()->decl.get(), tokens);
+            }
+            return VisitAction::SKIP_CHILDREN;
+        }
+        if (node->astKind == ASTKind::RETURN_EXPR) {
+            if (!funcBodies.empty() && funcBodies.back() && containExpr(*funcBodies.back())) {
+                HandlePos(lines, tokens, node->begin, *node);
+            }
+            return VisitAction::WALK_CHILDREN;
+        }
+        auto funcBody = getFuncBody(node);
+        if (!funcBody) {
+            return VisitAction::WALK_CHILDREN;
+        }
+        funcBodies.emplace_back(funcBody->body.get());
+        if (funcBody->body && !funcBody->body->body.empty()) {
+            HandleFuncBodyEntryAndExit(lines, *funcBody->body, tokens,
+                                       ReturnsUnitByParse(*funcBody, node->astKind == ASTKind::LAMBDA_EXPR));
+        }
+        return VisitAction::WALK_CHILDREN;
+    };
+    auto visitPost = [&](Ptr<Node> node) {
+        if (getFuncBody(node) && !funcBodies.empty()) {
+            funcBodies.pop_back();
+        }
+        return VisitAction::WALK_CHILDREN;
+    };
+    Walker(root, visitPre, visitPost).Walk();
+}
+
+void BreakpointsImpl::ToBreakpoints(const std::string &filePath, const std::vector<int> &lines,
+                                    std::set<BreakpointLocation> &result)
+{
+    const std::string uri = URI::URIFromAbsolutePath(filePath).ToString();
+    for (int line : lines) {
+        const Range range = {{0, line, 0}, {0, line, 0}};
+        (void) result.insert({uri, range});
     }
-    HandlePos(result, *arkAst, lastMember->begin, *lastMember);
 }
 
-void BreakpointsImpl::Breakpoints(const ArkAST &ast, std::set<BreakpointLocation> &result)
+void BreakpointsImpl::Breakpoints(const ArkAST &ast, size_t hash, std::set<BreakpointLocation> &result)
 {
     bool invalid = !ast.file || !ast.packageInstance;
     if (invalid) {
@@ -227,9 +313,52 @@ void BreakpointsImpl::Breakpoints(const ArkAST &ast, std::set<BreakpointLocation
     }
     Logger &logger = Logger::Instance();
     logger.LogMessage(MessageType::MSG_LOG, "BreakpointsImpl::Breakpoints in.");
-    curFilePath = ast.file->filePath;
-    HandleReturnExpr(result, ast);
-    HandleFuncDecl(result, ast);
-    HandleLambda(result, ast);
+    std::set<int> lines;
+    HandleReturnExpr(lines, ast);
+    HandleFuncDecl(lines, ast);
+    HandleLambda(lines, ast);
+    std::vector<int> table(lines.begin(), lines.end());
+    ToBreakpoints(ast.file->filePath, table, result);
+
+    std::lock_guard<std::mutex> lock(g_lineTablesMtx);
+    g_lineTables[ast.file->filePath] = {hash, true, std::move(table)};
+}
+
+bool BreakpointsImpl::FindBreakpoints(const std::string &filePath, size_t hash, bool parsedToo,
+                                      std::set<BreakpointLocation> &result)
+{
+    std::lock_guard<std::mutex> lock(g_lineTablesMtx);
+    auto found = g_lineTables.find(filePath);
+    if (found == g_lineTables.end() || found->second.hash != hash || !(found->second.analysed || parsedToo)) {
+        return false;
+    }
+    ToBreakpoints(filePath, found->second.lines, result);
+    return true;
+}
+
+void BreakpointsImpl::LinesByParse(Ptr<File> file, const std::vector<Token> &tokens, std::vector<int> &lines)
+{
+    if (!file) {
+        return;
+    }
+    std::set<int> found;
+    CollectByParse(found, file, tokens);
+    lines.assign(found.begin(), found.end());
+}
+
+void BreakpointsImpl::KeepParsedLines(const std::string &filePath, size_t hash, const std::vector<int> &lines)
+{
+    std::lock_guard<std::mutex> lock(g_lineTablesMtx);
+    auto &table = g_lineTables[filePath];
+    if (table.analysed && table.hash == hash) {
+        return;
+    }
+    table = {hash, false, lines};
+}
+
+void BreakpointsImpl::ForgetBreakpoints(const std::string &filePath)
+{
+    std::lock_guard<std::mutex> lock(g_lineTablesMtx);
+    (void)g_lineTables.erase(filePath);
 }
 }
@@ -14,11 +14,26 @@
 namespace ark {
 class BreakpointsImpl {
 public:
-    static std::string curFilePath;
+    // Breakpoints of the analysed AST, compiled from the text of filePath whose hash is given.
+    static void Breakpoints(const ArkAST &ast, size_t hash, std::set<BreakpointLocation> &result);
 
-    static void Breakpoints(const ArkAST &ast, std::set<BreakpointLocation> &result);
+    // Breakpoints known for the text of filePath whose hash is given, from its analysed AST or, if parsedToo,
+    // from a parse alone. False if there are none yet.
+    static bool FindBreakpoints(const std::string &filePath, size_t hash, bool parsedToo,
+                                std::set<BreakpointLocation> &result);
 
-    static void HandleBlockExit(std::set<BreakpointLocation> &result, Ptr<const Block> block);
+    // Lines a breakpoint can be set on in a parsed file. Return types are not inferred yet, a func without one is
+    // taken as returning Unit.
+    static void LinesByParse(Ptr<Cangjie::AST::File> file, const std::vector<Cangjie::Token> &tokens,
+                             std::vector<int> &lines);
+
+    // Keep the lines a parse of the text of filePath found, unless those of its analysed AST are known.
+    static void KeepParsedLines(const std::string &filePath, size_t hash, const std::vector<int> &lines);
+
+    static void ToBreakpoints(const std::string &filePath, const std::vector<int> &lines,
+                              std::set<BreakpointLocation> &result);
+
+    static void ForgetBreakpoints(const std::string &filePath);
 };
 }
 
@@ -11,7 +11,8 @@ using namespace Cangjie;
 using namespace AST;
 
 namespace ark {
-CallHierarchyItem DeclToCallHierarchyItem(Ptr<const Decl> decl)
+// kernelUri is given to the items whose file doesn't exist, it is the file of the request.
+CallHierarchyItem DeclToCallHierarchyItem(Ptr<const Decl> decl, const std::string &kernelUri)
 {
     CallHierarchyItem result;
     if (!decl) { return result; }
@@ -20,7 +21,7 @@ CallHierarchyItem DeclToCallHierarchyItem(Ptr<const Decl> decl)
     if (FileUtil::FileExist(path)) {
         result.uri.file = URI::URIFromAbsolutePath(path).ToString();
     } else {
-        result.uri.file = URI::URIFromAbsolutePath(CallHierarchyImpl::curFilePath).ToString();
+        result.uri.file = kernelUri;
         result.isKernel = true;
     }
     result.detail = decl->fullPackageName + "/" + decl->curFile->fileName;
@@ -70,14 +71,14 @@ CallHierarchyItem DeclToCallHierarchyItem(Ptr<const Decl> decl)
     return result;
 }
 
-CallHierarchyItem DeclToCallHierarchyItem(const lsp::Symbol&containerSym)
+CallHierarchyItem DeclToCallHierarchyItem(const lsp::Symbol&containerSym, const std::string &kernelUri)
 {
     CallHierarchyItem result;
     string path = containerSym.location.fileUri;
     if (FileUtil::FileExist(path)) {
         result.uri.file = URI::URIFromAbsolutePath(path).ToString();
     } else {
-        result.uri.file = URI::URIFromAbsolutePath(CallHierarchyImpl::curFilePath).ToString();
+        result.uri.file = kernelUri;
         result.isKernel = true;
     }
     auto pkgName = CompilerCangjieProject::GetInstance()->GetFullPkgName(path);
@@ -100,7 +101,7 @@ CallHierarchyItem DeclToCallHierarchyItem(const lsp::Symbol&containerSym)
 }
 
 void DealCallee(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& callee, lsp::MemIndex *index,
-    vector<CallHierarchyOutgoingCall>& result)
+    const std::string &kernelUri, vector<CallHierarchyOutgoingCall>& result)
 {
     std::unordered_set<lsp::SymbolID> declSymIds;
     (void)declSymIds.insert(callee.first);
@@ -117,7 +118,7 @@ void DealCallee(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& callee, l
                 && declSym.kind != ASTKind::LAMBDA_EXPR)) {
         return;
     }
-    const CallHierarchyItem item = DeclToCallHierarchyItem(declSym);
+    const CallHierarchyItem item = DeclToCallHierarchyItem(declSym, kernelUri);
     CallHierarchyOutgoingCall callHierarchyOutgoingCall;
     callHierarchyOutgoingCall.to = item;
     // deal ref incoming call
@@ -137,7 +138,7 @@ void DealCallee(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& callee, l
 }
 
 void DealCaller(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& caller, lsp::MemIndex *index,
-                vector<CallHierarchyIncomingCall>& result)
+                const std::string &kernelUri, vector<CallHierarchyIncomingCall>& result)
 {
     std::unordered_set<lsp::SymbolID> containerIds;
     (void)containerIds.insert(caller.first);
@@ -153,7 +154,7 @@ void DealCaller(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& caller, l
     if (containerSym.signature.empty()) {
         return;
     }
-    const CallHierarchyItem item = DeclToCallHierarchyItem(containerSym);
+    const CallHierarchyItem item = DeclToCallHierarchyItem(containerSym, kernelUri);
     CallHierarchyIncomingCall callHierarchyIncomingCall;
     callHierarchyIncomingCall.from = item;
     // deal ref incoming call
@@ -166,16 +167,14 @@ void DealCaller(const std::pair<lsp::SymbolID, std::vector<lsp::Ref>>& caller, l
     (void) result.emplace_back(callHierarchyIncomingCall);
 }
 
-void FindFuncDeclCaller(lsp::SymbolID id, lsp::MemIndex *index, vector <CallHierarchyIncomingCall> &result)
+void FindFuncDeclCaller(lsp::SymbolID id, lsp::MemIndex *index, const std::string &kernelUri,
+                        vector <CallHierarchyIncomingCall> &result)
 {
     if (id == lsp::INVALID_SYMBOL_ID) {
         return;
     }
     std::unordered_set<lsp::SymbolID> ids;
-    lsp::SymbolID topId = id;
-    index->FindRiddenUp(id, ids, topId);
-    index->FindRiddenDown(topId, ids);
-    (void)ids.insert(id);
+    index->FindOverrideFamily(id, ids);
 
     std::map<lsp::SymbolID, std::vector<lsp::Ref>> callers;
     const lsp::RefsRequest req{ids, lsp::RefKind::REFERENCE};
@@ -198,16 +197,14 @@ void FindFuncDeclCaller(lsp::SymbolID id, lsp::MemIndex *index, vector <CallHier
     });
 
     for (auto &caller: callers) {
-        DealCaller(caller, index, result);
+        DealCaller(caller, index, kernelUri, result);
     }
 }
 
-std::string CallHierarchyImpl::curFilePath;
-
 void CallHierarchyImpl::FindCallHierarchyImpl(const ArkAST &ast, CallHierarchyItem &result,
                                                    Position pos)
 {
-    curFilePath = ast.file ? ast.file->filePath : "";
+    const std::string curFilePath = ast.file ? ast.file->filePath : "";
     Logger &logger = Logger::Instance();
     logger.LogMessage(MessageType::MSG_LOG, "CallHierarchyImpl::FindCallHierarchyImpl in.");
     // update pos fileID
@@ -220,7 +217,8 @@ void CallHierarchyImpl::FindCallHierarchyImpl(const ArkAST &ast, CallHierarchyIt
     std::vector<Ptr<Decl> > decls;
     const Ptr<Decl> decl = ast.GetDeclByPosition(pos, syms, decls, {true, false});
     if (!decl) { return; }
-    result = DeclToCallHierarchyItem(dynamic_cast<FuncDecl*>(decl.get()));
+    result = DeclToCallHierarchyItem(dynamic_cast<FuncDecl*>(decl.get()),
+                                     URI::URIFromAbsolutePath(curFilePath).ToString());
     if (result.isKernel) {
         int index = ast.GetCurTokenByPos(pos, 0, static_cast<int>(ast.tokens.size()) - 1);
         if (index != -1) {
@@ -277,7 +275,8 @@ void CallHierarchyImpl::FindOnOutgoingCallsImpl(vector <CallHierarchyOutgoingCal
     });
 
     for (auto &callee: callees) {
-        DealCallee(callee, index, results);
+        // an item of a file that doesn't exist came with the uri of the file it was asked from
+        DealCallee(callee, index, callHierarchyItem.uri.file, results);
     }
 }
 
@@ -291,6 +290,6 @@ void CallHierarchyImpl::FindOnIncomingCallsImpl(vector <CallHierarchyIncomingCal
     if (!index) {
         return;
     }
-    FindFuncDeclCaller(callHierarchyItem.symbolId, index, results);
+    FindFuncDeclCaller(callHierarchyItem.symbolId, index, callHierarchyItem.uri.file, results);
 }
 }
@@ -14,8 +14,6 @@
 namespace ark {
     class CallHierarchyImpl {
     public:
-        static std::string curFilePath;
-
         static void FindCallHierarchyImpl(const ArkAST &ast, CallHierarchyItem &result, Position pos);
 
         // show caller
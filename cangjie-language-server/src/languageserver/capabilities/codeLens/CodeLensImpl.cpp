@@ -5,9 +5,9 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "CodeLensImpl.h"
+#include "../../CompilerCangjieProject.h"
 
 namespace ark {
-std::string CodeLensImpl::curFilePath;
 const std::string TITLE_RUN = "run";
 const std::string TITLE_DEBUG = "debug";
 const std::string COMMAND_TEST_RUN = "cangjie.test.run";
@@ -24,7 +24,7 @@ void HandleTestResult(std::vector<CodeLens> &result, std::string title, std::str
 
 void HandleClassTest(
     const Ptr<Decl> invocationDecl, ExecutableRange executableRange, const Ptr<const MacroExpandDecl> macroExpandDecl,
-    const ArkAST &ast, std::vector<CodeLens> &result)
+    const std::vector<Token> &tokens, std::vector<CodeLens> &result)
 {
     Position startPosition = {
         static_cast<unsigned int>(macroExpandDecl->begin.fileID),
@@ -42,8 +42,8 @@ void HandleClassTest(
         classDecl->end.line - 1,
         classDecl->end.column
     };
-    PositionUTF8ToIDE(ast.tokens, startPosition, *macroExpandDecl);
-    PositionUTF8ToIDE(ast.tokens, endPosition, *classDecl);
+    PositionUTF8ToIDE(tokens, startPosition, *macroExpandDecl);
+    PositionUTF8ToIDE(tokens, endPosition, *classDecl);
     executableRange.range = {startPosition, endPosition};
 
     HandleTestResult(result, TITLE_RUN, COMMAND_TEST_RUN, executableRange);
@@ -52,7 +52,7 @@ void HandleClassTest(
 
 void HandleFuncTest(
     const Ptr<Decl> invocationDecl, ExecutableRange executableRange, const Ptr<const MacroExpandDecl> macroExpandDecl,
-    const ArkAST &ast, std::vector<CodeLens> &result)
+    const std::vector<Token> &tokens, std::vector<CodeLens> &result)
 {
     Position startPosition = {
         static_cast<unsigned int>(macroExpandDecl->begin.fileID),
@@ -64,7 +64,9 @@ void HandleFuncTest(
         return;
     }
     executableRange.functionName = funcDecl->identifier;
-    executableRange.className = macroExpandDecl->GetConstInvocation()->outerDeclIdent;
+    if (!macroExpandDecl->GetConstInvocation()->outerDeclIdent.empty()) {
+        executableRange.className = macroExpandDecl->GetConstInvocation()->outerDeclIdent;
+    }
 
     if (funcDecl->outerDecl && funcDecl->outerDecl->astKind == ASTKind::CLASS_DECL) {
         auto classDecl = dynamic_cast<const ClassDecl*>(funcDecl->outerDecl.get());
@@ -78,8 +80,8 @@ void HandleFuncTest(
         funcDecl->end.line - 1,
         funcDecl->end.column
     };
-    PositionUTF8ToIDE(ast.tokens, startPosition, *macroExpandDecl);
-    PositionUTF8ToIDE(ast.tokens, endPosition, *funcDecl);
+    PositionUTF8ToIDE(tokens, startPosition, *macroExpandDecl);
+    PositionUTF8ToIDE(tokens, endPosition, *funcDecl);
     executableRange.range = {startPosition, endPosition};
 
     HandleTestResult(result, TITLE_RUN, COMMAND_TEST_RUN, executableRange);
@@ -100,14 +102,46 @@ void GetTestRange(std::vector<CodeLens> &result, const ArkAST &ast)
                           macroExpandDecl->identifier) == CODE_LENS_TARGET.end();
         if (invalidDecl) { continue; }
         ExecutableRange executableRange;
-        const std::string uri = URI::URIFromAbsolutePath(CodeLensImpl::curFilePath).ToString();
-        executableRange.uri = uri;
+        executableRange.uri = URI::URIFromAbsolutePath(ast.file->filePath).ToString();
         executableRange.projectName = executableRange.packageName = macroExpandDecl->fullPackageName;
         auto invocationDecl = macroExpandDecl->GetConstInvocation()->decl.get();
         if (invocationDecl->astKind == ASTKind::CLASS_DECL) {
-            HandleClassTest(invocationDecl, executableRange, macroExpandDecl, ast, result);
+            HandleClassTest(invocationDecl, executableRange, macroExpandDecl, ast.tokens, result);
+        } else if (invocationDecl->astKind == ASTKind::FUNC_DECL) {
+            HandleFuncTest(invocationDecl, executableRange, macroExpandDecl, ast.tokens, result);
+        }
+    }
+}
+
+// Same lenses as GetTestRange, read from the parse tree: the annotated decl of a macro call is already there
+// before expansion. Test functions are found at top level and in the body of test classes. Lenses are listed
+// last position first, as the search in GetTestRange sorts them.
+void GetTestRangeByParse(std::vector<CodeLens> &result, const std::vector<Ptr<Decl>> &decls,
+    const ExecutableRange &fileRange, const std::vector<Token> &tokens)
+{
+    for (auto it = decls.rbegin(); it != decls.rend(); ++it) {
+        auto decl = *it;
+        const auto macroExpandDecl = DynamicCast<const MacroExpandDecl*>(decl.get());
+        bool invalidDecl = !macroExpandDecl || !macroExpandDecl->GetConstInvocation() ||
+                !macroExpandDecl->GetConstInvocation()->decl ||
+                std::find(CODE_LENS_TARGET.begin(), CODE_LENS_TARGET.end(),
+                          macroExpandDecl->identifier) == CODE_LENS_TARGET.end();
+        if (invalidDecl) { continue; }
+        auto invocationDecl = macroExpandDecl->GetConstInvocation()->decl.get();
+        if (invocationDecl->astKind == ASTKind::CLASS_DECL) {
+            auto classDecl = StaticCast<const ClassDecl*>(invocationDecl);
+            if (classDecl->body) {
+                ExecutableRange classRange = fileRange;
+                classRange.className = classDecl->identifier;
+                std::vector<Ptr<Decl>> members;
+                for (auto &member : classDecl->body->decls) {
+                    members.emplace_back(member.get());
+                }
+                GetTestRangeByParse(result, members, classRange, tokens);
+            }
+            HandleClassTest(invocationDecl, fileRange, macroExpandDecl, tokens, result);
         } else if (invocationDecl->astKind == ASTKind::FUNC_DECL) {
-            HandleFuncTest(invocationDecl, executableRange, macroExpandDecl, ast, result);
+            HandleFuncTest(invocationDecl, fileRange, macroExpandDecl, tokens, result);
         }
     }
 }
@@ -120,8 +154,35 @@ void CodeLensImpl::GetCodeLens(const ArkAST &ast, std::vector<CodeLens> &result)
     }
     Logger &logger = Logger::Instance();
     logger.LogMessage(MessageType::MSG_LOG, "CodeLensImpl::GetCodeLens in.");
-    curFilePath = ast.file->filePath;
 
     GetTestRange(result, ast);
 }
+
+void CodeLensImpl::GetCodeLensByParse(const std::string &filePath, const ArkAST &ast, std::vector<CodeLens> &result)
+{
+    if (!ast.file) {
+        return;
+    }
+    ExecutableRange fileRange = GetFileTestRange(filePath);
+    for (auto it = ast.file->decls.rbegin(); it != ast.file->decls.rend(); ++it) {
+        GetCodeLensByParse(fileRange, ast, it->get(), result);
+    }
+}
+
+ExecutableRange CodeLensImpl::GetFileTestRange(const std::string &filePath)
+{
+    ExecutableRange fileRange;
+    fileRange.uri = URI::URIFromAbsolutePath(filePath).ToString();
+    fileRange.projectName = fileRange.packageName = CompilerCangjieProject::GetInstance()->GetFullPkgName(filePath);
+    return fileRange;
+}
+
+void CodeLensImpl::GetCodeLensByParse(const ExecutableRange &fileRange, const ArkAST &ast, Ptr<Decl> toplevelDecl,
+                                      std::vector<CodeLens> &result)
+{
+    if (!toplevelDecl) {
+        return;
+    }
+    GetTestRangeByParse(result, {toplevelDecl}, fileRange, ast.tokens);
+}
 }
@@ -14,9 +14,17 @@
 namespace ark {
     class CodeLensImpl {
     public:
-        static std::string curFilePath;
-
         static void GetCodeLens(const ArkAST &ast, std::vector<CodeLens> &result);
+
+        // Test lenses from a parse of the file, usable before the package is compiled.
+        static void GetCodeLensByParse(const std::string &filePath, const ArkAST &ast, std::vector<CodeLens> &result);
+
+        // What the tests of filePath are run with, the class and function of each test are added to it.
+        static ExecutableRange GetFileTestRange(const std::string &filePath);
+
+        // Test lenses of one top-level declaration of the parse of a file, last position first.
+        static void GetCodeLensByParse(const ExecutableRange &fileRange, const ArkAST &ast,
+                                       Ptr<Cangjie::AST::Decl> toplevelDecl, std::vector<CodeLens> &result);
     };
 }
 
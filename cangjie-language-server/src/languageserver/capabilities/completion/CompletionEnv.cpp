@@ -727,7 +727,7 @@ void CompletionEnv::DotAccessible(Decl &decl, const Decl &parentDecl, bool isSup
         initCompletion.label = signature;
         initCompletion.name = replaceString;
         initCompletion.kind = CompletionItemKind::CIK_FUNCTION;
-        initCompletion.detail = ItemResolverUtil::ResolveDetailByNode(decl);
+        initCompletion.detailNode = &decl;
         std::string insertText = ItemResolverUtil::ResolveInsertByNode(decl);
         insertText = insertText.replace(insertText.begin(),
                                         insertText.begin() + static_cast<long long>(std::string("init").size()),
@@ -774,13 +774,13 @@ void CompletionEnv::AddItem(Decl &decl, const std::string &signature, bool show)
         if (auto fd = DynamicCast<FuncDecl *>(&decl); fd && ::IsAllParamInitial(*fd)) {
             auto defaultFuncName = completion.name + "()";
             completion.label = completion.insertText = completion.name = defaultFuncName;
-            completion.detail = ItemResolverUtil::ResolveDetailByNode(decl);
+            completion.detailNode = &decl;
             completion.show = show;
             AddCompletionItem(completion.name, completion.name, completion);
         }
     }
     completion.label = signature;
-    completion.detail = ItemResolverUtil::ResolveDetailByNode(decl);
+    completion.detailNode = &decl;
     completion.insertText = ItemResolverUtil::ResolveInsertByNode(decl);
     completion.show = show;
     AddCompletionItem(signature, signature, completion);
@@ -827,7 +827,7 @@ void CompletionEnv::InvokedAccessible(Ptr<Node> node,
     CodeCompletion completion;
     completion.name = ItemResolverUtil::ResolveNameByNode(*node);
     completion.kind = ItemResolverUtil::ResolveKindByNode(*node);
-    completion.detail = ItemResolverUtil::ResolveDetailByNode(*node);
+    completion.detailNode = node;
     // if decl is deprecated
     if (auto decl = dynamic_cast<Decl *>(node.get())) {
         MarkDeprecated(*decl, completion);
@@ -849,7 +849,7 @@ void CompletionEnv::InvokedAccessible(Ptr<Node> node,
     AddCompletionItem(signature, signature, completion);
     if (completion.kind == CompletionItemKind::CIK_METHOD) {
         completion.label = completion.insertText = completion.name;
-        completion.detail = "";
+        completion.detailNode = nullptr;
         AddCompletionItem(completion.name, completion.name, completion);
     }
     // complete class_decl and struct_decl init func_decl
@@ -986,7 +986,8 @@ void CompletionEnv::CompleteNode(
     }
     completion.name = ItemResolverUtil::ResolveNameByNode(*node);
     completion.kind = ItemResolverUtil::ResolveKindByNode(*node);
-    completion.detail = ItemResolverUtil::ResolveDetailByNode(*node, parserAst->sourceManager);
+    completion.detailNode = node;
+    completion.detailSourceManager = parserAst->sourceManager;
     if (node->TestAttr(Attribute::ENUM_CONSTRUCTOR)) {
         completion.isEnumCtor = true;
         completion.container = container;
@@ -1023,6 +1024,8 @@ void CompletionEnv::CompleteNode(
         rawCompletion.label.replace(rawCompletion.label.find(completion.name), completion.name.length(), rawName);
         rawCompletion.insertText.replace(rawCompletion.insertText.find(completion.name),
                                          completion.name.length(), rawName);
+        rawCompletion.detail = ItemResolverUtil::ResolveDetailByNode(*node, parserAst->sourceManager);
+        rawCompletion.detailNode = nullptr;
         rawCompletion.detail.replace(rawCompletion.detail.find(completion.name), completion.name.length(), rawName);
         rawCompletion.name = rawName;
         AddCompletionItem(rawSignature, rawSignature, rawCompletion);
@@ -1030,7 +1033,7 @@ void CompletionEnv::CompleteNode(
     // complete function name
     if (completion.kind == CompletionItemKind::CIK_METHOD) {
         completion.label = completion.insertText = completion.name;
-        completion.detail = "";
+        completion.detailNode = nullptr;
         AddCompletionItem(completion.name, completion.name, completion);
         if (isRawIdentifier) {
             auto rawCompletion = completion;
@@ -1038,7 +1041,6 @@ void CompletionEnv::CompleteNode(
             rawCompletion.label.replace(rawCompletion.label.find(completion.name), completion.name.length(), rawName);
             rawCompletion.insertText.replace(rawCompletion.insertText.find(completion.name),
                                              completion.name.length(), rawName);
-            rawCompletion.detail = "";
             rawCompletion.name = rawName;
             AddCompletionItem(rawName, rawName, rawCompletion);
         }
@@ -1132,7 +1134,7 @@ void CompletionEnv::CompleteAliasItem(Ptr<Node> node, const std::string &aliasNa
     completion.label =
         signature.replace(signature.begin(), signature.begin() + static_cast<long long>(name.size()), aliasName);
     completion.kind = ItemResolverUtil::ResolveKindByNode(*node);
-    completion.detail = ItemResolverUtil::ResolveDetailByNode(*node);
+    completion.detailNode = node;
     completion.show = true;
     // if isImport complete simple
     if (auto decl = dynamic_cast<Decl *>(node.get())) {
@@ -1253,7 +1255,8 @@ void CompletionEnv::CompleteClassOrStructDecl(const T &decl, const std::string &
             completion.label = signature;
             completion.name = replaceString;
             completion.kind = CompletionItemKind::CIK_FUNCTION;
-            completion.detail = ItemResolverUtil::ResolveDetailByNode(*it.get(), temp);
+            completion.detailNode = it.get();
+            completion.detailSourceManager = temp;
             std::string insertText = ItemResolverUtil::ResolveInsertByNode(*it.get(), temp, isAfterAT);
             insertText = insertText.replace(insertText.begin(), insertText.begin() + len, insertReplaceString);
             completion.insertText = insertText;
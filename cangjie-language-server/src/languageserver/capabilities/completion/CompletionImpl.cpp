@@ -142,14 +142,20 @@ CompletionItem CodeCompletion::Render(const std::string &sortText, const std::st
     CompletionItem item;
     item.label = label;
     item.kind = kind;
-    item.detail = detail;
+    item.detail = detailNode ? ItemResolverUtil::ResolveDetailByNode(*detailNode, detailSourceManager) : detail;
     item.insertText = insertText;
     item.insertTextFormat = InsertTextFormat::SNIPPET;
     if (item.kind == CompletionItemKind::CIK_MODULE || item.insertText == name || item.insertText == name + "()") {
         item.insertTextFormat = InsertTextFormat::PLAIN_TEXT;
     }
     item.filterText = GetFilterText(name, prefix);
-    item.additionalTextEdits = additionalTextEdits;
+    if (autoImport) {
+        item.detail = "import " + autoImport->pkg;
+        TextEdit textEdit;
+        textEdit.range = autoImport->range;
+        textEdit.newText = "import " + autoImport->pkg + "." + autoImport->name + "\n";
+        item.additionalTextEdits = std::vector<TextEdit>{textEdit};
+    }
     item.deprecated = deprecated;
     item.sortText = sortText;
     return item;
@@ -164,6 +170,9 @@ void CompletionImpl::CodeComplete(const ArkAST &input,
 
     // update pos fileID
     pos.fileID = input.fileID;
+    if (input.file && input.file->curPackage) {
+        result.curPkgName = input.file->curPackage->fullPackageName;
+    }
     // adjust position from IDE to AST
     pos = PosFromIDE2Char(pos);
     // set value for whether to execute import package
@@ -339,11 +348,9 @@ void CompletionImpl::AutoImportPackageComplete(const ArkAST &input, CompletionRe
             item.name = sym.name;
             item.label = sym.signature;
             item.insertText = sym.insertText;
-            item.detail = "import " + pkg;
-            ark::TextEdit textEdit;
-            textEdit.range = textEditRange;
-            textEdit.newText = "import " + pkg + "." + sym.name + "\n";
-            item.additionalTextEdits = std::vector<TextEdit>{textEdit};
+            item.id = sym.id;
+            item.pkgName = pkg;
+            item.autoImport = CodeCompletion::AutoImport{pkg, sym.name, textEditRange};
             item.sortType = SortType::AUTO_IMPORT_SYM;
             result.completions.push_back(item);
         });
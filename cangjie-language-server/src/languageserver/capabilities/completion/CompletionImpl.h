@@ -43,12 +43,23 @@ struct CodeCompletion {
     std::string name;
     std::string label;
     std::string detail;
+    // detail and import edit are only built by Render, for the items which make it into the list
+    Ptr<Cangjie::AST::Node> detailNode;
+    Cangjie::SourceManager *detailSourceManager = nullptr;
     std::string insertText;
     std::string container;
     uint8_t itemDepth = 0;
 
-    std::optional<std::vector<TextEdit>> additionalTextEdits;
+    // set for items which add "import <pkg>.<name>" at the range when accepted
+    struct AutoImport {
+        std::string pkg;
+        std::string name;
+        Range range;
+    };
+    std::optional<AutoImport> autoImport;
     ark::lsp::SymbolID id = 0;
+    // package which declares the item, only known for items coming from the index
+    std::string pkgName;
 
     [[nodiscard]] CompletionItem Render(const std::string &sortText, const std::string &prefix) const;
 };
@@ -56,6 +67,7 @@ struct CodeCompletion {
 struct CompletionResult {
     std::vector<CodeCompletion> completions {};
     uint8_t cursorDepth = 0;
+    std::string curPkgName;
     std::unordered_set<ark::lsp::SymbolID> normalCompleteSymID {};
     std::unordered_set<ark::lsp::SymbolID> importDeclsSymID {};
 };
@@ -378,13 +378,13 @@ void DotCompleterByParse::CompleteQualifiedType(const std::string &beforePrefix,
             return;
         }
         auto curModule = basicStrings.front();
-        auto depends = ark::CompilerCangjieProject::GetInstance()->GetOneModuleDeps(curModule);
         auto strings = Utils::SplitQualifiedName(beforePrefix);
         if (strings.empty()) {
             return;
         }
         auto realModule = strings.front();
-        if (curModule != realModule && depends.count(realModule) == 0) {
+        if (curModule != realModule &&
+            !ark::CompilerCangjieProject::GetInstance()->IsRequiredModule(curModule, realModule)) {
             return;
         }
     }
@@ -1001,11 +1001,7 @@ void DotCompleterByParse::AddExtendDeclFromIndex(Ptr<Ty> &extendTy, CompletionEn
             item.name = sym.name;
             item.label = sym.signature;
             item.insertText = sym.insertText;
-            item.detail = "import " + pkg;
-            ark::TextEdit textEdit;
-            textEdit.range = editRange;
-            textEdit.newText = "import " + pkg + "." + interface + "\n";
-            item.additionalTextEdits = std::vector<TextEdit>{textEdit};
+            item.autoImport = CodeCompletion::AutoImport{pkg, interface, editRange};
             item.sortType = SortType::AUTO_IMPORT_SYM;
             completetions.push_back(item);
         });
@@ -5,28 +5,232 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "SortModel.h"
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
 #include "CompletionImpl.h"
+#include "../../logger/Logger.h"
+#include "nlohmann/json.hpp"
 
 namespace ark {
 constexpr double LOW_SCORE_LIMIT = 0.3;
 constexpr double KEYWORD_WEIGHT = 1.0;
 constexpr double NORMAL_SYM_WEIGHT = 0.8;
 constexpr double AUTO_IMPORT_SYM_WEIGHT = 0.6;
+constexpr double DIRECT_DEP_PROXIMITY = 0.5;
+constexpr double TRANSITIVE_DEP_PROXIMITY = 0.33;
 
-double SortModel::CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth)
+namespace {
+int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+SortModel::~SortModel()
+{
+    FlushUsage();
+}
+
+void SortModel::LoadUsage(const std::string &path)
+{
+    std::unique_lock<std::shared_mutex> lock(usageMtx);
+    if (usageDirty) {
+        SaveUsage();
+    }
+    usagePath = path;
+    usageFrequency = std::make_shared<const UsageTable>();
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return;
+    }
+    auto usage = nlohmann::json::parse(in, nullptr, false);
+    if (usage.is_discarded() || !usage.is_object()) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "ignore broken completion usage file: " + path);
+        return;
+    }
+    auto loaded = std::make_shared<UsageTable>();
+    for (auto it = usage.begin(); it != usage.end(); ++it) {
+        const auto &record = it.value();
+        if (!record.is_array() || record.size() != 2 || !record[0].is_number() || !record[1].is_number()) {
+            continue;
+        }
+        (*loaded)[it.key()] = {record[0].get<double>(), record[1].get<int64_t>()};
+    }
+    usageFrequency = std::move(loaded);
+}
+
+void SortModel::UpdateUsageFrequency(const std::string &item)
+{
+    std::unique_lock<std::shared_mutex> lock(usageMtx);
+    int64_t now = Now();
+    auto updated = std::make_shared<UsageTable>(*usageFrequency);
+    auto &record = (*updated)[item];
+    record.weight = Decay(record, now) + 1;
+    record.lastUsed = now;
+    if (updated->size() > MAX_USAGE_RECORDS) {
+        auto least = std::min_element(updated->begin(), updated->end(),
+            [now](const auto &left, const auto &right) { return Decay(left.second, now) < Decay(right.second, now); });
+        updated->erase(least);
+    }
+    usageFrequency = std::move(updated);
+    usageDirty = true;
+    // accepting items in a row must not rewrite the file each time
+    if (now - usageSavedAt >= USAGE_SAVE_INTERVAL) {
+        SaveUsage();
+    }
+}
+
+void SortModel::FlushUsage()
+{
+    std::unique_lock<std::shared_mutex> lock(usageMtx);
+    if (usageDirty) {
+        SaveUsage();
+    }
+}
+
+void SortModel::SaveUsage()
+{
+    usageDirty = false;
+    usageSavedAt = Now();
+    if (usagePath.empty()) {
+        return;
+    }
+    nlohmann::json usage = nlohmann::json::object();
+    for (const auto &[label, record] : *usageFrequency) {
+        usage[label] = {record.weight, record.lastUsed};
+    }
+    // Write a temporary file first so that a crash never leaves a truncated usage file behind.
+    std::string tmpPath = usagePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) {
+            return;
+        }
+        out << usage.dump();
+        if (out.fail()) {
+            return;
+        }
+    }
+    (void)std::rename(tmpPath.c_str(), usagePath.c_str());
+}
+
+double SortModel::GetUsageWeight(const std::string &label, int64_t now) const
+{
+    std::shared_lock<std::shared_mutex> lock(usageMtx);
+    auto it = usageFrequency->find(label);
+    return it == usageFrequency->end() ? 0 : Decay(it->second, now);
+}
+
+void SortModel::SnapshotUsage(RankingContext &context) const
+{
+    context.now = Now();
+    std::shared_lock<std::shared_mutex> lock(usageMtx);
+    context.usage = usageFrequency;
+}
+
+double SortModel::Decay(const UsageRecord &record, int64_t now)
+{
+    if (record.weight <= 0) {
+        return 0;
+    }
+    double elapsed = static_cast<double>(std::max<int64_t>(0, now - record.lastUsed));
+    return record.weight * std::exp2(-elapsed / USAGE_HALF_LIFE);
+}
+
+void SortModel::UpdateRefCounts(const std::string &pkgName, const lsp::RefSlab &refs)
+{
+    std::unordered_map<lsp::SymbolID, uint32_t> counts;
+    for (const auto &[id, symRefs] : refs) {
+        counts[id] = static_cast<uint32_t>(symRefs.size());
+    }
+    std::unique_lock<std::shared_mutex> lock(refMtx);
+    auto &old = pkgRefCounts[pkgName];
+    for (const auto &[id, count] : old) {
+        auto it = refCounts.find(id);
+        if (it != refCounts.end()) {
+            SetRefCount(id, it->second - std::min(it->second, count));
+        }
+    }
+    for (const auto &[id, count] : counts) {
+        auto it = refCounts.find(id);
+        SetRefCount(id, (it == refCounts.end() ? 0 : it->second) + count);
+    }
+    old = std::move(counts);
+    maxRefCount = refCountHistogram.empty() ? 0 : refCountHistogram.rbegin()->first;
+}
+
+void SortModel::SetRefCount(lsp::SymbolID id, uint32_t count)
+{
+    auto it = refCounts.find(id);
+    if (it != refCounts.end()) {
+        auto bucket = refCountHistogram.find(it->second);
+        if (bucket != refCountHistogram.end() && --bucket->second == 0) {
+            refCountHistogram.erase(bucket);
+        }
+    }
+    if (count == 0) {
+        if (it != refCounts.end()) {
+            refCounts.erase(it);
+        }
+        return;
+    }
+    refCounts[id] = count;
+    ++refCountHistogram[count];
+}
+
+double SortModel::CalculateRefPopularityScore(lsp::SymbolID id) const
+{
+    if (id == lsp::INVALID_SYMBOL_ID) {
+        return 0;
+    }
+    std::shared_lock<std::shared_mutex> lock(refMtx);
+    auto it = refCounts.find(id);
+    if (it == refCounts.end() || maxRefCount == 0) {
+        return 0;
+    }
+    return std::log1p(it->second) / std::log1p(maxRefCount);
+}
+
+double SortModel::CalculateProximityScore(const std::string &pkgName, const RankingContext &context)
+{
+    // items which do not come from another package, e.g. local variables and keywords, are not penalised
+    if (pkgName.empty() || pkgName == context.curPkgName) {
+        return BASE_SCORE;
+    }
+    if (context.directDeps.count(pkgName) > 0) {
+        return DIRECT_DEP_PROXIMITY;
+    }
+    if (context.allDeps.count(pkgName) > 0) {
+        return TRANSITIVE_DEP_PROXIMITY;
+    }
+    return 0;
+}
+
+double SortModel::CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth,
+    const RankingContext &context) const
 {
     double matchScore = CalculateMatchScore(item.name, prefix);
     double scopePathScore = 1.0 / (1.0 + std::abs(cursorDepth - item.itemDepth));
     double symbolTypeScore = CalculateSymbolTypeScore(item.sortType);
-    int frequency = usageFrequency[item.label];
+    double frequency = 0;
+    if (context.usage) {
+        auto it = context.usage->find(item.label);
+        frequency = it == context.usage->end() ? 0 : Decay(it->second, context.now);
+    }
     double usageFrequencyScore = frequency > 0 ? 1.0 - 1.0 / (1.0 + frequency) : 0;
+    double refPopularityScore = CalculateRefPopularityScore(item.id);
+    double proximityScore = CalculateProximityScore(item.pkgName, context);
     double score = editDistanceWeight * matchScore + scopePathWeight * scopePathScore +
-                   symbolTypeWeight * symbolTypeScore + usageFrequencyWeight * usageFrequencyScore;
+                   symbolTypeWeight * symbolTypeScore + usageFrequencyWeight * usageFrequencyScore +
+                   refPopularityWeight * refPopularityScore + proximityWeight * proximityScore;
     return score;
 }
 
-
 double SortModel::CalculateMatchScore(std::string_view completion, std::string_view prefix)
 {
     if (prefix.empty()) {
@@ -9,37 +9,112 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
 #include <string>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "CompletionImpl.h"
+#include "../../index/Ref.h"
 
 namespace ark {
+struct UsageRecord {
+    double weight = 0;
+    int64_t lastUsed = 0;
+};
+
+using UsageTable = std::unordered_map<std::string, UsageRecord>;
+
+// Per request information used by the ranking, computed once before the candidates are scored.
+struct RankingContext {
+    std::string curPkgName;
+    // packages the current package imports directly
+    std::unordered_set<std::string> directDeps;
+    // packages the current package depends on, directly or transitively
+    std::unordered_set<std::string> allDeps;
+    // time of the request in seconds since epoch and the usage at that time, filled by SortModel::SnapshotUsage
+    int64_t now = 0;
+    std::shared_ptr<const UsageTable> usage;
+};
+
 class SortModel {
 public:
     static constexpr double BASE_SCORE = 1.0;
     static constexpr double LENGTH_WEIGHT = 0.3;
     static constexpr double PREFIX_POSITION_WEIGHT = 0.4;
     static constexpr double CONTINUITY_WEIGHT = 0.3;
+    // usage of an item counts half as much after this many seconds (14 days)
+    static constexpr double USAGE_HALF_LIFE = 14 * 24 * 3600.0;
+    // at most this many labels are remembered, the least used ones are dropped first
+    static constexpr size_t MAX_USAGE_RECORDS = 4096;
+    // accepted items are written to the usage file at most once in this many seconds, the rest on FlushUsage
+    static constexpr int64_t USAGE_SAVE_INTERVAL = 60;
 
-    explicit SortModel(double edw = 0.4, double spw = 0.3, double stw = 0.1, double ufw = 0.2)
-        : editDistanceWeight(edw), scopePathWeight(spw), symbolTypeWeight(stw), usageFrequencyWeight(ufw)
+    explicit SortModel(double edw = 0.35, double spw = 0.25, double stw = 0.1, double ufw = 0.15,
+        double rpw = 0.1, double pxw = 0.05)
+        : editDistanceWeight(edw), scopePathWeight(spw), symbolTypeWeight(stw), usageFrequencyWeight(ufw),
+          refPopularityWeight(rpw), proximityWeight(pxw)
     {
     }
 
-    void UpdateUsageFrequency(const std::string &item) { usageFrequency[item]++; }
+    ~SortModel();
+
+    // Load the usage statistics of the workspace, later updates are written back to the same file.
+    void LoadUsage(const std::string &path);
+
+    void UpdateUsageFrequency(const std::string &item);
+
+    // Write the usage not saved yet, called on shutdown.
+    void FlushUsage();
+
+    // Take the time and the usage the candidates of one request are scored with, learned usage is ignored
+    // by CalculateScore without it.
+    void SnapshotUsage(RankingContext &context) const;
 
-    double CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth);
+    // Replace the reference counts of one package, they come from the index of that package.
+    void UpdateRefCounts(const std::string &pkgName, const lsp::RefSlab &refs);
+
+    double CalculateScore(const CodeCompletion &item, const std::string &prefix, uint8_t cursorDepth,
+        const RankingContext &context = {}) const;
+
+    // Decayed usage count of a label at the given time, in seconds since epoch.
+    double GetUsageWeight(const std::string &label, int64_t now) const;
 
 private:
     double editDistanceWeight;
     double scopePathWeight;
     double symbolTypeWeight;
     double usageFrequencyWeight;
+    double refPopularityWeight;
+    double proximityWeight;
+
+    mutable std::shared_mutex usageMtx;
+    // replaced as a whole on each update so that snapshots taken by requests stay unchanged
+    std::shared_ptr<const UsageTable> usageFrequency = std::make_shared<const UsageTable>();
+    std::string usagePath;
+    bool usageDirty = false;
+    int64_t usageSavedAt = 0;
+
+    mutable std::shared_mutex refMtx;
+    std::unordered_map<std::string, std::unordered_map<lsp::SymbolID, uint32_t>> pkgRefCounts;
+    std::unordered_map<lsp::SymbolID, uint32_t> refCounts;
+    // how many symbols have each reference count, its last key is the largest count
+    std::map<uint32_t, size_t> refCountHistogram;
+    uint32_t maxRefCount = 0;
+
+    void SaveUsage();
+
+    void SetRefCount(lsp::SymbolID id, uint32_t count);
+
+    double CalculateRefPopularityScore(lsp::SymbolID id) const;
+
+    static double CalculateProximityScore(const std::string &pkgName, const RankingContext &context);
 
-    std::unordered_map<std::string, int> usageFrequency;
+    static double Decay(const UsageRecord &record, int64_t now);
 
     static double CalculateMatchScore(std::string_view completion, std::string_view prefix);
 
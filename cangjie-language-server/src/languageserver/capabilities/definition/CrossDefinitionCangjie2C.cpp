@@ -5,6 +5,9 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "CrossDefinitionCangjie2C.h"
+#include <algorithm>
+#include "../../../json-rpc/URI.h"
+#include "../../CompilerCangjieProject.h"
 
 using namespace std;
 using namespace Cangjie;
@@ -106,6 +109,42 @@ void CrossDefinitionCangjie2C::Cangjie2CGetFuncMessage(std::vector<message> &Cro
     (void) CrossMessage.emplace_back(message);
 }
 
+std::vector<Location> CrossDefinitionCangjie2C::FindCFunctions(const message &crossMessage, bool definitionsOnly)
+{
+    std::vector<Location> result;
+    auto index = CompilerCangjieProject::GetInstance()->GetCFunctionIndex();
+    if (!index || crossMessage.functionName.empty()) {
+        return result;
+    }
+    std::vector<std::string> paramTypes;
+    for (const auto &param : crossMessage.functionParameters) {
+        (void) paramTypes.emplace_back(lsp::CFunctionIndex::NormalizeType(param));
+    }
+    std::vector<lsp::CFunction> sameTypes;
+    std::vector<lsp::CFunction> sameCount;
+    for (auto &function : index->Find(crossMessage.functionName)) {
+        if (function.paramTypes == paramTypes) {
+            (void) sameTypes.emplace_back(std::move(function));
+        } else if (function.paramTypes.size() == paramTypes.size()) {
+            (void) sameCount.emplace_back(std::move(function));
+        }
+    }
+    auto &matches = sameTypes.empty() ? sameCount : sameTypes;
+    bool hasDefinition = std::any_of(matches.begin(), matches.end(),
+        [](const lsp::CFunction &function) { return function.isDefinition; });
+    for (const auto &function : matches) {
+        if (definitionsOnly && hasDefinition && !function.isDefinition) {
+            continue;
+        }
+        Location location;
+        location.uri.file = URI::URIFromAbsolutePath(function.filePath).ToString();
+        location.range.start = {0, function.line, function.column};
+        location.range.end = {0, function.line, function.column + static_cast<int>(function.name.size())};
+        (void) result.emplace_back(std::move(location));
+    }
+    return result;
+}
+
 std::string CrossDefinitionCangjie2C::GetCType(const Cangjie::AST::Ty *ty, bool isSimple)
 {
     if (ty && CANGJIE2C.find(ty->kind) != CANGJIE2C.end()) {
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include "cangjie/AST/Types.h"
 #include "cangjie/AST/Node.h"
+#include "../../../json-rpc/Common.h"
 
 namespace ark {
 
@@ -21,6 +22,8 @@ struct message {
     std::string functionName;
     std::vector<std::string> functionParameters{};
     std::string retType;
+    // C functions of the workspace matching it, filled for go to definition only
+    std::vector<Location> definitions{};
 };
 
 class CrossDefinitionCangjie2C {
@@ -32,6 +35,15 @@ public:
     static std::string TypeVarray(const Cangjie::AST::Ty *ty, bool isSimple);
 
     static std::string TypeCpointer(const Cangjie::AST::Ty *ty, bool isSimple);
+
+    /**
+     * Find the C functions of the workspace a foreign func binds to. C names are not mangled, the candidates
+     * named like it are narrowed down to those with the same parameter types or, if none, the same count.
+     *
+     * @param crossMessage signature of the foreign func
+     * @param definitionsOnly leave out declarations when a definition is found
+     */
+    static std::vector<Location> FindCFunctions(const message &crossMessage, bool definitionsOnly);
 };
 }
 
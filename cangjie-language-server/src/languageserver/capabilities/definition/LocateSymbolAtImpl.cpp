@@ -26,7 +26,7 @@ void RedirectToMacroInvocation(const Decl &decl, LocatedSymbol &result, std::str
     }
 }
 
-bool GetDefinitionItems(const Decl &decl, LocatedSymbol &result)
+bool GetDefinitionItems(const Decl &decl, const std::string &curFilePath, LocatedSymbol &result)
 {
     Trace::Log("GetDefinitionItems in.");
     // invalid fileID
@@ -43,7 +43,7 @@ bool GetDefinitionItems(const Decl &decl, LocatedSymbol &result)
         range = GetDeclRange(decl, static_cast<int>(CountUnicodeCharacters(decl.identifier)));
     }
     const unsigned int fileID = range.start.fileID;
-    std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(LocateSymbolAtImpl::curFilePath, fileID);
+    std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(curFilePath, fileID);
     // Modify range and path if decl is in the MacroCall file.
     auto index = ark::CompilerCangjieProject::GetInstance()->GetMemIndex();
     if (!index) { return false; }
@@ -85,8 +85,6 @@ bool GetDefinitionItems(const Decl &decl, LocatedSymbol &result)
     return true;
 }
 
-std::string LocateSymbolAtImpl::curFilePath = "";
-
 bool LocateSymbolAtImpl::LocateSymbolAt(const ArkAST &ast, LocatedSymbol &result, Position pos)
 {
     Logger &logger = Logger::Instance();
@@ -97,7 +95,7 @@ bool LocateSymbolAtImpl::LocateSymbolAt(const ArkAST &ast, LocatedSymbol &result
     pos = PosFromIDE2Char(pos);
     PositionIDEToUTF8(ast.tokens, pos, *ast.file);
     // get curFilePath
-    curFilePath = ast.file ? ast.file->filePath : "";
+    std::string curFilePath = ast.file ? ast.file->filePath : "";
     LowFileName(curFilePath);
     // check current token is the kind required in function CheckTokenKind(TokenKind)
     std::vector<Symbol *> syms;
@@ -117,12 +115,15 @@ bool LocateSymbolAtImpl::LocateSymbolAt(const ArkAST &ast, LocatedSymbol &result
             decl = temp;
         }
     }
-    bool ret = GetDefinitionItems(*decl, result);
+    bool ret = GetDefinitionItems(*decl, curFilePath, result);
     return ret;
 }
 
 void LocateSymbolAtImpl::CrossDefinition(std::vector<message> &CrossMessage, Ptr<Cangjie::AST::FuncDecl> funcDecl)
 {
     CrossDefinitionCangjie2C::Cangjie2CGetFuncMessage(CrossMessage, funcDecl);
+    for (auto &item : CrossMessage) {
+        item.definitions = CrossDefinitionCangjie2C::FindCFunctions(item, true);
+    }
 }
 } // namespace ark
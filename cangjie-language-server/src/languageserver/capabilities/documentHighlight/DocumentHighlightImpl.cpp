@@ -12,8 +12,8 @@ using namespace Cangjie::AST;
 using namespace Cangjie::Meta;
 
 namespace ark {
-void GetDocumentHighlightItems(unsigned int fileID, const Decl &decl, std::set<DocumentHighlight> &result,
-                               const std::vector<Cangjie::Token> &tokens)
+void GetDocumentHighlightItems(const std::string &curFilePath, unsigned int fileID, const Decl &decl,
+                               std::set<DocumentHighlight> &result, const std::vector<Cangjie::Token> &tokens)
 {
     Logger &logger = Logger::Instance();
     logger.LogMessage(MessageType::MSG_LOG, "GetDocumentHighlightItems in.");
@@ -47,8 +47,7 @@ void GetDocumentHighlightItems(unsigned int fileID, const Decl &decl, std::set<D
             (void) result.insert({TransformFromChar2IDE(range), DocumentHighlightKind::TEXT});
         }
     }
-    std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(DocumentHighlightImpl::curFilePath,
-                                                                              fileID);
+    std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(curFilePath, fileID);
     auto pkgName = CompilerCangjieProject::GetInstance()->GetFullPkgName(path);
     auto package = CompilerCangjieProject::GetInstance()->GetSourcePackagesByPkg(pkgName);
     if (!package) { return; }
@@ -68,24 +67,24 @@ void GetDocumentHighlightItems(unsigned int fileID, const Decl &decl, std::set<D
     }
 }
 
-void HandlePropDecl(unsigned int fileID, const Decl &decl, std::set<DocumentHighlight> &result,
-                    const std::vector<Cangjie::Token> &tokens)
+void HandlePropDecl(const std::string &curFilePath, unsigned int fileID, const Decl &decl,
+                    std::set<DocumentHighlight> &result, const std::vector<Cangjie::Token> &tokens)
 {
     auto *pPropDecl = dynamic_cast<const PropDecl*>(&decl);
     if (pPropDecl && pPropDecl->outerDecl && pPropDecl->outerDecl->astKind == Cangjie::AST::ASTKind::EXTEND_DECL) {
-        GetDocumentHighlightItems(fileID, decl, result, tokens);
+        GetDocumentHighlightItems(curFilePath, fileID, decl, result, tokens);
     }
     auto funcDecls = GetInheritDecls(pPropDecl);
     for (auto item: funcDecls) {
-        GetDocumentHighlightItems(fileID, *item, result, tokens);
+        GetDocumentHighlightItems(curFilePath, fileID, *item, result, tokens);
     }
 }
 
-void HandleFuncAndPropDecl(unsigned int fileID, const Decl &decl, std::set<DocumentHighlight> &result,
-    const std::vector<Cangjie::Token> &tokens)
+void HandleFuncAndPropDecl(const std::string &curFilePath, unsigned int fileID, const Decl &decl,
+                           std::set<DocumentHighlight> &result, const std::vector<Cangjie::Token> &tokens)
 {
     if (decl.astKind == Cangjie::AST::ASTKind::PROP_DECL) {
-        HandlePropDecl(fileID, decl, result, tokens);
+        HandlePropDecl(curFilePath, fileID, decl, result, tokens);
         return;
     }
     auto funcDecl = dynamic_cast<const FuncDecl*>(&decl);
@@ -96,22 +95,20 @@ void HandleFuncAndPropDecl(unsigned int fileID, const Decl &decl, std::set<Docum
                  funcDecl->TestAttr(Cangjie::AST::Attribute::CONSTRUCTOR) ||
                  funcDecl->TestAttr(Cangjie::AST::Attribute::ENUM_CONSTRUCTOR);
     if (valid) {
-        GetDocumentHighlightItems(fileID, decl, result, tokens);
+        GetDocumentHighlightItems(curFilePath, fileID, decl, result, tokens);
     } else {
         // for extended function for class
         if (funcDecl->outerDecl && funcDecl->outerDecl->astKind == Cangjie::AST::ASTKind::EXTEND_DECL) {
-            GetDocumentHighlightItems(fileID, decl, result, tokens);
+            GetDocumentHighlightItems(curFilePath, fileID, decl, result, tokens);
         }
         if (!result.empty()) { return; }
         auto funcDecls = GetInheritDecls(funcDecl);
         for (auto item : funcDecls) {
-            GetDocumentHighlightItems(fileID, *item, result, tokens);
+            GetDocumentHighlightItems(curFilePath, fileID, *item, result, tokens);
         }
     }
 }
 
-std::string DocumentHighlightImpl::curFilePath = "";
-
 void DocumentHighlightImpl::FindDocumentHighlights(const ArkAST &ast, std::set<DocumentHighlight> &result,
                                                    Position pos)
 {
@@ -123,8 +120,7 @@ void DocumentHighlightImpl::FindDocumentHighlights(const ArkAST &ast, std::set<D
     pos = PosFromIDE2Char(pos);
     PositionIDEToUTF8(ast.tokens, pos, *ast.file);
     if (ast.IsFilterTokenInHighlight(pos)) { return; }
-    // get curFilePath
-    curFilePath = ast.file ? ast.file->filePath : "";
+    std::string curFilePath = ast.file ? ast.file->filePath : "";
     std::vector<Symbol *> syms;
     std::vector<Ptr<Cangjie::AST::Decl> > decls;
     Ptr<Decl> secend = ast.GetDeclByPosition(pos, syms, decls, {true, false});
@@ -148,7 +144,7 @@ void DocumentHighlightImpl::FindDocumentHighlights(const ArkAST &ast, std::set<D
                 }
             }
         }
-        HandleFuncAndPropDecl(pos.fileID, *decl, result, ast.tokens);
+        HandleFuncAndPropDecl(curFilePath, pos.fileID, *decl, result, ast.tokens);
         DealInCurPackage(ast, pos, syms, result, decl);
     }
 }
@@ -156,6 +152,7 @@ void DocumentHighlightImpl::FindDocumentHighlights(const ArkAST &ast, std::set<D
 void DocumentHighlightImpl::DealInCurPackage(const ArkAST &ast, const Position &pos, const vector<Symbol *> &syms,
                                              set <DocumentHighlight> &result, Ptr<Decl> &decl)
 {
+    const std::string curFilePath = ast.file ? ast.file->filePath : "";
     string genericDeclName = decl->identifier;
     if (decl->astKind == ASTKind::GENERIC_PARAM_DECL) {
         auto temp = ast.FindRealGenericParamDeclForExtend(genericDeclName, syms);
@@ -164,7 +161,7 @@ void DocumentHighlightImpl::DealInCurPackage(const ArkAST &ast, const Position &
         }
     }
     if (!Is<FuncDecl>(decl.get())) {
-        GetDocumentHighlightItems(pos.fileID, *decl, result, ast.tokens);
+        GetDocumentHighlightItems(curFilePath, pos.fileID, *decl, result, ast.tokens);
     }
     bool isInvalid = !(decl->outerDecl && ValidExtendIncludeGenericParam(decl->outerDecl) &&
                        decl->outerDecl->generic.get() &&
@@ -184,7 +181,7 @@ void DocumentHighlightImpl::DealInCurPackage(const ArkAST &ast, const Position &
         }
         for (auto &genericDecl: extendDecl->generic->typeParameters)
             if (genericDecl && genericDecl->identifier == genericDeclName) {
-                GetDocumentHighlightItems(pos.fileID, *genericDecl, result, ast.tokens);
+                GetDocumentHighlightItems(curFilePath, pos.fileID, *genericDecl, result, ast.tokens);
             }
     }
 }
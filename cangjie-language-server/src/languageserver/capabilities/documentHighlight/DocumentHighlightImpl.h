@@ -25,8 +25,6 @@
 namespace ark {
 class DocumentHighlightImpl {
 public:
-    static std::string curFilePath;
-
     static void
     FindDocumentHighlights(const ArkAST &ast, std::set<DocumentHighlight> &result, Cangjie::Position pos);
 
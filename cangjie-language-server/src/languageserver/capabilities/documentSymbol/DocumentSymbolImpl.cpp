@@ -245,37 +245,43 @@ void DocumentSymbolImpl::FindDocumentSymbols(const ArkAST &ast, std::vector<Docu
         return;
     }
     for (auto &toplevelDecl : ast.file->decls) {
-        if (!toplevelDecl) {
-            continue;
-        }
-        auto aimDecl = toplevelDecl.get();
-        auto astKind = toplevelDecl->astKind;
-        // just need no macroExpand Node
-        if (astKind == ASTKind::MACRO_EXPAND_DECL) {
-            auto macroExpandDecl = dynamic_cast< MacroExpandDecl *>(toplevelDecl.get().get());
-            if (macroExpandDecl && macroExpandDecl->invocation.decl) {
-                aimDecl = macroExpandDecl->invocation.decl.get();
-                astKind = aimDecl->astKind;
-            }
-        } else if (toplevelDecl->TestAttr(Attribute::MACRO_EXPANDED_NODE) && toplevelDecl->curMacroCall) {
-            auto *macroExpandDecl = dynamic_cast<MacroExpandDecl *>(toplevelDecl->curMacroCall.get());
-            if (macroExpandDecl && macroExpandDecl->invocation.decl) {
-                aimDecl = macroExpandDecl->invocation.decl.get();
-                astKind = aimDecl->astKind;
-            }
-        }
-        if (!supportSymbolKind.count(astKind)) {
-            continue;
-        }
-        DocumentSymbol documentSymbol;
-        if (astKind == ASTKind::ENUM_DECL) {
-            documentSymbol = GetDocumentSymbolByEnumDecl(ast, aimDecl);
-        } else {
-            documentSymbol = GetDocumentSymbolByDecl(ast, aimDecl);
+        FindDocumentSymbol(ast, toplevelDecl.get(), result);
+    }
+}
+
+void DocumentSymbolImpl::FindDocumentSymbol(const ArkAST &ast, Ptr<Decl> toplevelDecl,
+                                            std::vector<DocumentSymbol> &result)
+{
+    if (!toplevelDecl) {
+        return;
+    }
+    auto aimDecl = toplevelDecl;
+    auto astKind = toplevelDecl->astKind;
+    // just need no macroExpand Node
+    if (astKind == ASTKind::MACRO_EXPAND_DECL) {
+        auto macroExpandDecl = dynamic_cast< MacroExpandDecl *>(toplevelDecl.get());
+        if (macroExpandDecl && macroExpandDecl->invocation.decl) {
+            aimDecl = macroExpandDecl->invocation.decl.get();
+            astKind = aimDecl->astKind;
         }
-        if (!documentSymbol.name.empty()) {
-            result.emplace_back(documentSymbol);
+    } else if (toplevelDecl->TestAttr(Attribute::MACRO_EXPANDED_NODE) && toplevelDecl->curMacroCall) {
+        auto *macroExpandDecl = dynamic_cast<MacroExpandDecl *>(toplevelDecl->curMacroCall.get());
+        if (macroExpandDecl && macroExpandDecl->invocation.decl) {
+            aimDecl = macroExpandDecl->invocation.decl.get();
+            astKind = aimDecl->astKind;
         }
     }
+    if (!supportSymbolKind.count(astKind)) {
+        return;
+    }
+    DocumentSymbol documentSymbol;
+    if (astKind == ASTKind::ENUM_DECL) {
+        documentSymbol = GetDocumentSymbolByEnumDecl(ast, aimDecl);
+    } else {
+        documentSymbol = GetDocumentSymbolByDecl(ast, aimDecl);
+    }
+    if (!documentSymbol.name.empty()) {
+        result.emplace_back(documentSymbol);
+    }
 }
 }
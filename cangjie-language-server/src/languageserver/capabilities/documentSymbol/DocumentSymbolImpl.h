@@ -15,6 +15,10 @@ class DocumentSymbolImpl {
 public:
     static void FindDocumentSymbols(const ArkAST &ast, std::vector<DocumentSymbol> &result);
 
+    // The outline entry of one top-level declaration of the file of ast, if it has one.
+    static void FindDocumentSymbol(const ArkAST &ast, Ptr<Cangjie::AST::Decl> toplevelDecl,
+                                   std::vector<DocumentSymbol> &result);
+
     static std::map<Cangjie::AST::Attribute, std::string> GetSupportAttribute();
 
 private:
@@ -0,0 +1,102 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "FormattingImpl.h"
+#include <algorithm>
+#include "../../common/BasicHelper.h"
+#include "../../logger/Logger.h"
+#include "Format/FormatCodeProcessor.h"
+#include "Format/FormatConfig.h"
+#include "Format/FormatOutput.h"
+
+namespace ark {
+namespace {
+// Indentation widths cjfmt accepts.
+const int MAX_INDENT_WIDTH = 8;
+
+// Configurations of the projects the formatted files are in, shared by the requests of all documents.
+Cangjie::Format::ProjectConfigs g_projectConfigs;
+
+/* The options cjfmt would use for filePath, those of the nearest cangjie-format.toml. Only a file with no configuration
+ * takes the indentation from the editor, keeping the line breaks of the document. */
+Cangjie::Format::FormattingOptions ToFormatOptions(const std::string &filePath, const std::string &contents,
+                                                   const FormattingOptions &options)
+{
+    if (auto projectOptions = g_projectConfigs.OptionsFor(filePath)) {
+        return projectOptions.value();
+    }
+    Cangjie::Format::FormattingOptions formatOptions;
+    // the editor has no say in the other options, tabs are not supported and insertSpaces is ignored
+    formatOptions.indentWidth = std::clamp(options.tabSize, 0, MAX_INDENT_WIDTH);
+    // keep the line breaks of the document, else every line would be edited
+    if (contents.find("\r\n") != std::string::npos) {
+        formatOptions.newLine = "\r\n";
+    }
+    return formatOptions;
+}
+
+// Formats region of contents and turns the changes into edits.
+bool Format(const std::string &filePath, const std::string &contents, const Cangjie::Format::Region &region,
+            const FormattingOptions &options, std::vector<TextEdit> &result)
+{
+    // parse errors are the diagnostics' business, typing leaves code broken most of the time
+    auto replacements =
+        Cangjie::Format::FormatRegion(contents, filePath, region, ToFormatOptions(filePath, contents, options), false);
+    if (!replacements) {
+        Logger::Instance().LogMessage(MessageType::MSG_LOG, "Not formatted, the file has syntax errors: " + filePath);
+        return false;
+    }
+    auto lineOffsets = GetLineOffsets(contents);
+    for (auto &replacement : replacements.value()) {
+        Range range = {GetPositionFromOffset(contents, lineOffsets, replacement.offset),
+                       GetPositionFromOffset(contents, lineOffsets, replacement.offset + replacement.length)};
+        result.emplace_back(range, replacement.text);
+    }
+    return true;
+}
+} // namespace
+
+bool FormattingImpl::FormatDocument(const std::string &filePath, const std::string &contents,
+                                    const FormattingOptions &options, std::vector<TextEdit> &result)
+{
+    return Format(filePath, contents, Cangjie::Format::Region::wholeFile, options, result);
+}
+
+bool FormattingImpl::FormatRange(const std::string &filePath, const std::string &contents, const Range &range,
+                                 const FormattingOptions &options, std::vector<TextEdit> &result)
+{
+    int startLine = range.start.line + 1;
+    int endLine = range.end.line + 1;
+    // a selection of whole lines ends at the start of the line after them
+    if (range.end.column == 0 && endLine > startLine) {
+        endLine--;
+    }
+    return Format(filePath, contents, Cangjie::Format::Region(startLine, endLine, false), options, result);
+}
+
+bool FormattingImpl::FormatOnType(const std::string &filePath, const std::string &contents,
+                                  const Cangjie::Position &position, const std::string &ch,
+                                  const FormattingOptions &options, std::vector<TextEdit> &result)
+{
+    // after a line break the cursor is on the new line, the one it ended is formatted
+    int line = ch == "\n" ? position.line : position.line + 1;
+    if (line < 1) {
+        return true;
+    }
+    std::vector<TextEdit> edits;
+    if (!Format(filePath, contents, Cangjie::Format::Region(line, line, false), options, edits)) {
+        return false;
+    }
+    // the region grows to whole declarations, what comes after the cursor is the user's to type on
+    for (auto &edit : edits) {
+        if (edit.range.end.line < position.line ||
+            (edit.range.end.line == position.line && edit.range.end.column <= position.column)) {
+            result.push_back(std::move(edit));
+        }
+    }
+    return true;
+}
+} // namespace ark
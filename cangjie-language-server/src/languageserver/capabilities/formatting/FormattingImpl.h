@@ -0,0 +1,32 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef LSPSERVER_FORMATTINGIMPL_H
+#define LSPSERVER_FORMATTINGIMPL_H
+
+#include "../../../json-rpc/Protocol.h"
+
+namespace ark {
+/* Formatting with cjfmt. contents is the document as the client has it, the edits returned apply to it and only
+ * touch what formatting changes. The options are those of the cangjie-format.toml of the project, the editor's are
+ * used for a file with none. All return false if contents has syntax errors. */
+class FormattingImpl {
+public:
+    static bool FormatDocument(const std::string &filePath, const std::string &contents,
+                               const FormattingOptions &options, std::vector<TextEdit> &result);
+
+    // Formats the code on the lines of range, as cjfmt -l does.
+    static bool FormatRange(const std::string &filePath, const std::string &contents, const Range &range,
+                            const FormattingOptions &options, std::vector<TextEdit> &result);
+
+    // Formats the line ch was typed on, or the line it ended for a line break. position is just after ch.
+    static bool FormatOnType(const std::string &filePath, const std::string &contents,
+                             const Cangjie::Position &position, const std::string &ch,
+                             const FormattingOptions &options, std::vector<TextEdit> &result);
+};
+} // namespace ark
+
+#endif // LSPSERVER_FORMATTINGIMPL_H
@@ -5,6 +5,7 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "HoverImpl.h"
+#include "../../index/CjdIndex.h"
 #include "cangjie/Lex/Token.h"
 
 namespace {
@@ -18,8 +19,6 @@ using namespace Cangjie;
 using namespace Cangjie::AST;
 using namespace CONSTANTS;
 
-std::string HoverImpl::curFilePath = "";
-
 std::vector<std::string> HoverImpl::StringSplit(const std::string &src, const std::string &separateCharacter)
 {
     std::vector<std::string> strs;
@@ -349,8 +348,6 @@ std::string HoverImpl::ResolveComment(const std::string &comment, const CommentK
 
 std::string HoverImpl::GetDeclCommentOfBack(const std::vector<Cangjie::Token> &tokens, const int lastTokenIndexOnLine)
 {
-    Logger &logger = Logger::Instance();
-    logger.LogMessage(MessageType::MSG_LOG, "HoverImpl::GetDeclCommentOfBack in.");
     std::string commentOfBack;
     auto index = static_cast<std::vector<Cangjie::Token>::size_type>(static_cast<unsigned int>(lastTokenIndexOnLine));
     std::string retCommentOfBack = "";
@@ -372,8 +369,6 @@ std::string HoverImpl::GetDeclCommentOfAbove(const std::vector<Cangjie::Token> &
                                              bool &hasDocComment,
                                              const int prevLineFirstIndexOnLine)
 {
-    Logger &logger = Logger::Instance();
-    logger.LogMessage(MessageType::MSG_LOG, "HoverImpl::GetDeclCommentOfAbove in.");
     // format is "comment + decl", so minus 1 to get comments
     if (tokens.empty() || firstTokenIndexOnLine < 1) {
         return "";
@@ -418,8 +413,6 @@ std::string HoverImpl::GetDeclCommentByIndex(const std::vector<Cangjie::Token> &
                                              const unsigned int firstTokenIndexOnLine, const int lastTokenIndexOnLine,
                                              const int prevLineFirstIndexOnLine)
 {
-    Logger &logger = Logger::Instance();
-    logger.LogMessage(MessageType::MSG_LOG, "HoverImpl::GetDeclCommentByIndex in.");
     bool hasDocComment = false;
     // comments in the above
     std::string retCommentTop = GetDeclCommentOfAbove(tokens, firstTokenIndexOnLine,
@@ -434,6 +427,19 @@ std::string HoverImpl::GetDeclCommentByIndex(const std::vector<Cangjie::Token> &
             (retCommentTop + CONSTANTS::BLANK)) + retCommentBack;
 }
 
+std::string HoverImpl::GetDeclComment(const std::vector<Cangjie::Token> &tokens, const Decl &decl)
+{
+    int firstTokenIndexOnLine = GetFirstTokenOnCurLine(tokens, decl.GetIdentifierPos().line);
+    int lastTokenIndexOnLine = GetLastTokenOnCurLine(tokens, decl.GetIdentifierPos().line);
+    if (firstTokenIndexOnLine == -1 || lastTokenIndexOnLine == -1) {
+        return "";
+    }
+    // prev line first token index
+    int prevLineFirstIndexOnLine = GetFirstTokenOnCurLine(tokens, decl.GetIdentifierPos().line - 1);
+    return GetDeclCommentByIndex(tokens, static_cast<const unsigned int>(firstTokenIndexOnLine),
+        lastTokenIndexOnLine, prevLineFirstIndexOnLine);
+}
+
 std::string HoverImpl::GetHoverMessageByOuterDecl(const Decl &node)
 {
     std::string detail;
@@ -472,6 +478,7 @@ std::string HoverImpl::GetHoverMessageByOuterDecl(const Decl &node)
 int HoverImpl::GetHoverMessage(Ptr<Decl> decl, Hover &result, const ArkAST &ast)
 {
     auto instance = CompilerCangjieProject::GetInstance();
+    std::string curFilePath = ast.file ? ast.file->filePath : "";
     std::string path = instance->GetPathBySource(curFilePath, decl->identifier.Begin().fileID);
     // get source declared
     std::string source = ItemResolverUtil::ResolveSourceByNode(decl, path);
@@ -491,26 +498,29 @@ int HoverImpl::GetHoverMessage(Ptr<Decl> decl, Hover &result, const ArkAST &ast)
     if (MessageHeaderEndOfLine::GetIsDeveco()) {
         result.markedString.push_back(GetDeclApiKey(decl));
     }
-    // get decl arkAST
     if (!decl) {
         return 0;
     }
-    ArkAST *declAST = instance->GetArkAST(path);
-    if (declAST == nullptr || declAST->tokens.empty()) {
-        return 0;
+    // the comment of an indexed decl was extracted when its package was indexed
+    auto id = GetDeclSymbolID(*decl);
+    if (auto doc = instance->GetMemIndex()->FindDoc(id); doc && !doc->empty()) {
+        result.markedString.push_back(*doc);
+        return 1;
     }
-    // get comment
-    int firstTokenIndexOnLine = GetFirstTokenOnCurLine(declAST->tokens, decl->GetIdentifierPos().line);
-    int lastTokenIndexOnLine = GetLastTokenOnCurLine(declAST->tokens, decl->GetIdentifierPos().line);
-    if (firstTokenIndexOnLine == -1 || lastTokenIndexOnLine == -1) {
+    // not indexed, or indexed before its file was lexed: read the comment of the decl itself
+    ArkAST *declAST = instance->GetArkAST(path);
+    if (declAST != nullptr && !declAST->tokens.empty()) {
+        result.markedString.push_back(GetDeclComment(declAST->tokens, *decl));
         return 1;
     }
-    // prev line first token index
-    int prevLineFirstIndexOnLine = GetFirstTokenOnCurLine(declAST->tokens, decl->GetIdentifierPos().line - 1);
-    std::string comment = GetDeclCommentByIndex(declAST->tokens, static_cast<const unsigned int>(firstTokenIndexOnLine),
-        lastTokenIndexOnLine, prevLineFirstIndexOnLine);
-    result.markedString.push_back(comment);
-    return 1;
+    // a decl of a cjo package has its comment in the cjd source
+    if (auto cjdIndexer = lsp::CjdIndexer::GetInstance()) {
+        if (auto cjdSym = cjdIndexer->FindSymbol(id, decl->fullPackageName); cjdSym && !cjdSym->doc.empty()) {
+            result.markedString.push_back(cjdSym->doc);
+            return 1;
+        }
+    }
+    return 0;
 }
 
 std::string HoverImpl::GetDeclApiKey(const Ptr<Decl> &decl)
@@ -580,8 +590,6 @@ int HoverImpl::FindHover(const ArkAST &ast, Hover &result, Cangjie::Position pos
     pos = PosFromIDE2Char(pos);
     PositionIDEToUTF8(ast.tokens, pos, *ast.file);
 
-    // get curFilePath
-    curFilePath = ast.file ? ast.file->filePath : "";
     int index = ast.GetCurTokenByPos(pos, 0, static_cast<int>(ast.tokens.size()) - 1);
     if (index < 0 || ast.tokens[static_cast<size_t>(index)].kind == TokenKind::MAIN) {
         logger.LogMessage(MessageType::MSG_INFO, "this token does not need to hover.");
@@ -28,11 +28,12 @@ public:
 
     static std::string GetDeclCommentOfAbove(const std::vector<Cangjie::Token>&, const unsigned int, bool&, const int);
 
+    // Comment shown for decl, tokens are those of the file declaring it. Used by the index to extract it once.
+    static std::string GetDeclComment(const std::vector<Cangjie::Token>& tokens, const Cangjie::AST::Decl& decl);
+
     static int GetHoverMessage(Ptr<Cangjie::AST::Decl>, Hover &, const ArkAST &ast);
 
 private:
-    static std::string curFilePath;
-
     static std::vector<std::string> StringSplit(const std::string& src, const std::string& separateCharacter);
 
     static void TrimSpaceAndTab(std::string& s);
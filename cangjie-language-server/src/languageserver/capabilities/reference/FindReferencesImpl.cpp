@@ -6,6 +6,7 @@
 
 #include "FindReferencesImpl.h"
 #include "../../CompilerCangjieProject.h"
+#include "../definition/CrossDefinitionCangjie2C.h"
 
 using namespace Cangjie;
 using namespace Cangjie::AST;
@@ -13,8 +14,6 @@ using namespace Cangjie::Meta;
 
 namespace ark {
 
-std::string FindReferencesImpl::curFilePath = "";
-
 void FindReferencesImpl::GetCurPkgUesage(Ptr<Decl> decl, const ArkAST &ast, ReferencesResult &result)
 {
     if (!decl || !ast.file || !ast.file->curPackage) {
@@ -43,8 +42,7 @@ void FindReferencesImpl::FindReferences(const ArkAST &ast, ReferencesResult &res
     if (ast.IsFilterToken(pos)) {
         return;
     }
-    // get curFilePath
-    curFilePath = ast.file ? ast.file->filePath : "";
+    std::string curFilePath = ast.file ? ast.file->filePath : "";
     pos.fileID = ast.fileID;
     std::vector<Symbol *> syms;
     std::vector<Ptr<Cangjie::AST::Decl> > decls;
@@ -92,10 +90,7 @@ void FindReferencesImpl::FindReferences(const ArkAST &ast, ReferencesResult &res
             continue;
         }
         std::unordered_set<lsp::SymbolID> ids;
-        lsp::SymbolID topId = id;
-        index->FindRiddenUp(id, ids, topId);
-        index->FindRiddenDown(topId, ids);
-        (void)ids.insert(id);
+        index->FindOverrideFamily(id, ids);
 
         lsp::RefsRequest req{ids, lsp::RefKind::REFERENCE};
         lsp::Ref definition{ {}, {}, 0 };
@@ -128,6 +123,16 @@ void FindReferencesImpl::FindReferences(const ArkAST &ast, ReferencesResult &res
                 result.References.erase(it);
             }
         }
+        // the C functions a foreign func binds to are its uses on the other side of the boundary
+        if (decl->astKind == ASTKind::FUNC_DECL && decl->TestAttr(Attribute::FOREIGN)) {
+            std::vector<message> crossMessage;
+            CrossDefinitionCangjie2C::Cangjie2CGetFuncMessage(crossMessage, StaticCast<FuncDecl*>(decl));
+            for (const auto &item : crossMessage) {
+                for (auto &loc : CrossDefinitionCangjie2C::FindCFunctions(item, false)) {
+                    (void)result.References.emplace(std::move(loc));
+                }
+            }
+        }
     }
 }
 
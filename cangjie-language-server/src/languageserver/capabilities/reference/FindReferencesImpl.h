@@ -29,8 +29,6 @@ struct ReferencesResult {
 
 class FindReferencesImpl {
 public:
-    static std::string curFilePath;
-
     static void FindReferences(const ArkAST &ast, ReferencesResult &result, Cangjie::Position pos);
 
     static void GetCurPkgUesage(Ptr<Decl> decl, const ArkAST &ast, ReferencesResult &result);
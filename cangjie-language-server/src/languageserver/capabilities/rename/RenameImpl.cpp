@@ -5,46 +5,130 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "RenameImpl.h"
+#include <string_view>
 
 using namespace Cangjie;
 using namespace Cangjie::AST;
 namespace ark {
 
-std::string RenameImpl::curFilePath = "";
+namespace {
+void SortAndUnique(std::vector<TextEdit> &edits)
+{
+    std::sort(edits.begin(), edits.end());
+    auto same = [](const TextEdit &lhs, const TextEdit &rhs) { return !(lhs < rhs) && !(rhs < lhs); };
+    edits.erase(std::unique(edits.begin(), edits.end(), same), edits.end());
+}
+
+// Index positions of a file edited or waiting for its package to be recompiled may be out of date. Rather than
+// compiling it again, each of its edits is checked for the old name where the index says, the "file:line:column" of
+// those not holding it are added to stale.
+void FindStaleEdits(const std::string &path, const std::string &oldName, const std::vector<TextEdit> &edits,
+                    Callbacks &cb, std::vector<std::string> &stale)
+{
+    auto project = CompilerCangjieProject::GetInstance();
+    if (oldName.empty() || (!cb.NeedReParser(path) && !project->CheckNeedCompiler(path))) {
+        return;
+    }
+    std::string contents = cb.GetContentsByFile(path);
+    if (contents.empty()) {
+        contents = project->GetContentByFile(path);
+    }
+    if (contents.empty()) {
+        return;
+    }
+    std::vector<std::string_view> lines;
+    std::string_view rest = contents;
+    for (auto end = rest.find('\n'); end != std::string_view::npos; end = rest.find('\n')) {
+        lines.emplace_back(rest.substr(0, end));
+        rest.remove_prefix(end + 1);
+    }
+    lines.emplace_back(rest);
+    auto stillThere = [&lines, &oldName](const TextEdit &edit) {
+        auto line = static_cast<size_t>(edit.range.start.line);
+        auto column = static_cast<size_t>(edit.range.start.column);
+        if (line >= lines.size()) {
+            return false;
+        }
+        auto text = lines[line];
+        // columns count characters, only plain ascii lines can be checked by offset
+        if (std::any_of(text.begin(), text.end(), [](char ch) { return static_cast<unsigned char>(ch) >= 0x80; })) {
+            return true;
+        }
+        if (column < text.size() && text[column] == '`') {
+            ++column;
+        }
+        return column <= text.size() && text.substr(column, oldName.size()) == oldName;
+    };
+    for (const auto &edit : edits) {
+        if (!stillThere(edit)) {
+            stale.push_back(path + ":" + std::to_string(edit.range.start.line + 1) + ":" +
+                            std::to_string(edit.range.start.column + 1));
+        }
+    }
+}
+
+// A partial rename would leave the code broken, so it is refused until the stale files are analysed again.
+void ReportStaleEdits(const std::vector<std::string> &stale, MessageErrorDetail &errorInfo)
+{
+    const size_t shown = 5;
+    std::string locations;
+    for (size_t i = 0; i < stale.size(); ++i) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "rename: old name not found at " + stale[i]);
+        if (i < shown) {
+            locations += (i == 0 ? "" : ", ") + stale[i];
+        }
+    }
+    if (stale.size() > shown) {
+        locations += " and " + std::to_string(stale.size() - shown) + " more";
+    }
+    errorInfo.message = "Rename failed, the name is no longer found at " + locations +
+                        ". Please try again once the changed files are analysed.";
+    errorInfo.code = ErrorCode::INVALID_RENAME_FOR_STALE_INDEX;
+}
+} // namespace
 
-void HandleResult(const std::string path, const std::set<TextEdit> &testEdit, std::vector<TextDocumentEdit> &result,
-                  Callbacks &cb)
+void HandleResult(const std::string path, const std::vector<TextEdit> &testEdit,
+                  std::vector<TextDocumentEdit> &result, Callbacks &cb)
 {
     TextDocumentEdit textDocumentEdit;
     std::string uri = URI::URIFromAbsolutePath(path).ToString();
     textDocumentEdit.textDocument.uri.file = uri;
     textDocumentEdit.textDocument.version = cb.GetVersionByFile(path);
-    textDocumentEdit.textEdits.assign(testEdit.begin(), testEdit.end());
+    textDocumentEdit.textEdits = testEdit;
     result.push_back(textDocumentEdit);
 }
 
 std::string RenameImpl::GetRealName(std::vector<TextDocumentEdit> &result, Callbacks &cb,
-                                    DocumentChanges &documentChanges)
+                                    DocumentChanges &documentChanges, MessageErrorDetail &errorInfo)
 {
     EditMap usersEditNotInDef;
     // merge result
-    for (const auto &iter : documentChanges.usersEditMap) {
-        if (documentChanges.defineEditMap.find(iter.first) == documentChanges.defineEditMap.end()) {
-            (void)usersEditNotInDef.emplace(iter);
+    for (auto &iter : documentChanges.usersEditMap) {
+        auto found = documentChanges.defineEditMap.find(iter.first);
+        if (found == documentChanges.defineEditMap.end()) {
+            (void)usersEditNotInDef.emplace(iter.first, std::move(iter.second));
             continue;
         }
-        for (auto &editMap : iter.second) {
-            (void)documentChanges.defineEditMap[iter.first].emplace(editMap);
-        }
+        found->second.insert(found->second.end(), iter.second.begin(), iter.second.end());
     }
-    for (const auto &iter : documentChanges.defineEditMap) {
+    std::vector<std::string> stale;
+    for (auto &iter : documentChanges.defineEditMap) {
+        SortAndUnique(iter.second);
+        FindStaleEdits(iter.first, documentChanges.oldName, iter.second, cb, stale);
         HandleResult(iter.first, iter.second, result, cb);
     }
-    for (const auto &iter : usersEditNotInDef) {
+    for (auto &iter : usersEditNotInDef) {
+        SortAndUnique(iter.second);
+        FindStaleEdits(iter.first, documentChanges.oldName, iter.second, cb, stale);
         if (!iter.second.empty()) {
             HandleResult(iter.first, iter.second, result, cb);
         }
     }
+    if (!stale.empty()) {
+        ReportStaleEdits(stale, errorInfo);
+        result.clear();
+        return "";
+    }
     if (!documentChanges.defineEditMap.empty()) {
         auto iter = documentChanges.defineEditMap.begin();
         return iter->first;
@@ -55,27 +139,13 @@ std::string RenameImpl::GetRealName(std::vector<TextDocumentEdit> &result, Callb
 void RenameImpl::UpdateUserMap(ark::DocumentChanges &documentChanges, std::string file, TextEdit t)
 {
     CompilerCangjieProject::GetInstance()->GetRealPath(file);
-    auto found = documentChanges.usersEditMap.find(file);
-    if (found == documentChanges.usersEditMap.end()) {
-        std::set<TextEdit> textEdits;
-        (void)textEdits.emplace(t);
-        documentChanges.usersEditMap[file] = textEdits;
-    } else {
-        (void)documentChanges.usersEditMap[file].emplace(t);
-    }
+    documentChanges.usersEditMap[file].emplace_back(std::move(t));
 }
 
 void RenameImpl::UpdateDefineMap(ark::DocumentChanges &documentChanges, std::string file, TextEdit t)
 {
     CompilerCangjieProject::GetInstance()->GetRealPath(file);
-    auto found = documentChanges.defineEditMap.find(file);
-    if (found == documentChanges.defineEditMap.end()) {
-        std::set<TextEdit> textEdits;
-        (void)textEdits.emplace(t);
-        documentChanges.defineEditMap[file] = textEdits;
-    } else {
-        (void)documentChanges.defineEditMap[file].emplace(t);
-    }
+    documentChanges.defineEditMap[file].emplace_back(std::move(t));
 }
 
 void RenameImpl::GetLocalVarUesage(Ptr<Decl> decl, const ArkAST &ast, ark::DocumentChanges &documentChanges,
@@ -97,7 +167,7 @@ void RenameImpl::GetLocalVarUesage(Ptr<Decl> decl, const ArkAST &ast, ark::Docum
             samePackage = targetPackageName == packageName;
         }
         TextEdit t{GetProperRange(U, ast.tokens, samePackage), newName};
-        UpdateUserMap(documentChanges, curFilePath, t);
+        UpdateUserMap(documentChanges, ast.file->filePath, t);
     }
 }
 
@@ -108,7 +178,7 @@ void RenameImpl::HandleGeneric(Ptr<Decl> defineDecl, const ArkAST &ast, Document
         defineDecl = temp;
     }
     TextEdit t{TransformFromChar2IDE({defineDecl->begin, defineDecl->end}), newName};
-    UpdateDefineMap(documentChanges, curFilePath, t);
+    UpdateDefineMap(documentChanges, ast.file->filePath, t);
     GetLocalVarUesage(defineDecl, ast, documentChanges, newName);
     auto inheritable = dynamic_cast<InheritableDecl*>(defineDecl->outerDecl.get());
     if (!inheritable) {
@@ -131,14 +201,11 @@ void RenameImpl::HandleGeneric(Ptr<Decl> defineDecl, const ArkAST &ast, Document
 void RenameImpl::RenameByIndex(lsp::SymbolID id, DocumentChanges &documentChanges, const std::string &newName)
 {
     std::unordered_set<lsp::SymbolID> relationIds;
-    lsp::SymbolID topId = id;
     auto index = ark::CompilerCangjieProject::GetInstance()->GetMemIndex();
     if (!index) {
         return;
     }
-    index->FindRiddenUp(id, relationIds, topId);
-    index->FindRiddenDown(topId, relationIds);
-    (void)relationIds.emplace(topId);
+    index->FindOverrideFamily(id, relationIds);
 
     std::unordered_set<lsp::SymbolID> temIds;
     (void)temIds.emplace(id);
@@ -207,7 +274,7 @@ void HandleInit(Ptr<Decl> defineDecl, std::unordered_set<lsp::SymbolID> &defIds)
 }
 
 std::string RenameImpl::Rename(const ArkAST &ast, std::vector<TextDocumentEdit> &result, Position pos,
-                               const std::string &newName, Callbacks &cb)
+                               const std::string &newName, Callbacks &cb, MessageErrorDetail &errorInfo)
 {
     bool invalid = !ast.file || !ast.packageInstance;
     if (invalid) { return ""; }
@@ -220,8 +287,7 @@ std::string RenameImpl::Rename(const ArkAST &ast, std::vector<TextDocumentEdit>
     pos = PosFromIDE2Char(pos);
     PositionIDEToUTF8(ast.tokens, pos, *ast.file);
     int idx = ast.GetCurTokenByPos(pos, 0, static_cast<int>(ast.tokens.size()) - 1);
-    // get curFilePath
-    curFilePath = ast.file->filePath;
+    const std::string &curFilePath = ast.file->filePath;
     std::vector<Symbol *> syms;
     std::vector<Ptr<Cangjie::AST::Decl> > decls;
     DocumentChanges documentChanges;
@@ -235,7 +301,7 @@ std::string RenameImpl::Rename(const ArkAST &ast, std::vector<TextDocumentEdit>
     // Searching for local variables by ast
     if (defineDecl->astKind == ASTKind::GENERIC_PARAM_DECL) {
         HandleGeneric(defineDecl, ast, documentChanges, newName, syms);
-        return GetRealName(result, cb, documentChanges);
+        return GetRealName(result, cb, documentChanges, errorInfo);
     }
 
     if (!IsGlobalOrMemberOrItsParam(*defineDecl)) {
@@ -252,7 +318,7 @@ std::string RenameImpl::Rename(const ArkAST &ast, std::vector<TextDocumentEdit>
                    newName};
         UpdateDefineMap(documentChanges, curFilePath, t);
         GetLocalVarUesage(defineDecl, ast, documentChanges, newName);
-        return GetRealName(result, cb, documentChanges);
+        return GetRealName(result, cb, documentChanges, errorInfo);
     }
 
     // Searching for nonlocal variables by index
@@ -276,11 +342,16 @@ std::string RenameImpl::Rename(const ArkAST &ast, std::vector<TextDocumentEdit>
     // Get init funcs of struct/class and their own
     HandleInit(defineDecl, defIds);
 
+    // references to an init are spelt with the name of its type
+    bool isInit = defineDecl->astKind == ASTKind::FUNC_DECL && defineDecl->identifier == "init";
+    documentChanges.oldName = isInit && defineDecl->outerDecl ? defineDecl->outerDecl->identifier.Val()
+                                                              : defineDecl->identifier.Val();
+
     for (const auto &id : defIds) {
         RenameByIndex(id, documentChanges, newName);
     }
 
-    return GetRealName(result, cb, documentChanges);
+    return GetRealName(result, cb, documentChanges, errorInfo);
 }
 
 } // namespace ark
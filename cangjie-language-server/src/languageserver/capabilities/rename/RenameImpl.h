@@ -18,21 +18,25 @@
 #include "cangjie/AST/Searcher.h"
 
 namespace ark {
-using EditMap = std::unordered_map<std::string, std::set<TextEdit>>;
+// Edits are appended per file while collecting, each bucket is sorted and deduplicated once before replying.
+using EditMap = std::unordered_map<std::string, std::vector<TextEdit>>;
 struct DocumentChanges {
     EditMap defineEditMap;
     EditMap usersEditMap;
+    // Name being replaced, edits in files changed since they were indexed are checked against it.
+    std::string oldName;
 };
 
 class RenameImpl {
 public:
+    // errorInfo is set, and result left empty, when the edits found through the index are out of date.
     static std::string Rename(const ArkAST &ast, std::vector<TextDocumentEdit> &result, Cangjie::Position pos,
-                              const std::string &newName, Callbacks &callback);
+                              const std::string &newName, Callbacks &callback, MessageErrorDetail &errorInfo);
 
     static void RenameByIndex(lsp::SymbolID id, DocumentChanges &documentChanges, const std::string &newName);
 
     static std::string GetRealName(std::vector<TextDocumentEdit> &result, Callbacks &cb,
-                                   ark::DocumentChanges &documentChanges);
+                                   ark::DocumentChanges &documentChanges, MessageErrorDetail &errorInfo);
 
     static void GetLocalVarUesage(Ptr<Decl> decl, const ArkAST &ast, ark::DocumentChanges &documentChanges,
                                   const std::string &newName);
@@ -43,8 +47,6 @@ public:
 
     static void HandleGeneric(Ptr<Decl> defineDecl, const ArkAST &ast, DocumentChanges &documentChanges,
                               const std::string &newName, const std::vector<Symbol *> &syms);
-
-    static std::string curFilePath;
 };
 } // namespace ark
 
@@ -397,7 +397,7 @@ void GetQualifiedType(Ptr<Node> node, std::vector<SemanticHighlightToken> &resul
     Range range = {pos, {pos.fileID, pos.line,
         pos.column + static_cast<int>(CountUnicodeCharacters(qualifiedType->field))}};
     UpdateRange(tokens, range, *node);
-    static std::unordered_map<ASTKind, HighlightKind> highlightMap = {
+    static const std::unordered_map<ASTKind, HighlightKind> highlightMap = {
         {ASTKind::PACKAGE_DECL, HighlightKind::PACKAGE_H},
         {ASTKind::CLASS_LIKE_DECL, HighlightKind::CLASS_H},
         {ASTKind::CLASS_DECL, HighlightKind::CLASS_H},
@@ -409,7 +409,7 @@ void GetQualifiedType(Ptr<Node> node, std::vector<SemanticHighlightToken> &resul
     };
     HighlightKind kind = HighlightKind::VARIABLE_H;
     if (qualifiedType->target != nullptr && highlightMap.count(qualifiedType->target->astKind)) {
-        kind = highlightMap[qualifiedType->target->astKind];
+        kind = highlightMap.at(qualifiedType->target->astKind);
     }
     result.push_back({kind, TransformFromChar2IDE(range)});
 }
@@ -23,17 +23,15 @@ namespace {
 }
 
 namespace ark {
-std::string TypeHierarchyImpl::curFilePath = "";
-Position TypeHierarchyImpl::curPos;
-
 bool IsInheritableDecl(const Decl &decl)
 {
     return decl.astKind == ASTKind::CLASS_DECL || decl.astKind == ASTKind::INTERFACE_DECL ||
            decl.astKind == ASTKind::EXTEND_DECL || decl.astKind == ASTKind::ENUM_DECL ||
            decl.astKind == ASTKind::STRUCT_DECL;
 }
-// get TypeHierarchyItem by Decl
-TypeHierarchyItem TypeHierarchyImpl::TypeHierarchyFrom(Ptr<const Decl> decl)
+// get TypeHierarchyItem by Decl, a decl of the kernel lib is given curFilePath and curPos of the request
+TypeHierarchyItem TypeHierarchyImpl::TypeHierarchyFrom(Ptr<const Decl> decl, const std::string &curFilePath,
+                                                       const Position &curPos)
 {
     TypeHierarchyItem result;
     if (decl != nullptr && IsInheritableDecl(*decl) && AST2Symbol.find(decl->astKind) != AST2Symbol.end()) {
@@ -98,13 +96,11 @@ void TypeHierarchyImpl::FindTypeHierarchyImpl(const ark::ArkAST &ast, TypeHierar
     logger.LogMessage(MessageType::MSG_LOG, "TypeHierarchyImpl::FindTypeHierarchyImpl in.");
     // update pos fileID
     pos.fileID = ast.fileID;
-    curPos.column = pos.column;
-    curPos.line = pos.line;
-    curPos.fileID = pos.fileID;
+    const Position curPos = pos;
     if (ast.file == nullptr) {
         return;
     }
-    curFilePath = ast.file->filePath;
+    const std::string &curFilePath = ast.file->filePath;
     // adjust position from IDE to AST
     pos = PosFromIDE2Char(pos);
     PositionIDEToUTF8(ast.tokens, pos, *ast.file);
@@ -125,14 +121,14 @@ void TypeHierarchyImpl::FindTypeHierarchyImpl(const ark::ArkAST &ast, TypeHierar
     if (decl->TestAttr(Cangjie::AST::Attribute::PRIMARY_CONSTRUCTOR) ||
         decl->TestAttr(Cangjie::AST::Attribute::CONSTRUCTOR)) {
         Ptr<const Decl> realDecl = decl->outerDecl;
-        result = TypeHierarchyFrom(realDecl);
+        result = TypeHierarchyFrom(realDecl, curFilePath, curPos);
         result.isChildOrSuper = false;
         return;
     }
     if (!IsInheritableDecl(*decl)) {
         return;
     }
-    result = TypeHierarchyFrom(decl);
+    result = TypeHierarchyFrom(decl, curFilePath, curPos);
     result.isChildOrSuper = false;
     result.symbolId = GetSymbolId(*decl);
 }
@@ -21,12 +21,10 @@
 namespace ark {
 class TypeHierarchyImpl {
 public:
-    static std::string curFilePath;
-    static Position curPos;
-
     static void FindTypeHierarchyImpl(const ArkAST &ast, TypeHierarchyItem &result, Cangjie::Position pos);
 
-    static TypeHierarchyItem TypeHierarchyFrom(Ptr<const Decl> decl);
+    static TypeHierarchyItem TypeHierarchyFrom(Ptr<const Decl> decl, const std::string &curFilePath,
+                                               const Position &curPos);
 
     static void FindSuperTypesImpl(std::vector<TypeHierarchyItem> &results, const TypeHierarchyItem &hierarchyItem);
 
@@ -4,6 +4,7 @@
 //
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
+#include <algorithm>
 #include <iostream>
 #include "../logger/Logger.h"
 #include "BasicHelper.h"
@@ -167,4 +168,26 @@ int32_t GetOffsetFromPosition(const std::string &codeText, const Position pos)
 
     return static_cast<int32_t>(offsetAtCurLine + byteInCurLine);
 }
+
+std::vector<size_t> GetLineOffsets(const std::string &codeText)
+{
+    std::vector<size_t> lineOffsets{0};
+    for (size_t next = codeText.find('\n'); next != std::string::npos; next = codeText.find('\n', next + 1)) {
+        lineOffsets.push_back(next + 1);
+    }
+    return lineOffsets;
+}
+
+Position GetPositionFromOffset(const std::string &codeText, const std::vector<size_t> &lineOffsets, size_t offset)
+{
+    offset = std::min(offset, codeText.size());
+    // the last line starting at or before offset
+    auto line = std::upper_bound(lineOffsets.begin(), lineOffsets.end(), offset) - 1;
+    Position pos = {0, static_cast<int>(line - lineOffsets.begin()), 0};
+    (void)IterCodePointsOfUTF8(codeText.substr(*line, offset - *line), [&pos](int, int units) {
+        pos.column += units;
+        return false;
+    });
+    return pos;
+}
 } // namespace ark
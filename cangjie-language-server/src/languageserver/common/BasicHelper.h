@@ -16,6 +16,7 @@
 
 #include <functional>
 #include <cstdint>
+#include <vector>
 #include "../../json-rpc/Protocol.h"
 #include "cangjie/Basic/Position.h"
 
@@ -24,6 +25,13 @@ template<typename T>
 using Callback = std::function<void(T)>;
 
 std::int32_t GetOffsetFromPosition(const std::string &, Cangjie::Position);
+
+// Offsets the lines of codeText start at, for GetPositionFromOffset.
+std::vector<size_t> GetLineOffsets(const std::string &codeText);
+
+// The inverse of GetOffsetFromPosition, offset has to start a UTF-8 sequence and is clamped to the text.
+Cangjie::Position GetPositionFromOffset(const std::string &codeText, const std::vector<size_t> &lineOffsets,
+                                        size_t offset);
 } // namespace ark
 
 #endif // LSPSERVER_BASICHELPER_H
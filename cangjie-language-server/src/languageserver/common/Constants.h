@@ -53,6 +53,12 @@ namespace CONSTANTS {
     const unsigned int AD_OFFSET = 2;
     constexpr size_t MAC_THREAD_STACK_SIZE = 1024 * 1024 * 8;
     const unsigned int SORT_TEXT_SIZE = 6;
+    // completion replies carry at most this many items, the rest is reported through isIncomplete
+    const size_t MAX_COMPLETION_ITEMS = 300;
+    // accepted completion items of the workspace, stored under the .cache directory
+    const std::string COMPLETION_USAGE_FILE = "completion_usage.json";
+    // C functions of the workspace found for foreign funcs, stored under the .cache directory
+    const std::string C_FUNCTION_INDEX_FILE = "c_functions.json";
     const float ROUND_NUM = 0.5;
 } // namespace CONSTANTS
 
@@ -167,195 +167,13 @@ void InheritDeclUtil::HandleFuncDecl(bool isDocumentHighlight)
 
 void InheritDeclUtil::DealTopClass(std::vector<Ptr<InheritableDecl> > &topClasses)
 {
+    // Only the hierarchy reachable from the loaded ASTs is walked here. Overriding members of other packages are
+    // resolved by references and rename from the override graph of the index, see MemIndex::FindOverrideFamily,
+    // so no package has to be compiled just to find its subclasses.
     for (auto item: topClasses) {
         // realDecl has more info about subDecl
         auto realDecl = CompilerCangjieProject::GetInstance()->GetDeclInPkgByNode(item, editPkgPath);
-        if (!realDecl) { continue; }
-        // pre deal in topClass
         HandleRelatedFuncDeclsFromTopLevel(realDecl);
-        // deal upDown subClass
-        auto sortResult = CompilerCangjieProject::GetInstance()->GetIncTopologySort(realDecl->fullPackageName);
-        for (auto &sortPkgName: sortResult) {
-            pkgName = sortPkgName;
-            auto users = GetAimSubDecl(sortPkgName, superDecls, editPkgPath);
-            for (auto &user: users) {
-                HandleRelatedFuncDeclsFromTopLevel(user);
-            }
-            if (!isRename) {
-                GetRefInfoFromFuncDecl();
-            } else {
-                GetReNameInfoFromFuncDecl();
-            }
-            auto tempSuperDecls = superDecls;
-            for (auto &superDecl: tempSuperDecls) {
-                if (!superDecl.second) { (void) superDecls.erase(superDecl.first); }
-            }
-        }
-    }
-}
-
-void InheritDeclUtil::GetRefInfoFromFuncDecl()
-{
-    for (auto &decl: funcDecls) {
-        // add def to result
-        if (IsFromSrcOrNoSrc(decl) && !IsZeroPosition(decl)) {
-            // primary constructor has COMPILER_ADD attribute
-            if (decl->TestAttr(Cangjie::AST::Attribute::PRIMARY_CONSTRUCTOR)) {
-                auto name = decl->outerDecl ? decl->outerDecl->identifier : decl->identifierForLsp;
-                auto length = static_cast<int>(CountUnicodeCharacters(name));
-                addDeclToRef(decl, length);
-                // push the decl only if it's not add by the compiler
-            } else if ((!decl->TestAttr(Cangjie::AST::Attribute::COMPILER_ADD) ||
-                        decl->TestAttr(Cangjie::AST::Attribute::IS_CLONED_SOURCE_CODE) ||
-                        decl->TestAttr(Cangjie::AST::Attribute::MACRO_FUNC))) {
-                auto length = static_cast<int>(CountUnicodeCharacters(decl->identifier));
-                addDeclToRef(decl, length);
-            }
-        }
-        auto declPkgName = GetPkgNameFromNode(decl);
-        // not in CiMAP and CIMapNotInSrc
-        if (!IsFromCIMap(declPkgName) && !IsFromCIMapNotInSrc(declPkgName)) {
-            auto ciMapList = CompilerCangjieProject::GetInstance()->GetCiMapList();
-            // search users in CiMaP
-            for (auto &item : ciMapList) {
-                auto users = GetOnePkgUsers(*decl, item, editPkgPath);
-                InsertRefUsers(users);
-            }
-            // search users in CIMapNotInSrc
-            auto ciMapNotInSrcList = CompilerCangjieProject::GetInstance()->GetCIMapNotInSrcList();
-            // search in CiMap
-            for (auto &item: ciMapNotInSrcList) {
-                auto users = GetOnePkgUsers(*decl, item, editPkgPath);
-                InsertRefUsers(users);
-            }
-            continue;
-        }
-
-        // in CiMaP or NotInCiMap
-        auto sortResult = CompilerCangjieProject::GetInstance()->GetIncTopologySort(declPkgName);
-        for (const auto& item: sortResult) {
-            if (!decl->curFile) { continue; }
-            auto users = GetOnePkgUsers(*decl, item, decl->curFile->filePath, false, editPkgPath);
-            InsertRefUsers(users);
-        }
-    }
-    funcDecls = {};
-}
-
-void InheritDeclUtil::InsertRefUsers(std::unordered_set<Ptr<Cangjie::AST::Node> > &users)
-{
-    for (auto &user: users) {
-        bool isInvalid = !user || !IsFromSrcOrNoSrc(user) || IsZeroPosition(user) ||
-                         user->TestAttr(Attribute::COMPILER_ADD) &&
-                         !user->TestAttr(Attribute::IS_CLONED_SOURCE_CODE);
-        if (isInvalid) {
-            continue;
-        }
-        const auto fileID = user->begin.fileID;
-        std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(*user, fileID);
-        if (path.empty()) { continue; }
-        ArkAST *arkAst = CompilerCangjieProject::GetInstance()->GetArkAST(path);
-        const auto currentFileID = user->GetBegin().fileID;
-        std::string currentFilePath =
-                CompilerCangjieProject::GetInstance()->GetFilePathByID(*user, currentFileID);
-        Range range;
-        if (arkAst != nullptr) {
-            range = GetRangeFromNode(user, arkAst->tokens);
-        }
-        Location location = {{URI::URIFromAbsolutePath(currentFilePath).ToString()},
-                             TransformFromChar2IDE(range)};
-        (void) References.insert(location);
-    }
-}
-
-void InheritDeclUtil::GetReNameInfoFromFuncDecl()
-{
-    for (auto &decl: funcDecls) {
-        // get definition
-        if (decl->identifier != "init" && !IsZeroPosition(decl)) {
-            unsigned int fileID = decl->identifier.Begin().fileID;
-            int length = static_cast<int>(CountUnicodeCharacters(decl->identifier));
-            // for primary constructor
-            if (decl->TestAttr(Cangjie::AST::Attribute::PRIMARY_CONSTRUCTOR)) {
-                auto name = decl->outerDecl ? decl->outerDecl->identifier : decl->identifierForLsp;
-                length = static_cast<int>(CountUnicodeCharacters(name));
-            }
-            Range range = GetDeclRange(*decl, length);
-            std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(decl->curFile->filePath, fileID);
-            ArkAST *arkAst = CompilerCangjieProject::GetInstance()->GetArkAST(path);
-            if (arkAst) {
-                UpdateRange(arkAst->tokens, range, *decl);
-            }
-            TextEdit declEdit = {TransformFromChar2IDE(range), newName};
-            auto result = defineEditMap.find(path);
-            if (result == defineEditMap.end()) {
-                defineEditMap[path] = std::set<TextEdit>{declEdit};
-            } else {
-                (void) result->second.insert(declEdit);
-            }
-        }
-        // the fileID of defineEdit
-        if (!decl->curFile) { continue; }
-        auto definedPath = CompilerCangjieProject::GetInstance()->GetFilePathByID(
-            decl->curFile->filePath, decl->identifier.Begin().fileID);
-        // sort TextEdit by fileID
-        auto DeclPkgName = GetPkgNameFromNode(decl);
-        auto sortResult = CompilerCangjieProject::GetInstance()->GetIncTopologySort(DeclPkgName);
-        for (const auto& item: sortResult) {
-            if (!decl->curFile || decl->curFile->filePath.empty()) { continue; }
-            auto users = GetOnePkgUsers(*decl, item, decl->curFile->filePath, true, editPkgPath);
-            InsertRenameUsers(definedPath, users);
-        }
-    }
-    funcDecls = {};
-}
-
-void InheritDeclUtil::InsertRenameUsers(const std::string &definedPath,
-                                        std::unordered_set<Ptr<Cangjie::AST::Node> > &users)
-{
-    for (auto user: users) {
-        if (!user || IsZeroPosition(user)) { continue; }
-        if (user->TestAttr(Attribute::COMPILER_ADD) &&
-            !user->TestAttr(Attribute::IS_CLONED_SOURCE_CODE)) {
-            continue;
-        }
-        const auto fileID = user->begin.fileID;
-        bool isInvalid = Cangjie::Is<RefExpr>(user) &&
-                (dynamic_cast<RefExpr*>(user.get())->isThis || dynamic_cast<RefExpr*>(user.get())->isSuper);
-        if (isInvalid) {
-            continue;
-        }
-        std::string path = CompilerCangjieProject::GetInstance()->GetFilePathByID(*user, fileID);
-        if (path.empty()) { continue; }
-        ArkAST *arkAst = CompilerCangjieProject::GetInstance()->GetArkAST(path);
-        if (!arkAst) { continue; }
-        if (definedPath == path) {
-            TextEdit textEdit{};
-            textEdit.range = TransformFromChar2IDE(GetRangeFromNode(user, arkAst->tokens));
-            textEdit.newText = newName;
-            (void) defineEditMap[path].insert(textEdit);
-            continue;
-        }
-        TextEdit textEdit{};
-        textEdit.range = TransformFromChar2IDE(GetRangeFromNode(user, arkAst->tokens));
-        textEdit.newText = newName;
-        (void) usersEditMap[path].insert(textEdit);
-    }
-}
-
-void InheritDeclUtil::addDeclToRef(Ptr<Decl> const &decl, int length)
-{
-    if (!decl->curFile || decl->curFile->filePath.empty()) { return; }
-    Range range = GetDeclRange(*decl, length);
-    auto fileID = range.start.fileID;
-    auto instance = CompilerCangjieProject::GetInstance();
-    std::string path = instance->GetFilePathByID(decl->curFile->filePath, fileID);
-    if (path.empty()) { return; }
-    ArkAST *arkAst = instance->GetArkAST(path);
-    if (arkAst) {
-        UpdateRange(arkAst->tokens, range, *decl);
     }
-    Location location = {{URI::URIFromAbsolutePath(path).ToString()}, TransformFromChar2IDE(range)};
-    (void) References.insert(location);
 }
 } // namespace ark
@@ -35,24 +35,9 @@ private:
     Ptr<const Cangjie::AST::FuncDecl> defaultFuncDecl{nullptr};
     Ptr<const Cangjie::AST::PropDecl> defaultPropDecl{nullptr};
     std::set<Ptr<Cangjie::AST::Decl> > funcDecls{};
-    bool isRename = false;
     std::string pkgName = "";
-    std::string newName = "";
     std::string editPkgPath = "";
     std::map<std::string, bool> superDecls = {};
-    std::set<Location> References{};
-    std::unordered_map<std::string, std::set<TextEdit>> defineEditMap{};
-    std::unordered_map<std::string, std::set<TextEdit>> usersEditMap{};
-
-    void GetRefInfoFromFuncDecl();
-
-    void GetReNameInfoFromFuncDecl();
-
-    void addDeclToRef(Ptr<Cangjie::AST::Decl> const &decl, int length);
-
-    void InsertRefUsers(std::unordered_set<Ptr<Cangjie::AST::Node> > &users);
-
-    void InsertRenameUsers(const std::string &definedPath, std::unordered_set<Ptr<Cangjie::AST::Node> > &users);
 
     void DealTopClass(std::vector<Ptr<Cangjie::AST::InheritableDecl> > &topClasses);
 };
@@ -473,101 +473,6 @@ void SetHeadByFilePath(const std::string &filePath)
     }
 }
 
-std::unordered_set<Ptr<Node>> GetOnePkgUsers(const Cangjie::AST::Decl &decl,
-                                             const std::string &curPkg,
-                                             const std::string &curFilePath,
-                                             bool isRename,
-                                             const std::string &editPkg)
-{
-    std::unordered_set<Ptr<Node>> users;
-    if (curPkg.empty()) {
-        return users;
-    }
-    auto instance = CompilerCangjieProject::GetInstance();
-    if (!instance->PkgHasSemaCache(curPkg)) {
-        if (IsFromCIMap(curPkg)) {
-            instance->IncrementTempPkgCompile(curPkg);
-        } else {
-            instance->IncrementTempPkgCompileNotInSrc(curPkg);
-        }
-    }
-    auto package = instance->GetSourcePackagesByPkg(curPkg);
-    if (!package) {
-        return users;
-    }
-    auto temp = FindDeclUsage(decl, *package, isRename);
-    users.insert(temp.begin(), temp.end());
-
-    // setHead for editPkg and declPkg
-    SetHeadByFilePath(curFilePath);
-    SetHeadByFilePath(editPkg);
-    return users;
-}
-
-void AddTopDecl(const std::string &curPkg,
-                std::map<std::string, bool> &superDecl,
-                std::vector<Ptr<Decl>> &users,
-                const OwnedPtr<Decl> &memDecl,
-                Ptr<InheritableDecl> inheritableDecl)
-{
-    for (auto &in : inheritableDecl->inheritedTypes) {
-        if (!in->ty || in->ty->name.empty()) {
-            continue;
-        }
-        if (superDecl.find(in->ty->name) != superDecl.end()) {
-            users.push_back(memDecl.get());
-            return;
-        }
-    }
-    auto extendDecls = CompilerCangjieProject::GetInstance()->GetExtendDecls(inheritableDecl, curPkg);
-    for (auto extendDecl : extendDecls) {
-        for (auto &in : extendDecl->inheritedTypes) {
-            if (!in->ty || in->ty->name.empty()) {
-                continue;
-            }
-            if (superDecl.find(in->ty->name) != superDecl.end()) {
-                users.push_back(memDecl.get());
-                return;
-            }
-        }
-    }
-}
-
-std::vector<Ptr<Decl>> GetAimSubDecl(const std::string &curPkg,
-                                     std::map<std::string, bool> superDecl,
-                                     const std::string &editPkg)
-{
-    std::vector<Ptr<Decl>> users{};
-    if (curPkg.empty() || !IsFromCIMap(curPkg) && !IsFromCIMapNotInSrc(curPkg)) {
-        return users;
-    }
-    auto instance = CompilerCangjieProject::GetInstance();
-    if (!instance->PkgHasSemaCache(curPkg)) {
-        if (IsFromCIMap(curPkg)) {
-            instance->IncrementTempPkgCompile(curPkg);
-        } else {
-            instance->IncrementTempPkgCompileNotInSrc(curPkg);
-        }
-        SetHeadByFilePath(editPkg);
-    }
-
-    auto package = instance->GetSourcePackagesByPkg(curPkg);
-    if (!package) {
-        return users;
-    }
-    // found Inherited subclass
-    for (auto &topDecl : package->files) {
-        for (auto &memDecl : topDecl->decls) {
-            auto inheritableDecl = dynamic_cast<InheritableDecl *>(memDecl.get().get());
-            if (!inheritableDecl) {
-                continue;
-            }
-            AddTopDecl(curPkg, superDecl, users, memDecl, inheritableDecl);
-        }
-    }
-    return users;
-}
-
 int GetDotIndexPos(const std::vector<Cangjie::Token> &tokens, const int end, const int start)
 {
     if (end <= start || end < 1 || static_cast<unsigned long>(end) > tokens.size() || start < 0 ||
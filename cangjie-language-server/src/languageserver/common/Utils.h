@@ -169,15 +169,8 @@ bool InValidDecl(Ptr<const Cangjie::AST::Decl> decl);
 
 std::string GetPkgNameFromNode(Ptr<const Cangjie::AST::Node> node);
 
-std::unordered_set<Ptr<Cangjie::AST::Node>> GetOnePkgUsers(
-    const Cangjie::AST::Decl &decl, const std::string &curPkg, const std::string &curFilePath = "",
-    bool isRename = false, const std::string &editPkg = "");
-
 void SetHeadByFilePath(const std::string& filePath);
 
-std::vector<Ptr<Cangjie::AST::Decl>> GetAimSubDecl(
-    const std::string &curPkg, std::map<std::string, bool> superDecl, const std::string &editPkg = "");
-
 int GetDotIndexPos(const std::vector<Cangjie::Token> &tokens, const int end, const int start);
 
 void ConvertCarriageToSpace(std::string &str);
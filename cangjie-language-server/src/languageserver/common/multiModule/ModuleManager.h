@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 #include "cangjie/AST/Node.h"
 #include "nlohmann/json.hpp"
 #include "MultiModuleCommon.h"
@@ -27,14 +28,16 @@ public:
 
     void WorkspaceModeParser(const std::string &workspace = "");
 
-    std::unordered_set<std::string> GetAllRequiresOneModule(
-        const std::string &require, std::unordered_map<std::string, bool> &isVisited);
-
     void SetPackageRequires(const nlohmann::json &jsonData, const std::string &modulePath);
 
-
+    // Compute the requires closure of every module, must be called again whenever the modules change.
     void SetRequireAllPackages();
 
+    // Whether curModule requires module, directly or through other modules. A module requires itself.
+    bool IsModuleRequired(const std::string &curModule, const std::string &module) const;
+
+    bool IsModuleDirectlyRequired(const std::string &curModule, const std::string &module) const;
+
     std::string GetExpectedPkgName(const Cangjie::AST::File &file);
 
     std::string projectRootPath;
@@ -47,6 +50,20 @@ public:
     std::unordered_map<std::string, std::unordered_set<std::string>> requireAllPackages;
     // key: moduleName, value: modulePaths with same moduleName
     std::unordered_map<std::string, std::vector<std::string>> duplicateModules;
+
+private:
+    uint32_t InternModule(const std::string &moduleName);
+
+    bool TestRequire(const std::vector<std::vector<bool>> &requireSets, const std::string &curModule,
+        const std::string &module) const;
+
+    // module names interned to ids, requires are bitsets indexed by these ids
+    std::unordered_map<std::string, uint32_t> moduleIds;
+    std::vector<std::string> moduleNames;
+    std::vector<std::vector<bool>> directRequires;
+    std::vector<std::vector<bool>> requireClosure;
+    // key: source path of a module, value: moduleName
+    std::unordered_map<std::string, std::string> srcPathModules;
 };
 } // namespace ark
 
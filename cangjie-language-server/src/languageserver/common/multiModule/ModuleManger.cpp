@@ -105,48 +105,100 @@ void ModuleManager::SetPackageRequires(const nlohmann::json &jsonData, const std
     }
 }
 
-std::unordered_set<std::string> ModuleManager::GetAllRequiresOneModule(
-    const std::string &require,
-    std::unordered_map<std::string, bool> &isVisited)
+uint32_t ModuleManager::InternModule(const std::string &moduleName)
 {
-    std::unordered_set<std::string> res;
-    if (isVisited[require]) {
-        return res;
+    auto [it, inserted] = moduleIds.emplace(moduleName, static_cast<uint32_t>(moduleNames.size()));
+    if (inserted) {
+        moduleNames.push_back(moduleName);
     }
-    isVisited[require] = true;
-    auto deps = requirePackages[require];
+    return it->second;
+}
 
-    if (deps.empty()) {
-        return res;
+void ModuleManager::SetRequireAllPackages()
+{
+    moduleIds.clear();
+    moduleNames.clear();
+    for (const auto &[name, required] : requirePackages) {
+        (void)InternModule(name);
+        for (const auto &require : required) {
+            (void)InternModule(require);
+        }
     }
-    for (const auto &dependent : requirePackages[require]) {
-        auto temp = GetAllRequiresOneModule(dependent, isVisited);
-        res.insert(temp.begin(), temp.end());
+    size_t count = moduleNames.size();
+    directRequires.assign(count, std::vector<bool>(count, false));
+    for (const auto &[name, required] : requirePackages) {
+        auto &row = directRequires[moduleIds[name]];
+        for (const auto &require : required) {
+            row[moduleIds[require]] = true;
+        }
+    }
+    // the closure of a module holds the requires of every module reachable from it
+    requireClosure.assign(count, std::vector<bool>(count, false));
+    requireAllPackages.clear();
+    for (uint32_t id = 0; id < count; ++id) {
+        auto &closure = requireClosure[id];
+        std::vector<bool> visited(count, false);
+        std::vector<uint32_t> worklist{id};
+        visited[id] = true;
+        while (!worklist.empty()) {
+            auto cur = worklist.back();
+            worklist.pop_back();
+            for (uint32_t next = 0; next < count; ++next) {
+                if (!directRequires[cur][next]) {
+                    continue;
+                }
+                closure[next] = true;
+                if (!visited[next]) {
+                    visited[next] = true;
+                    worklist.push_back(next);
+                }
+            }
+        }
+        if (requirePackages.count(moduleNames[id]) == 0) {
+            continue;
+        }
+        auto &names = requireAllPackages[moduleNames[id]];
+        for (uint32_t other = 0; other < count; ++other) {
+            if (closure[other]) {
+                (void)names.insert(moduleNames[other]);
+            }
+        }
+    }
+
+    srcPathModules.clear();
+    for (const auto &iter : moduleInfoMap) {
+        auto srcPath = CompilerCangjieProject::GetInstance()->GetModuleSrcPath(iter.second.modulePath);
+        (void)srcPathModules.emplace(srcPath, iter.second.moduleName);
     }
-    res.insert(deps.begin(), deps.end());
-    return res;
 }
 
-void ModuleManager::SetRequireAllPackages()
+bool ModuleManager::TestRequire(const std::vector<std::vector<bool>> &requireSets, const std::string &curModule,
+    const std::string &module) const
 {
-    for (const auto &require : requirePackages) {
-        std::unordered_map<std::string, bool> isVisited;
-        auto item = GetAllRequiresOneModule(require.first, isVisited);
-        (void)requireAllPackages.emplace(require.first, item);
+    auto cur = moduleIds.find(curModule);
+    auto target = moduleIds.find(module);
+    if (cur == moduleIds.end() || target == moduleIds.end()) {
+        return false;
     }
+    return requireSets[cur->second][target->second];
+}
+
+bool ModuleManager::IsModuleRequired(const std::string &curModule, const std::string &module) const
+{
+    return TestRequire(requireClosure, curModule, module);
+}
+
+bool ModuleManager::IsModuleDirectlyRequired(const std::string &curModule, const std::string &module) const
+{
+    return TestRequire(directRequires, curModule, module);
 }
 
 std::string ModuleManager::GetExpectedPkgName(const Cangjie::AST::File &file)
 {
-    for (const auto &iter : moduleInfoMap) {
-        auto curModulePath = CompilerCangjieProject::GetInstance()->GetModuleSrcPath(iter.second.modulePath);
-        if (!IsUnderPath(curModulePath, file.filePath)) {
-            continue;
-        }
-        auto parentDirPath = ::GetParentPath(file.filePath);
-        if (curModulePath == parentDirPath) {
-            return iter.second.moduleName;
-        }
+    // a file directly in the source path of a module belongs to its root package
+    auto found = srcPathModules.find(::GetParentPath(file.filePath));
+    if (found != srcPathModules.end()) {
+        return found->second;
     }
     std::string path = Normalize(file.filePath);
     return CompilerCangjieProject::GetInstance()->GetFullPkgName(path);
@@ -0,0 +1,502 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "CFunctionIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unordered_set>
+#include "../logger/Logger.h"
+#include "cangjie/Utils/FileUtil.h"
+
+namespace ark {
+namespace lsp {
+namespace {
+const std::vector<std::string> C_FILE_EXTENSIONS = {"c", "h"};
+// cache files of another version are dropped, version 1 had columns in bytes
+const int CACHE_VERSION = 2;
+const std::string CACHE_VERSION_KEY = "version";
+
+// Words that are followed by '(' at file scope without naming a function.
+const std::unordered_set<std::string> NOT_FUNCTION_NAMES = {
+    "if", "while", "for", "switch", "return", "sizeof", "alignof", "_Alignof", "defined", "typeof", "__typeof__",
+    "__attribute__", "__declspec", "__asm__", "asm", "_Static_assert", "static_assert", "void", "char", "short",
+    "int", "long", "float", "double", "signed", "unsigned", "bool", "_Bool", "const", "volatile", "struct",
+    "union", "enum"};
+
+// Words that end a type, the word after them in a parameter is its name.
+const std::unordered_set<std::string> TYPE_WORDS = {
+    "void", "char", "short", "int", "long", "float", "double", "signed", "unsigned", "bool", "_Bool", "const",
+    "volatile", "restrict", "struct", "union", "enum"};
+
+enum class CTokenKind { WORD, STRING, PUNCT, OTHER };
+
+struct CToken {
+    CTokenKind kind;
+    std::string text;
+    int line;
+    int column;
+};
+
+bool IsWordChar(char ch)
+{
+    return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+}
+
+// Tokens of a C file outside comments and preprocessor lines.
+std::vector<CToken> Tokenize(const std::string &contents)
+{
+    std::vector<CToken> tokens;
+    size_t i = 0;
+    int line = 0;
+    int column = 0;
+    bool lineStart = true;
+    auto advance = [&contents, &i, &line, &column]() {
+        auto byte = static_cast<unsigned char>(contents[i]);
+        if (byte == '\n') {
+            ++line;
+            column = 0;
+        } else if ((byte & 0xC0) != 0x80) {
+            // columns count UTF-16 code units, a sequence of four bytes is a surrogate pair
+            column += (byte & 0xF8) == 0xF0 ? 2 : 1;
+        }
+        ++i;
+    };
+    while (i < contents.size()) {
+        char ch = contents[i];
+        if (ch == '\n') {
+            lineStart = true;
+            advance();
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(ch))) {
+            advance();
+            continue;
+        }
+        if (lineStart && ch == '#') {
+            // a directive ends at a newline that is not escaped
+            while (i < contents.size() && !(contents[i] == '\n' && (i == 0 || contents[i - 1] != '\\'))) {
+                advance();
+            }
+            continue;
+        }
+        lineStart = false;
+        if (contents.compare(i, 2, "//") == 0) {
+            while (i < contents.size() && contents[i] != '\n') {
+                advance();
+            }
+            continue;
+        }
+        if (contents.compare(i, 2, "/*") == 0) {
+            advance();
+            advance();
+            while (i < contents.size() && contents.compare(i, 2, "*/") != 0) {
+                advance();
+            }
+            if (i < contents.size()) {
+                advance();
+                advance();
+            }
+            continue;
+        }
+        CToken token{CTokenKind::OTHER, "", line, column};
+        if (ch == '"' || ch == '\'') {
+            token.kind = CTokenKind::STRING;
+            advance();
+            while (i < contents.size() && contents[i] != ch && contents[i] != '\n') {
+                if (contents[i] == '\\' && i + 1 < contents.size()) {
+                    token.text.push_back(contents[i]);
+                    advance();
+                }
+                token.text.push_back(contents[i]);
+                advance();
+            }
+            if (i < contents.size()) {
+                advance();
+            }
+        } else if (IsWordChar(ch)) {
+            token.kind = std::isdigit(static_cast<unsigned char>(ch)) ? CTokenKind::OTHER : CTokenKind::WORD;
+            while (i < contents.size() && IsWordChar(contents[i])) {
+                token.text.push_back(contents[i]);
+                advance();
+            }
+        } else {
+            token.kind = CTokenKind::PUNCT;
+            size_t length = contents.compare(i, 3, "...") == 0 ? 3 : 1;
+            token.text = contents.substr(i, length);
+            for (size_t k = 0; k < length; ++k) {
+                advance();
+            }
+        }
+        tokens.emplace_back(std::move(token));
+    }
+    return tokens;
+}
+
+size_t MatchingParen(const std::vector<CToken> &tokens, size_t open)
+{
+    int depth = 0;
+    for (size_t i = open; i < tokens.size(); ++i) {
+        if (tokens[i].text == "(") {
+            ++depth;
+        } else if (tokens[i].text == ")" && --depth == 0) {
+            return i;
+        }
+    }
+    return tokens.size();
+}
+
+// Type of one parameter, tokens in [begin, end) without the parameter name.
+std::string ParamType(const std::vector<CToken> &tokens, size_t begin, size_t end)
+{
+    std::vector<std::string> words;
+    size_t arrays = 0;
+    // an array parameter is a pointer
+    while (end > begin && tokens[end - 1].text == "]") {
+        while (end > begin && tokens[end - 1].text != "[") {
+            --end;
+        }
+        if (end > begin) {
+            --end;
+        }
+        ++arrays;
+    }
+    for (size_t i = begin; i < end; ++i) {
+        words.emplace_back(tokens[i].text);
+    }
+    bool hasName = words.size() > 1 && tokens[end - 1].kind == CTokenKind::WORD &&
+        TYPE_WORDS.count(words.back()) == 0 && words[words.size() - 2] != "struct" &&
+        words[words.size() - 2] != "union" && words[words.size() - 2] != "enum";
+    if (hasName) {
+        words.pop_back();
+    }
+    std::string type;
+    for (const auto &word : words) {
+        type += type.empty() ? word : " " + word;
+    }
+    type += std::string(arrays, '*');
+    return CFunctionIndex::NormalizeType(type);
+}
+
+std::vector<std::string> ParamTypes(const std::vector<CToken> &tokens, size_t open, size_t close)
+{
+    std::vector<std::string> types;
+    int depth = 0;
+    size_t begin = open + 1;
+    for (size_t i = open + 1; i <= close; ++i) {
+        const auto &text = tokens[i].text;
+        if (text == "(" || text == "[") {
+            ++depth;
+        } else if ((text == ")" || text == "]") && i != close) {
+            --depth;
+        } else if ((text == "," && depth == 0) || i == close) {
+            if (i > begin) {
+                types.emplace_back(ParamType(tokens, begin, i));
+            }
+            begin = i + 1;
+        }
+    }
+    if (types.size() == 1 && types[0] == "void") {
+        types.clear();
+    }
+    return types;
+}
+} // namespace
+
+CFunctionIndex::CFunctionIndex(const std::string &root, const std::string &cacheFile)
+    : root(root), cacheFile(cacheFile)
+{
+    Load();
+}
+
+std::string CFunctionIndex::NormalizeType(const std::string &type)
+{
+    std::string result;
+    bool space = false;
+    for (char ch : type) {
+        if (std::isspace(static_cast<unsigned char>(ch))) {
+            space = true;
+            continue;
+        }
+        if (space && !result.empty() && IsWordChar(ch) && IsWordChar(result.back())) {
+            result.push_back(' ');
+        }
+        space = false;
+        result.push_back(ch);
+    }
+    return result;
+}
+
+std::vector<CFunction> CFunctionIndex::Scan(const std::string &filePath, const std::string &contents)
+{
+    std::vector<CFunction> functions;
+    auto tokens = Tokenize(contents);
+    // true for the braces of extern "C" { }, which do not open a scope
+    std::vector<bool> linkageBlocks;
+    size_t depth = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const auto &token = tokens[i];
+        if (token.text == "{") {
+            bool linkage = i >= 2 && tokens[i - 1].kind == CTokenKind::STRING && tokens[i - 2].text == "extern";
+            linkageBlocks.push_back(linkage);
+            depth += linkage ? 0 : 1;
+            continue;
+        }
+        if (token.text == "}") {
+            if (!linkageBlocks.empty()) {
+                if (!linkageBlocks.back() && depth > 0) {
+                    --depth;
+                }
+                linkageBlocks.pop_back();
+            }
+            continue;
+        }
+        // a function name follows its return type and is followed by its parameters
+        bool candidate = depth == 0 && token.kind == CTokenKind::WORD && i > 0 && i + 1 < tokens.size() &&
+            tokens[i + 1].text == "(" && NOT_FUNCTION_NAMES.count(token.text) == 0 &&
+            (tokens[i - 1].kind == CTokenKind::WORD || tokens[i - 1].text == "*");
+        if (!candidate) {
+            continue;
+        }
+        size_t close = MatchingParen(tokens, i + 1);
+        if (close >= tokens.size()) {
+            break;
+        }
+        size_t next = close + 1;
+        // skip attributes between the parameters and the body or the semicolon
+        while (next + 1 < tokens.size() && tokens[next].kind == CTokenKind::WORD && tokens[next + 1].text == "(") {
+            next = MatchingParen(tokens, next + 1) + 1;
+        }
+        if (next >= tokens.size() || (tokens[next].text != "{" && tokens[next].text != ";")) {
+            continue;
+        }
+        CFunction function;
+        function.name = token.text;
+        function.paramTypes = ParamTypes(tokens, i + 1, close);
+        function.isDefinition = tokens[next].text == "{";
+        function.filePath = filePath;
+        function.line = token.line;
+        function.column = token.column;
+        functions.emplace_back(std::move(function));
+        i = next - 1;
+    }
+    return functions;
+}
+
+std::vector<CFunction> CFunctionIndex::Find(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<CFunction> result;
+    auto found = byName.find(name);
+    if (found == byName.end()) {
+        return result;
+    }
+    for (const auto &[path, index] : found->second) {
+        result.emplace_back(files.at(path).functions[index]);
+    }
+    return result;
+}
+
+bool CFunctionIndex::IsCFile(const std::string &filePath)
+{
+    return std::any_of(C_FILE_EXTENSIONS.begin(), C_FILE_EXTENSIONS.end(),
+        [&filePath](const std::string &extension) { return Cangjie::FileUtil::HasExtension(filePath, extension); });
+}
+
+CFunctionIndex::ScannedFile CFunctionIndex::ScanFile(const std::string &path, int64_t mtime)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return {mtime, Scan(path, contents.str())};
+}
+
+void CFunctionIndex::Refresh()
+{
+    if (root.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> refreshLock(refreshMtx);
+    std::unordered_map<std::string, int64_t> known;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto &[path, scanned] : files) {
+            (void)known.emplace(path, scanned.mtime);
+        }
+    }
+    std::vector<std::string> dirs = {root};
+    for (auto &dir : Cangjie::FileUtil::GetAllDirsUnderCurrentPath(root)) {
+        // hidden directories hold caches and version control data
+        if (dir.find("/.") == std::string::npos && dir.find("\\.") == std::string::npos) {
+            dirs.emplace_back(dir);
+        }
+    }
+    std::unordered_set<std::string> seen;
+    std::unordered_map<std::string, ScannedFile> rescanned;
+    for (const auto &dir : dirs) {
+        for (const auto &extension : C_FILE_EXTENSIONS) {
+            for (const auto &file : Cangjie::FileUtil::GetAllFilesUnderCurrentPath(dir, extension, false)) {
+                auto path = Cangjie::FileUtil::Normalize(Cangjie::FileUtil::JoinPath(dir, file));
+                if (!seen.emplace(path).second) {
+                    continue;
+                }
+                struct stat statBuf {};
+                if (stat(path.c_str(), &statBuf) != 0) {
+                    continue;
+                }
+                auto mtime = static_cast<int64_t>(statBuf.st_mtime);
+                auto found = known.find(path);
+                if (found != known.end() && found->second == mtime) {
+                    continue;
+                }
+                rescanned[path] = ScanFile(path, mtime);
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    bool changed = !rescanned.empty();
+    for (auto &[path, scanned] : rescanned) {
+        files[path] = std::move(scanned);
+    }
+    // files added by UpdateFile during the walk are kept
+    for (auto it = files.begin(); it != files.end();) {
+        if (seen.count(it->first) == 0 && known.count(it->first) != 0) {
+            it = files.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (!changed) {
+        return;
+    }
+    Reindex();
+    auto cache = ToCache();
+    auto cacheRevision = ++revision;
+    lock.unlock();
+    Save(cache, cacheRevision);
+}
+
+void CFunctionIndex::UpdateFile(const std::string &filePath, bool deleted)
+{
+    auto path = Cangjie::FileUtil::Normalize(filePath);
+    if (root.empty() || !IsCFile(path) || path.rfind(Cangjie::FileUtil::Normalize(root), 0) != 0) {
+        return;
+    }
+    struct stat statBuf {};
+    bool exists = !deleted && stat(path.c_str(), &statBuf) == 0;
+    ScannedFile scanned;
+    if (exists) {
+        scanned = ScanFile(path, static_cast<int64_t>(statBuf.st_mtime));
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    if (exists) {
+        files[path] = std::move(scanned);
+    } else if (files.erase(path) == 0) {
+        return;
+    }
+    Reindex();
+    auto cache = ToCache();
+    auto cacheRevision = ++revision;
+    lock.unlock();
+    Save(cache, cacheRevision);
+}
+
+void CFunctionIndex::Reindex()
+{
+    byName.clear();
+    for (const auto &[path, scanned] : files) {
+        for (size_t i = 0; i < scanned.functions.size(); ++i) {
+            byName[scanned.functions[i].name].emplace_back(path, i);
+        }
+    }
+}
+
+void CFunctionIndex::Load()
+{
+    if (cacheFile.empty()) {
+        return;
+    }
+    std::ifstream in(cacheFile);
+    if (!in.is_open()) {
+        return;
+    }
+    auto cache = nlohmann::json::parse(in, nullptr, false);
+    if (cache.is_discarded() || !cache.is_object()) {
+        Logger::Instance().LogMessage(MessageType::MSG_WARNING, "ignore broken C function index: " + cacheFile);
+        return;
+    }
+    if (cache.value(CACHE_VERSION_KEY, 0) != CACHE_VERSION) {
+        return;
+    }
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        const auto &record = it.value();
+        if (!record.is_object() || !record.value("functions", nlohmann::json()).is_array()) {
+            continue;
+        }
+        ScannedFile scanned;
+        scanned.mtime = record.value("mtime", int64_t{0});
+        for (const auto &function : record["functions"]) {
+            if (!function.is_object()) {
+                continue;
+            }
+            scanned.functions.push_back({function.value("name", ""),
+                function.value("params", std::vector<std::string>{}), function.value("definition", false),
+                it.key(), function.value("line", 0), function.value("column", 0)});
+        }
+        files[it.key()] = std::move(scanned);
+    }
+    // scans of files changed since they were saved are replaced by the first refresh
+    Reindex();
+}
+
+nlohmann::json CFunctionIndex::ToCache() const
+{
+    nlohmann::json cache = nlohmann::json::object();
+    if (cacheFile.empty()) {
+        return cache;
+    }
+    cache[CACHE_VERSION_KEY] = CACHE_VERSION;
+    for (const auto &[path, scanned] : files) {
+        nlohmann::json functions = nlohmann::json::array();
+        for (const auto &function : scanned.functions) {
+            functions.push_back({{"name", function.name}, {"params", function.paramTypes},
+                {"definition", function.isDefinition}, {"line", function.line}, {"column", function.column}});
+        }
+        cache[path] = {{"mtime", scanned.mtime}, {"functions", std::move(functions)}};
+    }
+    return cache;
+}
+
+void CFunctionIndex::Save(const nlohmann::json &cache, uint64_t cacheRevision)
+{
+    if (cacheFile.empty()) {
+        return;
+    }
+    // lookups go on while the file is written, writers are ordered so that the last revision stays
+    std::lock_guard<std::mutex> lock(saveMtx);
+    if (cacheRevision < savedRevision) {
+        return;
+    }
+    savedRevision = cacheRevision;
+    std::string tmpPath = cacheFile + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) {
+            return;
+        }
+        out << cache.dump();
+        if (out.fail()) {
+            return;
+        }
+    }
+    (void)std::rename(tmpPath.c_str(), cacheFile.c_str());
+}
+} // namespace lsp
+} // namespace ark
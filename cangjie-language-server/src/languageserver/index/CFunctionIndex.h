@@ -0,0 +1,94 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef LSPSERVER_INDEX_CFUNCTIONINDEX_H
+#define LSPSERVER_INDEX_CFUNCTIONINDEX_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace ark {
+namespace lsp {
+// A function declared or defined in a C file, line and column start at 0, the column counts UTF-16 code units as
+// LSP positions do.
+struct CFunction {
+    std::string name;
+    // types of the parameters without their names, "..." for a variadic one, empty for (void)
+    std::vector<std::string> paramTypes;
+    bool isDefinition = false;
+    std::string filePath;
+    int line = 0;
+    int column = 0;
+};
+
+/**
+ * @brief Functions of the C sources and headers under a directory, foreign funcs are looked up in it.
+ *
+ * Files are scanned lexically without preprocessing, a function whose signature is produced by a macro is not
+ * found. Scans are kept in a cache file and a file is scanned again only when its modification time changes.
+ * Lookups only read the index, it is brought up to date after a compilation and on watched file changes.
+ */
+class CFunctionIndex {
+public:
+    // cacheFile may be empty, then scans are not kept between sessions
+    CFunctionIndex(const std::string &root, const std::string &cacheFile);
+
+    // Functions named name as of the last refresh.
+    std::vector<CFunction> Find(const std::string &name) const;
+
+    // Walks the root and scans the C files changed since the last refresh, lookups are not blocked meanwhile.
+    void Refresh();
+
+    // Scans filePath again, or forgets it if deleted, when it is a C file under the root.
+    void UpdateFile(const std::string &filePath, bool deleted);
+
+    static bool IsCFile(const std::string &filePath);
+
+    static std::vector<CFunction> Scan(const std::string &filePath, const std::string &contents);
+
+    // Spaces are kept only between words, "const char *" and "const char*" are the same type.
+    static std::string NormalizeType(const std::string &type);
+
+private:
+    struct ScannedFile {
+        int64_t mtime = 0;
+        std::vector<CFunction> functions;
+    };
+
+    static ScannedFile ScanFile(const std::string &path, int64_t mtime);
+
+    // Rebuilds byName from files, mtx held.
+    void Reindex();
+
+    // The cache file contents for files, mtx held.
+    nlohmann::json ToCache() const;
+
+    void Load();
+
+    // Writes cache, made at revision, unless a later revision was written already. mtx is not held.
+    void Save(const nlohmann::json &cache, uint64_t revision);
+
+    std::string root;
+    std::string cacheFile;
+    mutable std::mutex mtx;
+    // a single walk at a time, taken before mtx
+    std::mutex refreshMtx;
+    std::unordered_map<std::string, ScannedFile> files;
+    // name to the file declaring it and the index of the function in that file
+    std::unordered_map<std::string, std::vector<std::pair<std::string, size_t>>> byName;
+    uint64_t revision = 0; // of files, mtx held
+    std::mutex saveMtx;
+    uint64_t savedRevision = 0; // saveMtx held
+};
+} // namespace lsp
+} // namespace ark
+
+#endif // LSPSERVER_INDEX_CFUNCTIONINDEX_H
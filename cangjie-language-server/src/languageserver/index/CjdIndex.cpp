@@ -5,6 +5,7 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include <fstream>
+#include <future>
 #include "CjdIndex.h"
 
 namespace Cangjie {
@@ -35,6 +36,30 @@ void DCompilerInstance::ImportCjoToManager(const std::unique_ptr<ark::CjoManager
 
 namespace ark {
 namespace  lsp {
+namespace {
+// Tokens of the cj.d sources, the collector reads the comments of their decls from them.
+std::map<std::string, std::unique_ptr<ArkAST>> LexPackageFiles(DCompilerInstance &ci, const Package &package)
+{
+    std::map<std::string, std::unique_ptr<ArkAST>> astMap;
+    for (auto &file : package.files) {
+        auto filePath = NormalizePath(file->filePath);
+        LowFileName(filePath);
+        auto buffer = ci.bufferCache.find(filePath);
+        if (buffer == ci.bufferCache.end()) {
+            continue;
+        }
+        auto arkAST = std::make_unique<ArkAST>(std::make_pair(filePath, buffer->second), file.get(), ci.diag,
+                                               nullptr, &ci.GetSourceManager());
+        int fileId = ci.GetSourceManager().GetFileID(filePath);
+        if (fileId >= 0) {
+            arkAST->fileID = static_cast<unsigned int>(fileId);
+        }
+        astMap[filePath] = std::move(arkAST);
+    }
+    return astMap;
+}
+} // namespace
+
 CjdIndexer *CjdIndexer::instance = nullptr;
 
 void CjdIndexer::InitInstance(Callbacks *cb, const std::string& stdCjdPathOption,
@@ -97,16 +122,25 @@ void CjdIndexer::ParsePackageDependencies()
     Trace::Log("ParsePackageDependencies end");
 }
 
-void CjdIndexer::BuildCJDIndex()
+void CjdIndexer::BuildCJDIndex(ThrdPool &pool)
 {
     // 3. compiler all packages, build cj.d index
     Trace::Log("BuildCJDIndex start");
     auto sortResult = graph->TopologicalSort();
+    // no task may complete before all tasks depending on it are added, or they would wait for it forever
+    std::promise<void> submitted;
+    std::shared_future<void> allSubmitted = submitted.get_future().share();
     for (auto &package: sortResult) {
         auto taskId = GenTaskId(package);
         std::unordered_set<uint64_t> dependencies;
-        auto allDependencies = graph->FindAllDependencies(package);
-        auto task = [this, package, taskId]() {
+        // a package imports the cjo data exported by the tasks of its dependencies
+        for (auto &dependency : graph->FindAllDependencies(package)) {
+            if (ciMap.find(dependency) != ciMap.end()) {
+                (void)dependencies.emplace(GenTaskId(dependency));
+            }
+        }
+        auto task = [this, package, taskId, &pool, allSubmitted]() {
+            allSubmitted.wait();
             Trace::Log("start execute task ", package);
             (void) ciMap[package]->ImportCjoToManager(cjoManager, graph);
             (void) ciMap[package]->ImportPackage();
@@ -120,8 +154,12 @@ void CjdIndexer::BuildCJDIndex()
             cjoManager->SetData(package, {data, DataStatus::FRESH});
             lsp::SymbolCollector sc = lsp::SymbolCollector(*ciMap[package]->typeManager,
                                                            ciMap[package]->importManager, false);
+            sc.SetArkAstMap(LexPackageFiles(*ciMap[package], *packages[0]));
             sc.Build(*packages[0]);
-            pkgSymsMap.insert_or_assign(package, *sc.GetSymbolMap());
+            {
+                std::unique_lock<std::mutex> indexLock(mtx);
+                AddPkgSymbols(package, *sc.GetSymbolMap());
+            }
             auto shardIdentifier = "cjd";
             auto shard = lsp::IndexFileOut();
             shard.symbols = sc.GetSymbolMap();
@@ -129,28 +167,49 @@ void CjdIndexer::BuildCJDIndex()
             shard.relations = sc.GetRelations();
             shard.extends = sc.GetSymbolExtendMap();
             cacheManager->StoreIndexShard(package, shardIdentifier, shard);
-            thrdPool->TaskCompleted(taskId);
+            pool.TaskCompleted(taskId);
             Trace::Log("finish execute task ", package);
         };
-        thrdPool->AddTask(taskId, dependencies, task);
+        pool.AddTask(taskId, dependencies, task);
     }
-    thrdPool->WaitUntilAllTasksComplete();
+    submitted.set_value();
+    pool.WaitUntilAllTasksComplete();
     Trace::Log("All tasks are completed in full compilation");
     Trace::Log("BuildCJDIndex end");
 }
 
-SymbolLocation CjdIndexer::GetSymbolDeclaration(SymbolID id, const std::string& fullPkgName)
+void CjdIndexer::AddPkgSymbols(const std::string &fullPkgName, const SymbolSlab &symbols)
 {
-    SymbolLocation loc;
-    if (auto found = pkgSymsMap.find(fullPkgName); found != pkgSymsMap.end()) {
-        for (auto &sym: found->second) {
-            if (sym.id == id) {
-                loc = sym.location;
-                break;
-            }
+    // the rest of a symbol is in the .cjo index already, only what the source adds is kept
+    std::unordered_map<SymbolID, CjdSymbol> pkgSyms;
+    pkgSyms.reserve(symbols.size());
+    for (auto &sym : symbols) {
+        (void)pkgSyms.try_emplace(sym.id, CjdSymbol{sym.location, sym.doc});
+    }
+    (void)pkgSymsMap.insert_or_assign(fullPkgName, std::move(pkgSyms));
+}
+
+std::optional<CjdSymbol> CjdIndexer::FindSymbol(SymbolID id, const std::string& fullPkgName)
+{
+    std::unique_lock<std::mutex> indexLock(mtx);
+    auto found = pkgSymsMap.find(fullPkgName);
+    if (found == pkgSymsMap.end() && cachedPkgs.erase(fullPkgName) != 0) {
+        auto indexCache = cacheManager->LoadIndexShard(fullPkgName, "cjd");
+        if (!indexCache.has_value()) {
+            Trace::Log("Load cjd index shard failed", fullPkgName);
+            return std::nullopt;
         }
+        AddPkgSymbols(fullPkgName, indexCache->get()->symbols);
+        found = pkgSymsMap.find(fullPkgName);
+    }
+    if (found == pkgSymsMap.end()) {
+        return std::nullopt;
+    }
+    auto sym = found->second.find(id);
+    if (sym == found->second.end()) {
+        return std::nullopt;
     }
-    return loc;
+    return sym->second;
 }
 
 void CjdIndexer::ReadCJDSource(const std::string &rootPath, const std::string &modulePath,
@@ -188,22 +247,16 @@ void CjdIndexer::BuildIndexFromCache()
 {
     Trace::Log("BuildIndexFromCache Start");
     std::string cjdIndexDir = JoinPath(JoinPath(cjdCachePath, ".cache"), "index");
+    std::unique_lock<std::mutex> indexLock(mtx);
+    // shards are read on first lookup, most packages are never looked up by a project
     for (auto& idxFile:
             FileUtil::GetAllFilesUnderCurrentPath(cjdIndexDir, "idx")) {
-        auto package = FileUtil::GetFileBase(FileUtil::GetFileBase(idxFile));
-        std::string shardIdentifier = "cjd";
-        auto indexCache = cacheManager->LoadIndexShard(package, shardIdentifier);
-        if (!indexCache.has_value()) {
-            Trace::Log("BuildIndexFromCache failed", package);
-            return;
-        }
-        std::unique_lock<std::mutex> indexLock(mtx);
-        (void) pkgSymsMap.insert_or_assign(package, indexCache->get()->symbols);
+        (void)cachedPkgs.emplace(FileUtil::GetFileBase(FileUtil::GetFileBase(idxFile)));
     }
     Trace::Log("BuildIndexFromCache End");
 }
 
-void CjdIndexer::Build()
+void CjdIndexer::Build(ThrdPool &pool)
 {
     if (CheckCjdCache()) {
         BuildIndexFromCache();
@@ -212,7 +265,7 @@ void CjdIndexer::Build()
     isIndexing = true;
     LoadAllCJDResource();
     ParsePackageDependencies();
-    BuildCJDIndex();
+    BuildCJDIndex(pool);
     GenerateValidFile();
     isIndexing = false;
 }
@@ -229,7 +282,8 @@ bool CjdIndexer::CheckCjdCache()
 
 std::string CjdIndexer::GetValidCode()
 {
-    std::string contents;
+    // shards of another schema version make the cache invalid as a whole
+    std::string contents = std::to_string(INDEX_SCHEMA_VERSION);
     std::string reason;
     for (auto& file: FileUtil::GetAllFilesUnderCurrentPath(cjdCachePath, "idx")) {
         contents += file + FileUtil::ReadFileContent(file, reason).value_or("");
@@ -8,6 +8,7 @@
 #define LSPSERVER_INDEX_CJDINDEXER_H
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -50,6 +51,12 @@ struct DPkgInfo : public PkgInfo {
     }
 };
 
+// What the cj.d source adds to a symbol the .cjo index already has: where it is declared and its comment.
+struct CjdSymbol {
+    SymbolLocation location;
+    std::string doc;
+};
+
 class CjdIndexer {
 public:
     explicit CjdIndexer(Callbacks *cb,
@@ -83,7 +90,8 @@ public:
 
     static CjdIndexer *GetInstance();
 
-    SymbolLocation GetSymbolDeclaration(SymbolID id, const std::string& fullPkgName);
+    // A copy, the symbols of a package are replaced when it is indexed again.
+    std::optional<CjdSymbol> FindSymbol(SymbolID id, const std::string& fullPkgName);
 
     std::unordered_map<std::string, std::unique_ptr<DPkgInfo>> &GetPkgMap()
     {
@@ -92,7 +100,8 @@ public:
 
     bool CheckCjdCache();
 
-    void Build();
+    // Packages are compiled as tasks of pool, the one used to compile the project.
+    void Build(ThrdPool &pool);
 
     void BuildIndexFromCache();
 
@@ -111,7 +120,10 @@ private:
 
     void ParsePackageDependencies();
 
-    void BuildCJDIndex();
+    void BuildCJDIndex(ThrdPool &pool);
+
+    // called with mtx held
+    void AddPkgSymbols(const std::string &fullPkgName, const SymbolSlab &symbols);
 
     void GenerateValidFile();
 
@@ -128,10 +140,11 @@ private:
     Callbacks *callback = nullptr;
     std::unique_ptr<DependencyGraph> graph = std::make_unique<DependencyGraph>();
     std::unique_ptr<CjoManager> cjoManager = std::make_unique<CjoManager>();
-    std::unique_ptr<ThrdPool> thrdPool = std::make_unique<ThrdPool>(6);
     std::unique_ptr<CacheManager> cacheManager;
 
-    std::map<std::string, SymbolSlab> pkgSymsMap{};
+    // guarded by mtx, a package found in the cache is read from its shard the first time it is looked up
+    std::unordered_map<std::string, std::unordered_map<SymbolID, CjdSymbol>> pkgSymsMap{};
+    std::unordered_set<std::string> cachedPkgs;
     std::unordered_map<std::string, std::unique_ptr<DPkgInfo>> pkgMap;
     std::unordered_map<std::string, std::unique_ptr<DCompilerInstance>> ciMap;
 };
@@ -7,6 +7,9 @@
 #include "IndexStorage.h"
 
 #include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <ios>
 #include <regex>
@@ -18,6 +21,27 @@
 namespace ark {
 namespace lsp {
 namespace {
+// A shard starts with this magic and the little-endian schema version, the flatbuffer follows. The header keeps the
+// flatbuffer 8-byte aligned.
+const char INDEX_SHARD_MAGIC[] = {'C', 'J', 'I', 'X'};
+const size_t INDEX_SHARD_HEADER_SIZE = 8;
+
+std::array<uint8_t, INDEX_SHARD_HEADER_SIZE> ShardHeader()
+{
+    std::array<uint8_t, INDEX_SHARD_HEADER_SIZE> header{};
+    (void)std::memcpy(header.data(), INDEX_SHARD_MAGIC, sizeof(INDEX_SHARD_MAGIC));
+    for (size_t i = 0; i < sizeof(INDEX_SCHEMA_VERSION); ++i) {
+        header[sizeof(INDEX_SHARD_MAGIC) + i] = static_cast<uint8_t>(INDEX_SCHEMA_VERSION >> (i * CHAR_BIT));
+    }
+    return header;
+}
+
+bool HasCurrentHeader(const uint8_t *data, size_t size)
+{
+    auto header = ShardHeader();
+    return size >= header.size() && std::memcmp(data, header.data(), header.size()) == 0;
+}
+
 std::pair<std::string, std::string> SplitFileName(const std::string &file)
 {
     std::pair<std::string, std::string> res;
@@ -110,6 +134,9 @@ void ReadSymbol(Symbol &res, const IdxFormat::Symbol *sym)
     if (sym->cur_module()) {
         res.curModule = sym->cur_module()->str();
     }
+    if (sym->doc()) {
+        res.doc = sym->doc()->str();
+    }
 }
 
 void ReadRef(Ref &res, const IdxFormat::Ref *ref)
@@ -168,10 +195,12 @@ auto StoreSymbol(flatbuffers::FlatBufferBuilder &builder, const Symbol &sym)
     auto macro_call_uri = builder.CreateString(sym.curMacroCall.fileUri);
     auto macro = IdxFormat::CreateLocation(builder, &macro_call_begin,
                                            &macro_call_end, macro_call_uri);
+    // equal comments are written once
+    auto doc = builder.CreateSharedString(sym.doc);
     return IdxFormat::CreateSymbol(builder, sym.id, name, scope, loc, decl_loc,
                                    static_cast<uint16_t>(sym.kind), sig, ret, sym.isMemberParam,
                                    static_cast<uint8_t>(sym.modifier), sym.isCjoSym, sym.isDeprecated,
-                                   text, module, macro);
+                                   text, module, macro, doc);
 }
 
 auto StoreRef(flatbuffers::FlatBufferBuilder &builder, const Ref &ref)
@@ -254,8 +283,9 @@ bool CacheManager::IsStale(const std::string &pkgName, const std::string &digest
     if (found == astIdMap.end()) {
         return true;
     }
-    // Cache is fresh, not to rebuild.
-    if (found->second == digest) {
+    // Cache is fresh, not to rebuild. The index of a package is stored with its ast, a shard of another schema
+    // version needs the package compiled again.
+    if (found->second == digest && IsShardCurrent(pkgName, digest)) {
         return false;
     }
 
@@ -318,8 +348,13 @@ std::optional<std::unique_ptr<IndexFileIn>> CacheManager::LoadIndexShard(const s
     std::string reason;
 
     (void)FileUtil::ReadBinaryFileToBuffer(idxFilePath, buffer, reason);
+    if (!HasCurrentHeader(buffer.data(), buffer.size())) {
+        (void)FileUtil::Remove(idxFilePath);
+        return std::nullopt;
+    }
 
-    flatbuffers::Verifier verifier = flatbuffers::Verifier(buffer.data(), buffer.size());
+    const uint8_t *data = buffer.data() + INDEX_SHARD_HEADER_SIZE;
+    flatbuffers::Verifier verifier = flatbuffers::Verifier(data, buffer.size() - INDEX_SHARD_HEADER_SIZE);
     bool ok = IdxFormat::VerifyHashedPackageBuffer(verifier);
     if (!ok) {
         (void)FileUtil::Remove(idxFilePath);
@@ -327,7 +362,7 @@ std::optional<std::unique_ptr<IndexFileIn>> CacheManager::LoadIndexShard(const s
     }
 
     auto ifi = std::make_unique<IndexFileIn>();
-    auto hashedPackage = IdxFormat::GetHashedPackage(buffer.data());
+    auto hashedPackage = IdxFormat::GetHashedPackage(data);
     if (hashedPackage == nullptr) {
         return std::nullopt;
     }
@@ -471,6 +506,8 @@ void CacheManager::StoreIndexShard(const std::string &curPkgName, const std::str
     IdxFormat::FinishHashedPackageBuffer(builder, hashedPackage);
 
     std::ofstream outFile{FileStore::NormalizePath(idxFilePath).c_str(), std::ios::binary | std::ios::out};
+    auto header = ShardHeader();
+    (void)outFile.write(reinterpret_cast<char *>(header.data()), header.size());
     (void)outFile.write(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
     outFile.close();
 }
@@ -483,5 +520,16 @@ std::string CacheManager::GetShardPathFromFilePath(std::string curPkgName,
     auto sr = FileUtil::JoinPath(indexDir, idxFileName);
     return sr;
 }
+
+bool CacheManager::IsShardCurrent(const std::string &curPkgName, const std::string &shardIdentifier) const
+{
+    std::ifstream inFile{FileStore::NormalizePath(GetShardPathFromFilePath(curPkgName, shardIdentifier)).c_str(),
+                         std::ios::binary | std::ios::in};
+    std::array<uint8_t, INDEX_SHARD_HEADER_SIZE> header{};
+    if (!inFile.read(reinterpret_cast<char *>(header.data()), header.size())) {
+        return false;
+    }
+    return HasCurrentHeader(header.data(), header.size());
+}
 } // namespace lsp
 } // namespace ark
\ No newline at end of file
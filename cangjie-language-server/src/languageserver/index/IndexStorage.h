@@ -16,6 +16,9 @@
 
 namespace ark {
 namespace lsp {
+// Version of the index shard schema and of what its fields hold, written in the header of every shard. Bump it
+// with any such change, shards of another version are stale and rebuilt.
+const uint32_t INDEX_SCHEMA_VERSION = 2;
 
 using ASTData = std::vector<uint8_t>;
 struct FileIn {
@@ -106,6 +109,9 @@ public:
     std::string GetShardPathFromFilePath(std::string curPkgName,
                                          const std::string &shardIdentifier) const;
 
+    // Whether the index shard exists and was written with the current schema version, only its header is read.
+    bool IsShardCurrent(const std::string &curPkgName, const std::string &shardIdentifier) const;
+
     std::unique_ptr<AstFileHandler> astLoader = std::make_unique<AstFileHandler>();
 
     void readRefs(
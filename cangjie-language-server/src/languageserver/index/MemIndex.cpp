@@ -5,6 +5,7 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "MemIndex.h"
+#include <algorithm>
 #include "../CompilerCangjieProject.h"
 
 namespace {
@@ -125,6 +126,129 @@ void MemIndex::Relations(const RelationsRequest &req, std::function<void(const R
     }
 }
 
+void MemIndex::UpdatePkgSymbols(const std::string &pkgName, SymbolSlab symbols)
+{
+    std::unique_lock<std::shared_mutex> lock(docMtx);
+    auto &docs = pkgDocs[pkgName];
+    if (auto found = pkgSymsMap.find(pkgName); found != pkgSymsMap.end()) {
+        for (const auto &sym : found->second) {
+            auto entry = docIndex.find(sym.id);
+            if (entry != docIndex.end() && entry->second.first == &docs) {
+                (void)docIndex.erase(entry);
+            }
+        }
+    }
+    docs.clear();
+    (void)docs.emplace_back();
+    // overloads and overriding members often repeat one comment, it is kept once
+    std::unordered_map<std::string_view, uint32_t> seen;
+    for (const auto &sym : symbols) {
+        uint32_t index = 0;
+        if (!sym.doc.empty()) {
+            auto [it, inserted] = seen.emplace(sym.doc, static_cast<uint32_t>(docs.size()));
+            if (inserted) {
+                (void)docs.emplace_back(sym.doc);
+            }
+            index = it->second;
+        }
+        docIndex[sym.id] = {&docs, index};
+    }
+    docs.shrink_to_fit();
+    // the comments are read from the table only, the symbols do not keep a copy
+    for (auto &sym : symbols) {
+        std::string().swap(sym.doc);
+    }
+    (void)pkgSymsMap.insert_or_assign(pkgName, std::move(symbols));
+}
+
+std::optional<std::string> MemIndex::FindDoc(SymbolID id) const
+{
+    std::shared_lock<std::shared_mutex> lock(docMtx);
+    auto found = docIndex.find(id);
+    if (found == docIndex.end()) {
+        return std::nullopt;
+    }
+    auto &[docs, index] = found->second;
+    return (*docs)[index];
+}
+
+void MemIndex::UpdatePkgRelations(const std::string &pkgName, const RelationSlab &relations)
+{
+    std::unique_lock<std::shared_mutex> lock(overrideMtx);
+    auto found = pkgRelationsMap.find(pkgName);
+    if (found != pkgRelationsMap.end()) {
+        UnlinkOverrides(found->second);
+    }
+    LinkOverrides(relations);
+    (void)pkgRelationsMap.insert_or_assign(pkgName, relations);
+}
+
+void MemIndex::LinkOverrides(const RelationSlab &relations)
+{
+    for (const auto &rel : relations) {
+        if (rel.predicate != RelationKind::RIDDEND_BY) {
+            continue;
+        }
+        riddenByMap[rel.subject].push_back(rel.object);
+        overridesMap[rel.object].push_back(rel.subject);
+    }
+}
+
+namespace {
+void EraseEdge(std::unordered_map<SymbolID, std::vector<SymbolID>> &graph, SymbolID from, SymbolID to)
+{
+    auto found = graph.find(from);
+    if (found == graph.end()) {
+        return;
+    }
+    auto &targets = found->second;
+    // the same edge may come from several packages, only drop one occurrence
+    auto it = std::find(targets.begin(), targets.end(), to);
+    if (it != targets.end()) {
+        (void)targets.erase(it);
+    }
+    if (targets.empty()) {
+        (void)graph.erase(found);
+    }
+}
+} // namespace
+
+void MemIndex::UnlinkOverrides(const RelationSlab &relations)
+{
+    for (const auto &rel : relations) {
+        if (rel.predicate != RelationKind::RIDDEND_BY) {
+            continue;
+        }
+        EraseEdge(riddenByMap, rel.subject, rel.object);
+        EraseEdge(overridesMap, rel.object, rel.subject);
+    }
+}
+
+void MemIndex::FindOverrideFamily(SymbolID id, std::unordered_set<SymbolID> &ids) const
+{
+    std::shared_lock<std::shared_mutex> lock(overrideMtx);
+    std::vector<SymbolID> worklist{id};
+    (void)ids.insert(id);
+    auto visit = [&ids, &worklist](const std::unordered_map<SymbolID, std::vector<SymbolID>> &graph,
+                                   SymbolID from) {
+        auto found = graph.find(from);
+        if (found == graph.end()) {
+            return;
+        }
+        for (auto to : found->second) {
+            if (ids.insert(to).second) {
+                worklist.push_back(to);
+            }
+        }
+    };
+    while (!worklist.empty()) {
+        auto cur = worklist.back();
+        worklist.pop_back();
+        visit(riddenByMap, cur);
+        visit(overridesMap, cur);
+    }
+}
+
 Symbol MemIndex::GetAimSymbol(const Decl& decl)
 {
     auto pkgName = decl.fullPackageName;
@@ -148,8 +272,7 @@ void MemIndex::FindImportSymsOnCompletion(const std::unordered_set<ark::lsp::Sym
     }
     size_t normalCompleteCount = 0;
     size_t importDeclCount = 0;
-    std::unordered_set<std::string> curModuleDeps =
-        CompilerCangjieProject::GetInstance()->GetOneModuleDirectDeps(curModule);
+    auto project = CompilerCangjieProject::GetInstance();
     for (const auto &pkgSyms : pkgSymsMap) {
         // filter curPackage sym
         if (curPkgName == pkgSyms.first) {
@@ -158,7 +281,7 @@ void MemIndex::FindImportSymsOnCompletion(const std::unordered_set<ark::lsp::Sym
         auto relation = GetPackageRelation(curPkgName, pkgSyms.first);
         for (const auto &sym : pkgSyms.second) {
             // filter symbols that not dependent by curModule
-            if (!sym.isCjoSym && !curModuleDeps.count(sym.curModule)) {
+            if (!sym.isCjoSym && !project->IsDirectlyRequiredModule(curModule, sym.curModule)) {
                 continue;
             }
             // filter symbols that are already in the NormalComplete
@@ -199,8 +322,7 @@ void MemIndex::FindExtendSymsOnCompletion(const ark::lsp::SymbolID &dotCompleteS
     }
     size_t normalCompleteCount = 0;
     size_t importDeclCount = 0;
-    std::unordered_set<std::string> curModuleDeps =
-        CompilerCangjieProject::GetInstance()->GetOneModuleDirectDeps(curModule);
+    auto project = CompilerCangjieProject::GetInstance();
     for (const auto &extendSyms : pkgExtendsMap) {
         // filter curPackage sym
         if (curPkgName == extendSyms.first) {
@@ -230,7 +352,7 @@ void MemIndex::FindExtendSymsOnCompletion(const ark::lsp::SymbolID &dotCompleteS
                     }
                     auto sym = symMap[symbol.id];
                     // filter symbols that not dependent by curModule
-                    if (!sym.isCjoSym && !curModuleDeps.count(sym.curModule)) {
+                    if (!sym.isCjoSym && !project->IsDirectlyRequiredModule(curModule, sym.curModule)) {
                         continue;
                     }
                     // filter by modifier
@@ -249,8 +371,7 @@ void MemIndex::FindImportSymsOnQuickFix(const std::string &curPkgName, const std
     const std::function<void(const std::string &, const Symbol &)>& callback)
 {
     size_t importDeclCount = 0;
-    std::unordered_set<std::string> curModuleDeps =
-        CompilerCangjieProject::GetInstance()->GetOneModuleDirectDeps(curModule);
+    auto project = CompilerCangjieProject::GetInstance();
     for (const auto &pkgSyms : pkgSymsMap) {
         // filter curPackage sym
         if (curPkgName == pkgSyms.first) {
@@ -263,7 +384,7 @@ void MemIndex::FindImportSymsOnQuickFix(const std::string &curPkgName, const std
                 continue;
             }
             // filter symbols that not dependent by curModule
-            if (!sym.isCjoSym && !curModuleDeps.count(sym.curModule)) {
+            if (!sym.isCjoSym && !project->IsDirectlyRequiredModule(curModule, sym.curModule)) {
                 continue;
             }
             // filter imported syms
@@ -9,6 +9,10 @@
 
 #include <cstdint>
 #include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include "../common/Utils.h"
 #include "Ref.h"
@@ -91,32 +95,38 @@ public:
 
     std::map<std::string, ExtendSlab> pkgExtendsMap{};
 
-    void FindRiddenUp(SymbolID id, std::unordered_set<SymbolID> &ids, SymbolID &topId)
-    {
-        for (const auto &relations : pkgRelationsMap) {
-            for (const auto &rel : relations.second) {
-                if (rel.predicate == RelationKind::RIDDEND_BY && rel.object == id) {
-                    (void)ids.emplace(rel.subject);
-                    topId = rel.subject;
-                    FindRiddenUp(rel.subject, ids, topId);
-                }
-            }
-        }
-    }
-
-    void FindRiddenDown(SymbolID id, std::unordered_set<SymbolID> &ids)
-    {
-        for (const auto &relations : pkgRelationsMap) {
-            for (const auto &rel : relations.second) {
-                if (rel.predicate == RelationKind::RIDDEND_BY && rel.subject == id) {
-                    (void)ids.emplace(rel.object);
-                    FindRiddenDown(rel.object, ids);
-                }
-            }
-        }
-    }
+    // Replace the symbols of one package, the documentation table is updated together with them. The comments move
+    // to the table, the stored symbols have an empty doc.
+    void UpdatePkgSymbols(const std::string &pkgName, SymbolSlab symbols);
+
+    // Comment of an indexed symbol as extracted by the collector, empty if it has none and nullopt if the symbol
+    // is not indexed.
+    std::optional<std::string> FindDoc(SymbolID id) const;
+
+    // Replace the relations of one package, the override graph is updated together with them.
+    void UpdatePkgRelations(const std::string &pkgName, const RelationSlab &relations);
+
+    // Collect every member connected to id by override or interface implementation in any package: the members
+    // it overrides, their other overriding members and so on, so a member implementing two interfaces brings in
+    // both hierarchies. Only the override graph is visited, no AST is needed.
+    void FindOverrideFamily(SymbolID id, std::unordered_set<SymbolID> &ids) const;
 
     Symbol GetAimSymbol(const Decl &decl);
+
+private:
+    void LinkOverrides(const RelationSlab &relations);
+
+    void UnlinkOverrides(const RelationSlab &relations);
+
+    mutable std::shared_mutex overrideMtx;
+    // RIDDEND_BY edges of all packages: overridden member -> overriding members, and the reverse
+    std::unordered_map<SymbolID, std::vector<SymbolID>> riddenByMap{};
+    std::unordered_map<SymbolID, std::vector<SymbolID>> overridesMap{};
+
+    mutable std::shared_mutex docMtx;
+    // distinct comments of each package, the first one is empty
+    std::unordered_map<std::string, std::vector<std::string>> pkgDocs{};
+    std::unordered_map<SymbolID, std::pair<const std::vector<std::string> *, uint32_t>> docIndex{};
 };
 
 } // namespace lsp
@@ -56,6 +56,8 @@ public:
     std::string insertText;
     std::string curModule;
     SymbolLocation curMacroCall;
+    // normalised comment of the declaration as shown by hover, empty if it has none
+    std::string doc;
 
     bool IsInvalidSym()
     {
@@ -4,8 +4,13 @@
 //
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include "../CompilerCangjieProject.h"
+#include "../capabilities/hover/HoverImpl.h"
 #include "MemIndex.h"
 #include "CjdIndex.h"
 #include "SymbolCollector.h"
@@ -77,6 +82,8 @@ ark::lsp::Modifier GetDeclModifier(const Decl &decl)
 } // namespace
 
 namespace ark::lsp {
+// packages with fewer files than this per thread are collected on the calling thread only
+const size_t MIN_FILES_PER_JOB = 4;
 const std::unordered_set<ASTKind> G_IGNORE_KINDS{ASTKind::MAIN_DECL, ASTKind::MACRO_DECL,
                                                  ASTKind::VAR_WITH_PATTERN_DECL,
                                                  ASTKind::PRIMARY_CTOR_DECL, ASTKind::INVALID_DECL};
@@ -100,76 +107,143 @@ bool SymbolCollector::ShouldPassInCjdIndexing(Ptr<Node> node)
     return CjdIndexer::GetInstance() && CjdIndexer::GetInstance()->GetRunningState() && DynamicCast<FuncDecl *>(node);
 }
 
-void SymbolCollector::Build(const Package &package)
+void SymbolCollector::Build(const Package &package, ThrdPool *pool)
 {
     Preamble(package);
-    std::unordered_set<Ptr<InheritableDecl>> inheritableDecls;
-    (void)scopes.emplace_back(&package, package.fullPackageName + ":");
-    for (auto &file : package.files) {
-        auto filePath = file->curFile->filePath;
-        auto collectPre = [this, &inheritableDecls, &filePath](auto node) {
-            if (auto invocation = node->GetConstInvocation()) {
-                CreateMacroRef(*node, *invocation);
-            }
-            if (!Ty::IsTyCorrect(node->ty)) {
-                if (!ShouldPassInCjdIndexing(node)) {
-                    return VisitAction::WALK_CHILDREN;
+    const auto &files = package.files;
+    size_t jobs = pool == nullptr ? 1 : std::min(pool->Size() + 1, files.size() / MIN_FILES_PER_JOB);
+    if (jobs <= 1) {
+        for (auto &file : files) {
+            CollectFile(package, *file);
+        }
+        CollectRelations();
+        return;
+    }
+    std::vector<std::unique_ptr<SymbolCollector>> collectors(files.size());
+    // The pool threads may all be busy compiling other packages, so the calling thread collects too and never
+    // waits for a helper which has not started. A helper starting after the files are done returns at once.
+    struct Progress {
+        std::atomic<size_t> next{0};
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t running = 0;
+        bool closed = false;
+    };
+    auto progress = std::make_shared<Progress>();
+    auto collect = [this, &package, &files, &collectors](Progress &state) {
+        for (size_t i = state.next++; i < files.size(); i = state.next++) {
+            collectors[i] = std::unique_ptr<SymbolCollector>(new SymbolCollector(this));
+            collectors[i]->CollectFile(package, *files[i]);
+        }
+    };
+    for (size_t i = 1; i < jobs; ++i) {
+        pool->AddTask([progress, collect]() {
+            {
+                std::lock_guard<std::mutex> lock(progress->mtx);
+                if (progress->closed) {
+                    return;
                 }
+                ++progress->running;
             }
-            if (node->astKind == ASTKind::PRIMARY_CTOR_DECL ||
-                node->TestAnyAttr(Attribute::MACRO_INVOKE_FUNC, Attribute::IN_CORE)) {
-                return VisitAction::SKIP_CHILDREN;
-            }
-            if (auto fd = DynamicCast<FuncDecl *>(node); fd && fd->propDecl) {
-                return VisitAction::WALK_CHILDREN;
-            } else if (auto id = DynamicCast<InheritableDecl *>(node)) {
-                (void)inheritableDecls.emplace(id);
-            }
-            if (Utils::In(node->astKind, G_IGNORE_KINDS)) {
+            collect(*progress);
+            std::lock_guard<std::mutex> lock(progress->mtx);
+            --progress->running;
+            progress->cv.notify_all();
+        });
+    }
+    collect(*progress);
+    {
+        std::unique_lock<std::mutex> lock(progress->mtx);
+        progress->closed = true;
+        progress->cv.wait(lock, [&progress] { return progress->running == 0; });
+    }
+    for (auto &collector : collectors) {
+        Merge(*collector);
+    }
+    CollectRelations();
+}
+
+void SymbolCollector::CollectFile(const Package &package, const File &file)
+{
+    (void)scopes.emplace_back(&package, package.fullPackageName + ":");
+    auto filePath = file.curFile->filePath;
+    auto collectPre = [this, &filePath](auto node) {
+        if (auto invocation = node->GetConstInvocation()) {
+            CreateMacroRef(*node, *invocation);
+        }
+        if (!Ty::IsTyCorrect(node->ty)) {
+            if (!ShouldPassInCjdIndexing(node)) {
                 return VisitAction::WALK_CHILDREN;
             }
-            if (auto decl = DynamicCast<Decl *>(node)) {
-                CreateBaseOrExtendSymbol(*decl, filePath);
-                UpdateScope(*decl);
-            } else if (auto ref = DynamicCast<NameReferenceExpr *>(node)) {
-                CreateRef(*ref, filePath);
-            } else if (auto ce = DynamicCast<CallExpr *>(node); ce && !ce->desugarExpr) {
-                CreateNamedArgRef(*ce);
-            } else if (auto type = DynamicCast<Type *>(node)) {
-                CreateTypeRef(*type, filePath);
-            }
+        }
+        if (node->astKind == ASTKind::PRIMARY_CTOR_DECL ||
+            node->TestAnyAttr(Attribute::MACRO_INVOKE_FUNC, Attribute::IN_CORE)) {
+            return VisitAction::SKIP_CHILDREN;
+        }
+        if (auto fd = DynamicCast<FuncDecl *>(node); fd && fd->propDecl) {
             return VisitAction::WALK_CHILDREN;
-        };
-
-        auto collectPost = [this](auto node) {
-            RestoreScope(*node);
+        } else if (auto id = DynamicCast<InheritableDecl *>(node)) {
+            (void)inheritableDecls.emplace_back(id);
+        }
+        if (Utils::In(node->astKind, G_IGNORE_KINDS)) {
             return VisitAction::WALK_CHILDREN;
-        };
+        }
+        if (auto decl = DynamicCast<Decl *>(node)) {
+            CreateBaseOrExtendSymbol(*decl, filePath);
+            UpdateScope(*decl);
+        } else if (auto ref = DynamicCast<NameReferenceExpr *>(node)) {
+            CreateRef(*ref, filePath);
+        } else if (auto ce = DynamicCast<CallExpr *>(node); ce && !ce->desugarExpr) {
+            CreateNamedArgRef(*ce);
+        } else if (auto type = DynamicCast<Type *>(node)) {
+            CreateTypeRef(*type, filePath);
+        }
+        return VisitAction::WALK_CHILDREN;
+    };
 
-        Walker(file.get(), collectPre, collectPost).Walk();
+    auto collectPost = [this](auto node) {
+        RestoreScope(*node);
+        return VisitAction::WALK_CHILDREN;
+    };
 
-        // Some desugar node information is stored in trashBin.
-        for (auto &it : file->trashBin) {
-            Walker(it.get(), collectPre, collectPost).Walk();
-        }
+    Walker(const_cast<File *>(&file), collectPre, collectPost).Walk();
 
-        for (auto &it : file->originalMacroCallNodes) {
-            auto invocation = it->GetConstInvocation();
-            if (!invocation) {
-                continue;
-            }
-            CreateMacroRef(*it, *invocation);
-            Walker(invocation->decl.get(), [this](auto node) {
-                if (auto i = node->GetConstInvocation()) {
-                    CreateMacroRef(*node, *i);
-                    return VisitAction::WALK_CHILDREN;
-                }
-                return VisitAction::WALK_CHILDREN;
-            }).Walk();
+    // Some desugar node information is stored in trashBin.
+    for (auto &it : file.trashBin) {
+        Walker(it.get(), collectPre, collectPost).Walk();
+    }
+
+    for (auto &it : file.originalMacroCallNodes) {
+        auto invocation = it->GetConstInvocation();
+        if (!invocation) {
+            continue;
         }
+        CreateMacroRef(*it, *invocation);
+        Walker(invocation->decl.get(), [this](auto node) {
+            if (auto i = node->GetConstInvocation()) {
+                CreateMacroRef(*node, *i);
+                return VisitAction::WALK_CHILDREN;
+            }
+            return VisitAction::WALK_CHILDREN;
+        }).Walk();
     }
     scopes.pop_back();
-    CollectRelations(inheritableDecls);
+}
+
+void SymbolCollector::Merge(SymbolCollector &other)
+{
+    pkgSymsMap.insert(pkgSymsMap.end(), std::make_move_iterator(other.pkgSymsMap.begin()),
+        std::make_move_iterator(other.pkgSymsMap.end()));
+    for (auto &[id, refs] : other.symbolRefMap) {
+        auto &target = symbolRefMap[id];
+        target.insert(target.end(), std::make_move_iterator(refs.begin()), std::make_move_iterator(refs.end()));
+    }
+    for (auto &[id, items] : other.symbolExtendMap) {
+        auto &target = symbolExtendMap[id];
+        target.insert(target.end(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+    }
+    inheritableDecls.insert(inheritableDecls.end(), other.inheritableDecls.begin(), other.inheritableDecls.end());
+    declToSymIdMap.insert(other.declToSymIdMap.begin(), other.declToSymIdMap.end());
 }
 
 void SymbolCollector::CreateBaseOrExtendSymbol(const Decl &decl, const std::string &filePath)
@@ -214,8 +288,15 @@ void SymbolCollector::CreateBaseSymbol(const Decl &decl, const std::string &file
         curMacroCall = {curMacroCallNode->begin, curMacroCallNode->end, curMacroCallNode->curFile->filePath};
     }
     SymbolLocation declaration = {.begin = {0, 0}, .end = {0, 0}, .fileUri = ""};
+    std::string doc;
     if (NeedToObtainCjdDeclPos(isCjoPkg)) {
-        declaration = CjdIndexer::GetInstance()->GetSymbolDeclaration(GetDeclSymbolID(decl), decl.fullPackageName);
+        // the cjd source of a cjo package holds its comments
+        if (auto cjdSym = CjdIndexer::GetInstance()->FindSymbol(GetDeclSymbolID(decl), decl.fullPackageName)) {
+            declaration = cjdSym->location;
+            doc = cjdSym->doc;
+        }
+    } else if (auto arkAst = GetArkAST(filePath); arkAst && !loc.IsZeroLoc() && arkAst->fileID == loc.begin.fileID) {
+        doc = HoverImpl::GetDeclComment(arkAst->tokens, decl);
     }
     Symbol declSym{.id = GetDeclSymbolID(decl),
                    .name = identifier,
@@ -241,6 +322,7 @@ void SymbolCollector::CreateBaseSymbol(const Decl &decl, const std::string &file
         declSym.insertText += "(${2:input: Tokens})";
     }
     declSym.curMacroCall = curMacroCall;
+    declSym.doc = std::move(doc);
     if (decl.HasAnno(AnnotationKind::DEPRECATED)) {
         declSym.isDeprecated = true;
     }
@@ -379,8 +461,9 @@ void SymbolCollector::CreateRef(const NameReferenceExpr &ref, const std::string
     }
     auto identifier = target->TestAttr(Attribute::CONSTRUCTOR) ? target->outerDecl->identifier
                                                                : target->identifier;
-    if (aliasMap.find(identifier) != aliasMap.end()) {
-        identifier = aliasMap[identifier];
+    auto &aliases = GetAliasMap();
+    if (auto alias = aliases.find(identifier); alias != aliases.end()) {
+        identifier = alias->second;
     }
     auto offset = (identifier == "[]" || identifier == "()") ? 1 : CountUnicodeCharacters(identifier);
     auto begin = ma ? ma->GetFieldPos() : (refExpr ? refExpr->GetIdentifierPos() : ref.GetBegin());
@@ -481,10 +564,13 @@ void SymbolCollector::CreateNamedArgRef(const CallExpr &ce)
     }
 }
 
-void SymbolCollector::CollectRelations(
-    const std::unordered_set<Ptr<InheritableDecl>> &inheritableDecls)
+void SymbolCollector::CollectRelations()
 {
+    std::unordered_set<Ptr<InheritableDecl>> visited;
     for (auto &id : inheritableDecls) {
+        if (!visited.emplace(id).second) {
+            continue;
+        }
         for (auto &type : id->inheritedTypes) {
             auto decl = Ty::GetDeclPtrOfTy(type->ty);
             if (decl == nullptr || type->ty->IsObject()) { // Ignore core object.
@@ -686,7 +772,7 @@ void SymbolCollector::UpdatePos(SymbolLocation &location, const Node &node,
                                 const std::string &filePath)
 {
     Range range = {location.begin, location.end};
-    ark::ArkAST *arkAst = this->astMap[filePath].get();
+    ark::ArkAST *arkAst = GetArkAST(filePath);
     if (!arkAst) {
         return;
     }
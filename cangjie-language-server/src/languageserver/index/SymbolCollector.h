@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 #include "../ArkAST.h"
+#include "../ThrdPool.h"
 #include "Ref.h"
 #include "Relation.h"
 #include "Symbol.h"
@@ -34,7 +35,9 @@ public:
 
     void Preamble(const Package& package);
 
-    void Build(const Package& package);
+    // Files are collected into their own slabs, by the calling thread and by the threads of pool that are free
+    // meanwhile, and merged in file order afterwards, so the result does not depend on the number of threads.
+    void Build(const Package& package, ThrdPool* pool = nullptr);
 
     const std::vector<Symbol>* GetSymbolMap() const
     {
@@ -62,6 +65,28 @@ public:
     }
 
 private:
+    // Collector of a single file, it reads the package wide state of its parent and is merged back into it.
+    explicit SymbolCollector(const SymbolCollector* parent)
+        : tyMgr(parent->tyMgr), importMgr(parent->importMgr), isCjoPkg(parent->isCjoPkg), root(parent)
+    {
+    }
+
+    void CollectFile(const Package& package, const File& file);
+
+    void Merge(SymbolCollector& other);
+
+    ArkAST* GetArkAST(const std::string& filePath) const
+    {
+        auto& map = root ? root->astMap : astMap;
+        auto found = map.find(filePath);
+        return found == map.end() ? nullptr : found->second.get();
+    }
+
+    const std::unordered_map<std::string, std::string>& GetAliasMap() const
+    {
+        return root ? root->aliasMap : aliasMap;
+    }
+
     void UpdateScope(const Decl& decl)
     {
         std::string name;
@@ -85,7 +110,7 @@ private:
 
     bool ShouldPassInCjdIndexing(Ptr<Node> node);
 
-    void CollectRelations(const std::unordered_set<Ptr<InheritableDecl>>& inheritableDecls);
+    void CollectRelations();
 
     void CollectNamedParam(Ptr<const Decl> parent, Ptr<const Decl> member);
 
@@ -194,7 +219,12 @@ private:
 
     std::map<SymbolID, std::vector<ExtendItem>> symbolExtendMap;
 
+    // in the order they were visited, relations are collected from them once all files are merged
+    std::vector<Ptr<InheritableDecl>> inheritableDecls;
+
     bool isCjoPkg;
+
+    const SymbolCollector* root = nullptr;
 };
 } // namespace lsp
 } // namespace ark
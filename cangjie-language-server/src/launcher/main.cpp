@@ -5,6 +5,7 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "../json-rpc/StdioTransport.h"
+#include "../json-rpc/SocketTransport.h"
 #include "../languageserver/ArkLanguageServer.h"
 #include "../languageserver/logger/CrashReporter.h"
 #include "../languageserver/capabilities/shutdown/Shutdown.h"
@@ -80,20 +81,38 @@ int main(int argc, const char *argv[], const char *envp[])
         ark::CrashReporter::RegisterHandlers();
     }
 
-    Trace::Log("LSP Starting over stdin/stdout");
-    // add if/else can add another transport layer
     ark::TransportRegistrar<ark::Transport, ark::StdioTransport> stdioTransportRegistrar("stdio");
     stdioTransportRegistrar.Regist();
-    ark::Transport *pStdioTransport = ark::TransportFactory<ark::Transport>::Instance().GetTransport("stdio");
+    ark::TransportRegistrar<ark::Transport, ark::SocketTransport> socketTransportRegistrar("socket");
+    socketTransportRegistrar.Regist();
+    bool useSocket = opts.IsOptionSet("listen") || opts.IsOptionSet("connect");
+    ark::Transport *pStdioTransport =
+        ark::TransportFactory<ark::Transport>::Instance().GetTransport(useSocket ? "socket" : "stdio");
     if (pStdioTransport == nullptr) {
         (void)fprintf(stderr, "error: get transport fail.");
         return 0;
     }
+    if (useSocket) {
+        auto *socketTransport = static_cast<ark::SocketTransport *>(pStdioTransport);
+        bool ready = opts.IsOptionSet("listen") ? socketTransport->Listen(opts.GetLongOption("listen").value())
+                                                : socketTransport->Connect(opts.GetLongOption("connect").value());
+        if (!ready) {
+            (void)fprintf(stderr, "error: can not open socket transport.");
+            return 0;
+        }
+        Trace::Log("LSP Starting over socket");
+    } else {
+        Trace::Log("LSP Starting over stdin/stdout");
 #ifdef WIN32
-    _setmode(_fileno(stdin), _O_BINARY);
-    _setmode(_fileno(stdout), _O_BINARY);
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
 #endif
-    pStdioTransport->SetIO(stdin, stdout);
+        pStdioTransport->SetIO(stdin, stdout);
+    }
+    if (opts.IsOptionSet("record")) {
+        (void)static_cast<ark::StdioTransport *>(pStdioTransport)->StartRecording(
+            opts.GetLongOption("record").value());
+    }
 
 #ifdef MACRO_DYNAMIC
     char splitStr = ':';
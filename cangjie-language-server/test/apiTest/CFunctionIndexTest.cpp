@@ -0,0 +1,100 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../../../src/languageserver/index/CFunctionIndex.h"
+
+using namespace ark::lsp;
+
+namespace apitest {
+namespace {
+const std::string SOURCE = R"(#include <stdint.h>
+#define MAX(a, b) \
+    ((a) > (b) ? (a) : (b))
+/* int commented(int x) { return x; } */
+#ifdef __cplusplus
+extern "C" {
+#endif
+static int32_t add(int32_t a, int32_t b) { return a + b; }
+const char *greet(const char *name, ...);
+void noargs(void)
+{
+    if (MAX(1, 2)) { notAtFileScope(1); }
+}
+struct S { int (*cb)(int); };
+typedef int (*fp)(int);
+int sum(int values[], size_t n) __attribute__((nonnull));
+#ifdef __cplusplus
+}
+#endif
+)";
+} // namespace
+
+TEST(CFunctionIndexTest, ScansFunctionsAtFileScope)
+{
+    auto functions = CFunctionIndex::Scan("/ws/native/lib.c", SOURCE);
+    ASSERT_EQ(functions.size(), 4u);
+
+    EXPECT_EQ(functions[0].name, "add");
+    EXPECT_TRUE(functions[0].isDefinition);
+    EXPECT_EQ(functions[0].line, 7);
+    EXPECT_EQ(functions[0].column, 15);
+    EXPECT_EQ(functions[0].paramTypes, (std::vector<std::string>{"int32_t", "int32_t"}));
+
+    EXPECT_EQ(functions[1].name, "greet");
+    EXPECT_FALSE(functions[1].isDefinition);
+    EXPECT_EQ(functions[1].paramTypes, (std::vector<std::string>{"const char*", "..."}));
+
+    EXPECT_EQ(functions[2].name, "noargs");
+    EXPECT_TRUE(functions[2].paramTypes.empty());
+
+    EXPECT_EQ(functions[3].name, "sum");
+    EXPECT_FALSE(functions[3].isDefinition);
+    EXPECT_EQ(functions[3].paramTypes, (std::vector<std::string>{"int*", "size_t"}));
+}
+
+TEST(CFunctionIndexTest, ColumnsCountUtf16Units)
+{
+    // 'é' is two bytes and one unit, '😀' four bytes and two units
+    auto functions = CFunctionIndex::Scan("/ws/native/lib.c", "/* é😀 */ int f(void);\n");
+    ASSERT_EQ(functions.size(), 1u);
+    EXPECT_EQ(functions[0].column, 14);
+}
+
+TEST(CFunctionIndexTest, TypesCompareWithoutLayoutSpaces)
+{
+    EXPECT_EQ(CFunctionIndex::NormalizeType("const char *"), "const char*");
+    EXPECT_EQ(CFunctionIndex::NormalizeType("int32_t **"), "int32_t**");
+    EXPECT_EQ(CFunctionIndex::NormalizeType("unsigned   long"), "unsigned long");
+}
+
+TEST(CFunctionIndexTest, LookupsSeeOnlyUpdatedFiles)
+{
+    auto root = std::filesystem::temp_directory_path() / "cfunction_index_test";
+    std::filesystem::create_directories(root);
+    auto path = (root / "lib.c").string();
+    std::ofstream(path) << "int first(int a);\n";
+    CFunctionIndex index(root.string(), "");
+    EXPECT_TRUE(index.Find("first").empty());
+
+    index.UpdateFile(path, false);
+    ASSERT_EQ(index.Find("first").size(), 1u);
+    EXPECT_EQ(index.Find("first")[0].filePath, path);
+
+    // a lookup does not look at the disk
+    std::ofstream(path) << "int second(void);\n";
+    EXPECT_EQ(index.Find("first").size(), 1u);
+    EXPECT_TRUE(index.Find("second").empty());
+
+    index.UpdateFile(path, true);
+    EXPECT_TRUE(index.Find("first").empty());
+    std::filesystem::remove_all(root);
+}
+} // namespace apitest
@@ -0,0 +1,74 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include <gtest/gtest.h>
+#include <unordered_set>
+#include "../../../src/languageserver/index/MemIndex.h"
+
+using namespace ark::lsp;
+
+namespace apitest {
+namespace {
+Relation RiddenBy(SymbolID parent, SymbolID member)
+{
+    return {parent, RelationKind::RIDDEND_BY, member};
+}
+
+Symbol Documented(SymbolID id, const std::string &doc)
+{
+    Symbol sym{};
+    sym.id = id;
+    sym.doc = doc;
+    return sym;
+}
+} // namespace
+
+TEST(MemIndexTest, OverrideFamilySpansPackagesAndDiamonds)
+{
+    MemIndex index;
+    // pkgA: interface I { f }, interface J { f }; pkgB: class C <: I & J { f }; pkgC: class D <: C { f }
+    index.UpdatePkgRelations("pkgB", {RiddenBy(1, 3), RiddenBy(2, 3)});
+    index.UpdatePkgRelations("pkgC", {RiddenBy(3, 4), {3, RelationKind::BASE_OF, 5}});
+
+    std::unordered_set<SymbolID> ids;
+    index.FindOverrideFamily(1, ids);
+    EXPECT_EQ(ids, (std::unordered_set<SymbolID>{1, 2, 3, 4}));
+
+    ids.clear();
+    index.FindOverrideFamily(6, ids);
+    EXPECT_EQ(ids, (std::unordered_set<SymbolID>{6}));
+}
+
+TEST(MemIndexTest, UpdatingPackageReplacesItsOverrides)
+{
+    MemIndex index;
+    index.UpdatePkgRelations("pkgB", {RiddenBy(1, 3)});
+    index.UpdatePkgRelations("pkgC", {RiddenBy(3, 4)});
+    index.UpdatePkgRelations("pkgC", {});
+
+    std::unordered_set<SymbolID> ids;
+    index.FindOverrideFamily(1, ids);
+    EXPECT_EQ(ids, (std::unordered_set<SymbolID>{1, 3}));
+    EXPECT_TRUE(index.pkgRelationsMap["pkgC"].empty());
+}
+
+TEST(MemIndexTest, DocsAreServedBySymbolAndReplacedWithPackage)
+{
+    MemIndex index;
+    index.UpdatePkgSymbols("pkgA", {Documented(1, "sum of a and b"), Documented(2, "sum of a and b"),
+                                    Documented(3, "")});
+
+    EXPECT_EQ(index.FindDoc(1), "sum of a and b");
+    EXPECT_EQ(index.FindDoc(2), "sum of a and b");
+    EXPECT_EQ(index.FindDoc(3), "");
+    EXPECT_FALSE(index.FindDoc(4).has_value());
+
+    index.UpdatePkgSymbols("pkgA", {Documented(1, "difference of a and b")});
+    EXPECT_EQ(index.FindDoc(1), "difference of a and b");
+    EXPECT_FALSE(index.FindDoc(2).has_value());
+    EXPECT_EQ(index.pkgSymsMap["pkgA"].size(), 1u);
+}
+} // namespace apitest
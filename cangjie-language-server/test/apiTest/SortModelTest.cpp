@@ -0,0 +1,304 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "../../../src/languageserver/capabilities/completion/SortModel.h"
+
+using namespace ark;
+
+namespace apitest {
+namespace {
+/**
+ * A trace in the format written by LSPServer --record=<file>. Each completion request whose list was followed by a
+ * textDocument/trackCompletion notification is one session. Set COMPLETION_SESSIONS to a recorded trace to evaluate
+ * real sessions instead of this sample.
+ */
+const std::string SAMPLE_TRACE = R"TRACE(
+{"time":0,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":{"uri":"file:///demo/src/main.cj","languageId":"Cangjie","version":1,"text":"package demo\nmain() {\n    list.ap\n    pr\n}\n"}}}}
+{"time":10,"direction":"recv","message":{"jsonrpc":"2.0","id":1,"method":"textDocument/completion","params":{"textDocument":{"uri":"file:///demo/src/main.cj"},"position":{"line":2,"character":11}}}}
+{"time":20,"direction":"send","message":{"jsonrpc":"2.0","id":1,"result":[{"label":"append(T)","kind":2,"filterText":"ap_append"},{"label":"appendAll(Collection<T>)","kind":2,"filterText":"ap_appendAll"},{"label":"apply()","kind":3,"filterText":"ap_apply","additionalTextEdits":[{"range":{"start":{"line":1,"character":0},"end":{"line":1,"character":0}},"newText":"import other.apply\n"}]}]}}
+{"time":30,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/trackCompletion","params":{"label":"appendAll(Collection<T>)"}}}
+{"time":40,"direction":"recv","message":{"jsonrpc":"2.0","id":2,"method":"textDocument/completion","params":{"textDocument":{"uri":"file:///demo/src/main.cj"},"position":{"line":3,"character":6}}}}
+{"time":50,"direction":"send","message":{"jsonrpc":"2.0","id":2,"result":{"isIncomplete":true,"items":[{"label":"print(String)","kind":3,"filterText":"pr_print"},{"label":"println(String)","kind":3,"filterText":"pr_println"},{"label":"private","kind":14,"filterText":"pr_private"}]}}}
+{"time":60,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/trackCompletion","params":{"label":"println(String)"}}}
+{"time":70,"direction":"recv","message":{"jsonrpc":"2.0","id":3,"method":"textDocument/completion","params":{"textDocument":{"uri":"file:///demo/src/main.cj"},"position":{"line":2,"character":11}}}}
+{"time":80,"direction":"send","message":{"jsonrpc":"2.0","id":3,"result":[{"label":"append(T)","kind":2,"filterText":"ap_append"},{"label":"appendAll(Collection<T>)","kind":2,"filterText":"ap_appendAll"},{"label":"apply()","kind":3,"filterText":"ap_apply","additionalTextEdits":[{"range":{"start":{"line":1,"character":0},"end":{"line":1,"character":0}},"newText":"import other.apply\n"}]}]}}
+{"time":90,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/trackCompletion","params":{"label":"appendAll(Collection<T>)"}}}
+{"time":100,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file:///demo/src/main.cj","version":2},"contentChanges":[{"range":{"start":{"line":3,"character":6},"end":{"line":3,"character":6}},"text":"intln()\n    pr"}]}}}
+{"time":110,"direction":"recv","message":{"jsonrpc":"2.0","id":4,"method":"textDocument/completion","params":{"textDocument":{"uri":"file:///demo/src/main.cj"},"position":{"line":4,"character":6}}}}
+{"time":120,"direction":"send","message":{"jsonrpc":"2.0","id":4,"result":{"isIncomplete":true,"items":[{"label":"print(String)","kind":3,"filterText":"pr_print"},{"label":"println(String)","kind":3,"filterText":"pr_println"},{"label":"private","kind":14,"filterText":"pr_private"}]}}}
+{"time":130,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/trackCompletion","params":{"label":"println(String)"}}}
+{"time":140,"direction":"recv","message":{"jsonrpc":"2.0","id":5,"method":"textDocument/completion","params":{"textDocument":{"uri":"file:///demo/src/main.cj"},"position":{"line":2,"character":11}}}}
+{"time":150,"direction":"send","message":{"jsonrpc":"2.0","id":5,"result":[{"label":"append(T)","kind":2,"filterText":"ap_append"},{"label":"appendAll(Collection<T>)","kind":2,"filterText":"ap_appendAll"},{"label":"apply()","kind":3,"filterText":"ap_apply","additionalTextEdits":[{"range":{"start":{"line":1,"character":0},"end":{"line":1,"character":0}},"newText":"import other.apply\n"}]}]}}
+{"time":160,"direction":"recv","message":{"jsonrpc":"2.0","method":"textDocument/trackCompletion","params":{"label":"appendAll(Collection<T>)"}}}
+)TRACE";
+
+// The trace holds neither the scope depths nor the packages of the items, those scores are the same for all of them.
+struct Session {
+    std::string prefix;
+    std::vector<CodeCompletion> candidates;
+    std::string chosen;
+};
+
+// Byte offset of an LSP position, whose character counts UTF-16 code units.
+size_t OffsetOf(const std::string &text, const nlohmann::json &position)
+{
+    size_t offset = 0;
+    for (int line = position.value("line", 0); line > 0 && offset < text.size(); --line) {
+        auto newline = text.find('\n', offset);
+        offset = newline == std::string::npos ? text.size() : newline + 1;
+    }
+    for (int units = position.value("character", 0); units > 0 && offset < text.size() && text[offset] != '\n';) {
+        auto lead = static_cast<unsigned char>(text[offset]);
+        size_t length = lead < 0x80 ? 1 : (lead < 0xE0 ? 2 : (lead < 0xF0 ? 3 : 4));
+        units -= length == 4 ? 2 : 1;
+        offset = std::min(text.size(), offset + length);
+    }
+    return offset;
+}
+
+void ApplyChanges(std::string &text, const nlohmann::json &changes)
+{
+    for (const auto &change : changes) {
+        if (!change.contains("range")) {
+            text = change.value("text", "");
+            continue;
+        }
+        size_t begin = OffsetOf(text, change["range"]["start"]);
+        size_t end = std::max(begin, OffsetOf(text, change["range"]["end"]));
+        text.replace(begin, end - begin, change.value("text", ""));
+    }
+}
+
+// The identifier the user was typing at the completion position.
+std::string PrefixAt(const std::string &text, size_t offset)
+{
+    size_t begin = offset;
+    while (begin > 0) {
+        auto c = static_cast<unsigned char>(text[begin - 1]);
+        if (!std::isalnum(c) && c != '_' && c < 0x80) {
+            break;
+        }
+        --begin;
+    }
+    return text.substr(begin, offset - begin);
+}
+
+CodeCompletion CandidateOf(const nlohmann::json &item, const std::string &prefix)
+{
+    CodeCompletion candidate;
+    candidate.label = item.value("label", "");
+    candidate.kind = static_cast<CompletionItemKind>(item.value("kind", 0));
+    // the filter text is the name, or the prefix and the name joined with '_' for clients which filter themselves
+    auto filterText = item.value("filterText", candidate.label);
+    candidate.name = filterText.compare(0, prefix.size() + 1, prefix + "_") == 0 ?
+        filterText.substr(prefix.size() + 1) : filterText;
+    if (candidate.kind == CompletionItemKind::CIK_KEYWORD) {
+        candidate.sortType = SortType::KEYWORD;
+    } else if (item.contains("additionalTextEdits")) {
+        candidate.sortType = SortType::AUTO_IMPORT_SYM;
+    }
+    return candidate;
+}
+
+std::vector<Session> LoadSessions()
+{
+    std::string contents = SAMPLE_TRACE;
+    if (const char *path = std::getenv("COMPLETION_SESSIONS")) {
+        std::ifstream in(path);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        contents = buffer.str();
+    }
+    std::map<std::string, std::string> documents;
+    // prefixes of the completion requests waiting for their replies, by request id
+    std::map<std::string, std::string> pending;
+    std::optional<Session> offered;
+    std::vector<Session> sessions;
+    std::stringstream lines(contents);
+    std::string line;
+    while (std::getline(lines, line)) {
+        auto record = nlohmann::json::parse(line, nullptr, false);
+        if (record.is_discarded() || !record.is_object() || !record.contains("message")) {
+            continue;
+        }
+        const auto &message = record["message"];
+        auto method = message.value("method", "");
+        const auto &params = message.contains("params") ? message["params"] : nlohmann::json::object();
+        if (record.value("direction", "") == "send") {
+            auto request = message.contains("id") ? pending.find(message["id"].dump()) : pending.end();
+            if (request == pending.end() || !message.contains("result")) {
+                continue;
+            }
+            const auto &result = message["result"];
+            const auto &items = result.is_object() ? result.value("items", nlohmann::json::array()) : result;
+            offered = Session{request->second, {}, ""};
+            for (const auto &item : items) {
+                offered->candidates.push_back(CandidateOf(item, request->second));
+            }
+            pending.erase(request);
+        } else if (method == "textDocument/didOpen") {
+            documents[params["textDocument"].value("uri", "")] = params["textDocument"].value("text", "");
+        } else if (method == "textDocument/didChange") {
+            ApplyChanges(documents[params["textDocument"].value("uri", "")], params["contentChanges"]);
+        } else if (method == "textDocument/completion" && message.contains("id")) {
+            const auto &text = documents[params["textDocument"].value("uri", "")];
+            pending[message["id"].dump()] = PrefixAt(text, OffsetOf(text, params["position"]));
+            // a new request means the previous list was dismissed
+            offered.reset();
+        } else if (method == "textDocument/trackCompletion" && offered) {
+            offered->chosen = params.value("label", "");
+            sessions.push_back(*offered);
+            offered.reset();
+        }
+    }
+    return sessions;
+}
+
+// Rank of the chosen item, starting at 1, ordered as the server orders its candidates.
+size_t RankOfChosen(const SortModel &model, const Session &session)
+{
+    RankingContext context;
+    model.SnapshotUsage(context);
+    std::vector<std::pair<double, std::string>> scored;
+    for (const auto &item : session.candidates) {
+        scored.emplace_back(model.CalculateScore(item, session.prefix, 0, context), item.label);
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto &left, const auto &right) {
+        return left.first != right.first ? left.first > right.first : left.second < right.second;
+    });
+    for (size_t i = 0; i < scored.size(); ++i) {
+        if (scored[i].second == session.chosen) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Replay the sessions in order and return the mean reciprocal rank of the accepted items.
+double MeanReciprocalRank(SortModel &model, const std::vector<Session> &sessions, bool learn)
+{
+    double sum = 0;
+    for (const auto &session : sessions) {
+        size_t rank = RankOfChosen(model, session);
+        sum += rank == 0 ? 0 : 1.0 / static_cast<double>(rank);
+        if (learn) {
+            model.UpdateUsageFrequency(session.chosen);
+        }
+    }
+    return sessions.empty() ? 0 : sum / static_cast<double>(sessions.size());
+}
+
+int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+/**
+ * Smoke check that learned usage reaches the ranking at all. The sample trace is hand-written to repeat the
+ * same choices, so the numbers printed for it say nothing about the ranking quality; only a real recording
+ * given with COMPLETION_SESSIONS does.
+ */
+TEST(SortModelTest, LearnedUsageSmokeCheck)
+{
+    auto sessions = LoadSessions();
+    ASSERT_FALSE(sessions.empty());
+    SortModel cold;
+    SortModel learned;
+    double coldMrr = MeanReciprocalRank(cold, sessions, false);
+    double learnedMrr = MeanReciprocalRank(learned, sessions, true);
+    std::cout << (std::getenv("COMPLETION_SESSIONS") ? "completion MRR" : "completion MRR smoke check, sample trace")
+              << " without usage: " << coldMrr << ", with usage: " << learnedMrr << std::endl;
+    EXPECT_GT(learnedMrr, coldMrr);
+}
+
+TEST(SortModelTest, UsageIsPersistedAndDecays)
+{
+    auto root = std::filesystem::temp_directory_path() / "sort_model_usage_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    const std::string path = (root / "completion_usage.json").string();
+    {
+        SortModel model;
+        model.LoadUsage(path);
+        model.UpdateUsageFrequency("println(String)");
+        model.UpdateUsageFrequency("println(String)");
+    }
+    SortModel reloaded;
+    reloaded.LoadUsage(path);
+    int64_t now = Now();
+    double weight = reloaded.GetUsageWeight("println(String)", now);
+    EXPECT_NEAR(weight, 2.0, 0.01);
+    auto halfLifeLater = now + static_cast<int64_t>(SortModel::USAGE_HALF_LIFE);
+    double halfLife = reloaded.GetUsageWeight("println(String)", halfLifeLater);
+    EXPECT_NEAR(halfLife, weight / 2, 0.01);
+    EXPECT_EQ(reloaded.GetUsageWeight("print(String)", now), 0);
+    std::filesystem::remove_all(root);
+}
+
+TEST(SortModelTest, RefPopularityFollowsTheLargestCount)
+{
+    SortModel model;
+    CodeCompletion item;
+    item.name = "foo";
+    item.label = "foo()";
+    item.id = 1;
+    auto refsOf = [](lsp::SymbolID id, size_t count) {
+        lsp::RefSlab refs;
+        refs[id] = std::vector<lsp::Ref>(count);
+        return refs;
+    };
+    double unknown = model.CalculateScore(item, "fo", 0);
+    model.UpdateRefCounts("a", refsOf(1, 10));
+    double mostUsed = model.CalculateScore(item, "fo", 0);
+    model.UpdateRefCounts("b", refsOf(2, 100));
+    double lessUsed = model.CalculateScore(item, "fo", 0);
+    // replacing the counts of package b lowers the largest count again
+    model.UpdateRefCounts("b", refsOf(2, 1));
+    double mostUsedAgain = model.CalculateScore(item, "fo", 0);
+    EXPECT_GT(mostUsed, lessUsed);
+    EXPECT_GT(lessUsed, unknown);
+    EXPECT_DOUBLE_EQ(mostUsedAgain, mostUsed);
+}
+
+TEST(SortModelTest, ProximityPrefersCloserPackages)
+{
+    SortModel model;
+    RankingContext context;
+    context.curPkgName = "demo";
+    context.directDeps = {"direct"};
+    context.allDeps = {"direct", "transitive"};
+    CodeCompletion item;
+    item.name = "foo";
+    item.label = "foo()";
+    item.pkgName = "demo";
+    double samePkg = model.CalculateScore(item, "fo", 0, context);
+    item.pkgName = "direct";
+    double direct = model.CalculateScore(item, "fo", 0, context);
+    item.pkgName = "transitive";
+    double transitive = model.CalculateScore(item, "fo", 0, context);
+    item.pkgName = "unrelated";
+    double unrelated = model.CalculateScore(item, "fo", 0, context);
+    EXPECT_GT(samePkg, direct);
+    EXPECT_GT(direct, transitive);
+    EXPECT_GT(transitive, unrelated);
+}
+} // namespace apitest
@@ -10,9 +10,12 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include <vector>
+#include "../../../src/languageserver/common/BasicHelper.h"
 #include "../../../src/languageserver/common/Utils.h"
+#include "Format/FormatOutput.h"
 
 using namespace Cangjie::FileUtil;
+using Cangjie::Format::TextReplacement;
 
 namespace apitest {
 
@@ -88,4 +91,130 @@ namespace apitest {
         EXPECT_TRUE(ark::IsMatchingCompletion("Hw", "HelloWorld", false));
     }
 
+
+    class FormatEditsTest : public ::testing::Test {
+    protected:
+        void SetUp() override {}
+
+        void TearDown() override {}
+    };
+
+    TEST_F(FormatEditsTest, LineOffsetsCountLineFeeds)
+    {
+        EXPECT_EQ(ark::GetLineOffsets(""), std::vector<size_t>({0}));
+        EXPECT_EQ(ark::GetLineOffsets("a\r\nb\n"), std::vector<size_t>({0, 3, 5}));
+        EXPECT_EQ(ark::GetLineOffsets("a\nb"), std::vector<size_t>({0, 2}));
+    }
+
+    TEST_F(FormatEditsTest, PositionColumnsAreUtf16)
+    {
+        // 中 is one UTF-16 unit in three bytes, 😀 two units in four bytes
+        std::string text = "let s = \"中😀x\"\nlet t = 😀\n";
+        auto lineOffsets = ark::GetLineOffsets(text);
+        auto pos = ark::GetPositionFromOffset(text, lineOffsets, text.find('x'));
+        EXPECT_EQ(pos.line, 0);
+        EXPECT_EQ(pos.column, 12);
+        pos = ark::GetPositionFromOffset(text, lineOffsets, text.rfind('\n'));
+        EXPECT_EQ(pos.line, 1);
+        EXPECT_EQ(pos.column, 10);
+    }
+
+    TEST_F(FormatEditsTest, PositionOnCrlfLines)
+    {
+        std::string text = "a\r\nbc\r\n";
+        auto lineOffsets = ark::GetLineOffsets(text);
+        auto pos = ark::GetPositionFromOffset(text, lineOffsets, 1);
+        EXPECT_EQ(pos.line, 0);
+        EXPECT_EQ(pos.column, 1);
+        pos = ark::GetPositionFromOffset(text, lineOffsets, text.find('c'));
+        EXPECT_EQ(pos.line, 1);
+        EXPECT_EQ(pos.column, 1);
+    }
+
+    TEST_F(FormatEditsTest, PositionAtEndOfFile)
+    {
+        std::string text = "ab\ncd";
+        auto lineOffsets = ark::GetLineOffsets(text);
+        auto pos = ark::GetPositionFromOffset(text, lineOffsets, text.size());
+        EXPECT_EQ(pos.line, 1);
+        EXPECT_EQ(pos.column, 2);
+        // offsets past the end are clamped
+        pos = ark::GetPositionFromOffset(text, lineOffsets, text.size() + 5);
+        EXPECT_EQ(pos.line, 1);
+        EXPECT_EQ(pos.column, 2);
+        text = "ab\n";
+        pos = ark::GetPositionFromOffset(text, ark::GetLineOffsets(text), text.size());
+        EXPECT_EQ(pos.line, 1);
+        EXPECT_EQ(pos.column, 0);
+    }
+
+    TEST_F(FormatEditsTest, ReplacementsKeepUnchangedBytes)
+    {
+        std::string before = "let a=1\r\nlet b = 2\r\n";
+        std::string after = "let a = 1\r\nlet b = 2\r\n";
+        auto replacements = Cangjie::Format::TextReplacements(before, after);
+        ASSERT_EQ(replacements.size(), 1);
+        EXPECT_EQ(replacements[0].offset, 5);
+        EXPECT_EQ(replacements[0].length, 1);
+        EXPECT_EQ(replacements[0].text, " = ");
+        EXPECT_EQ(Cangjie::Format::ApplyReplacements(before, replacements), after);
+        EXPECT_TRUE(Cangjie::Format::TextReplacements(after, after).empty());
+    }
+
+    TEST_F(FormatEditsTest, ReplacementsAtEndOfFile)
+    {
+        std::string before = "a\nb";
+        std::string after = "a\nb\n";
+        auto replacements = Cangjie::Format::TextReplacements(before, after);
+        ASSERT_EQ(replacements.size(), 1);
+        EXPECT_EQ(replacements[0].offset, 3);
+        EXPECT_EQ(replacements[0].length, 0);
+        EXPECT_EQ(replacements[0].text, "\n");
+        EXPECT_EQ(Cangjie::Format::ApplyReplacements(before, replacements), after);
+
+        replacements = Cangjie::Format::TextReplacements(after, before);
+        ASSERT_EQ(replacements.size(), 1);
+        EXPECT_EQ(replacements[0].offset, 3);
+        EXPECT_EQ(replacements[0].length, 1);
+        EXPECT_EQ(replacements[0].text, "");
+        EXPECT_EQ(Cangjie::Format::ApplyReplacements(after, replacements), before);
+    }
+
+    TEST_F(FormatEditsTest, NarrowingKeepsCrlfWhole)
+    {
+        // CRLF to LF replaces the whole line break rather than removing the CR alone
+        std::string before = "a\r\n";
+        TextReplacement replacement{0, before.size(), "a\n"};
+        Cangjie::Format::NarrowReplacement(before, replacement);
+        EXPECT_EQ(replacement.offset, 1);
+        EXPECT_EQ(replacement.length, 2);
+        EXPECT_EQ(replacement.text, "\n");
+    }
+
+    TEST_F(FormatEditsTest, NarrowingKeepsUtf8SequencesWhole)
+    {
+        // é and è share their first byte
+        std::string before = "x = \"é\"";
+        TextReplacement replacement{0, before.size(), "x = \"è\""};
+        Cangjie::Format::NarrowReplacement(before, replacement);
+        EXPECT_EQ(replacement.offset, 5);
+        EXPECT_EQ(replacement.length, 2);
+        EXPECT_EQ(replacement.text, "è");
+    }
+
+    TEST_F(FormatEditsTest, ReplacementRangesInUtf16)
+    {
+        std::string before = "let s = \"😀\"+1\n";
+        std::string after = "let s = \"😀\" + 1\n";
+        auto replacements = Cangjie::Format::TextReplacements(before, after);
+        ASSERT_EQ(replacements.size(), 1);
+        auto lineOffsets = ark::GetLineOffsets(before);
+        auto start = ark::GetPositionFromOffset(before, lineOffsets, replacements[0].offset);
+        auto end = ark::GetPositionFromOffset(before, lineOffsets, replacements[0].offset + replacements[0].length);
+        EXPECT_EQ(start.line, 0);
+        EXPECT_EQ(start.column, 12);
+        EXPECT_EQ(end.column, 13);
+        EXPECT_EQ(replacements[0].text, " + ");
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,229 @@
+# Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+# This source file is part of the Cangjie project, licensed under Apache-2.0
+# with Runtime Library Exception.
+#
+# See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+
+"""generate a large synthetic cjpm workspace and a replay trace exercising it"""
+
+import argparse
+import json
+import os
+import sys
+
+PROJECT_NAME = "bench"
+WORKSPACE_URI = "{{WORKSPACE_URI}}"
+
+CJPM_TOML = """[package]
+  cjc-version = "0.60.6"
+  name = "%s"
+  description = "synthetic workspace for lsp_replay.py"
+  version = "1.0.0"
+  target-dir = ""
+  src-dir = ""
+  output-type = "executable"
+  compile-option = ""
+  override-compile-option = ""
+  link-option = ""
+  [package.package-configuration]
+""" % PROJECT_NAME
+
+CAPABILITIES = {
+    "workspace": {"applyEdit": True, "workspaceEdit": {}, "didChangeWatchedFiles": {}, "symbol": {},
+                  "executeCommand": {}, "workspaceFolders": False, "configuration": False},
+    "textDocument": {
+        "synchronization": {"willSave": True, "willSaveWaitUntil": True, "didSave": True},
+        "completion": {"completionItem": {"snippetSupport": True}},
+        "hover": {}, "signatureHelp": {}, "references": {}, "documentHighlight": {"dynamicRegistration": True},
+        "definition": {}, "documentSymbol": {}, "rename": {"prepareSupport": True}, "callHierarchy": {},
+        "semanticTokens": {
+            "tokenTypes": ["namespace", "type", "class", "enum", "interface", "struct", "typeParameter",
+                           "parameter", "variable", "property", "enumMember", "event", "function", "method",
+                           "macro", "keyword", "modifier", "comment", "string", "number", "regexp", "operator",
+                           "member", "label"],
+            "tokenModifiers": ["declaration", "definition", "readonly", "static", "deprecated", "abstract",
+                               "async", "modification", "documentation", "defaultLibrary"],
+            "dynamicRegistration": True
+        }
+    }
+}
+
+
+class SourceFile:
+    """Text of one generated file and the positions the trace sends requests to."""
+
+    def __init__(self, rel_path):
+        self.rel_path = rel_path
+        self.lines = []
+        self.marks = {}
+
+    def add(self, line):
+        self.lines.append(line)
+
+    def mark(self, name, column):
+        self.marks.setdefault(name, (len(self.lines), column))
+
+    def text(self):
+        return "\n".join(self.lines) + "\n"
+
+    def uri(self):
+        return WORKSPACE_URI + "/" + self.rel_path
+
+
+def generate_file(pkg, index, classes):
+    source = SourceFile("src/pkg%d/file%d.cj" % (pkg, index))
+    source.add("package %s.pkg%d" % (PROJECT_NAME, pkg))
+    source.add("")
+    if pkg > 0:
+        source.add("import %s.pkg%d.*" % (PROJECT_NAME, pkg - 1))
+        source.add("")
+    source.add("public interface Shape%d_%d {" % (pkg, index))
+    source.add("    func area(): Int64")
+    source.add("}")
+    source.add("")
+    for c in range(classes):
+        name = "Item%d_%d_%d" % (pkg, index, c)
+        source.add("public class %s <: Shape%d_%d {" % (name, pkg, index))
+        source.add("    public var value: Int64 = %d" % c)
+        source.add("    public init(value: Int64) {")
+        source.add("        this.value = value")
+        source.add("    }")
+        source.add("    public func area(): Int64 {")
+        source.add("        value * %d" % (c + 1))
+        source.add("    }")
+        source.add("    public func combine(other: %s): Int64 {" % name)
+        source.add("        value + other.value")
+        source.add("    }")
+        source.add("}")
+        source.add("")
+        source.add("public func helper%d_%d_%d(x: Int64): Int64 {" % (pkg, index, c))
+        prefix = "    let item = "
+        source.mark("definition", len(prefix) + 1)
+        source.add(prefix + "%s(x)" % name)
+        body = "    let total = item.area() + item.combine(item)"
+        source.mark("hover", body.index("area") + 1)
+        source.mark("completion", body.index("area") + 2)
+        source.add(body)
+        if pkg > 0:
+            source.add("    total + helper%d_%d_%d(x)" % (pkg - 1, index, c))
+        else:
+            source.add("    total")
+        source.add("}")
+        source.add("")
+    return source
+
+
+def generate_main(packages, files):
+    source = SourceFile("src/main.cj")
+    source.add("package %s" % PROJECT_NAME)
+    source.add("")
+    source.add("import %s.pkg%d.*" % (PROJECT_NAME, packages - 1))
+    source.add("")
+    source.add("main(): Int64 {")
+    for index in range(files):
+        source.add("    helper%d_%d_0(%d)" % (packages - 1, index, index))
+    source.add("    return 0")
+    source.add("}")
+    return source
+
+
+class TraceWriter:
+    """Client messages in the format written by LSPServer --record."""
+
+    def __init__(self):
+        self.records = []
+        self.next_id = 0
+
+    def notify(self, method, params):
+        self.append({"jsonrpc": "2.0", "method": method, "params": params})
+
+    def request(self, method, params):
+        self.next_id += 1
+        self.append({"jsonrpc": "2.0", "id": self.next_id, "method": method, "params": params})
+
+    def append(self, message):
+        self.records.append({"time": len(self.records) * 1000, "direction": "recv", "message": message})
+
+    def write(self, path):
+        with open(path, "w", encoding="utf-8") as f:
+            for record in self.records:
+                f.write(json.dumps(record, ensure_ascii=False, separators=(",", ":")) + "\n")
+
+
+def position_params(source, mark):
+    line, character = source.marks[mark]
+    return {"textDocument": {"uri": source.uri()}, "position": {"line": line, "character": character}}
+
+
+def generate_trace(sources, open_files, rounds):
+    trace = TraceWriter()
+    trace.request("initialize", {"processId": None, "rootPath": "{{WORKSPACE}}", "rootUri": WORKSPACE_URI,
+                                 "capabilities": CAPABILITIES})
+    trace.notify("initialized", {})
+    opened = sources[-open_files:]
+    for source in opened:
+        trace.notify("textDocument/didOpen", {"textDocument": {"uri": source.uri(), "languageId": "Cangjie",
+                                                               "version": 0, "text": source.text()}})
+    for r in range(rounds):
+        for source in opened:
+            document = {"textDocument": {"uri": source.uri()}}
+            trace.request("textDocument/semanticTokens/full", document)
+            trace.request("textDocument/documentSymbol", document)
+            trace.request("textDocument/hover", position_params(source, "hover"))
+            trace.request("textDocument/definition", position_params(source, "definition"))
+            trace.request("textDocument/completion", position_params(source, "completion"))
+            references = position_params(source, "hover")
+            references["context"] = {"includeDeclaration": True}
+            trace.request("textDocument/references", references)
+            # an edit which keeps the file valid, so the next round works on a freshly compiled package
+            text = source.text() + "// round %d\n" % r
+            trace.notify("textDocument/didChange", {"textDocument": {"uri": source.uri(), "version": r + 1},
+                                                    "contentChanges": [{"text": text}]})
+    trace.request("shutdown", {})
+    trace.notify("exit", {})
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="directory of the generated workspace")
+    parser.add_argument("--packages", type=int, default=20, help="number of packages, each imports the previous")
+    parser.add_argument("--files", type=int, default=10, help="files per package")
+    parser.add_argument("--classes", type=int, default=10, help="classes per file")
+    parser.add_argument("--open-files", type=int, default=3, help="files opened by the trace")
+    parser.add_argument("--rounds", type=int, default=10, help="rounds of requests on every opened file")
+    args = parser.parse_args()
+    if args.packages < 1 or args.files < 1 or args.classes < 1:
+        print("packages, files and classes must be positive", file=sys.stderr)
+        return 1
+
+    sources = []
+    for pkg in range(args.packages):
+        for index in range(args.files):
+            sources.append(generate_file(pkg, index, args.classes))
+    sources.append(generate_main(args.packages, args.files))
+    os.makedirs(args.output, exist_ok=True)
+    with open(os.path.join(args.output, "cjpm.toml"), "w", encoding="utf-8") as f:
+        f.write(CJPM_TOML)
+    for source in sources:
+        path = os.path.join(args.output, source.rel_path)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(source.text())
+    # the last package holds the deepest dependency chain, requests go to its files
+    library = [s for s in sources if s.rel_path.startswith("src/pkg%d/" % (args.packages - 1))]
+    trace = generate_trace(library, min(args.open_files, len(library)), args.rounds)
+    trace_path = os.path.join(args.output, "replay.trace")
+    trace.write(trace_path)
+    lines = sum(len(s.lines) for s in sources)
+    print("generated %d files, %d lines, trace with %d messages: %s" % (len(sources), lines,
+                                                                        len(trace.records), trace_path))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,368 @@
+# Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+# This source file is part of the Cangjie project, licensed under Apache-2.0
+# with Runtime Library Exception.
+#
+# See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+
+"""replay a recorded JSON-RPC session against LSPServer and report latency, throughput and resource usage"""
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import threading
+import time
+from pathlib import Path
+from urllib.parse import quote
+
+IS_LINUX = platform.system() == "Linux"
+IS_MACOS = platform.system() == "Darwin"
+if not platform.system() == "Windows":
+    import resource
+
+WORKSPACE_PLACEHOLDER = "{{WORKSPACE}}"
+WORKSPACE_URI_PLACEHOLDER = "{{WORKSPACE_URI}}"
+FIRST_DIAGNOSTICS = "$/firstDiagnostics"
+PERCENTILES = (50, 95, 99)
+
+
+def path_to_uri(path):
+    path = Path(path).resolve().as_posix()
+    if not path.startswith("/"):
+        path = "/" + path
+    return "file://" + quote(path)
+
+
+def load_trace(trace_file, workspace, mappings):
+    """Read a trace written by LSPServer --record, or by gen_workspace.py, and return its messages."""
+    with open(trace_file, "r", encoding="utf-8") as f:
+        text = f.read()
+    if workspace:
+        text = text.replace(WORKSPACE_URI_PLACEHOLDER, path_to_uri(workspace))
+        text = text.replace(WORKSPACE_PLACEHOLDER, Path(workspace).resolve().as_posix())
+    for old, new in mappings:
+        text = text.replace(old, new)
+    records = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            records.append(json.loads(line))
+        except json.JSONDecodeError:
+            print("skip broken trace line: " + line[:80], file=sys.stderr)
+    return records
+
+
+def percentile(samples, p):
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    k = (len(ordered) - 1) * p / 100.0
+    low = int(k)
+    high = min(low + 1, len(ordered) - 1)
+    return ordered[low] + (ordered[high] - ordered[low]) * (k - low)
+
+
+class Session:
+    """One LSPServer process fed with the client side of a trace."""
+
+    def __init__(self, server_cmd, env, records, timeout):
+        self.records = records
+        self.timeout = timeout
+        self.process = subprocess.Popen(server_cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        stderr=subprocess.DEVNULL, env=env)
+        self.write_lock = threading.Lock()
+        self.cond = threading.Condition()
+        self.pending = {}
+        self.latencies = {}
+        self.errors = {}
+        self.timeouts = {}
+        self.first_diagnostics_at = None
+        self.peak_rss_kb = 0
+        # replies of the recorded client to requests sent by the server, per method
+        self.client_replies = {}
+        server_requests = {}
+        for record in records:
+            message = record.get("message", {})
+            if record.get("direction") == "send" and "method" in message and "id" in message:
+                server_requests[json.dumps(message["id"])] = message["method"]
+            elif record.get("direction") == "recv" and "method" not in message and "id" in message:
+                method = server_requests.get(json.dumps(message["id"]))
+                if method:
+                    self.client_replies.setdefault(method, []).append(message)
+        self.reader = threading.Thread(target=self.read_loop, daemon=True)
+        self.reader.start()
+
+    def send(self, message):
+        body = json.dumps(message, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+        with self.write_lock:
+            self.process.stdin.write(b"Content-Length: %d\r\n\r\n" % len(body))
+            self.process.stdin.write(body)
+            self.process.stdin.flush()
+
+    def read_message(self):
+        length = 0
+        while True:
+            line = self.process.stdout.readline()
+            if not line:
+                return None
+            line = line.strip()
+            if not line:
+                break
+            if line.lower().startswith(b"content-length:"):
+                length = int(line.split(b":", 1)[1])
+        return json.loads(self.process.stdout.read(length)) if length > 0 else {}
+
+    def read_loop(self):
+        while True:
+            try:
+                message = self.read_message()
+            except (ValueError, OSError):
+                message = None
+            if message is None:
+                with self.cond:
+                    # the server is gone, the requests still waiting never get a reply
+                    for method, _ in self.pending.values():
+                        self.errors[method] = self.errors.get(method, 0) + 1
+                    self.pending.clear()
+                    self.cond.notify_all()
+                return
+            now = time.perf_counter()
+            if "method" in message:
+                self.on_server_message(message, now)
+                continue
+            key = json.dumps(message.get("id"))
+            with self.cond:
+                started = self.pending.pop(key, None)
+                if started is not None:
+                    method, sent_at = started
+                    self.latencies.setdefault(method, []).append((now - sent_at) * 1000.0)
+                    if "error" in message:
+                        self.errors[method] = self.errors.get(method, 0) + 1
+                    self.cond.notify_all()
+
+    def on_server_message(self, message, now):
+        if message["method"] == "textDocument/publishDiagnostics" and self.first_diagnostics_at is None:
+            self.first_diagnostics_at = now
+        if "id" not in message:
+            return
+        # answer requests of the server the way the recorded client did
+        replies = self.client_replies.get(message["method"])
+        reply = {"jsonrpc": "2.0", "id": message["id"], "result": None}
+        if replies:
+            reply = dict(replies.pop(0))
+            reply["id"] = message["id"]
+        self.send(reply)
+
+    def sample_rss(self):
+        if not IS_LINUX:
+            return
+        try:
+            with open("/proc/%d/status" % self.process.pid, "r") as f:
+                for line in f:
+                    if line.startswith("VmHWM:"):
+                        self.peak_rss_kb = max(self.peak_rss_kb, int(line.split()[1]))
+        except OSError:
+            pass
+
+    def wait_for(self, key):
+        deadline = time.perf_counter() + self.timeout
+        with self.cond:
+            while key in self.pending:
+                remaining = deadline - time.perf_counter()
+                if remaining <= 0:
+                    method, _ = self.pending.pop(key)
+                    self.timeouts[method] = self.timeouts.get(method, 0) + 1
+                    print("timeout waiting for " + method, file=sys.stderr)
+                    return
+                self.cond.wait(remaining)
+
+    def run(self, pace, speed):
+        client_messages = [r for r in self.records if r.get("direction") == "recv"
+                           and "method" in r.get("message", {})]
+        start = time.perf_counter()
+        first_time = client_messages[0].get("time", 0) if client_messages else 0
+        for record in client_messages:
+            message = record["message"]
+            method = message["method"]
+            if pace == "recorded":
+                due = start + (record.get("time", 0) - first_time) / 1e6 / speed
+                delay = due - time.perf_counter()
+                if delay > 0:
+                    time.sleep(delay)
+            if method == "exit":
+                break
+            key = json.dumps(message["id"]) if "id" in message else None
+            if key is not None:
+                with self.cond:
+                    self.pending[key] = (method, time.perf_counter())
+            self.send(message)
+            self.sample_rss()
+            if key is not None and pace == "sequential":
+                self.wait_for(key)
+        for key in list(self.pending.keys()):
+            self.wait_for(key)
+        self.sample_rss()
+        wall = time.perf_counter() - start
+        if self.first_diagnostics_at is not None:
+            self.latencies[FIRST_DIAGNOSTICS] = [(self.first_diagnostics_at - start) * 1000.0]
+        self.stop()
+        return wall
+
+    def stop(self):
+        if self.process.poll() is None:
+            try:
+                self.send({"jsonrpc": "2.0", "id": "__replay_shutdown__", "method": "shutdown", "params": {}})
+                self.send({"jsonrpc": "2.0", "method": "exit", "params": {}})
+                self.process.stdin.close()
+            except OSError:
+                pass
+        try:
+            self.process.wait(timeout=self.timeout)
+        except subprocess.TimeoutExpired:
+            self.process.kill()
+            self.process.wait()
+
+
+def children_usage():
+    if platform.system() == "Windows":
+        return 0.0, 0.0, 0
+    usage = resource.getrusage(resource.RUSAGE_CHILDREN)
+    # ru_maxrss is in bytes on macOS and in kilobytes elsewhere
+    max_rss_kb = usage.ru_maxrss // 1024 if IS_MACOS else usage.ru_maxrss
+    return usage.ru_utime, usage.ru_stime, max_rss_kb
+
+
+def summarize(latencies, errors, timeouts):
+    methods = {}
+    # a method whose requests all failed or timed out has no latency but must still be reported
+    for method in sorted(set(latencies) | set(errors) | set(timeouts)):
+        samples = latencies.get(method, [])
+        entry = {"count": len(samples), "errors": errors.get(method, 0), "timeouts": timeouts.get(method, 0),
+                 "max": round(max(samples), 3) if samples else 0.0}
+        for p in PERCENTILES:
+            entry["p%d" % p] = round(percentile(samples, p), 3)
+        methods[method] = entry
+    return methods
+
+
+def compare(result, baseline, tolerance, min_delta_ms):
+    """Return the list of regressions of result against baseline."""
+    regressions = []
+    for method, base in baseline.get("methods", {}).items():
+        current = result["methods"].get(method)
+        if current is None:
+            regressions.append("%s: in the baseline but missing from this run" % method)
+            continue
+        for key in ("errors", "timeouts"):
+            if current.get(key, 0) > base.get(key, 0):
+                regressions.append("%s %s: %d -> %d" % (method, key, base.get(key, 0), current.get(key, 0)))
+        if current["count"] == 0 or base.get("count", 0) == 0:
+            continue
+        for key in ("p50", "p95"):
+            if current[key] > base[key] * (1 + tolerance) and current[key] - base[key] > min_delta_ms:
+                regressions.append("%s %s: %.1f ms -> %.1f ms" % (method, key, base[key], current[key]))
+    base_rss = baseline.get("peakRssKb", 0)
+    if base_rss and result["peakRssKb"] > base_rss * (1 + tolerance):
+        regressions.append("peak RSS: %d KB -> %d KB" % (base_rss, result["peakRssKb"]))
+    return regressions
+
+
+def print_report(result):
+    print("%-40s %7s %7s %8s %10s %10s %10s %10s" % ("method", "count", "errors", "timeouts", "p50 ms", "p95 ms",
+                                                     "p99 ms", "max ms"))
+    for method, entry in result["methods"].items():
+        print("%-40s %7d %7d %8d %10.1f %10.1f %10.1f %10.1f" % (method, entry["count"], entry["errors"],
+                                                                 entry["timeouts"], entry["p50"], entry["p95"],
+                                                                 entry["p99"], entry["max"]))
+    print("requests: %d in %.2f s, %.1f requests/s" % (result["requests"], result["wallSeconds"],
+                                                      result["throughput"]))
+    print("peak RSS: %d KB, CPU: %.2f s user, %.2f s system" % (result["peakRssKb"], result["cpuUserSeconds"],
+                                                                result["cpuSystemSeconds"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, usage="%(prog)s [options] trace [-- server arguments]")
+    parser.add_argument("trace", help="trace file recorded with LSPServer --record=<file> or by gen_workspace.py")
+    parser.add_argument("--server", required=True, help="path of the LSPServer binary")
+    parser.add_argument("--workspace", help="workspace substituted for {{WORKSPACE}} in the trace")
+    parser.add_argument("--map", action="append", default=[], metavar="OLD=NEW",
+                        help="replace OLD by NEW in the trace, e.g. the root of the recording machine")
+    parser.add_argument("--pace", choices=["sequential", "recorded"], default="sequential",
+                        help="wait for every reply before the next request, or keep the recorded timing")
+    parser.add_argument("--speed", type=float, default=1.0, help="speed up factor for --pace recorded")
+    parser.add_argument("--iterations", type=int, default=1, help="replay the trace this many times")
+    parser.add_argument("--timeout", type=float, default=600, help="seconds to wait for one reply")
+    parser.add_argument("--output", help="write the machine-readable result to this JSON file")
+    parser.add_argument("--baseline", help="result of an earlier run, exit with 1 when this run regresses")
+    parser.add_argument("--tolerance", type=float, default=0.2, help="allowed relative slowdown")
+    parser.add_argument("--min-delta-ms", type=float, default=5.0,
+                        help="latency differences below this are never reported as regressions")
+    # everything after "--" is passed to LSPServer as is
+    argv = sys.argv[1:]
+    server_args = []
+    if "--" in argv:
+        server_args = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    args = parser.parse_args(argv)
+
+    mappings = []
+    for item in args.map:
+        old, _, new = item.partition("=")
+        mappings.append((old, new))
+    records = load_trace(args.trace, args.workspace, mappings)
+    if not records:
+        print("trace is empty: " + args.trace, file=sys.stderr)
+        return 1
+
+    latencies = {}
+    errors = {}
+    timeouts = {}
+    wall = 0.0
+    peak_rss_kb = 0
+    for _ in range(max(1, args.iterations)):
+        session = Session([args.server] + server_args, dict(os.environ), records, args.timeout)
+        wall += session.run(args.pace, args.speed)
+        for method, samples in session.latencies.items():
+            latencies.setdefault(method, []).extend(samples)
+        for method, count in session.errors.items():
+            errors[method] = errors.get(method, 0) + count
+        for method, count in session.timeouts.items():
+            timeouts[method] = timeouts.get(method, 0) + count
+        peak_rss_kb = max(peak_rss_kb, session.peak_rss_kb)
+    user, system, max_rss_kb = children_usage()
+    requests = sum(len(s) for m, s in latencies.items() if m != FIRST_DIAGNOSTICS)
+    result = {
+        "trace": os.path.basename(args.trace),
+        "iterations": max(1, args.iterations),
+        "requests": requests,
+        "wallSeconds": round(wall, 3),
+        "throughput": round(requests / wall, 3) if wall > 0 else 0,
+        "peakRssKb": max(peak_rss_kb, max_rss_kb),
+        "cpuUserSeconds": round(user, 3),
+        "cpuSystemSeconds": round(system, 3),
+        "methods": summarize(latencies, errors, timeouts),
+    }
+    print_report(result)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            json.dump(result, f, indent=2)
+    if args.baseline:
+        with open(args.baseline, "r", encoding="utf-8") as f:
+            regressions = compare(result, json.load(f), args.tolerance, args.min_delta_ms)
+        for regression in regressions:
+            print("regression: " + regression, file=sys.stderr)
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,24 @@
+# Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+# This source file is part of the Cangjie project, licensed under Apache-2.0
+# with Runtime Library Exception.
+#
+# See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+# Run at build time as cmake -DVERSION=... -DSOURCE_DIR=... -DPARSER_LIB_DIR=... -DOUTPUT=... -P BuildFingerprint.cmake.
+# Writes OUTPUT, a header defining CJFMT_BUILD_FINGERPRINT as the hash of the version, of the content of the formatter
+# sources and of the Cangjie parser library: the format cache only trusts entries made by the same formatter.
+
+file(GLOB_RECURSE sources ${SOURCE_DIR}/src/*.cpp ${SOURCE_DIR}/include/*.h)
+file(GLOB parser_libs ${PARSER_LIB_DIR}/libcangjie-lsp.*)
+list(SORT sources)
+list(SORT parser_libs)
+
+set(build_id "${VERSION}")
+foreach (file ${sources} ${parser_libs})
+    file(SHA256 ${file} file_hash)
+    string(APPEND build_id ";${file_hash}")
+endforeach ()
+string(SHA256 fingerprint "${build_id}")
+
+file(WRITE ${OUTPUT} "// Generated by cmake/BuildFingerprint.cmake, do not edit.\n"
+        "#define CJFMT_BUILD_FINGERPRINT \"${fingerprint}\"\n")
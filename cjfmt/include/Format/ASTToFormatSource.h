@@ -73,8 +73,11 @@ public:
 
     ASTToFormatSource(RegionFormattingTracker& tracker, Cangjie::SourceManager& sm) : tracker(tracker), sm(sm) {}
     Doc ASTToDoc(Ptr<Cangjie::AST::Node> node, int level = 0, FuncOptions funcOptions = FuncOptions());
+    // doc is moved into a DocArena to be printed, it is left without members
     std::string DocToString(Doc& doc);
-    std::string DocToString(Doc& doc, int& pos, std::string& formatted);
+    // print cmd, or each of cmds in turn, from pos on
+    void DocToString(DocArena& arena, const DocCmd& cmd, int& pos, std::string& formatted);
+    void DocToString(DocArena& arena, const std::vector<DocCmd>& cmds, int& pos, std::string& formatted);
     void AddAnnotations(Doc& doc, const std::vector<OwnedPtr<Cangjie::AST::Annotation>>& annotations, int level,
         bool changeLine = true);
     static void AddCustomization(Doc& doc, const std::set<std::string>& customization, int level);
@@ -10,13 +10,21 @@
 #include "cangjie/Lex/Token.h"
 #include "cangjie/Basic/SourceManager.h"
 
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace Cangjie::Format {
 
+// indentWidth is the width of one indentation level, as in the options the code was formatted with
 std::string InsertComments(const std::vector<Cangjie::Token> &originalTokens,
-    const std::vector<Cangjie::Token> &formattedTokens, Cangjie::SourceManager &sm);
+    const std::vector<Cangjie::Token> &formattedTokens, Cangjie::SourceManager &sm, int indentWidth);
+
+// The tokens of printed, the code formatted from originalTokens and added to sm as fileID, taken from originalTokens
+// instead of lexing printed: the printer writes the tokens of the input in their order, with other blanks and maybe
+// without ';'. Empty if printed does not hold them like that, it is to be lexed then.
+std::optional<std::vector<Cangjie::Token>> TokensOfPrintedCode(const std::vector<Cangjie::Token> &originalTokens,
+    const std::string &printed, unsigned int fileID, Cangjie::SourceManager &sm);
 
 } // namespace Cangjie::Format
 
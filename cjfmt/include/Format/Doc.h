@@ -7,11 +7,13 @@
 #ifndef CJFMT_DOC_H
 #define CJFMT_DOC_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace Cangjie::Format {
 
+// An option changing the output also has to be part of the key of FormatCache, see OptionsFingerprint.
 struct FormattingOptions {
     int indentWidth{4};        // default indentation width
     int lineLength{120};       // default line width
@@ -21,6 +23,9 @@ struct FormattingOptions {
     bool multipleLineMethodChainOverLineLength = true;
 };
 
+// Formatting options of a file, by its path.
+using OptionsProvider = std::function<FormattingOptions(const std::string& filePath)>;
+
 struct FuncOptions {
     bool patternOrEnum;
     bool isLambda;
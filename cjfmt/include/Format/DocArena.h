@@ -0,0 +1,101 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_DOCARENA_H
+#define CJFMT_DOCARENA_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "Format/Doc.h"
+
+namespace Cangjie::Format {
+using DocId = uint32_t;
+
+// A node of a DocArena, its members are stored one after the other in the arena.
+struct DocNode {
+    DocType type = DocType::INVALID;
+    int indent{};
+    std::string_view value;
+    uint32_t firstMember{};
+    uint32_t memberCount{};
+    // display width of the value, and of the node with all its members printed flat
+    int valueWidth{};
+    int width{};
+    // whether a LINE is among the members, at any depth
+    bool hasLine{false};
+};
+
+// An entry of the print stack. A printer indents a node deeper than it was built by shift, and everything below it
+// by memberShift, instead of rewriting the indent of every node of the subtree.
+struct DocCmd {
+    DocId id{};
+    Mode mode{Mode::MODE_FLAT};
+    int shift{};
+    int memberShift{};
+};
+
+class DocMembers {
+public:
+    DocMembers(const DocId* first, uint32_t count) : first(first), count(count) {}
+    const DocId* begin() const { return first; }
+    const DocId* end() const { return first + count; }
+    uint32_t size() const { return count; }
+    DocId operator[](uint32_t i) const { return first[i]; }
+
+private:
+    const DocId* first;
+    uint32_t count;
+};
+
+// The Doc tree flattened for printing: nodes refer to their members by index and to their text by a view of the
+// interned texts. Widths are computed once when a node is added, so fit checks never walk a subtree again.
+class DocArena {
+public:
+    // Add doc and all its members, doc is left without members.
+    DocId Add(Doc& doc);
+
+    DocNode& operator[](DocId id)
+    {
+        return nodes[id];
+    }
+
+    DocMembers Members(DocId id) const
+    {
+        return DocMembers(members.data() + nodes[id].firstMember, nodes[id].memberCount);
+    }
+
+    // the i-th member of the node of cmd, shifted like everything below that node
+    DocCmd MemberOf(const DocCmd& cmd, uint32_t i, Mode mode) const
+    {
+        return DocCmd{members[nodes[cmd.id].firstMember + i], mode, cmd.memberShift, cmd.memberShift};
+    }
+
+    int IndentOf(const DocCmd& cmd) const
+    {
+        return nodes[cmd.id].indent + cmd.shift;
+    }
+
+    // Push the members of the node of cmd so that the first one is on top.
+    void PushMembers(const DocCmd& cmd, Mode mode, std::vector<DocCmd>& leftCmd) const
+    {
+        for (uint32_t i = nodes[cmd.id].memberCount; i > 0; --i) {
+            leftCmd.emplace_back(MemberOf(cmd, i - 1, mode));
+        }
+    }
+
+private:
+    std::vector<DocNode> nodes;
+    std::vector<DocId> members;
+    // ids of the members added so far of the nodes being added
+    std::vector<DocId> pending;
+    std::unordered_set<std::string> texts;
+};
+} // namespace Cangjie::Format
+
+#endif // CJFMT_DOCARENA_H
@@ -13,12 +13,12 @@ class ArgsProcessor : public DocProcessor {
 public:
     explicit ArgsProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : DocProcessor(astToFormatSource, options){};
-    void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) override;
-    void SoftLineProcessor(
-        std::string& formatted, int& pos, std::pair<Doc, Mode>& current, size_t& i, bool& haveNotChangedLine);
-    void SoftLineWithSpaceProcessor(
-        std::string& formatted, int& pos, std::pair<Doc, Mode>& current, size_t& i, bool& haveNotChangedLine);
+    void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) override;
+    void SoftLineProcessor(DocArena& arena, std::string& formatted, int& pos, const DocCmd& current,
+        std::vector<DocCmd>& args, size_t& i, bool& haveNotChangedLine);
+    void SoftLineWithSpaceProcessor(DocArena& arena, std::string& formatted, int& pos, const DocCmd& current,
+        std::vector<DocCmd>& args, size_t& i, bool& haveNotChangedLine);
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_ARGSPROCESSOR_H
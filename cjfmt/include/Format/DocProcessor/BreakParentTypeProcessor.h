@@ -13,8 +13,8 @@ class BreakParentTypeProcessor : public DocProcessor {
 public:
     explicit BreakParentTypeProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : DocProcessor(astToFormatSource, options){};
-    void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) override;
+    void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) override;
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_BREAKPARENTTYPEPROCESSOR_H
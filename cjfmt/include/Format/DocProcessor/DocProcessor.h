@@ -8,6 +8,7 @@
 #define CJFMT_DOCPROCESSOR_H
 
 #include "Format/Doc.h"
+#include "Format/DocArena.h"
 #include "cangjie/AST/ASTContext.h"
 #include "cangjie/AST/Node.h"
 #include "cangjie/Basic/Display.h"
@@ -21,12 +22,11 @@ public:
     explicit DocProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : astToFormatSource(astToFormatSource), options(options){};
     virtual ~DocProcessor() = default;
-    virtual void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) = 0;
+    virtual void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) = 0;
 
 protected:
-    bool Fits(const std::pair<Doc, Mode>& next, int rem);
-    int CalculateDocLen(Doc& doc);
+    bool Fits(DocArena& arena, const DocCmd& next, int rem);
 
     FormattingOptions& options;
     ASTToFormatSource& astToFormatSource;
@@ -13,8 +13,8 @@ class FuncArgProcessor : public DocProcessor {
 public:
     explicit FuncArgProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : DocProcessor(astToFormatSource, options){};
-    void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) override;
+    void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) override;
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_FUNCARGPROCESSOR_H
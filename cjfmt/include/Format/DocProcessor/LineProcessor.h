@@ -13,12 +13,11 @@ class LineProcessor : public DocProcessor {
 public:
     explicit LineProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : DocProcessor(astToFormatSource, options){};
-    void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) override;
+    void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) override;
 
 private:
-    void AddLine(
-        std::vector<std::pair<Doc, Mode>>& leftCmd, std::pair<Doc, Mode>& current, std::string& formatted, int& pos);
+    void AddLine(DocArena& arena, std::vector<DocCmd>& leftCmd, DocCmd& current, std::string& formatted, int& pos);
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_LINEPROCESSOR_H
@@ -13,11 +13,12 @@ class MemberAccessProcessor : public DocProcessor {
 public:
     explicit MemberAccessProcessor(ASTToFormatSource& astToFormatSource, FormattingOptions& options)
         : DocProcessor(astToFormatSource, options){};
-    void DocToString(std::string& formatted, int& pos, std::pair<Doc, Mode>& current,
-        std::vector<std::pair<Doc, Mode>>& leftCmd) override;
+    void DocToString(DocArena& arena, std::string& formatted, int& pos, DocCmd& current,
+        std::vector<DocCmd>& leftCmd) override;
 
 private:
-    void NonMethodChianProcessor(Doc& member, int& pos, std::string& formatted);
+    void NonMethodChianProcessor(
+        DocArena& arena, std::vector<std::vector<DocCmd>>& lst, size_t i, int& pos, std::string& formatted);
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_MEMBERACCESSPROCESSOR_H
@@ -0,0 +1,55 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_FORMATCACHE_H
+#define CJFMT_FORMATCACHE_H
+
+#include "Format/Doc.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Cangjie::Format {
+/* Contents known to format to themselves under this build of cjfmt and one set of formatting options, kept on disk
+ * between runs so that files already formatted are not lexed and parsed again. Each content is only known by its
+ * SHA-256 digest. Entries of a run are appended to the file, which is only rewritten when it has to restart. */
+class FormatCache {
+public:
+    FormatCache(const std::string& cacheDir, const FormattingOptions& options);
+
+    // Reads the entries saved by earlier runs, the cache starts empty if there are none or they can't be read.
+    void Load();
+    // Whether content was recorded as formatted. Safe to call from several threads once loaded.
+    [[nodiscard]] bool IsFormatted(const std::string& content) const;
+    // Records content, which formatting left unchanged.
+    void AddFormatted(const std::string& content);
+    // Appends the entries added since the last save to the file.
+    void Save();
+    // Whether the entries are valid for options.
+    [[nodiscard]] bool IsFor(const FormattingOptions& options) const;
+
+    // Per-user cache directory, empty if there is none.
+    static std::string DefaultDir();
+
+private:
+    using Key = std::string; // hex SHA-256 of the content
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    static Key KeyOf(const std::string& content);
+
+    std::string cacheDir;
+    std::string fingerprint; // of the options
+    std::string cachePath;
+    std::string header; // build and options the entries are valid for, the first line of the file
+    bool fileValid = false; // the file was read with this header, entries can be appended to it
+    std::unordered_set<Key, KeyHash> entries;
+    std::vector<Key> added;
+};
+} // namespace Cangjie::Format
+#endif // CJFMT_FORMATCACHE_H
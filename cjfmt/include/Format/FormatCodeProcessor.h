@@ -9,6 +9,8 @@
 
 #include "Format/ASTToFormatSource.h"
 #include "Format/Doc.h"
+#include "Format/FormatCache.h"
+#include "Format/FormatOutput.h"
 #include "cangjie/Basic/Print.h"
 #include "cangjie/Parse/Parser.h"
 #include "cangjie/Utils/FileUtil.h"
@@ -29,9 +31,22 @@ const int DEPTH_OF_RECURSION = 0;
  * configuration option later. */
 const int MAX_RECURSION_DEPTH = -1;
 
-int FmtDir(const std::string& fmtDirPath, const std::string& dirOutputPath);
-std::optional<std::string> FormatText(const std::string& rawCode, const std::string& filepath, Region regionToFormat);
-bool FormatFile(std::string& rawCode, const std::string& filepath, std::string& sourceFormat, Region regionToFormat);
+/* Formats the .cj files under fmtDirPath on jobs threads, each with the options optionsFor gives for it, diagnostics
+ * and output files follow the path order. In the check and diff modes nothing is written and ERR is returned if any
+ * file would change. Unless cacheDir is empty, files the cache there knows to be formatted are not parsed, those found
+ * formatted are added to it. */
+int FmtDir(const std::string& fmtDirPath, const std::string& dirOutputPath, const OptionsProvider& optionsFor,
+    unsigned int jobs = 1, OutputMode mode = OutputMode::WRITE, const std::string& cacheDir = "");
+// Formatted rawCode, nothing if it has syntax errors, which are printed unless emitDiagnostics is false.
+std::optional<std::string> FormatText(const std::string& rawCode, const std::string& filepath, Region regionToFormat,
+    const FormattingOptions& options, bool emitDiagnostics = true);
+/* Replacements formatting the lines of regionToFormat of rawCode, nothing if it has syntax errors. Only the top level
+ * declarations holding the region are parsed and formatted, so the cost follows the size of the region rather than
+ * that of the file. */
+std::optional<std::vector<TextReplacement>> FormatRegion(const std::string& rawCode, const std::string& filepath,
+    Region regionToFormat, const FormattingOptions& options, bool emitDiagnostics = true);
+bool FormatFile(std::string& rawCode, const std::string& filepath, std::string& sourceFormat, Region regionToFormat,
+    const FormattingOptions& options);
 bool HasEnding(std::string const& fullString, std::string const& ending);
 void TraveDepthLimitedDirs(
     const std::string& path, std::map<std::string, std::string>& fileMap, int depth, const int maxDepth);
@@ -0,0 +1,61 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_FORMATCONFIG_H
+#define CJFMT_FORMATCONFIG_H
+
+#include "Format/Doc.h"
+
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Cangjie::Format {
+// Name of the configuration of a project, looked up from the directory of a file being formatted upwards.
+inline const std::string PROJECT_CONFIG_NAME = "cangjie-format.toml";
+
+// The cangjie-format.toml of the directory of filePath or of the nearest of its parents, empty if there is none.
+std::string FindProjectConfig(const std::string& filePath);
+
+/* options with the values set in the configuration file at configPath, nullopt if it can't be read. A value missing or
+ * invalid is left as it is in options, with a message added to warnings. */
+std::optional<FormattingOptions> ReadFormatConfig(
+    const std::string& configPath, std::vector<std::string>& warnings, FormattingOptions options = {});
+
+/* The options of the project configurations of files, for tools formatting many files over time. A configuration
+ * file is parsed again only when it was modified. Safe to use from several threads. */
+class ProjectConfigs {
+public:
+    // Called with each configuration file parsed, its options and the warnings about its values.
+    using ReadCallback = std::function<void(
+        const std::string& configPath, const std::optional<FormattingOptions>& options, const std::vector<std::string>&)>;
+
+    explicit ProjectConfigs(ReadCallback onRead = nullptr) : onRead(std::move(onRead))
+    {
+    }
+
+    // Options of the nearest project configuration of filePath, nullopt if there is none or it can't be read.
+    std::optional<FormattingOptions> OptionsFor(const std::string& filePath);
+
+    // Options of the configuration file at configPath, nullopt if it can't be read.
+    std::optional<FormattingOptions> OptionsOf(const std::string& configPath);
+
+private:
+    struct ParsedConfig {
+        time_t modified;
+        std::optional<FormattingOptions> options;
+    };
+
+    ReadCallback onRead;
+    std::mutex mtx;
+    std::map<std::string, ParsedConfig> parsedConfigs;
+};
+} // namespace Cangjie::Format
+#endif // CJFMT_FORMATCONFIG_H
@@ -0,0 +1,52 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_FORMATOUTPUT_H
+#define CJFMT_FORMATOUTPUT_H
+
+#include <string>
+#include <vector>
+
+namespace Cangjie::Format {
+enum class OutputMode {
+    WRITE, // write the formatted text to the target, only when it differs from what is there
+    CHECK, // list the files whose formatted text differs from the source, write nothing
+    DIFF,  // print a unified diff of the files whose formatted text differs from the source, write nothing
+};
+
+/* Unified diff with three lines of context turning before into after, empty if they are equal. The paths are only
+ * used in the header lines. */
+std::string UnifiedDiff(const std::string& before, const std::string& after, const std::string& beforePath,
+    const std::string& afterPath);
+
+// Replaces the length bytes of a text at offset by text.
+struct TextReplacement {
+    size_t offset;
+    size_t length;
+    std::string text;
+};
+
+/* Replacements turning before into after, in increasing offset order and not overlapping, each applying to before.
+ * They follow the line diff of the two and are then narrowed to the bytes that differ, never splitting a UTF-8
+ * sequence or a CRLF, so that an editor applying them leaves the unchanged parts of a line and the cursor alone. */
+std::vector<TextReplacement> TextReplacements(const std::string& before, const std::string& after);
+
+// Drops the head and tail replacement shares with the bytes of before it replaces, at whole UTF-8 sequences and CRLFs.
+void NarrowReplacement(const std::string& before, TextReplacement& replacement);
+
+// text with the replacements applied, they have to be in increasing offset order and not overlap.
+std::string ApplyReplacements(const std::string& text, const std::vector<TextReplacement>& replacements);
+
+/* Writes content through a temporary file next to path which is then renamed over it, so readers never see a partly
+ * written file and a failed write leaves the old one in place. A symbolic link is kept, its target is written. */
+bool WriteFileAtomically(const std::string& linkPath, const std::string& content);
+
+/* Writes, lists or diffs the formatted text of sourcePath according to mode. changed tells whether formatting changes
+ * the file. Returns ERR only if the target could not be written. */
+int OutputFormatted(const std::string& sourcePath, const std::string& targetPath, const std::string& rawCode,
+    const std::string& formatted, OutputMode mode, bool& changed);
+} // namespace Cangjie::Format
+#endif // CJFMT_FORMATOUTPUT_H
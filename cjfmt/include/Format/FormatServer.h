@@ -0,0 +1,28 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_FORMATSERVER_H
+#define CJFMT_FORMATSERVER_H
+
+#include "Format/Doc.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace Cangjie::Format {
+/* Serves format requests read from in until it ends or a QUIT request comes, one response written to out for each.
+ * A request is the line
+ *     FORMAT <length> <region> <path>
+ * followed by the length bytes of the buffer to format, region being '-' for the whole buffer or start:end. The path
+ * is only used to find the formatting options and in diagnostics. The response is
+ *     OK <length>
+ * followed by the formatted buffer, or
+ *     ERROR <length>
+ * followed by a message, diagnostics go to the standard error. */
+int RunFormatServer(std::istream& in, std::ostream& out, const OptionsProvider& optionsFor);
+} // namespace Cangjie::Format
+#endif // CJFMT_FORMATSERVER_H
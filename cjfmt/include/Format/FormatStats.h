@@ -0,0 +1,79 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#ifndef CJFMT_FORMATSTATS_H
+#define CJFMT_FORMATSTATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+
+namespace Cangjie::Format {
+enum class FormatPhase : size_t {
+    LEX,       // lexing the input
+    PARSE,     // parsing the tokens
+    DOC_BUILD, // turning the AST into a Doc
+    PRINT,     // printing the Doc
+    COMMENTS,  // lexing the printed code and putting the comments back
+    PHASE_COUNT
+};
+
+/* Time spent in each phase of formatting, summed over the files formatted, for --stats. Memory is the growth of the
+ * peak resident size of the process while a phase ran, only meaningful when one file is formatted at a time. */
+class FormatStats {
+public:
+    void SetEnabled(bool enabled);
+    [[nodiscard]] bool IsEnabled() const noexcept;
+    void AddInput(size_t bytes);
+    void AddPhase(FormatPhase phase, double seconds, size_t peakGrowth);
+    /* One line per phase that ran with its time, the input bytes per second and its peak memory growth. A file with
+     * syntax errors is neither turned into a Doc nor printed, those phases are missing when no file got that far. */
+    void PrintReport(std::ostream& out) const;
+
+    static FormatStats& GetInstance() noexcept
+    {
+        static FormatStats instance;
+        return instance;
+    }
+
+private:
+    FormatStats() noexcept {};
+    ~FormatStats() = default;
+    FormatStats(const FormatStats&) = delete;
+    FormatStats& operator=(const FormatStats&) = delete;
+
+    struct PhaseStats {
+        double seconds{0};
+        size_t peakGrowth{0}; // bytes, the largest over the runs of the phase
+        size_t runs{0};
+    };
+
+    mutable std::mutex m_mtx; // the files of a directory are formatted on several threads
+    std::atomic<bool> m_enabled{false}; // read by every phase, without taking m_mtx
+    size_t m_inputBytes{0};
+    size_t m_files{0};
+    std::array<PhaseStats, static_cast<size_t>(FormatPhase::PHASE_COUNT)> m_phases;
+};
+
+// Adds the time from its construction to its destruction to phase, if the stats are enabled.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(FormatPhase phase);
+    ~PhaseTimer();
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    FormatPhase phase;
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+    size_t startPeak{0};
+};
+} // namespace Cangjie::Format
+#endif // CJFMT_FORMATSTATS_H
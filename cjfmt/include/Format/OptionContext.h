@@ -8,6 +8,7 @@
 #define CJFMT_OPTIONCONTEXT_H
 
 #include "Format/ASTToFormatSource.h"
+#include "Format/FormatOutput.h"
 
 #include <iostream>
 #include <string>
@@ -21,7 +22,13 @@ public:
     void SetDirOutputPath(const std::string& dirOutputPath);
     void SetConfigFilePath(const std::string& configFilePath);
     void SetCangjieHome(const std::string& cangjieHome);
-    void SetConfigOptions(const FormattingOptions& configOptions);
+    void SetJobs(unsigned int jobs);
+    void SetOutputMode(OutputMode outputMode);
+    void SetCacheDir(const std::string& cacheDir);
+    void SetUseCache(bool useCache);
+    void SetFromStdin(bool fromStdin);
+    void SetAssumeFilename(const std::string& assumeFilename);
+    void SetServerMode(bool serverMode);
 
     [[nodiscard]] const std::string& GetFmtFilePath() const;
     [[nodiscard]] const std::string& GetFileOutputPath() const;
@@ -29,7 +36,13 @@ public:
     [[nodiscard]] const std::string& GetDirOutputPath() const;
     [[nodiscard]] const std::string& GetConfigFilePath() const;
     [[nodiscard]] const std::string& GetCangjieHome() const;
-    [[nodiscard]] FormattingOptions GetConfigOptions() const noexcept;
+    [[nodiscard]] unsigned int GetJobs() const noexcept;
+    [[nodiscard]] OutputMode GetOutputMode() const noexcept;
+    [[nodiscard]] const std::string& GetCacheDir() const;
+    [[nodiscard]] bool GetUseCache() const noexcept;
+    [[nodiscard]] bool GetFromStdin() const noexcept;
+    [[nodiscard]] const std::string& GetAssumeFilename() const;
+    [[nodiscard]] bool GetServerMode() const noexcept;
 
     static OptionContext& GetInstance() noexcept
     {
@@ -49,7 +62,13 @@ private:
     std::string m_dirOutputPath;
     std::string m_configFilePath;
     std::string m_cangjieHome;
-    FormattingOptions m_configOptions;
+    unsigned int m_jobs{0}; // 0 until -j is given, then the hardware concurrency is used
+    OutputMode m_outputMode{OutputMode::WRITE};
+    std::string m_cacheDir; // empty until --cache-dir is given, then the per-user cache directory is used
+    bool m_useCache{true};
+    bool m_fromStdin{false};
+    std::string m_assumeFilename;
+    bool m_serverMode{false};
 };
 } // namespace Cangjie::Format
 #endif // CJFMT_OPTIONCONTEXT_H
@@ -39,7 +39,8 @@ public:
     std::vector<Token>::const_iterator outputIterator;
 
 private:
-    std::optional<std::vector<Token>> RecoverOnMismatch();
+    // realigns the iterators after the formatter dropped a token, comments skipped on the way go to skippedComments
+    void RecoverOnMismatch(std::vector<Token> &skippedComments);
 };
 
 // find subset of original tokens between [startPosition, endPosition] and corresponding subset of output tokens
@@ -303,37 +303,36 @@ void ASTToFormatSource::AddAnnotations(
 
 std::string ASTToFormatSource::DocToString(Doc& doc)
 {
-    std::vector<std::pair<Doc, Mode>> leftCmd;
+    DocArena arena;
+    DocCmd root{arena.Add(doc), Mode::MODE_FLAT};
     std::string formatted;
     int pos = 0;
-    leftCmd.emplace_back(std::pair<Doc, Mode>(doc, Mode::MODE_FLAT));
-    while (!leftCmd.empty()) {
-        std::pair<Doc, Mode> current = leftCmd.back();
-        leftCmd.pop_back();
-        if (toStringMap.find(current.first.type) != toStringMap.end()) {
-            toStringMap[current.first.type]->DocToString(formatted, pos, current, leftCmd);
-        }
-    }
+    DocToString(arena, root, pos, formatted);
     return formatted;
 }
 
-std::string ASTToFormatSource::DocToString(Doc& doc, int& pos, std::string& formatted)
+void ASTToFormatSource::DocToString(DocArena& arena, const DocCmd& cmd, int& pos, std::string& formatted)
 {
-    std::vector<std::pair<Doc, Mode>> leftCmd;
-    leftCmd.emplace_back(std::pair<Doc, Mode>(doc, Mode::MODE_FLAT));
+    DocToString(arena, std::vector<DocCmd>{cmd}, pos, formatted);
+}
+
+void ASTToFormatSource::DocToString(
+    DocArena& arena, const std::vector<DocCmd>& cmds, int& pos, std::string& formatted)
+{
+    std::vector<DocCmd> leftCmd(cmds.rbegin(), cmds.rend());
     while (!leftCmd.empty()) {
-        std::pair<Doc, Mode> current = leftCmd.back();
+        DocCmd current = leftCmd.back();
         leftCmd.pop_back();
-        if (toStringMap.find(current.first.type) != toStringMap.end()) {
-            toStringMap[current.first.type]->DocToString(formatted, pos, current, leftCmd);
+        auto processor = toStringMap.find(arena[current.id].type);
+        if (processor != toStringMap.end()) {
+            processor->second->DocToString(arena, formatted, pos, current, leftCmd);
         }
     }
-    return formatted;
 }
 
 void ASTToFormatSource::AddModifier(Doc& doc, const std::set<Cangjie::AST::Modifier>& modifiers, int level)
 {
-    static std::vector<std::set<TokenKind>> MODIFIER_PRIORITY = {
+    static const std::vector<std::set<TokenKind>> MODIFIER_PRIORITY = {
         {TokenKind::PUBLIC, TokenKind::PRIVATE, TokenKind::INTERNAL, TokenKind::PROTECTED, TokenKind::FOREIGN},
         {TokenKind::UNSAFE, TokenKind::MUT},
         {TokenKind::SEALED, TokenKind::OPEN, TokenKind::ABSTRACT, TokenKind::STATIC, TokenKind::OPERATOR},
@@ -341,7 +340,7 @@ void ASTToFormatSource::AddModifier(Doc& doc, const std::set<Cangjie::AST::Modif
         {TokenKind::OVERRIDE, TokenKind::REDEF}
     };
 
-    for (auto priority : MODIFIER_PRIORITY) {
+    for (const auto& priority : MODIFIER_PRIORITY) {
         for (auto modifier : modifiers) {
             if (priority.find(modifier.modifier) != priority.end()) {
                 AddModifier(doc, modifier, level);
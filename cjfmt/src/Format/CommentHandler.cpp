@@ -5,11 +5,12 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "Format/CommentHandler.h"
-#include "Format/OptionContext.h"
 #include "Format/SimultaneousIterator.h"
 #include "cangjie/Basic/DiagnosticEngine.h"
 
+#include <algorithm>
 #include <optional>
+#include <utility>
 
 namespace Cangjie::Format {
 using namespace Cangjie;
@@ -17,35 +18,42 @@ using namespace Cangjie::AST;
 
 namespace {
 const int MAX_LINEBREAKS = 2;
-OptionContext& g_optionContext = OptionContext::GetInstance();
-const int INDENT = g_optionContext.GetConfigOptions().indentWidth; // XXX: take from configuration
 
 bool IsClosing(const Token &token)
 {
     return token.kind == TokenKind::RCURL || token.kind == TokenKind::RPAREN || token.kind == TokenKind::RSQUARE;
 }
 
+// columns count characters
+int CountCharacters(const std::string &text)
+{
+    return static_cast<int>(std::count_if(
+        text.begin(), text.end(), [](char ch) { return (static_cast<unsigned char>(ch) & 0xC0) != 0x80; }));
+}
+
 bool IsMultilineComment(const Token &token)
 {
     // Extract first two characters (start at position 0, max length 2)
     return token.Value().substr(0, 2) == "/*" && token.Value().find('\n') != std::string::npos;
 }
 
+// Comments and the original tokens around them, which point into the original token stream rather than being
+// copied, the handler advances over every token of the file.
 struct InsertData {
-    std::optional<Token> tokenBefore;
-    std::optional<Token> tokenAfter;
+    const Token* tokenBefore; // nullptr at the start of the file
+    const Token* tokenAfter;  // nullptr at the end of the file
     std::vector<Token> comments;
 
-    InsertData(const std::optional<Token> tokenBefore, const std::optional<Token> tokenAfter,
-        const std::vector<Token> comments)
-        : tokenBefore(tokenBefore), tokenAfter(tokenAfter), comments(comments)
+    InsertData(const Token* tokenBefore, const Token* tokenAfter, std::vector<Token> comments)
+        : tokenBefore(tokenBefore), tokenAfter(tokenAfter), comments(std::move(comments))
     {}
 };
 
 class CommentHandler : private SimultaneousIterator {
 public:
-    CommentHandler(const std::vector<Token> &originalTokens, const std::vector<Token> &outputTokens, SourceManager &sm)
-        : SimultaneousIterator(originalTokens, outputTokens), sm(sm)
+    CommentHandler(const std::vector<Token> &originalTokens, const std::vector<Token> &outputTokens, SourceManager &sm,
+        int indentWidth)
+        : SimultaneousIterator(originalTokens, outputTokens), sm(sm), indentWidth(indentWidth)
     {
         this->outputText = "";
     }
@@ -57,9 +65,8 @@ public:
         }
         std::vector<Token> startOfFileComments = IterateAndCollectComments();
         if (!startOfFileComments.empty()) {
-            auto firstNonCommentToken =
-                originalIterator != originalTokens.end() ? std::optional(*originalIterator) : std::nullopt;
-            InsertComments(InsertData(std::nullopt, firstNonCommentToken, startOfFileComments));
+            auto firstNonCommentToken = originalIterator != originalTokens.end() ? &*originalIterator : nullptr;
+            InsertComments(InsertData(nullptr, firstNonCommentToken, std::move(startOfFileComments)));
         }
 
         if (outputIterator == outputTokens.end()) {
@@ -102,6 +109,7 @@ public:
 
 private:
     SourceManager &sm;
+    int indentWidth;
     std::string outputText;
 
     void Insert(char character, int times)
@@ -169,7 +177,7 @@ private:
         }
         auto firstOnThisLine = FindFirstTokenOnThisLine(tokenToIndent);
         auto sameIndent = (firstOnThisLine->Begin().column - 1);
-        auto oneLevelIndented = sameIndent + INDENT;
+        auto oneLevelIndented = sameIndent + indentWidth;
 
         if (!isComment && tokenToIndent == firstOnThisLine) {
             return sameIndent;
@@ -207,20 +215,15 @@ private:
 
     std::optional<InsertData> AdvanceAndComputeInsertData()
     {
-        std::optional<Token> tokenBefore = std::nullopt;
-
-        if (originalIterator != originalTokens.end()) {
-            tokenBefore = std::optional(*originalIterator);
-        }
+        const Token* tokenBefore = originalIterator != originalTokens.end() ? &*originalIterator : nullptr;
 
         auto commentsBetween = Advance();
         if (commentsBetween.empty()) {
             return std::nullopt;
         }
-        std::optional<Token> tokenAfter =
-            (originalIterator != originalTokens.end()) ? std::optional(*originalIterator) : std::nullopt;
+        const Token* tokenAfter = originalIterator != originalTokens.end() ? &*originalIterator : nullptr;
 
-        return InsertData(tokenBefore, tokenAfter, commentsBetween);
+        return InsertData(tokenBefore, tokenAfter, std::move(commentsBetween));
     }
 
     void EnsureSpaceAfterStar(std::string &line, size_t starPosition)
@@ -297,7 +300,7 @@ private:
 
         bool isReadyInsertNL = false;
         while (it != comments.end()) {
-            auto token = *it;
+            const auto& token = *it;
 
             // manage whitespace characters before each of the comments
             Position prevTokenPos;
@@ -345,9 +348,70 @@ private:
 }
 
 std::string InsertComments(const std::vector<Token> &originalTokens, const std::vector<Token> &formattedTokens,
-    SourceManager &sm)
+    SourceManager &sm, int indentWidth)
 {
-    auto commentHandler = CommentHandler(originalTokens, formattedTokens, sm);
+    auto commentHandler = CommentHandler(originalTokens, formattedTokens, sm, indentWidth);
     return commentHandler.DoInsert();
 }
+
+std::optional<std::vector<Token>> TokensOfPrintedCode(const std::vector<Token> &originalTokens,
+    const std::string &printed, unsigned int fileID, SourceManager &sm)
+{
+    std::vector<Token> tokens;
+    tokens.reserve(originalTokens.size());
+    size_t offset = 0;
+    int line = 1;
+    int column = 1;
+    // blanks between tokens, each line break is a token as when lexed
+    auto skipBlanks = [&]() {
+        while (offset < printed.size()) {
+            size_t length = printed.compare(offset, 2, "\r\n") == 0 ? 2 : (printed[offset] == '\n' ? 1 : 0);
+            if (length > 0) {
+                tokens.emplace_back(TokenKind::NL, printed.substr(offset, length), Position(fileID, line, column),
+                    Position(fileID, line, column + 1));
+                offset += length;
+                line++;
+                column = 1;
+            } else if (printed[offset] == ' ' || printed[offset] == '\t') {
+                offset++;
+                column++;
+            } else {
+                break;
+            }
+        }
+    };
+    for (auto &token : originalTokens) {
+        if (token.kind == TokenKind::COMMENT || token.kind == TokenKind::NL) {
+            continue;
+        }
+        skipBlanks();
+        if (token.kind == TokenKind::END) {
+            tokens.emplace_back(TokenKind::END, "", Position(fileID, line, column), Position(fileID, line, column));
+            continue;
+        }
+        // where a token spanning lines ends is left to the lexer
+        if (token.Begin().line != token.End().line) {
+            return std::nullopt;
+        }
+        int width = token.End().column - token.Begin().column;
+        const std::string &value = token.Value();
+        // the value of a literal is not its text, which is then taken from the source
+        std::string text = CountCharacters(value) == width ? value : sm.GetContentBetween(token.Begin(), token.End());
+        if (width <= 0 || printed.compare(offset, text.size(), text) != 0) {
+            if (token.kind == TokenKind::SEMI) {
+                continue;
+            }
+            return std::nullopt;
+        }
+        tokens.emplace_back(
+            token.kind, value, Position(fileID, line, column), Position(fileID, line, column + width));
+        offset += text.size();
+        column += width;
+    }
+    skipBlanks();
+    if (offset != printed.size()) {
+        return std::nullopt;
+    }
+    return tokens;
+}
 } // namespace Cangjie::Format
\ No newline at end of file
@@ -0,0 +1,39 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/DocArena.h"
+#include "cangjie/Basic/Display.h"
+
+namespace Cangjie::Format {
+DocId DocArena::Add(Doc& doc)
+{
+    size_t begin = pending.size();
+    int membersWidth = 0;
+    bool hasLine = false;
+    for (auto& member : doc.members) {
+        DocId id = Add(member);
+        pending.push_back(id);
+        membersWidth += nodes[id].width;
+        hasLine = hasLine || nodes[id].type == DocType::LINE || nodes[id].hasLine;
+    }
+    // the members are printed from here on, free them before the parent goes on with its next member
+    doc.members.clear();
+
+    DocNode node;
+    node.type = doc.type;
+    node.indent = doc.indent;
+    node.valueWidth = static_cast<int>(DisplayWidth(doc.value));
+    node.width = node.valueWidth + membersWidth;
+    node.hasLine = hasLine;
+    node.value = *texts.insert(std::move(doc.value)).first;
+    node.firstMember = static_cast<uint32_t>(members.size());
+    node.memberCount = static_cast<uint32_t>(pending.size() - begin);
+    members.insert(members.end(), pending.begin() + static_cast<std::ptrdiff_t>(begin), pending.end());
+    pending.resize(begin);
+    nodes.push_back(node);
+    return static_cast<DocId>(nodes.size() - 1);
+}
+} // namespace Cangjie::Format
@@ -10,50 +10,41 @@
 using namespace Cangjie::Format;
 
 namespace {
-void IncreaseIndent(Doc& doc)
+// the arguments after a broken line go one level deeper, along with everything below them
+void IncreaseIndent(DocArena& arena, std::vector<DocCmd>& args, size_t i, bool haveNotChangedLine)
 {
-    for (auto& member : doc.members) {
-        member.indent++;
-        IncreaseIndent(member);
+    for (size_t j = i + 1; j < args.size(); ++j) {
+        if (arena[args[j].id].type == DocType::FUNC_ARG && haveNotChangedLine) {
+            args[j].shift++;
+            args[j].memberShift++;
+        }
     }
 }
 } // namespace
 
-void ArgsProcessor::SoftLineProcessor(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, size_t& i, bool& haveNotChangedLine)
+void ArgsProcessor::SoftLineProcessor(DocArena& arena, std::string& formatted, int& pos, const DocCmd& current,
+    std::vector<DocCmd>& args, size_t& i, bool& haveNotChangedLine)
 {
-    std::pair<Doc, Mode> next(current.first.members[i + 1], current.second);
-    if (!Fits(next, options.lineLength - pos)) {
+    if (!Fits(arena, DocCmd{args[i + 1].id, current.mode}, options.lineLength - pos)) {
         formatted += options.newLine;
-        formatted += std::string(current.first.members[i].indent * options.indentWidth, ' ');
-        pos = current.first.members[i].indent * options.indentWidth;
-        for (size_t j = i + 1; j < current.first.members.size(); ++j) {
-            if (current.first.members[j].type == DocType::FUNC_ARG && haveNotChangedLine) {
-                current.first.members[j].indent++;
-                IncreaseIndent(current.first.members[j]);
-            }
-        }
+        formatted += std::string(arena.IndentOf(args[i]) * options.indentWidth, ' ');
+        pos = arena.IndentOf(args[i]) * options.indentWidth;
+        IncreaseIndent(arena, args, i, haveNotChangedLine);
         haveNotChangedLine = false;
     }
 }
 
-void ArgsProcessor::SoftLineWithSpaceProcessor(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, size_t& i, bool& haveNotChangedLine)
+void ArgsProcessor::SoftLineWithSpaceProcessor(DocArena& arena, std::string& formatted, int& pos,
+    const DocCmd& current, std::vector<DocCmd>& args, size_t& i, bool& haveNotChangedLine)
 {
-    std::pair<Doc, Mode> next(current.first.members[i + 1], current.second);
-    if (!Fits(next, options.lineLength - pos)) {
+    if (!Fits(arena, DocCmd{args[i + 1].id, current.mode}, options.lineLength - pos)) {
         formatted += options.newLine;
-        formatted += std::string(current.first.members[i].indent * options.indentWidth, ' ');
-        pos = current.first.members[i].indent * options.indentWidth;
-        for (size_t j = i + 1; j < current.first.members.size(); ++j) {
-            if (current.first.members[j].type == DocType::FUNC_ARG && haveNotChangedLine) {
-                current.first.members[j].indent++;
-                IncreaseIndent(current.first.members[j]);
-            }
-        }
+        formatted += std::string(arena.IndentOf(args[i]) * options.indentWidth, ' ');
+        pos = arena.IndentOf(args[i]) * options.indentWidth;
+        IncreaseIndent(arena, args, i, haveNotChangedLine);
         haveNotChangedLine = false;
     } else {
-        if (next.first.type != DocType::LINE) {
+        if (arena[args[i + 1].id].type != DocType::LINE) {
             formatted += " ";
             pos += 1;
         }
@@ -61,21 +52,27 @@ void ArgsProcessor::SoftLineWithSpaceProcessor(
 }
 
 void ArgsProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
+    std::vector<DocCmd> args;
+    uint32_t count = arena[current.id].memberCount;
+    args.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        args.emplace_back(arena.MemberOf(current, i, Mode::MODE_FLAT));
+    }
     bool haveNotChangedLine = true;
-    for (size_t i = 0; i < current.first.members.size(); ++i) {
-        if (current.first.members[i].type == DocType::SOFTLINE) {
-            if (current.first.members.size() == 1) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (arena[args[i].id].type == DocType::SOFTLINE) {
+            if (args.size() == 1) {
                 return;
             }
-            SoftLineProcessor(formatted, pos, current, i, haveNotChangedLine);
+            SoftLineProcessor(arena, formatted, pos, current, args, i, haveNotChangedLine);
             continue;
         }
-        if (current.first.members[i].type == DocType::SOFTLINE_WITH_SPACE) {
-            SoftLineWithSpaceProcessor(formatted, pos, current, i, haveNotChangedLine);
+        if (arena[args[i].id].type == DocType::SOFTLINE_WITH_SPACE) {
+            SoftLineWithSpaceProcessor(arena, formatted, pos, current, args, i, haveNotChangedLine);
             continue;
         }
-        astToFormatSource.DocToString(current.first.members[i], pos, formatted);
+        astToFormatSource.DocToString(arena, args[i], pos, formatted);
     }
 }
@@ -10,13 +10,13 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::BreakParentTypeProcessor::DocToString(std::string &formatted, int &pos,
-    std::pair<Doc, Mode> &current, std::vector<std::pair<Doc, Mode>> &)
+void Cangjie::Format::BreakParentTypeProcessor::DocToString(DocArena &arena, std::string &formatted, int &pos,
+    DocCmd &current, std::vector<DocCmd> &)
 {
-    if (current.second == Mode::MODE_BREAK) {
+    if (current.mode == Mode::MODE_BREAK) {
         formatted += options.newLine;
-        formatted += std::string(current.first.indent * options.indentWidth, ' ');
-        pos = current.first.indent * options.indentWidth;
+        formatted += std::string(arena.IndentOf(current) * options.indentWidth, ' ');
+        pos = arena.IndentOf(current) * options.indentWidth;
     }
 }
 }
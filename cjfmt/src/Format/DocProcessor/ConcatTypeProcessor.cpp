@@ -11,9 +11,7 @@
 using namespace Cangjie::Format;
 
 void ConcatTypeProcessor::DocToString(
-    std::string&, int&, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string&, int&, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
-    for (auto it = current.first.members.rbegin(); it != current.first.members.rend(); ++it) {
-        leftCmd.emplace_back(*it, current.second);
-    }
+    arena.PushMembers(current, current.mode, leftCmd);
 }
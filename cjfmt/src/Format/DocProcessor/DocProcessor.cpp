@@ -11,40 +11,43 @@
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
 
-bool DocProcessor::Fits(const std::pair<Doc, Mode>& next, int rem)
+bool DocProcessor::Fits(DocArena& arena, const DocCmd& next, int rem)
 {
-    std::vector<std::pair<Doc, Mode>> fitCmd;
-    fitCmd.emplace_back(next);
+    std::vector<std::pair<DocId, Mode>> fitCmd;
+    fitCmd.emplace_back(next.id, next.mode);
     while (rem >= 0) {
         if (fitCmd.empty()) {
             return true;
         }
-        std::pair<Doc, Mode> current = fitCmd.back();
+        auto [id, currentMode] = fitCmd.back();
         fitCmd.pop_back();
-        switch (current.first.type) {
+        const auto& current = arena[id];
+        switch (current.type) {
             case DocType::STRING:
-                rem -= static_cast<int>(current.first.value.length());
+                rem -= static_cast<int>(current.value.length());
                 return rem >= 0;
             case DocType::FUNC_ARG:
             case DocType::LAMBDA:
-            case DocType::CONCAT:
-                for (auto it = current.first.members.rbegin(); it != current.first.members.rend(); ++it) {
-                    fitCmd.emplace_back(*it, Mode::MODE_FLAT);
+            case DocType::CONCAT: {
+                auto members = arena.Members(id);
+                for (uint32_t i = members.size(); i > 0; --i) {
+                    fitCmd.emplace_back(members[i - 1], Mode::MODE_FLAT);
                 }
                 break;
+            }
             case DocType::LINE:
             case DocType::SEPARATE:
                 return true;
             case DocType::GROUP:
-                return rem - CalculateDocLen(current.first) > 0;
+                return rem - current.width > 0;
             case DocType::SOFTLINE_WITH_SPACE:
-                if (current.second == Mode::MODE_BREAK) {
+                if (currentMode == Mode::MODE_BREAK) {
                     return true;
                 }
                 rem -= 1;
                 break;
             case DocType::BREAK_PARENT:
-                if (current.second == Mode::MODE_BREAK) {
+                if (currentMode == Mode::MODE_BREAK) {
                     return true;
                 }
                 break;
@@ -54,14 +57,4 @@ bool DocProcessor::Fits(const std::pair<Doc, Mode>& next, int rem)
     }
     return false;
 }
-
-int DocProcessor::CalculateDocLen(Doc& doc)
-{
-    int len = 0;
-    len += static_cast<int>(DisplayWidth(doc.value));
-    for (auto& member : doc.members) {
-        len += CalculateDocLen(member);
-    }
-    return len;
-}
 } // namespace Cangjie::Format
@@ -9,8 +9,8 @@
 using namespace Cangjie::Format;
 
 void DotProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
-    formatted += current.first.value;
-    pos += static_cast<int>(DisplayWidth(current.first.value));
+    formatted += arena[current.id].value;
+    pos += arena[current.id].valueWidth;
 }
\ No newline at end of file
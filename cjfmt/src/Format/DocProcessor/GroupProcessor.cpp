@@ -10,11 +10,9 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::GroupProcessor::DocToString(std::string &, int &, std::pair<Doc, Mode> &current,
-    std::vector<std::pair<Doc, Mode>> &leftCmd)
+void Cangjie::Format::GroupProcessor::DocToString(DocArena &arena, std::string &, int &, DocCmd &current,
+    std::vector<DocCmd> &leftCmd)
 {
-    for (auto it = current.first.members.rbegin(); it != current.first.members.rend(); ++it) {
-        leftCmd.emplace_back(*it, Mode::MODE_FLAT);
-    }
+    arena.PushMembers(current, Mode::MODE_FLAT, leftCmd);
 }
 }
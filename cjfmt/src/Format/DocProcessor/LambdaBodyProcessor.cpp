@@ -9,56 +9,28 @@
 
 using namespace Cangjie::Format;
 
-namespace {
-bool hasLineType(Doc& doc)
-{
-    for (auto& member : doc.members) {
-        if (member.type == DocType::LINE) {
-            return true;
-        }
-        if (hasLineType(member)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-void IncreaseIndent(Doc& doc)
-{
-    for (auto& member : doc.members) {
-        member.indent++;
-        IncreaseIndent(member);
-    }
-}
-} // namespace
-
 void LambdaBodyProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
-    if (current.first.members.size() == 1) {
-        auto hasLine = hasLineType(current.first);
+    auto& body = arena[current.id];
+    if (body.memberCount == 1) {
+        auto hasLine = body.hasLine;
         auto rem = options.lineLength - pos;
-        bool overLength;
-        if (!hasLine) {
-            auto length = CalculateDocLen(current.first);
-            overLength = rem - length <= 0 ? true : false;
-        }
+        bool overLength = !hasLine && rem - body.width <= 0;
         if (hasLine || overLength) {
             formatted += options.newLine;
-            formatted += std::string((current.first.indent + 1) * options.indentWidth, ' ');
-            pos = (current.first.indent + 1) * options.indentWidth;
-        }
-        for (auto& member : current.first.members) {
-            astToFormatSource.DocToString(member, pos, formatted);
+            formatted += std::string((arena.IndentOf(current) + 1) * options.indentWidth, ' ');
+            pos = (arena.IndentOf(current) + 1) * options.indentWidth;
         }
+        astToFormatSource.DocToString(arena, arena.MemberOf(current, 0, Mode::MODE_FLAT), pos, formatted);
         if (hasLine || overLength) {
             formatted += options.newLine;
-            formatted += std::string(current.first.indent * options.indentWidth, ' ');
-            pos = current.first.indent * options.indentWidth;
+            formatted += std::string(arena.IndentOf(current) * options.indentWidth, ' ');
+            pos = arena.IndentOf(current) * options.indentWidth;
         }
     } else {
-        for (auto& member : current.first.members) {
-            astToFormatSource.DocToString(member, pos, formatted);
+        for (uint32_t i = 0; i < body.memberCount; ++i) {
+            astToFormatSource.DocToString(arena, arena.MemberOf(current, i, Mode::MODE_FLAT), pos, formatted);
         }
     }
 }
\ No newline at end of file
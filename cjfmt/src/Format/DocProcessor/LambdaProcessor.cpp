@@ -8,9 +8,7 @@
 using namespace Cangjie::Format;
 
 void LambdaProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
-    for (auto it = current.first.members.rbegin(); it != current.first.members.rend(); ++it) {
-        leftCmd.emplace_back(*it, current.second);
-    }
+    arena.PushMembers(current, current.mode, leftCmd);
 }
\ No newline at end of file
@@ -8,11 +8,11 @@
 using namespace Cangjie::Format;
 
 void LineDotProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
     formatted += options.newLine;
-    formatted += std::string(current.first.indent * options.indentWidth, ' ');
-    pos = current.first.indent * options.indentWidth;
-    formatted += current.first.value;
-    pos += static_cast<int>(DisplayWidth(current.first.value));
+    formatted += std::string(arena.IndentOf(current) * options.indentWidth, ' ');
+    pos = arena.IndentOf(current) * options.indentWidth;
+    formatted += arena[current.id].value;
+    pos += arena[current.id].valueWidth;
 }
\ No newline at end of file
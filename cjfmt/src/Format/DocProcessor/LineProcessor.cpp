@@ -10,23 +10,21 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::LineProcessor::DocToString(std::string &formatted, int &pos, std::pair<Doc, Mode> &current,
-    std::vector<std::pair<Doc, Mode>> &leftCmd)
+void Cangjie::Format::LineProcessor::DocToString(DocArena &arena, std::string &formatted, int &pos,
+    DocCmd &current, std::vector<DocCmd> &leftCmd)
 {
-    AddLine(leftCmd, current, formatted, pos);
+    AddLine(arena, leftCmd, current, formatted, pos);
 }
 
-void LineProcessor::AddLine(std::vector<std::pair<Doc, Mode>> &leftCmd, std::pair<Doc, Mode> &current,
-    std::string &formatted, int &pos)
+void LineProcessor::AddLine(DocArena &arena, std::vector<DocCmd> &leftCmd, DocCmd &current, std::string &formatted,
+    int &pos)
 {
-    if (!leftCmd.empty()) {
-        while (leftCmd.back().first.type == DocType::LINE) {
-            current = leftCmd.back();
-            leftCmd.pop_back();
-        }
+    while (!leftCmd.empty() && arena[leftCmd.back().id].type == DocType::LINE) {
+        current = leftCmd.back();
+        leftCmd.pop_back();
     }
     formatted += options.newLine;
-    formatted += std::string(current.first.indent * options.indentWidth, ' ');
-    pos = current.first.indent * options.indentWidth;
+    formatted += std::string(arena.IndentOf(current) * options.indentWidth, ' ');
+    pos = arena.IndentOf(current) * options.indentWidth;
 }
 }
@@ -10,23 +10,26 @@
 using namespace Cangjie::Format;
 
 namespace {
-void ParserCurrent(Doc& doc, Doc& ma)
+void ParserCurrent(DocArena& arena, const DocCmd& cmd, std::vector<DocCmd>& ma)
 {
-    if (doc.type == DocType::CONCAT || doc.type == DocType::GROUP || doc.type == DocType::MEMBER_ACCESS) {
-        for (auto& member : doc.members) {
-            ParserCurrent(member, ma);
+    auto type = arena[cmd.id].type;
+    if (type == DocType::CONCAT || type == DocType::GROUP || type == DocType::MEMBER_ACCESS) {
+        for (uint32_t i = 0; i < arena[cmd.id].memberCount; ++i) {
+            ParserCurrent(arena, arena.MemberOf(cmd, i, Mode::MODE_FLAT), ma);
         }
     } else {
-        ma.members.emplace_back(doc);
+        ma.emplace_back(cmd);
     }
 }
 
-void SplitVectorByFisrtDot(const std::vector<Doc>& original, std::vector<Doc>& firstHalf, std::vector<Doc>& secondHalf)
+void SplitVectorByFisrtDot(DocArena& arena, const std::vector<DocCmd>& original, std::vector<DocCmd>& firstHalf,
+    std::vector<DocCmd>& secondHalf)
 {
-    auto it = std::find_if(original.begin(), original.end(), [](const Doc& doc) { return doc.value == "."; });
+    auto it = std::find_if(
+        original.begin(), original.end(), [&arena](const DocCmd& cmd) { return arena[cmd.id].value == "."; });
     if (it != original.end()) {
         auto index = std::distance(original.begin(), it);
-        if (index > 0 && original[index - 1].type == DocType::LINE) {
+        if (index > 0 && arena[original[index - 1].id].type == DocType::LINE) {
             index--;
         }
         firstHalf.assign(original.begin(), original.begin() + index);
@@ -34,128 +37,162 @@ void SplitVectorByFisrtDot(const std::vector<Doc>& original, std::vector<Doc>& f
     }
 }
 
-void IncreaseIndent(Doc& doc)
+// a part of the chain is either a dot, or the items between two dots, which are never a dot
+bool IsDot(DocArena& arena, const std::vector<DocCmd>& part)
 {
-    for (auto& member : doc.members) {
-        member.indent++;
-        IncreaseIndent(member);
+    return arena[part.front().id].value == ".";
+}
+
+// indent the members of a dot, or the items between two dots and their members, one level deeper
+void IncreaseIndent(DocArena& arena, std::vector<DocCmd>& part)
+{
+    if (IsDot(arena, part)) {
+        part.front().memberShift++;
+        return;
+    }
+    for (auto& item : part) {
+        item.shift++;
+        item.memberShift++;
     }
 }
 
-void MemberAccessAddParentheses(std::vector<std::pair<Doc, Mode>>& leftCmd, Doc& ma)
+// move the next doc to print into ma, it is printed flat with ma
+void MoveLeftCmd(std::vector<DocCmd>& leftCmd, std::vector<DocCmd>& ma)
 {
-    if (!leftCmd.empty() && leftCmd.back().first.value == "(") {
-        ma.members.emplace_back(leftCmd.back().first);
-        leftCmd.pop_back();
-        while (leftCmd.back().first.value != ")") {
-            ma.members.emplace_back(leftCmd.back().first);
-            leftCmd.pop_back();
+    ma.emplace_back(leftCmd.back());
+    ma.back().mode = Mode::MODE_FLAT;
+    leftCmd.pop_back();
+}
+
+bool NextValueIs(DocArena& arena, const std::vector<DocCmd>& leftCmd, std::string_view value)
+{
+    return !leftCmd.empty() && arena[leftCmd.back().id].value == value;
+}
+
+void MemberAccessAddParentheses(DocArena& arena, std::vector<DocCmd>& leftCmd, std::vector<DocCmd>& ma)
+{
+    if (NextValueIs(arena, leftCmd, "(")) {
+        MoveLeftCmd(leftCmd, ma);
+        while (!leftCmd.empty() && !NextValueIs(arena, leftCmd, ")")) {
+            MoveLeftCmd(leftCmd, ma);
+        }
+        if (!leftCmd.empty()) {
+            MoveLeftCmd(leftCmd, ma);
         }
-        ma.members.emplace_back(leftCmd.back().first);
-        leftCmd.pop_back();
     }
 
-    if (!leftCmd.empty() && leftCmd.back().first.value == " ") {
-        ma.members.emplace_back(leftCmd.back().first);
-        leftCmd.pop_back();
-        if (!leftCmd.empty() && leftCmd.back().first.type == DocType::LAMBDA) {
-            ma.members.emplace_back(leftCmd.back().first);
-            leftCmd.pop_back();
+    if (NextValueIs(arena, leftCmd, " ")) {
+        MoveLeftCmd(leftCmd, ma);
+        if (!leftCmd.empty() && arena[leftCmd.back().id].type == DocType::LAMBDA) {
+            MoveLeftCmd(leftCmd, ma);
         }
     }
 }
 
-int SplitVectorByDOT(Doc& secondHalf, Doc& contact, std::vector<Doc>& lst)
+int SplitVectorByDOT(DocArena& arena, const std::vector<DocCmd>& secondHalf, std::vector<std::vector<DocCmd>>& lst)
 {
     int count = 0;
-    for (auto& member : secondHalf.members) {
-        if (member.value == ".") {
+    std::vector<DocCmd> contact;
+    for (auto& member : secondHalf) {
+        if (arena[member.id].value == ".") {
             count++;
-            if (!contact.members.empty()) {
-                lst.emplace_back(contact);
-                contact.members.clear();
+            if (!contact.empty()) {
+                lst.emplace_back(std::move(contact));
+                contact.clear();
             }
-            lst.emplace_back(member);
+            lst.emplace_back(1, member);
         } else {
-            contact.members.emplace_back(member);
+            contact.emplace_back(member);
         }
     }
-    if (!contact.members.empty()) {
-        lst.emplace_back(contact);
+    if (!contact.empty()) {
+        lst.emplace_back(std::move(contact));
     }
     return count;
 }
 
-void MethodChainProcessor(Doc& member)
+void MethodChainProcessor(DocArena& arena, std::vector<DocCmd>& member)
 {
-    if (member.type == DocType::DOT) {
-        member.indent++;
-        member.type = DocType::LINE_DOT;
-    }
-    for (auto& mem : member.members) {
-        mem.indent++;
-        IncreaseIndent(mem);
+    if (IsDot(arena, member) && arena[member.front().id].type == DocType::DOT) {
+        member.front().shift++;
+        arena[member.front().id].type = DocType::LINE_DOT;
     }
+    IncreaseIndent(arena, member);
 }
 }
 
-void MemberAccessProcessor::NonMethodChianProcessor(Doc& member, int& pos, std::string& formatted)
+void MemberAccessProcessor::NonMethodChianProcessor(
+    DocArena& arena, std::vector<std::vector<DocCmd>>& lst, size_t i, int& pos, std::string& formatted)
 {
-    if (member.type == DocType::DOT) {
+    if (!IsDot(arena, lst[i]) || i + 1 >= lst.size()) {
+        return;
+    }
+    auto& dot = lst[i].front();
+    auto& next = lst[i + 1];
+    if (arena[dot.id].type == DocType::DOT) {
         int l = 0;
-        for (auto& item : std::next(&member)->members) {
-            if (item.type == DocType::LINE || item.type == DocType::SOFTLINE ||
-                item.type == DocType::SOFTLINE_WITH_SPACE || item.type == DocType::DOT ||
-                item.type == DocType::LINE_DOT) {
+        std::vector<DocId> nextItems;
+        if (IsDot(arena, next)) {
+            auto members = arena.Members(next.front().id);
+            nextItems.assign(members.begin(), members.end());
+        } else {
+            for (auto& item : next) {
+                nextItems.emplace_back(item.id);
+            }
+        }
+        for (auto id : nextItems) {
+            auto type = arena[id].type;
+            if (type == DocType::LINE || type == DocType::SOFTLINE || type == DocType::SOFTLINE_WITH_SPACE ||
+                type == DocType::DOT || type == DocType::LINE_DOT) {
                 break;
             }
-            l += static_cast<int>(DisplayWidth(item.value));
+            l += arena[id].valueWidth;
         }
         if (options.lineLength - pos - l <= 0) {
             formatted += options.newLine;
-            formatted += std::string((member.indent + 1) * options.indentWidth, ' ');
-            pos = (member.indent + 1) * options.indentWidth;
-            IncreaseIndent(*std::next(&member));
+            formatted += std::string((arena.IndentOf(dot) + 1) * options.indentWidth, ' ');
+            pos = (arena.IndentOf(dot) + 1) * options.indentWidth;
+            IncreaseIndent(arena, next);
         }
-    } else if (member.type == DocType::LINE_DOT) {
-        IncreaseIndent(*std::next(&member));
+    } else if (arena[dot.id].type == DocType::LINE_DOT) {
+        IncreaseIndent(arena, next);
     }
 }
 
 void MemberAccessProcessor::DocToString(
-    std::string& formatted, int& pos, std::pair<Doc, Mode>& current, std::vector<std::pair<Doc, Mode>>& leftCmd)
+    DocArena& arena, std::string& formatted, int& pos, DocCmd& current, std::vector<DocCmd>& leftCmd)
 {
-    Doc ma;
-    for (auto& member : current.first.members) {
-        ParserCurrent(member, ma);
+    std::vector<DocCmd> ma;
+    for (uint32_t i = 0; i < arena[current.id].memberCount; ++i) {
+        ParserCurrent(arena, arena.MemberOf(current, i, Mode::MODE_FLAT), ma);
     }
 
     // if methodChain expr is a.b().c(xxx)
     // ma will be a.b().c, so need to add (xxx) to ma;
-    MemberAccessAddParentheses(leftCmd, ma);
+    MemberAccessAddParentheses(arena, leftCmd, ma);
 
     // e.g. a.b().c().d()
-    Doc firstHalf;  // firstHalf is a
-    Doc secondHalf; // secondHalf is .b().c().d()
-    SplitVectorByFisrtDot(ma.members, firstHalf.members, secondHalf.members);
+    std::vector<DocCmd> firstHalf;  // firstHalf is a
+    std::vector<DocCmd> secondHalf; // secondHalf is .b().c().d()
+    SplitVectorByFisrtDot(arena, ma, firstHalf, secondHalf);
 
-    firstHalf.type = DocType::CONCAT;
-    astToFormatSource.DocToString(firstHalf, pos, formatted);
+    astToFormatSource.DocToString(arena, firstHalf, pos, formatted);
 
     auto rem = options.lineLength - pos;
-    auto length = CalculateDocLen(secondHalf);
+    int length = 0;
+    for (auto& member : secondHalf) {
+        length += arena[member.id].width;
+    }
 
-    std::vector<Doc> lst;
-    Doc contact;
-    contact.type = DocType::CONCAT;
-    int count = SplitVectorByDOT(secondHalf, contact, lst);
+    std::vector<std::vector<DocCmd>> lst;
+    int count = SplitVectorByDOT(arena, secondHalf, lst);
 
-    for (auto& member : lst) {
+    for (size_t i = 0; i < lst.size(); ++i) {
         if (rem - length <= 0 && count > 1 && options.multipleLineMethodChainOverLineLength) {
-            MethodChainProcessor(member);
+            MethodChainProcessor(arena, lst[i]);
         } else {
-            NonMethodChianProcessor(member, pos, formatted);
+            NonMethodChianProcessor(arena, lst, i, pos, formatted);
         }
-        astToFormatSource.DocToString(member, pos, formatted);
+        astToFormatSource.DocToString(arena, lst[i], pos, formatted);
     }
 }
\ No newline at end of file
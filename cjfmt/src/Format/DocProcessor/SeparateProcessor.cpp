@@ -10,8 +10,8 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::SeparateProcessor::DocToString(std::string &formatted, int &pos, std::pair<Doc, Mode> &,
-    std::vector<std::pair<Doc, Mode>> &)
+void Cangjie::Format::SeparateProcessor::DocToString(DocArena &, std::string &formatted, int &pos, DocCmd &,
+    std::vector<DocCmd> &)
 {
     formatted += options.newLine;
     pos = 0;
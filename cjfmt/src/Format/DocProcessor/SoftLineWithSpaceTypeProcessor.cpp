@@ -10,16 +10,16 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::SoftLineWithSpaceTypeProcessor::DocToString(std::string &formatted, int &pos,
-    std::pair<Doc, Mode> &current, std::vector<std::pair<Doc, Mode>> &leftCmd)
+void Cangjie::Format::SoftLineWithSpaceTypeProcessor::DocToString(DocArena &arena, std::string &formatted,
+    int &pos, DocCmd &current, std::vector<DocCmd> &leftCmd)
 {
-    auto next = leftCmd.back();
-    if (!Fits(next, options.lineLength - pos)) {
+    auto& next = leftCmd.back();
+    if (!Fits(arena, next, options.lineLength - pos)) {
         formatted += options.newLine;
-        formatted += std::string(current.first.indent * options.indentWidth, ' ');
-        pos = current.first.indent * options.indentWidth;
+        formatted += std::string(arena.IndentOf(current) * options.indentWidth, ' ');
+        pos = arena.IndentOf(current) * options.indentWidth;
     } else {
-        if (next.first.type != DocType::LINE) {
+        if (arena[next.id].type != DocType::LINE) {
             formatted += " ";
             pos += 1;
         }
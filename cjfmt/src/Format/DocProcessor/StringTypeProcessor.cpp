@@ -10,10 +10,10 @@
 
 namespace Cangjie::Format {
 using namespace Cangjie::AST;
-void Cangjie::Format::StringTypeProcessor::DocToString(std::string &formatted, int &pos, std::pair<Doc, Mode> &current,
-    std::vector<std::pair<Doc, Mode>> &)
+void Cangjie::Format::StringTypeProcessor::DocToString(DocArena &arena, std::string &formatted, int &pos,
+    DocCmd &current, std::vector<DocCmd> &)
 {
-    formatted += current.first.value;
-    pos += static_cast<int>(DisplayWidth(current.first.value));
+    formatted += arena[current.id].value;
+    pos += arena[current.id].valueWidth;
 }
 }
@@ -0,0 +1,243 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/FormatCache.h"
+#include "Format/BuildFingerprint.h"
+#include "Format/FormatOutput.h"
+#include "cangjie/Utils/FileUtil.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace Cangjie::Format {
+namespace {
+/* Entries kept in a cache file, 65 bytes each on disk. Past it the file restarts with the entries of the current run,
+ * which drops the contents of files edited since. */
+const size_t MAX_CACHE_ENTRIES = 1 << 18;
+const size_t DIGEST_HEX_SIZE = 64;
+
+#ifdef _WIN32
+const std::string DELIMITER = "\\";
+#else
+const std::string DELIMITER = "/";
+#endif
+
+// Every option that changes the output, a new member of FormattingOptions has to be added here.
+std::string OptionsFingerprint(const FormattingOptions& options)
+{
+    std::ostringstream out;
+    out << "indentWidth=" << options.indentWidth << ";lineLength=" << options.lineLength
+        << ";newLine=" << (options.newLine == "\n" ? "LF" : "CRLF")
+        << ";allowMultiLineMethodChain=" << options.allowMultiLineMethodChain
+        << ";multipleLineMethodChainLevel=" << options.multipleLineMethodChainLevel
+        << ";multipleLineMethodChainOverLineLength=" << options.multipleLineMethodChainOverLineLength;
+    return out.str();
+}
+
+std::string ToHex(size_t value)
+{
+    std::ostringstream out;
+    out << std::hex << value;
+    return out.str();
+}
+
+// SHA-256 as in FIPS 180-4.
+class Sha256 {
+public:
+    std::string HexDigest(const std::string& data)
+    {
+        const size_t blockSize = 64;
+        size_t full = data.size() / blockSize * blockSize;
+        for (size_t i = 0; i < full; i += blockSize) {
+            Block(reinterpret_cast<const uint8_t*>(data.data()) + i);
+        }
+        // the rest, a 1 bit, zeros and the length in bits, in one or two blocks
+        std::array<uint8_t, blockSize * 2> tail{};
+        size_t rest = data.size() - full;
+        (void)std::memcpy(tail.data(), data.data() + full, rest);
+        tail[rest] = 0x80;
+        size_t tailSize = rest + 1 + sizeof(uint64_t) <= blockSize ? blockSize : blockSize * 2;
+        uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+            tail[tailSize - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+        }
+        for (size_t i = 0; i < tailSize; i += blockSize) {
+            Block(tail.data() + i);
+        }
+        static const char* const digits = "0123456789abcdef";
+        std::string hex;
+        for (uint32_t word : state) {
+            for (int shift = 28; shift >= 0; shift -= 4) {
+                hex.push_back(digits[(word >> shift) & 0xf]);
+            }
+        }
+        return hex;
+    }
+
+private:
+    static uint32_t Rotr(uint32_t x, int n)
+    {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    void Block(const uint8_t* block)
+    {
+        static const uint32_t k[64] = {0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+            0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+            0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa,
+            0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+            0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb,
+            0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624,
+            0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+            0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb,
+            0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+                (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | static_cast<uint32_t>(block[i * 4 + 3]);
+        }
+        for (size_t i = 16; i < 64; ++i) {
+            uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        auto v = state;
+        for (size_t i = 0; i < 64; ++i) {
+            uint32_t s1 = Rotr(v[4], 6) ^ Rotr(v[4], 11) ^ Rotr(v[4], 25);
+            uint32_t ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            uint32_t t1 = v[7] + s1 + ch + k[i] + w[i];
+            uint32_t s0 = Rotr(v[0], 2) ^ Rotr(v[0], 13) ^ Rotr(v[0], 22);
+            uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            v = {t1 + s0 + maj, v[0], v[1], v[2], v[3] + t1, v[4], v[5], v[6]};
+        }
+        for (size_t i = 0; i < state.size(); ++i) {
+            state[i] += v[i];
+        }
+    }
+
+    std::array<uint32_t, 8> state{
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+};
+
+bool IsDigestLine(const std::string& line)
+{
+    return line.size() == DIGEST_HEX_SIZE &&
+        line.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+} // namespace
+
+FormatCache::FormatCache(const std::string& cacheDir, const FormattingOptions& options)
+    : cacheDir(cacheDir), fingerprint(OptionsFingerprint(options))
+{
+    header = std::string("cjfmt ") + CJFMT_BUILD_FINGERPRINT + " " + fingerprint;
+    // one file per build and options, the header tells files whose names collide apart
+    cachePath = FileUtil::JoinPath(cacheDir, "format-" + ToHex(std::hash<std::string>{}(header)) + ".cache");
+}
+
+bool FormatCache::IsFor(const FormattingOptions& options) const
+{
+    return OptionsFingerprint(options) == fingerprint;
+}
+
+size_t FormatCache::KeyHash::operator()(const Key& key) const noexcept
+{
+    // already a digest, its first bits are as good a hash as any
+    size_t hash = 0;
+    for (size_t i = 0; i < sizeof(size_t) * 2 && i < key.size(); ++i) {
+        hash = (hash << 4) | static_cast<size_t>(key[i] <= '9' ? key[i] - '0' : key[i] - 'a' + 10);
+    }
+    return hash;
+}
+
+FormatCache::Key FormatCache::KeyOf(const std::string& content)
+{
+    return Sha256().HexDigest(content);
+}
+
+void FormatCache::Load()
+{
+    if (cachePath.empty()) {
+        return;
+    }
+    std::ifstream instream(cachePath, std::ios::in | std::ios::binary);
+    std::string line;
+    if (!instream || !std::getline(instream, line) || line != header) {
+        return;
+    }
+    fileValid = true;
+    while (std::getline(instream, line)) {
+        // a line cut short by a crash while appending is skipped
+        if (IsDigestLine(line)) {
+            (void)entries.emplace(std::move(line));
+        }
+    }
+}
+
+bool FormatCache::IsFormatted(const std::string& content) const
+{
+    return !cachePath.empty() && entries.count(KeyOf(content)) != 0;
+}
+
+void FormatCache::AddFormatted(const std::string& content)
+{
+    if (cachePath.empty()) {
+        return;
+    }
+    auto key = KeyOf(content);
+    if (entries.count(key) == 0) {
+        added.push_back(std::move(key));
+    }
+}
+
+void FormatCache::Save()
+{
+    if (cachePath.empty() || added.empty()) {
+        return;
+    }
+    if (!FileUtil::IsDir(cacheDir) && FileUtil::CreateDirs(cacheDir + DELIMITER) == -1) {
+        return;
+    }
+    std::string lines;
+    for (auto& key : added) {
+        lines += key + "\n";
+    }
+    if (fileValid && entries.size() + added.size() <= MAX_CACHE_ENTRIES) {
+        // one write per save, a cjfmt appending at the same time does not interleave with it
+        std::ofstream outstream(cachePath, std::ios::out | std::ios::binary | std::ios::app);
+        (void)outstream.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+    } else {
+        // missing, written by another build or full: restart it, another cjfmt doing so at the same time may win
+        fileValid = WriteFileAtomically(cachePath, header + "\n" + lines);
+        if (fileValid) {
+            entries.clear();
+        }
+    }
+    for (auto& key : added) {
+        (void)entries.emplace(std::move(key));
+    }
+    added.clear();
+}
+
+std::string FormatCache::DefaultDir()
+{
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    return base && *base ? FileUtil::JoinPath(base, "cjfmt") : "";
+#else
+    const char* base = std::getenv("XDG_CACHE_HOME");
+    if (base && *base) {
+        return FileUtil::JoinPath(base, "cjfmt");
+    }
+    const char* home = std::getenv("HOME");
+    return home && *home ? FileUtil::JoinPath(FileUtil::JoinPath(home, ".cache"), "cjfmt") : "";
+#endif
+}
+} // namespace Cangjie::Format
@@ -5,8 +5,17 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "Format/FormatCodeProcessor.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <set>
+#include <thread>
 #include "Format/CommentHandler.h"
+#include "Format/FormatStats.h"
 #include "Format/DocProcessor/ArgsProcessor.h"
 #include "Format/DocProcessor/BreakParentTypeProcessor.h"
 #include "Format/DocProcessor/ConcatTypeProcessor.h"
@@ -110,7 +119,6 @@
 #include "Format/NodeFormatter/Type/ThisTypeFormatter.h"
 #include "Format/NodeFormatter/Type/TupleTypeFormatter.h"
 #include "Format/NodeFormatter/Type/VArrayTypeFormatter.h"
-#include "Format/OptionContext.h"
 #include "Format/SimultaneousIterator.h"
 #include "Format/TomlParser.h"
 
@@ -309,24 +317,44 @@ void RegisterDocProcessors(ASTToFormatSource& toSourceManager, FormattingOptions
 namespace {
 class FormatCodeProcessor {
 public:
-    FormatCodeProcessor(const std::string& rawCode, const std::string& filepath, const Region region)
-        : rawCode(rawCode), filepath(filepath), sm(), diag(), regionToFormat(region), tracker(region)
+    // With deferDiagnostics, parse errors are kept until EmitDiagnostics instead of being printed by Run.
+    FormatCodeProcessor(const std::string& rawCode, const std::string& filepath, const Region region,
+        const FormattingOptions& options, bool deferDiagnostics = false)
+        : rawCode(rawCode),
+          filepath(filepath),
+          sm(),
+          diag(),
+          regionToFormat(region),
+          tracker(region),
+          options(options),
+          deferDiagnostics(deferDiagnostics)
     {
         diag.SetSourceManager(&sm);
-        OptionContext& optionContext = OptionContext::GetInstance();
-        this->options = optionContext.GetConfigOptions();
     }
 
     std::optional<std::string> Run()
     {
-        auto inputTokens = RunLexer(rawCode, filepath);
+        if (FormatStats::GetInstance().IsEnabled()) {
+            FormatStats::GetInstance().AddInput(rawCode.size());
+        }
+        std::vector<Token> inputTokens;
+        {
+            PhaseTimer timer(FormatPhase::LEX);
+            inputTokens = RunLexer(rawCode, filepath);
+        }
         if (inputTokens.empty()) {
             return "";
         }
 
         Parser parser(inputTokens, diag, sm);
-        auto file = parser.ParseTopLevel();
-        diag.EmitCategoryGroup();
+        OwnedPtr<File> file;
+        {
+            PhaseTimer timer(FormatPhase::PARSE);
+            file = parser.ParseTopLevel();
+        }
+        if (!deferDiagnostics) {
+            diag.EmitCategoryGroup();
+        }
         if (parser.GetDiagnosticEngine().GetErrorCount() > 0) {
             return std::nullopt;
         }
@@ -334,6 +362,7 @@ public:
         std::string result;
         auto formatted = TransformAstToText(file);
         if (tracker.actuallyFormattedStart.has_value() && tracker.actuallyFormattedEnd.has_value()) {
+            PhaseTimer timer(FormatPhase::COMMENTS);
             result = ConstructResultingText(file, inputTokens, formatted);
         } else {
             // couldn't find any ast nodes to format, should report this to user?
@@ -346,6 +375,11 @@ public:
         return result;
     }
 
+    void EmitDiagnostics()
+    {
+        diag.EmitCategoryGroup();
+    }
+
 private:
     const std::string& rawCode;
     const std::string& filepath;
@@ -354,12 +388,18 @@ private:
     Region regionToFormat;
     RegionFormattingTracker tracker;
     FormattingOptions options;
+    bool deferDiagnostics;
 
     std::string TransformAstToText(const OwnedPtr<File>& file)
     {
         ASTToFormatSource astTransformer(tracker, sm);
         SetupTranformer(astTransformer);
-        Doc doc = astTransformer.ASTToDoc(file.get());
+        Doc doc;
+        {
+            PhaseTimer timer(FormatPhase::DOC_BUILD);
+            doc = astTransformer.ASTToDoc(file.get());
+        }
+        PhaseTimer timer(FormatPhase::PRINT);
         return astTransformer.DocToString(doc);
     }
 
@@ -422,7 +462,7 @@ private:
             }
         }
 
-        auto fragmentText = InsertComments(originalFragmentTokens, formattedFragmentTokens, sm);
+        auto fragmentText = InsertComments(originalFragmentTokens, formattedFragmentTokens, sm, options.indentWidth);
         auto contentBefore =
             sm.GetContentBetween(originalFileAllTokens.front().Begin(), originalFragmentTokens.front().Begin());
         auto contentAfter =
@@ -449,21 +489,40 @@ private:
         return contentBefore + fragmentText + contentAfter;
     }
 
+    /* The printed text with the comments of inputTokens put back. A whole file without comments is returned as
+     * printed. For a whole file with comments, the tokens of the printed text are those of inputTokens laid over it,
+     * the text is only lexed again when they do not line up, e.g. when modifiers were reordered. A region is always
+     * lexed again, which of inputTokens it holds is only known from its tokens. */
     std::string ConstructResultingText(OwnedPtr<File>&, const std::vector<Token>& inputTokens, std::string& formatted)
     {
         (void)formatted.erase(0, formatted.find_first_not_of(" \t\n"));
         (void)formatted.erase(formatted.find_last_not_of(" \t\n") + 1);
-        auto formattedTokens = RunLexer(formatted, "___formattedSnippet.cj");
+        if (regionToFormat.isWholeFile &&
+            std::none_of(inputTokens.begin(), inputTokens.end(),
+                [](const Token& token) { return token.kind == TokenKind::COMMENT; })) {
+            /* Nothing to put back. Like InsertComments, drop what follows the last token that is not a line break
+             * or ';'. */
+            (void)formatted.erase(formatted.find_last_not_of(" \t\r\n;") + 1);
+            return formatted;
+        }
+        auto fileID = sm.AddSource("___formattedSnippet.cj", formatted);
         if (!regionToFormat.isWholeFile) {
-            return ConstructTextForCodeFragment(inputTokens, formattedTokens);
-        } else {
-            return InsertComments(inputTokens, formattedTokens, sm);
+            return ConstructTextForCodeFragment(inputTokens, RunLexer(formatted, fileID));
+        }
+        auto formattedTokens = TokensOfPrintedCode(inputTokens, formatted, fileID, sm);
+        if (!formattedTokens.has_value()) {
+            formattedTokens = RunLexer(formatted, fileID);
         }
+        return InsertComments(inputTokens, *formattedTokens, sm, options.indentWidth);
     }
 
     std::vector<Token> RunLexer(const std::string& code, const std::string& path)
     {
-        auto fileID = sm.AddSource(path, code);
+        return RunLexer(code, sm.AddSource(path, code));
+    }
+
+    std::vector<Token> RunLexer(const std::string& code, unsigned int fileID)
+    {
         auto lexer = Lexer(fileID, code, diag, sm);
         return lexer.GetTokens();
     }
@@ -518,15 +577,165 @@ private:
         str.erase(0, currentPos);
     }
 };
-} // namespace
 
-std::optional<std::string> FormatText(const std::string& rawCode, const std::string& filepath, const Region region)
+std::optional<std::string> RunProcessor(const std::string& rawCode, const std::string& filepath, const Region region,
+    const FormattingOptions& options, bool emitDiagnostics)
 {
-    auto formatCode = FormatCodeProcessor(rawCode, filepath, region);
+    // deferred diagnostics that are never emitted are dropped
+    auto formatCode = FormatCodeProcessor(rawCode, filepath, region, options, !emitDiagnostics);
     return formatCode.Run();
 }
 
-bool FormatFile(std::string& rawCode, const std::string& filepath, std::string& sourceFormat, Region regionToFormat)
+// Bytes [begin, end) of a file holding whole top level declarations, begin being the start of line firstLine.
+struct Snippet {
+    size_t begin;
+    size_t end;
+    int firstLine;
+};
+
+// Keywords and modifiers only a top level declaration starts with, the code before them ends whatever it is.
+const std::set<TokenKind> DECLARATION_START_KINDS = {TokenKind::PACKAGE, TokenKind::IMPORT, TokenKind::CLASS,
+    TokenKind::STRUCT, TokenKind::ENUM, TokenKind::INTERFACE, TokenKind::EXTEND, TokenKind::FUNC, TokenKind::MAIN,
+    TokenKind::LET, TokenKind::VAR, TokenKind::CONST, TokenKind::TYPE, TokenKind::MACRO, TokenKind::PUBLIC,
+    TokenKind::PRIVATE, TokenKind::INTERNAL, TokenKind::PROTECTED, TokenKind::ABSTRACT, TokenKind::OPEN,
+    TokenKind::SEALED, TokenKind::FOREIGN, TokenKind::UNSAFE};
+
+/* Lines top level declarations start on: the first token of the line is a declaration keyword or modifier at column
+ * 1, outside any bracket. Any other line, such as a '.bar()' continuing the expression of the line before, belongs to
+ * the declaration above it, even after a '}'. A declaration starting otherwise, with an annotation for instance, is
+ * only formatted along with the one before it. Empty if the file doesn't start with such a line, the code before the
+ * first one would belong to no snippet. */
+std::vector<int> FindDeclarationLines(const std::vector<Token>& tokens)
+{
+    std::vector<int> lines;
+    int depth = 0;
+    bool firstOnLine = true;
+    std::optional<TokenKind> lastKind; // of the last token that is neither a line break nor a comment
+    for (auto& token : tokens) {
+        if (token.kind == TokenKind::NL) {
+            firstOnLine = true;
+            continue;
+        }
+        bool isFirstOnLine = firstOnLine;
+        firstOnLine = false;
+        if (token.kind == TokenKind::COMMENT) {
+            continue;
+        }
+        if (isFirstOnLine && depth == 0 && token.Begin().column == 1 && DECLARATION_START_KINDS.count(token.kind) > 0) {
+            lines.push_back(token.Begin().line);
+        } else if (!lastKind) {
+            return {};
+        }
+        if (token.kind == TokenKind::LCURL || token.kind == TokenKind::LPAREN || token.kind == TokenKind::LSQUARE) {
+            ++depth;
+        } else if (token.kind == TokenKind::RCURL || token.kind == TokenKind::RPAREN ||
+            token.kind == TokenKind::RSQUARE) {
+            depth = std::max(depth - 1, 0);
+        }
+        lastKind = token.kind;
+    }
+    return lines;
+}
+
+/* The smallest run of top level declarations holding the code on the lines of region, from the start of the first
+ * one to the last non-blank byte of the last one. Blank lines between declarations belong to none. snippet stays
+ * empty if the region holds no code, false if rawCode can't be split into declarations. */
+bool FindRegionSnippet(
+    const std::string& rawCode, const std::string& filepath, const Region& region, std::optional<Snippet>& snippet)
+{
+    SourceManager sm;
+    DiagnosticEngine diag;
+    diag.SetSourceManager(&sm);
+    auto fileID = sm.AddSource(filepath, rawCode);
+    std::vector<Token> tokens;
+    {
+        PhaseTimer timer(FormatPhase::LEX);
+        tokens = Lexer(fileID, rawCode, diag, sm).GetTokens();
+    }
+    if (diag.GetErrorCount() > 0) {
+        return false;
+    }
+    auto declarationLines = FindDeclarationLines(tokens);
+    if (declarationLines.empty()) {
+        return false;
+    }
+    std::vector<size_t> lineOffsets{0};
+    for (size_t i = 0; i < rawCode.size(); ++i) {
+        if (rawCode[i] == '\n') {
+            lineOffsets.push_back(i + 1);
+        }
+    }
+    for (size_t i = 0; i < declarationLines.size() && declarationLines[i] <= region.endLine; ++i) {
+        size_t begin = lineOffsets[static_cast<size_t>(declarationLines[i] - 1)];
+        size_t end = i + 1 < declarationLines.size() ? lineOffsets[static_cast<size_t>(declarationLines[i + 1] - 1)]
+                                                     : rawCode.size();
+        while (end > begin && std::isspace(static_cast<unsigned char>(rawCode[end - 1]))) {
+            --end;
+        }
+        auto endLine = static_cast<int>(std::upper_bound(lineOffsets.begin(), lineOffsets.end(), end - 1) -
+            lineOffsets.begin());
+        if (endLine < region.startLine) {
+            continue;
+        }
+        if (snippet) {
+            snippet->end = end;
+        } else {
+            snippet = Snippet{begin, end, declarationLines[i]};
+        }
+    }
+    return true;
+}
+} // namespace
+
+std::optional<std::vector<TextReplacement>> FormatRegion(const std::string& rawCode, const std::string& filepath,
+    const Region region, const FormattingOptions& options, bool emitDiagnostics)
+{
+    std::optional<Snippet> snippet;
+    if (!region.isWholeFile && FindRegionSnippet(rawCode, filepath, region, snippet)) {
+        if (!snippet) {
+            return std::vector<TextReplacement>{};
+        }
+        std::string snippetCode = rawCode.substr(snippet->begin, snippet->end - snippet->begin);
+        int lineShift = snippet->firstLine - 1;
+        Region snippetRegion(std::max(region.startLine - lineShift, 1), region.endLine - lineShift, false);
+        // diagnostics would have the lines of the snippet, one that doesn't parse is formatted with the whole file
+        auto formatted = RunProcessor(snippetCode, filepath, snippetRegion, options, false);
+        if (formatted) {
+            // the snippet ends with its last token, not with the line break added after the formatted code
+            (void)formatted->erase(formatted->find_last_not_of(" \t\r\n") + 1);
+            auto replacements = TextReplacements(snippetCode, formatted.value());
+            for (auto& replacement : replacements) {
+                replacement.offset += snippet->begin;
+            }
+            return replacements;
+        }
+    }
+    auto formatted = RunProcessor(rawCode, filepath, region, options, emitDiagnostics);
+    if (!formatted) {
+        return std::nullopt;
+    }
+    return TextReplacements(rawCode, formatted.value());
+}
+
+std::optional<std::string> FormatText(const std::string& rawCode, const std::string& filepath, const Region region,
+    const FormattingOptions& options, bool emitDiagnostics)
+{
+    if (region.isWholeFile) {
+        return RunProcessor(rawCode, filepath, region, options, emitDiagnostics);
+    }
+    auto replacements = FormatRegion(rawCode, filepath, region, options, emitDiagnostics);
+    if (!replacements) {
+        return std::nullopt;
+    }
+    auto formatted = ApplyReplacements(rawCode, replacements.value());
+    if (formatted.empty() || formatted.back() != '\n') {
+        formatted.push_back('\n');
+    }
+    return formatted;
+}
+
+bool FormatFile(std::string& rawCode, const std::string& filepath, std::string& sourceFormat, Region regionToFormat,
+    const FormattingOptions& options)
 {
     std::ifstream instream(filepath);
     std::string buffer((std::istreambuf_iterator<char>(instream)), std::istreambuf_iterator<char>());
@@ -535,7 +744,7 @@ bool FormatFile(std::string& rawCode, const std::string& filepath, std::string&
     if (regionToFormat.startLine == -1 || regionToFormat.endLine == -1) {
         regionToFormat = Region::wholeFile;
     }
-    auto formatted = FormatText(rawCode, filepath, regionToFormat);
+    auto formatted = FormatText(rawCode, filepath, regionToFormat, options);
     if (!formatted) {
         return false;
     }
@@ -564,7 +773,70 @@ std::string GetTargetName(
     return targetName;
 }
 
-int FmtDir(const std::string& fmtDirPath, const std::string& dirOutputPath)
+namespace {
+/* Files a worker may run ahead of the one being written, per job. Bounds the formatted files held in memory when one
+ * file takes much longer than those after it. */
+const size_t MAX_PENDING_FILES_PER_JOB = 4;
+
+// A file of the directory being formatted, workers format it and FmtDir reports and writes it in path order.
+struct DirFile {
+    std::string path;
+    std::string name;
+    FormattingOptions options;
+    FormatCache* cache = nullptr; // the one for options, null without caching
+    std::string rawCode;
+    std::string formatted;
+    // kept until the diagnostics of the file are reported, they refer to its sources, null for a cached file
+    std::unique_ptr<FormatCodeProcessor> processor;
+    bool parsed = false; // formatted holds the output of the formatter rather than a copy of rawCode
+    bool done = false;
+};
+
+void FormatDirFile(DirFile& file)
+{
+    std::ifstream instream(file.path);
+    file.rawCode.assign((std::istreambuf_iterator<char>(instream)), std::istreambuf_iterator<char>());
+    instream.close();
+    if (file.cache && file.cache->IsFormatted(file.rawCode)) {
+        file.formatted = file.rawCode;
+        return;
+    }
+    file.processor =
+        std::make_unique<FormatCodeProcessor>(file.rawCode, file.path, Region::wholeFile, file.options, true);
+    auto formatted = file.processor->Run();
+    file.parsed = formatted.has_value();
+    file.formatted = formatted ? std::move(formatted.value()) : file.rawCode;
+}
+
+int WriteDirFile(const DirFile& file, const std::string& absDirPath, const std::string& dirOutputPath,
+    OutputMode mode, bool& changed)
+{
+    /* Obtain the output file path based on the output path and retain the source file directory structure. */
+    auto targetName = GetTargetName(file.path, file.name, absDirPath, dirOutputPath);
+    if (targetName.empty()) {
+        Errorln("Create target file error.");
+        return ERR;
+    }
+    return OutputFormatted(file.path, targetName, file.rawCode, file.formatted, mode, changed);
+}
+
+// The cache in caches for options, added and loaded when first needed.
+FormatCache* CacheFor(
+    std::vector<std::unique_ptr<FormatCache>>& caches, const std::string& cacheDir, const FormattingOptions& options)
+{
+    for (auto& cache : caches) {
+        if (cache->IsFor(options)) {
+            return cache.get();
+        }
+    }
+    caches.push_back(std::make_unique<FormatCache>(cacheDir, options));
+    caches.back()->Load();
+    return caches.back().get();
+}
+} // namespace
+
+int FmtDir(const std::string& fmtDirPath, const std::string& dirOutputPath, const OptionsProvider& optionsFor,
+    unsigned int jobs, OutputMode mode, const std::string& cacheDir)
 {
     std::regex reg = std::regex("[*|;&$><`?!\\n]+");
     if (std::regex_search(fmtDirPath, reg)) {
@@ -575,27 +847,96 @@ int FmtDir(const std::string& fmtDirPath, const std::string& dirOutputPath)
     std::map<std::string, std::string> filesMap;
     /* Obtain the path and name of the source file. Save to file map. */
     TraveDepthLimitedDirs(absDirPath, filesMap, DEPTH_OF_RECURSION, MAX_RECURSION_DEPTH);
+    std::vector<DirFile> files(filesMap.size());
+    // one per set of options, files of projects configured alike share it
+    std::vector<std::unique_ptr<FormatCache>> caches;
+    size_t index = 0;
     for (auto& file : filesMap) {
-        std::string sourceFormat, targetName, rawCode;
-        /* Format the file content and save the formatted content to sourceFormat. */
-        if (!FormatFile(rawCode, file.first, sourceFormat, Region::wholeFile)) {
-            sourceFormat = rawCode;
-        }
-        /* Obtain the output file path based on the output path and retain the source file directory structure. */
-        targetName = GetTargetName(file.first, file.second, absDirPath, dirOutputPath);
-        if (targetName.empty()) {
-            Errorln("Create target file error.");
-            return ERR;
-        }
-        std::ofstream outStream(targetName, std::ios::out | std::ofstream::binary);
-        if (!outStream) {
-            Errorln("Create target file error.");
-            return ERR;
-        }
-        auto length = sourceFormat.size();
-        (void)outStream.write(sourceFormat.c_str(), static_cast<long>(length));
-        outStream.close();
-    }
-    return OK;
+        files[index].path = file.first;
+        files[index].name = file.second;
+        // resolved here, the provider may read configuration files and is not called from the workers
+        files[index].options = optionsFor(file.first);
+        if (!cacheDir.empty()) {
+            files[index].cache = CacheFor(caches, cacheDir, files[index].options);
+        }
+        ++index;
+    }
+
+    /* Workers take the files in path order and format them. This thread reports diagnostics and writes the files in
+     * the same order, so the output does not depend on the number of jobs. */
+    jobs = std::max(jobs, 1u);
+    const size_t window = jobs * MAX_PENDING_FILES_PER_JOB;
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t next = 0;
+    size_t written = 0;
+    bool stop = false;
+    auto work = [&files, &mtx, &cv, &next, &written, &stop, window]() {
+        while (true) {
+            size_t current;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return stop || next >= files.size() || next < written + window; });
+                if (stop || next >= files.size()) {
+                    return;
+                }
+                current = next++;
+            }
+            FormatDirFile(files[current]);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                files[current].done = true;
+            }
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < jobs && i < files.size(); ++i) {
+        workers.emplace_back(work);
+    }
+
+    int result = OK;
+    bool anyChanged = false;
+    bool anyUnparsed = false;
+    for (auto& file : files) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&file] { return file.done; });
+        }
+        if (file.processor) {
+            file.processor->EmitDiagnostics();
+        }
+        // a cached file has no processor, one that has and was not parsed has syntax errors
+        anyUnparsed = anyUnparsed || (file.processor && !file.parsed);
+        bool changed = false;
+        result = WriteDirFile(file, absDirPath, dirOutputPath, mode, changed);
+        anyChanged = anyChanged || changed;
+        if (file.cache && file.parsed && !changed) {
+            file.cache->AddFormatted(file.rawCode);
+        }
+        file.processor.reset();
+        std::string().swap(file.rawCode);
+        std::string().swap(file.formatted);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++written;
+            stop = result != OK;
+        }
+        cv.notify_all();
+        if (result != OK) {
+            break;
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& cache : caches) {
+        cache->Save();
+    }
+    // checking fails for files that would change and for those that can't be formatted at all
+    if (result == OK && mode != OutputMode::WRITE && (anyChanged || anyUnparsed)) {
+        return ERR;
+    }
+    return result;
 }
 } // namespace Cangjie::Format
@@ -0,0 +1,281 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/FormatConfig.h"
+#include "Format/TomlParser.h"
+#include "cangjie/Utils/FileUtil.h"
+
+#include <sys/stat.h>
+#include <type_traits>
+#include <variant>
+
+namespace Cangjie::Format {
+namespace {
+constexpr int MIN_LINE_LIMIT_LENGTH = 1;
+constexpr int MAX_LINE_LIMIT_LENGTH = 120;
+constexpr int MIN_INDENT_WIDTH = 0;
+constexpr int MAX_INDENT_WIDTH = 8;
+constexpr int MIN_METHOD_CHAIN_LEVEL = 2;
+constexpr int MAX_METHOD_CHAIN_LEVEL = 10;
+#ifdef _WIN32
+const std::string DELIMITER = "\\";
+#else
+const std::string DELIMITER = "/";
+#endif
+
+void SetOptionIndentWidth(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto indentWidthOptional = parser.GetValue("indentWidth");
+    if (!indentWidthOptional.has_value()) {
+        warnings.emplace_back(
+            "Can't find configuration options: indentWidth, built-in options will be used: indentWidth = 4");
+        return;
+    }
+    std::optional<int> indentWidth;
+    std::visit(
+        [&indentWidth, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, int>) {
+                indentWidth = value;
+            } else {
+                warnings.emplace_back("Configuration options: indentWidth's type should be integer, "
+                                      "Built-in options will be used: indentWidth = 4");
+            }
+        },
+        indentWidthOptional.value());
+    if (!indentWidth.has_value()) {
+        return;
+    }
+    if (*indentWidth < MIN_INDENT_WIDTH || *indentWidth > MAX_INDENT_WIDTH) {
+        warnings.emplace_back("Configuration options: indentWidth is out of range [0, 8], "
+                              "Built-in options will be used: indentWidth = 4");
+        return;
+    }
+    options.indentWidth = *indentWidth;
+}
+
+void SetOptionLineLength(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto lineLimitLengthOptional = parser.GetValue("linelimitLength");
+    if (!lineLimitLengthOptional.has_value()) {
+        warnings.emplace_back("Can't find configuration options: linelimitLength, "
+                              "built-in options will be used: linelimitLength = 120");
+        return;
+    }
+    std::optional<int> linelimitLength;
+    std::visit(
+        [&linelimitLength, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, int>) {
+                linelimitLength = value;
+            } else {
+                warnings.emplace_back("Configuration options: linelimitLength's type should be integer, "
+                                      "Built-in options will be used: linelimitLength = 120");
+            }
+        },
+        lineLimitLengthOptional.value());
+    if (!linelimitLength.has_value()) {
+        return;
+    }
+    if (*linelimitLength < MIN_LINE_LIMIT_LENGTH || *linelimitLength > MAX_LINE_LIMIT_LENGTH) {
+        warnings.emplace_back("Configuration options: linelimitLength is out of range [1, 120], "
+                              "Built-in options will be used: linelimitLength = 120");
+        return;
+    }
+    options.lineLength = *linelimitLength;
+}
+
+void SetOptionLineBreakType(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto lineBreakTypeOptional = parser.GetValue("lineBreakType");
+    if (!lineBreakTypeOptional.has_value()) {
+        warnings.emplace_back("Can't find configuration options: lineBreakType, "
+                              "built-in options will be used: lineBreakType = \"LF\"");
+        return;
+    }
+    std::optional<std::string> lineBreakType;
+    std::visit(
+        [&lineBreakType, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                lineBreakType = value;
+            } else {
+                warnings.emplace_back(
+                    "Configuration options: lineBreakType's type should be string, "
+                    "Built-in options will be used: lineBreakType = \"LF\"");
+            }
+        },
+        lineBreakTypeOptional.value());
+
+    if (!lineBreakType.has_value()) {
+        return;
+    }
+    if (*lineBreakType != "CRLF" && *lineBreakType != "LF") {
+        warnings.emplace_back("\"Configuration options: neither CRLF nor LF, "
+                              "Built-in options will be used: lineBreakType = \"LF\"");
+        return;
+    }
+    options.newLine = *lineBreakType == "CRLF" ? "\r\n" : "\n";
+}
+
+void SetOptionMethodChainning(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto methodChainningOptional = parser.GetValue("allowMultiLineMethodChain");
+    if (!methodChainningOptional.has_value()) {
+        warnings.emplace_back("Can't find configuration options: allowMultiLineMethodChain, "
+                              "built-in options will be used: allowMultiLineMethodChain = false");
+        return;
+    }
+    std::optional<bool> allowMultiLineMethodChain;
+    std::visit(
+        [&allowMultiLineMethodChain, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, bool>) {
+                allowMultiLineMethodChain = value;
+            } else {
+                warnings.emplace_back("Configuration options: allowMultiLineMethodChain's type should be boolean, "
+                                      "Built-in options will be used: allowMultiLineMethodChain = false");
+            }
+        },
+        methodChainningOptional.value());
+    if (!allowMultiLineMethodChain.has_value()) {
+        return;
+    }
+    options.allowMultiLineMethodChain = *allowMultiLineMethodChain;
+}
+
+void SetOptionMethodChainLevel(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto methodChainningOptional = parser.GetValue("multipleLineMethodChainLevel");
+    if (!methodChainningOptional.has_value()) {
+        warnings.emplace_back("Can't find configuration options: multipleLineMethodChainLevel, "
+                              "built-in options will be used: multipleLineMethodChainLevel = 5");
+        return;
+    }
+    std::optional<int> multipleLineMethodChainLevel;
+    std::visit(
+        [&multipleLineMethodChainLevel, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, int>) {
+                multipleLineMethodChainLevel = value;
+            } else {
+                warnings.emplace_back("Configuration options: multipleLineMethodChainLevel's type should be integer, "
+                                      "Built-in options will be used: multipleLineMethodChainLevel = 5");
+            }
+        },
+        methodChainningOptional.value());
+    if (!multipleLineMethodChainLevel.has_value()) {
+        return;
+    }
+    if (*multipleLineMethodChainLevel < MIN_METHOD_CHAIN_LEVEL ||
+        *multipleLineMethodChainLevel > MAX_METHOD_CHAIN_LEVEL) {
+        warnings.emplace_back("Configuration options: multipleLineMethodChainLevel is out of range [2, 10], "
+                              "Built-in options will be used: multipleLineMethodChainLevel = 5");
+        return;
+    }
+    options.multipleLineMethodChainLevel = *multipleLineMethodChainLevel;
+}
+
+void SetOptionMultipleLineMethodChainOverLineLength(
+    const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    auto methodChainningOptional = parser.GetValue("multipleLineMethodChainOverLineLength");
+    if (!methodChainningOptional.has_value()) {
+        warnings.emplace_back("Can't find configuration options: multipleLineMethodChainOverLineLength, "
+                              "built-in options will be used: multipleLineMethodChainOverLineLength = true");
+        return;
+    }
+    std::optional<bool> multipleLineMethodChainOverLineLength;
+    std::visit(
+        [&multipleLineMethodChainOverLineLength, &warnings](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, bool>) {
+                multipleLineMethodChainOverLineLength = value;
+            } else {
+                warnings.emplace_back(
+                    "Configuration options: multipleLineMethodChainOverLineLength's type should be boolean, "
+                    "Built-in options will be used: multipleLineMethodChainOverLineLength = true");
+            }
+        },
+        methodChainningOptional.value());
+    if (!multipleLineMethodChainOverLineLength.has_value()) {
+        return;
+    }
+    options.multipleLineMethodChainOverLineLength = *multipleLineMethodChainOverLineLength;
+}
+
+void SetFmtConfigOptions(const TomlParser& parser, FormattingOptions& options, std::vector<std::string>& warnings)
+{
+    SetOptionIndentWidth(parser, options, warnings);
+    SetOptionLineLength(parser, options, warnings);
+    SetOptionLineBreakType(parser, options, warnings);
+    SetOptionMethodChainning(parser, options, warnings);
+    SetOptionMethodChainLevel(parser, options, warnings);
+    SetOptionMultipleLineMethodChainOverLineLength(parser, options, warnings);
+}
+
+time_t ModificationTime(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+} // namespace
+
+std::string FindProjectConfig(const std::string& filePath)
+{
+    std::string dir = filePath;
+    bool isAbsolute = !dir.empty() && (dir[0] == '/' || dir[0] == '\\' || (dir.size() > 1 && dir[1] == ':'));
+    if (!isAbsolute) {
+        dir = (FileUtil::GetAbsPath(".") | FileUtil::IdenticalFunc) + DELIMITER + dir;
+    }
+    auto pos = dir.find_last_of("/\\");
+    while (pos != std::string::npos) {
+        dir.erase(pos);
+        auto configPath = FileUtil::JoinPath(dir.empty() ? DELIMITER : dir, PROJECT_CONFIG_NAME);
+        if (FileUtil::FileExist(configPath) && !FileUtil::IsDir(configPath)) {
+            return configPath;
+        }
+        pos = dir.find_last_of("/\\");
+    }
+    return "";
+}
+
+std::optional<FormattingOptions> ReadFormatConfig(
+    const std::string& configPath, std::vector<std::string>& warnings, FormattingOptions options)
+{
+    TomlParser parser;
+    if (configPath.empty() || !parser.ReadFile(configPath)) {
+        return std::nullopt;
+    }
+    SetFmtConfigOptions(parser, options, warnings);
+    return options;
+}
+
+std::optional<FormattingOptions> ProjectConfigs::OptionsFor(const std::string& filePath)
+{
+    auto configPath = FindProjectConfig(filePath);
+    if (configPath.empty()) {
+        return std::nullopt;
+    }
+    return OptionsOf(configPath);
+}
+
+std::optional<FormattingOptions> ProjectConfigs::OptionsOf(const std::string& configPath)
+{
+    auto modified = ModificationTime(configPath);
+    std::lock_guard<std::mutex> lock(mtx);
+    auto found = parsedConfigs.find(configPath);
+    if (found == parsedConfigs.end() || found->second.modified != modified) {
+        std::vector<std::string> warnings;
+        auto options = ReadFormatConfig(configPath, warnings);
+        if (onRead) {
+            onRead(configPath, options, warnings);
+        }
+        found = parsedConfigs.insert_or_assign(configPath, ParsedConfig{modified, options}).first;
+    }
+    return found->second.options;
+}
+} // namespace Cangjie::Format
@@ -0,0 +1,411 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/FormatOutput.h"
+#include "Format/FormatCodeProcessor.h"
+#include "cangjie/Basic/Print.h"
+#include "cangjie/Utils/FileUtil.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <sys/stat.h>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Cangjie::Format {
+namespace {
+const size_t DIFF_CONTEXT_LINES = 3;
+
+enum class EditKind { EQUAL, REMOVE, INSERT };
+
+// One line of the edit script, with the positions in both texts it applies at.
+struct Edit {
+    EditKind kind;
+    size_t beforeLine;
+    size_t afterLine;
+};
+
+// Lines of text, each keeping its line break so that a change of line break type shows up in the diff.
+std::vector<std::string_view> SplitLines(const std::string& text)
+{
+    std::vector<std::string_view> lines;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        auto end = text.find('\n', begin);
+        end = end == std::string::npos ? text.size() : end + 1;
+        lines.emplace_back(text.data() + begin, end - begin);
+        begin = end;
+    }
+    return lines;
+}
+
+/* Shortest edit script between the lines of before and after, Myers' O((N+M)D) algorithm. The common head and tail
+ * are matched up front, formatting usually touches a few places of a file. */
+std::vector<Edit> DiffLines(const std::vector<std::string_view>& before, const std::vector<std::string_view>& after)
+{
+    size_t head = 0;
+    while (head < before.size() && head < after.size() && before[head] == after[head]) {
+        ++head;
+    }
+    size_t tail = 0;
+    while (tail < before.size() - head && tail < after.size() - head &&
+        before[before.size() - 1 - tail] == after[after.size() - 1 - tail]) {
+        ++tail;
+    }
+    const long n = static_cast<long>(before.size() - head - tail);
+    const long m = static_cast<long>(after.size() - head - tail);
+    auto same = [&before, &after, head](long x, long y) {
+        return before[head + static_cast<size_t>(x)] == after[head + static_cast<size_t>(y)];
+    };
+
+    // furthest[k + limit] is the furthest x reached on diagonal k = x - y, trace[d] keeps diagonals -d..d of round d
+    const long limit = n + m;
+    std::vector<long> furthest(static_cast<size_t>(2 * limit + 2), 0);
+    auto at = [&furthest, limit](long diagonal) -> long& {
+        return furthest[static_cast<size_t>(diagonal + limit)];
+    };
+    std::vector<std::vector<long>> trace;
+    for (long d = 0; d <= limit; ++d) {
+        bool reached = false;
+        for (long k = -d; k <= d; k += 2) {
+            long x = (k == -d || (k != d && at(k - 1) < at(k + 1))) ? at(k + 1) : at(k - 1) + 1;
+            long y = x - k;
+            while (x < n && y < m && same(x, y)) {
+                ++x;
+                ++y;
+            }
+            at(k) = x;
+            if (x >= n && y >= m) {
+                reached = true;
+            }
+        }
+        trace.emplace_back(furthest.begin() + (limit - d), furthest.begin() + (limit + d + 1));
+        if (reached) {
+            break;
+        }
+    }
+
+    std::vector<Edit> edits;
+    for (size_t i = 0; i < tail; ++i) {
+        edits.push_back({EditKind::EQUAL, head + static_cast<size_t>(n) + tail - 1 - i,
+            head + static_cast<size_t>(m) + tail - 1 - i});
+    }
+    long x = n;
+    long y = m;
+    for (long d = static_cast<long>(trace.size()) - 1; d >= 0; --d) {
+        long prevX = 0;
+        long prevY = 0;
+        if (d > 0) {
+            const auto& prev = trace[static_cast<size_t>(d - 1)];
+            auto prevAt = [&prev, d](long diagonal) { return prev[static_cast<size_t>(diagonal + d - 1)]; };
+            long k = x - y;
+            long prevK = (k == -d || (k != d && prevAt(k - 1) < prevAt(k + 1))) ? k + 1 : k - 1;
+            prevX = prevAt(prevK);
+            prevY = prevX - prevK;
+        }
+        // the snake of round d, then the single insertion or removal that started it
+        while (x > prevX && y > prevY) {
+            --x;
+            --y;
+            edits.push_back({EditKind::EQUAL, head + static_cast<size_t>(x), head + static_cast<size_t>(y)});
+        }
+        if (d > 0) {
+            edits.push_back({x == prevX ? EditKind::INSERT : EditKind::REMOVE, head + static_cast<size_t>(prevX),
+                head + static_cast<size_t>(prevY)});
+            x = prevX;
+            y = prevY;
+        }
+    }
+    for (size_t i = head; i > 0; --i) {
+        edits.push_back({EditKind::EQUAL, i - 1, i - 1});
+    }
+    std::reverse(edits.begin(), edits.end());
+    return edits;
+}
+
+void AppendLine(std::string& out, char prefix, std::string_view line)
+{
+    out.push_back(prefix);
+    out.append(line);
+    if (line.empty() || line.back() != '\n') {
+        out.append("\n\\ No newline at end of file\n");
+    }
+}
+
+// Range of a hunk header, the line before the hunk when it is empty as diff does.
+std::string HunkRange(size_t start, size_t count)
+{
+    return std::to_string(count == 0 ? start : start + 1) + "," + std::to_string(count);
+}
+
+void AppendHunk(std::string& out, const std::vector<Edit>& edits, size_t begin, size_t end,
+    const std::vector<std::string_view>& before, const std::vector<std::string_view>& after)
+{
+    size_t beforeCount = 0;
+    size_t afterCount = 0;
+    for (size_t i = begin; i < end; ++i) {
+        beforeCount += edits[i].kind != EditKind::INSERT ? 1 : 0;
+        afterCount += edits[i].kind != EditKind::REMOVE ? 1 : 0;
+    }
+    out.append("@@ -" + HunkRange(edits[begin].beforeLine, beforeCount) + " +" +
+        HunkRange(edits[begin].afterLine, afterCount) + " @@\n");
+    for (size_t i = begin; i < end; ++i) {
+        switch (edits[i].kind) {
+            case EditKind::EQUAL:
+                AppendLine(out, ' ', before[edits[i].beforeLine]);
+                break;
+            case EditKind::REMOVE:
+                AppendLine(out, '-', before[edits[i].beforeLine]);
+                break;
+            case EditKind::INSERT:
+                AppendLine(out, '+', after[edits[i].afterLine]);
+                break;
+        }
+    }
+}
+
+// Whether text can be cut before index without splitting a UTF-8 sequence or a CRLF.
+bool CanSplitAt(const std::string& text, size_t index)
+{
+    if (index == 0 || index >= text.size()) {
+        return true;
+    }
+    auto byte = static_cast<unsigned char>(text[index]);
+    return (byte & 0xC0) != 0x80 && !(text[index - 1] == '\r' && text[index] == '\n');
+}
+
+// The file path names once symbolic links are followed, path itself if it does not exist.
+std::string ResolveLinks(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return path;
+    }
+    char buffer[MAX_PATH];
+    DWORD length = GetFinalPathNameByHandleA(handle, buffer, MAX_PATH, FILE_NAME_NORMALIZED);
+    (void)CloseHandle(handle);
+    return length > 0 && length < MAX_PATH ? std::string(buffer, length) : path;
+#else
+    char* resolved = realpath(path.c_str(), nullptr);
+    if (resolved == nullptr) {
+        return path;
+    }
+    std::string result(resolved);
+    free(resolved);
+    return result;
+#endif
+}
+
+bool ReadFile(const std::string& path, std::string& content)
+{
+    std::ifstream instream(path, std::ios::in | std::ios::binary);
+    if (!instream) {
+        return false;
+    }
+    content.assign((std::istreambuf_iterator<char>(instream)), std::istreambuf_iterator<char>());
+    return true;
+}
+} // namespace
+
+std::string UnifiedDiff(const std::string& before, const std::string& after, const std::string& beforePath,
+    const std::string& afterPath)
+{
+    if (before == after) {
+        return "";
+    }
+    auto beforeLines = SplitLines(before);
+    auto afterLines = SplitLines(after);
+    auto edits = DiffLines(beforeLines, afterLines);
+
+    std::string out = "--- " + beforePath + "\n+++ " + afterPath + "\n";
+    size_t i = 0;
+    while (i < edits.size()) {
+        while (i < edits.size() && edits[i].kind == EditKind::EQUAL) {
+            ++i;
+        }
+        if (i == edits.size()) {
+            break;
+        }
+        size_t begin = i > DIFF_CONTEXT_LINES ? i - DIFF_CONTEXT_LINES : 0;
+        size_t end = i;
+        // changes separated by less than twice the context share a hunk
+        while (true) {
+            while (end < edits.size() && edits[end].kind != EditKind::EQUAL) {
+                ++end;
+            }
+            size_t equalEnd = end;
+            while (equalEnd < edits.size() && edits[equalEnd].kind == EditKind::EQUAL) {
+                ++equalEnd;
+            }
+            if (equalEnd == edits.size() || equalEnd - end > 2 * DIFF_CONTEXT_LINES) {
+                break;
+            }
+            end = equalEnd;
+        }
+        end = (std::min)(end + DIFF_CONTEXT_LINES, edits.size());
+        AppendHunk(out, edits, begin, end, beforeLines, afterLines);
+        i = end;
+    }
+    return out;
+}
+
+void NarrowReplacement(const std::string& before, TextReplacement& replacement)
+{
+    const std::string& text = replacement.text;
+    size_t limit = (std::min)(replacement.length, text.size());
+    size_t head = 0;
+    while (head < limit && before[replacement.offset + head] == text[head]) {
+        ++head;
+    }
+    while (head > 0 && (!CanSplitAt(before, replacement.offset + head) || !CanSplitAt(text, head))) {
+        --head;
+    }
+    size_t tail = 0;
+    while (tail < limit - head &&
+        before[replacement.offset + replacement.length - 1 - tail] == text[text.size() - 1 - tail]) {
+        ++tail;
+    }
+    while (tail > 0 &&
+        (!CanSplitAt(before, replacement.offset + replacement.length - tail) ||
+            !CanSplitAt(text, text.size() - tail))) {
+        --tail;
+    }
+    replacement.offset += head;
+    replacement.length -= head + tail;
+    replacement.text = text.substr(head, text.size() - head - tail);
+}
+
+std::vector<TextReplacement> TextReplacements(const std::string& before, const std::string& after)
+{
+    std::vector<TextReplacement> replacements;
+    if (before == after) {
+        return replacements;
+    }
+    auto beforeLines = SplitLines(before);
+    auto afterLines = SplitLines(after);
+    auto edits = DiffLines(beforeLines, afterLines);
+    size_t beforeOffset = 0;
+    size_t afterOffset = 0;
+    size_t i = 0;
+    while (i < edits.size()) {
+        if (edits[i].kind == EditKind::EQUAL) {
+            beforeOffset += beforeLines[edits[i].beforeLine].size();
+            afterOffset += afterLines[edits[i].afterLine].size();
+            ++i;
+            continue;
+        }
+        // a run of removed and inserted lines is one replacement
+        size_t removedBegin = beforeOffset;
+        size_t insertedBegin = afterOffset;
+        for (; i < edits.size() && edits[i].kind != EditKind::EQUAL; ++i) {
+            if (edits[i].kind == EditKind::REMOVE) {
+                beforeOffset += beforeLines[edits[i].beforeLine].size();
+            } else {
+                afterOffset += afterLines[edits[i].afterLine].size();
+            }
+        }
+        TextReplacement replacement{
+            removedBegin, beforeOffset - removedBegin, after.substr(insertedBegin, afterOffset - insertedBegin)};
+        NarrowReplacement(before, replacement);
+        if (replacement.length != 0 || !replacement.text.empty()) {
+            replacements.push_back(std::move(replacement));
+        }
+    }
+    return replacements;
+}
+
+std::string ApplyReplacements(const std::string& text, const std::vector<TextReplacement>& replacements)
+{
+    std::string result;
+    result.reserve(text.size());
+    size_t copied = 0;
+    for (auto& replacement : replacements) {
+        (void)result.append(text, copied, replacement.offset - copied);
+        (void)result.append(replacement.text);
+        copied = replacement.offset + replacement.length;
+    }
+    (void)result.append(text, copied, std::string::npos);
+    return result;
+}
+
+bool WriteFileAtomically(const std::string& linkPath, const std::string& content)
+{
+    // renaming over a symbolic link would replace it by a regular file, the file it points to is replaced instead
+    const std::string path = ResolveLinks(linkPath);
+    // the process id keeps two cjfmt writing the same file from sharing a temporary one
+#ifdef _WIN32
+    const std::string tmpPath = path + "." + std::to_string(_getpid()) + ".cjfmt.tmp";
+#else
+    const std::string tmpPath = path + "." + std::to_string(getpid()) + ".cjfmt.tmp";
+#endif
+    std::ofstream outStream(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!outStream) {
+        return false;
+    }
+    (void)outStream.write(content.data(), static_cast<std::streamsize>(content.size()));
+    outStream.close();
+    if (!outStream) {
+        (void)std::remove(tmpPath.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    // keep the permissions of the file being replaced
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        (void)chmod(tmpPath.c_str(), st.st_mode & 07777);
+    }
+    bool renamed = std::rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!renamed) {
+        (void)std::remove(tmpPath.c_str());
+    }
+    return renamed;
+}
+
+int OutputFormatted(const std::string& sourcePath, const std::string& targetPath, const std::string& rawCode,
+    const std::string& formatted, OutputMode mode, bool& changed)
+{
+    changed = formatted != rawCode;
+    if (mode == OutputMode::CHECK) {
+        if (changed) {
+            Println(sourcePath);
+        }
+        return OK;
+    }
+    if (mode == OutputMode::DIFF) {
+        if (changed) {
+            Print(UnifiedDiff(rawCode, formatted, sourcePath, sourcePath));
+        }
+        return OK;
+    }
+    if (targetPath == sourcePath) {
+        if (!changed) {
+            return OK;
+        }
+    } else if (std::string existing; FileUtil::FileExist(targetPath) && ReadFile(targetPath, existing) &&
+        existing == formatted) {
+        // an earlier run already wrote the same output, keep its modification time
+        return OK;
+    }
+    if (!WriteFileAtomically(targetPath, formatted)) {
+        Errorln("Create target file error.");
+        return ERR;
+    }
+    return OK;
+}
+} // namespace Cangjie::Format
@@ -0,0 +1,101 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/FormatServer.h"
+#include "Format/FormatCodeProcessor.h"
+
+#include <regex>
+#include <sstream>
+
+namespace Cangjie::Format {
+namespace {
+const std::string FORMAT_REQUEST = "FORMAT";
+const std::string QUIT_REQUEST = "QUIT";
+// Longer buffers are refused, a corrupt length must not make the server allocate without bound.
+const size_t MAX_BUFFER_LENGTH = 1UL << 30;
+
+void Respond(std::ostream& out, const std::string& status, const std::string& body)
+{
+    out << status << ' ' << body.size() << '\n';
+    (void)out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    (void)out.flush();
+}
+
+bool ParseLength(const std::string& text, size_t& length)
+{
+    static const std::regex reg("\\d{1,10}");
+    if (!std::regex_match(text, reg)) {
+        return false;
+    }
+    length = static_cast<size_t>(std::stoull(text));
+    return length <= MAX_BUFFER_LENGTH;
+}
+
+bool ParseRegion(const std::string& text, Region& region)
+{
+    if (text == "-") {
+        region = Region::wholeFile;
+        return true;
+    }
+    static const std::regex reg("(\\d{1,9}):(\\d{1,9})");
+    std::smatch match;
+    if (!std::regex_match(text, match, reg)) {
+        return false;
+    }
+    int start = std::stoi(match[1].str());
+    int end = std::stoi(match[2].str());
+    if (start > end) {
+        return false;
+    }
+    region = Region(start, end, false);
+    return true;
+}
+} // namespace
+
+int RunFormatServer(std::istream& in, std::ostream& out, const OptionsProvider& optionsFor)
+{
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line == QUIT_REQUEST) {
+            return OK;
+        }
+        std::istringstream request(line);
+        std::string command, lengthText, regionText, path;
+        request >> command >> lengthText >> regionText;
+        (void)std::getline(request >> std::ws, path);
+        size_t length = 0;
+        if (command != FORMAT_REQUEST || !ParseLength(lengthText, length) || path.empty()) {
+            // without a valid length the end of the buffer is unknown, the rest of the input can't be trusted
+            Respond(out, "ERROR", "Invalid request: " + line);
+            return ERR;
+        }
+        std::string buffer(length, '\0');
+        if (!in.read(buffer.data(), static_cast<std::streamsize>(length))) {
+            Respond(out, "ERROR", "The input ended inside the buffer of: " + line);
+            return ERR;
+        }
+        Region region = Region::wholeFile;
+        if (!ParseRegion(regionText, region)) {
+            Respond(out, "ERROR", "Invalid region format, use - or <start>:<end>: " + regionText);
+            continue;
+        }
+
+        auto formatted = FormatText(buffer, path, region, optionsFor(path));
+        if (!formatted) {
+            Respond(out, "ERROR", "The buffer has syntax errors and was not formatted.");
+            continue;
+        }
+        Respond(out, "OK", formatted.value());
+    }
+    return OK;
+}
+} // namespace Cangjie::Format
@@ -0,0 +1,111 @@
+// Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+// This source file is part of the Cangjie project, licensed under Apache-2.0
+// with Runtime Library Exception.
+//
+// See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#include "Format/FormatStats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace Cangjie::Format;
+
+namespace {
+const char* const PHASE_NAMES[] = {"lex", "parse", "doc build", "print", "comments"};
+const double BYTES_PER_MIB = 1024.0 * 1024.0;
+
+// Peak resident size of the process in bytes, 0 where it is not measured.
+size_t PeakMemory()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // in KiB
+#endif
+#endif
+}
+
+std::string FormatLine(const char* name, double seconds, double mibPerSecond, double peakMib)
+{
+    char line[128];
+    (void)std::snprintf(line, sizeof(line), "%-10s %10.4f %12.2f %10.2f\n", name, seconds, mibPerSecond, peakMib);
+    return line;
+}
+} // namespace
+
+void FormatStats::SetEnabled(bool enabled)
+{
+    m_enabled.store(enabled);
+}
+
+bool FormatStats::IsEnabled() const noexcept
+{
+    return m_enabled.load();
+}
+
+void FormatStats::AddInput(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_inputBytes += bytes;
+    ++m_files;
+}
+
+void FormatStats::AddPhase(FormatPhase phase, double seconds, size_t peakGrowth)
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto& stats = m_phases[static_cast<size_t>(phase)];
+    stats.seconds += seconds;
+    stats.peakGrowth = std::max(stats.peakGrowth, peakGrowth);
+    ++stats.runs;
+}
+
+void FormatStats::PrintReport(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    double mib = static_cast<double>(m_inputBytes) / BYTES_PER_MIB;
+    out << "files " << m_files << ", input " << m_inputBytes << " bytes\n";
+    out << "phase         seconds        MiB/s   peak MiB\n";
+    double total = 0;
+    for (size_t i = 0; i < m_phases.size(); ++i) {
+        auto& stats = m_phases[i];
+        if (stats.runs == 0) {
+            continue;
+        }
+        total += stats.seconds;
+        out << FormatLine(PHASE_NAMES[i], stats.seconds, stats.seconds > 0 ? mib / stats.seconds : 0,
+            static_cast<double>(stats.peakGrowth) / BYTES_PER_MIB);
+    }
+    // the peak of the whole process rather than a growth
+    out << FormatLine("total", total, total > 0 ? mib / total : 0, static_cast<double>(PeakMemory()) / BYTES_PER_MIB);
+    (void)out.flush();
+}
+
+PhaseTimer::PhaseTimer(FormatPhase phase) : phase(phase), enabled(FormatStats::GetInstance().IsEnabled())
+{
+    if (enabled) {
+        startPeak = PeakMemory();
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (!enabled) {
+        return;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto peak = PeakMemory();
+    FormatStats::GetInstance().AddPhase(phase, elapsed.count(), peak > startPeak ? peak - startPeak : 0);
+}
@@ -38,9 +38,39 @@ void OptionContext::SetCangjieHome(const std::string& cangjieHome)
     this->m_cangjieHome = cangjieHome;
 }
 
-void OptionContext::SetConfigOptions(const FormattingOptions& configOptions)
+void OptionContext::SetJobs(unsigned int jobs)
 {
-    this->m_configOptions = configOptions;
+    this->m_jobs = jobs;
+}
+
+void OptionContext::SetOutputMode(OutputMode outputMode)
+{
+    this->m_outputMode = outputMode;
+}
+
+void OptionContext::SetCacheDir(const std::string& cacheDir)
+{
+    this->m_cacheDir = cacheDir;
+}
+
+void OptionContext::SetUseCache(bool useCache)
+{
+    this->m_useCache = useCache;
+}
+
+void OptionContext::SetFromStdin(bool fromStdin)
+{
+    this->m_fromStdin = fromStdin;
+}
+
+void OptionContext::SetAssumeFilename(const std::string& assumeFilename)
+{
+    this->m_assumeFilename = assumeFilename;
+}
+
+void OptionContext::SetServerMode(bool serverMode)
+{
+    this->m_serverMode = serverMode;
 }
 
 const std::string& OptionContext::GetFmtFilePath() const
@@ -73,8 +103,37 @@ const std::string& OptionContext::GetCangjieHome() const
     return m_cangjieHome;
 }
 
-FormattingOptions OptionContext::GetConfigOptions() const noexcept
+unsigned int OptionContext::GetJobs() const noexcept
 {
-    return m_configOptions;
+    return m_jobs;
 }
 
+OutputMode OptionContext::GetOutputMode() const noexcept
+{
+    return m_outputMode;
+}
+
+const std::string& OptionContext::GetCacheDir() const
+{
+    return m_cacheDir;
+}
+
+bool OptionContext::GetUseCache() const noexcept
+{
+    return m_useCache;
+}
+
+bool OptionContext::GetFromStdin() const noexcept
+{
+    return m_fromStdin;
+}
+
+const std::string& OptionContext::GetAssumeFilename() const
+{
+    return m_assumeFilename;
+}
+
+bool OptionContext::GetServerMode() const noexcept
+{
+    return m_serverMode;
+}
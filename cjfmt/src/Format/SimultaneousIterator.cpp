@@ -64,46 +64,42 @@ std::vector<Token> SimultaneousIterator::Advance()
             ++outputIterator;
         }
     }
-    auto recovered = RecoverOnMismatch();
-    if (recovered.has_value()) {
-        auto commentsSkippedWhileRecovering = recovered.value();
-        (void)commentsBetween.insert(commentsBetween.end(),
-            commentsSkippedWhileRecovering.begin(), commentsSkippedWhileRecovering.end());
-    }
-
+    RecoverOnMismatch(commentsBetween);
     return commentsBetween;
 }
 
-std::optional<std::vector<Token>> SimultaneousIterator::RecoverOnMismatch()
+void SimultaneousIterator::RecoverOnMismatch(std::vector<Token> &skippedComments)
 {
     if (originalIterator == originalTokens.end() || outputIterator == outputTokens.end()) {
-        return std::nullopt;
+        return;
     }
     if (originalIterator->Value() == outputIterator->Value()) {
-        return std::nullopt;
+        return;
     }
 
     if (IsModifier(*originalIterator) && IsModifier(*outputIterator)) {
         // formatter can reorder modifiers
-        return std::nullopt;
+        return;
     }
 
     // try to recover to next non-whitespace token
     // first try to move original iterator forward
     // because we could delete tokens such as semicolon
     // so the output iterator would be ahead of original
-    std::vector<Token> skippedComments;
     auto originalRecoverCandidate = std::next(originalIterator);
     while (originalRecoverCandidate != originalTokens.end() && IsCommentOrNL(*originalRecoverCandidate)) {
-        if (IsComment(*originalRecoverCandidate)) {
-            skippedComments.push_back(*originalRecoverCandidate);
-        }
         ++originalRecoverCandidate;
     }
     if (originalRecoverCandidate != originalTokens.end() &&
         originalRecoverCandidate->Value() == outputIterator->Value()) {
+        // only the comments of a successful recovery are kept, the lookahead itself copies nothing
+        for (auto it = std::next(originalIterator); it != originalRecoverCandidate; ++it) {
+            if (IsComment(*it)) {
+                skippedComments.push_back(*it);
+            }
+        }
         originalIterator = originalRecoverCandidate;
-        return skippedComments;
+        return;
     }
 
     auto outputRecoverCandidate = std::next(outputIterator);
@@ -113,10 +109,7 @@ std::optional<std::vector<Token>> SimultaneousIterator::RecoverOnMismatch()
     if (outputRecoverCandidate != outputTokens.end() &&
         outputRecoverCandidate->Value() == originalIterator->Value()) {
         outputIterator = outputRecoverCandidate;
-        return std::nullopt;
     }
-
-    return std::nullopt;
 }
 
 std::optional<std::pair<std::vector<Token>, std::vector<Token>>> ExtractTokensBetweenPositions(
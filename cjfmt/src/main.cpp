@@ -5,14 +5,25 @@
 // See https://cangjie-lang.cn/pages/LICENSE for license information.
 
 #include "Format/FormatCodeProcessor.h"
+#include "Format/FormatConfig.h"
+#include "Format/FormatServer.h"
+#include "Format/FormatStats.h"
 #include "Format/OptionContext.h"
-#include "Format/TomlParser.h"
 #include "cangjie/Basic/Print.h"
 #include "cangjie/Parse/Parser.h"
 #include "cangjie/Utils/FileUtil.h"
 
+#include <algorithm>
+#include <getopt.h>
+#include <iostream>
 #include <istream>
+#include <memory>
 #include <string>
+#include <thread>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 #include <regex>
 
@@ -22,12 +33,18 @@ using namespace Cangjie::Format;
 
 namespace {
 constexpr int MINIMUM_CJ_FILE_NAME = 4;
-constexpr int MIN_LINE_LIMIT_LENGTH = 1;
-constexpr int MAX_LINE_LIMIT_LENGTH = 120;
-constexpr int MIN_INDENT_WIDTH = 0;
-constexpr int MAX_INDENT_WIDTH = 8;
-constexpr int MIN_METHOD_CHAIN_LEVEL = 2;
-constexpr int MAX_METHOD_CHAIN_LEVEL = 10;
+constexpr int MAX_JOBS = 1024;
+// values of the long options, past any short option character
+constexpr int OPT_CHECK = 256;
+constexpr int OPT_DIFF = 257;
+constexpr int OPT_CACHE_DIR = 258;
+constexpr int OPT_NO_CACHE = 259;
+constexpr int OPT_STDIN = 260;
+constexpr int OPT_ASSUME_FILENAME = 261;
+constexpr int OPT_SERVER = 262;
+constexpr int OPT_STATS = 263;
+// file name of a buffer read with --stdin when --assume-filename is not given
+const std::string STDIN_FILE_NAME = "<stdin>.cj";
 #ifdef _WIN32
 const std::string DELIMITER = "\\";
 #else
@@ -42,22 +59,56 @@ void ShowUsage()
     Println("cjfmt -f file [option]...");
 }
 
-int FmtFile(const std::string& fmtFilePath, const std::string& fileOutputPath, const Region region)
+/* Progress messages are left out with --check and --diff, whose standard output is the file list or the diff, and
+ * with --stdin and --server, whose standard output is the formatted code. */
+void PrintProgress(const std::string& message)
+{
+    OptionContext& optionContext = OptionContext::GetInstance();
+    if (optionContext.GetOutputMode() == OutputMode::WRITE && !optionContext.GetFromStdin() &&
+        !optionContext.GetServerMode()) {
+        Println(message);
+    }
+}
+
+bool IsCachedAsFormatted(const std::string& fmtFilePath, const FormatCache& cache, std::string& rawCode)
 {
+    std::ifstream instream(fmtFilePath);
+    if (!instream) {
+        return false;
+    }
+    rawCode.assign((std::istreambuf_iterator<char>(instream)), std::istreambuf_iterator<char>());
+    return cache.IsFormatted(rawCode);
+}
+
+int FmtFile(const std::string& fmtFilePath, const std::string& fileOutputPath, const Region region,
+    const FormattingOptions& options, OutputMode mode, FormatCache* cache)
+{
+    // a region may be formatted in a file that is not formatted as a whole, the cache only holds whole files
+    if (!region.isWholeFile) {
+        cache = nullptr;
+    }
     std::string source, rawCode;
-    if (!FormatFile(rawCode, fmtFilePath, source, region)) {
+    bool parsed = false;
+    if (cache && IsCachedAsFormatted(fmtFilePath, *cache, rawCode)) {
+        source = rawCode;
+    } else if (FormatFile(rawCode, fmtFilePath, source, region, options)) {
+        parsed = true;
+    } else if (mode != OutputMode::WRITE) {
+        // a file that can't be parsed is not known to be formatted, the diagnostics have been reported
+        return ERR;
+    } else {
         source = rawCode;
     }
 
-    std::ofstream outStream(fileOutputPath, std::ios::out | std::ios::binary);
-    if (!outStream.is_open()) {
-        Errorln("Create target file error!");
+    bool changed = false;
+    if (OutputFormatted(fmtFilePath, fileOutputPath, rawCode, source, mode, changed) != OK) {
         return ERR;
     }
-    auto length = source.size();
-    (void)outStream.write(source.data(), static_cast<long>(length));
-    outStream.close();
-    return OK;
+    if (cache && parsed && !changed) {
+        cache->AddFormatted(rawCode);
+        cache->Save();
+    }
+    return mode != OutputMode::WRITE && changed ? ERR : OK;
 }
 
 int EditFileNameAndPath(std::string& fmtFilePath, std::string& fileOutputPath)
@@ -93,8 +144,10 @@ int EditFileNameAndPath(std::string& fmtFilePath, std::string& fileOutputPath)
 void PrintHelp()
 {
     Println("Usage: ");
-    Println("     cjfmt -f fileName [-o fileName] [-l start:end]");
-    Println("     cjfmt -d fileDir [-o fileDir]");
+    Println("     cjfmt -f fileName [-o fileName] [-l start:end] [--check | --diff]");
+    Println("     cjfmt -d fileDir [-o fileDir] [-j jobs] [--check | --diff]");
+    Println("     cjfmt --stdin [--assume-filename fileName] [-l start:end]");
+    Println("     cjfmt --server");
     Println("Options:");
     Println("   -h            Show usage");
     Println("                     eg: cjfmt -h");
@@ -117,6 +170,8 @@ void PrintHelp()
             "configuration file in CANGJIE_HOME");
     Println("                 If the default configuration file also fails to be read, will use the built-in "
             "configuration.");
+    Println("                 Without it, each file uses the cangjie-format.toml of its directory or of the nearest of "
+            "its parents, if any.");
     Println("                     eg: cjfmt -f a.cj -c ./config/cangjie-format.toml");
     Println("                     eg: cjfmt -d ~/testsrc -c ~/home/project/config/cangjie-format.toml");
     Println("   -l <region>   Only format lines in the specified region for the provided file. Only valid if a single "
@@ -125,6 +180,46 @@ void PrintHelp()
             "representing first and last lines to be formated in the specified file.");
     Println("                 Line count starts with 1.");
     Println("                     eg: cjfmt -f a.cj -o ./fmta.cj -l 1:25");
+    Println("   -j <jobs>     Number of files formatted at the same time. Only valid if a file directory was "
+            "specified.");
+    Println("                 Defaults to the number of hardware threads. Diagnostics and output files keep the path "
+            "order whatever the number.");
+    Println("                     eg: cjfmt -d ~/testsrc -j 8");
+    Println("   --check       Write nothing, list the files that formatting would change and exit with 1 if there "
+            "are any.");
+    Println("                     eg: cjfmt -d ~/testsrc --check");
+    Println("   --diff        Write nothing, print a unified diff of the changes formatting would make and exit with 1 "
+            "if there are any.");
+    Println("                     eg: cjfmt -f a.cj --diff");
+    Println("                 Without them, only the files whose content changes are written.");
+    Println("   --cache-dir <dir>");
+    Println("                 Directory of the cache of files known to be formatted, which are then not formatted "
+            "again.");
+    Println("                 Defaults to cjfmt under the per-user cache directory ($XDG_CACHE_HOME, ~/.cache or "
+            "%LOCALAPPDATA%).");
+    Println("                     eg: cjfmt -d ~/testsrc --cache-dir ./.cjfmt_cache");
+    Println("   --no-cache    Neither read nor update the cache, every file is formatted.");
+    Println("                     eg: cjfmt -d ~/testsrc --no-cache");
+    Println("   --stdin       Format the code read from the standard input and write it to the standard output.");
+    Println("                 Code with syntax errors is written back unchanged and cjfmt exits with 1.");
+    Println("                     eg: cjfmt --stdin < a.cj > fmta.cj");
+    Println("   --assume-filename <value>");
+    Println("                 File name of the code read with --stdin, used in diagnostics and to find the "
+            "cangjie-format.toml of the file's");
+    Println("                 directory or the nearest of its parents when -c is not given.");
+    Println("                     eg: cjfmt --stdin --assume-filename src/a.cj < src/a.cj");
+    Println("   --server      Serve format requests read from the standard input until it ends or QUIT is read, "
+            "each configuration file is read once.");
+    Println("                 A request is the line 'FORMAT <length> <region> <path>' followed by the <length> bytes "
+            "of the code, <region> being");
+    Println("                 '-' for the whole code or start:end. The response is the line 'OK <length>' followed by "
+            "the formatted code,");
+    Println("                 or 'ERROR <length>' followed by a message.");
+    Println("                     eg: cjfmt --server");
+    Println("   --stats       Print the time and peak memory growth of each formatting phase to the standard error "
+            "when done.");
+    Println("                 Memory figures are only meaningful when one file is formatted at a time.");
+    Println("                     eg: cjfmt -f a.cj --check --stats");
 }
 
 void PrintVersion()
@@ -136,236 +231,114 @@ void PrintVersion()
 #endif
 }
 
-void SetOptionIndentWidth(TomlParser& parser, FormattingOptions& options)
+std::optional<FormattingOptions> ReadConfigHelper(const std::string& configPath, const std::string& configType)
 {
-    auto indentWidthOptional = parser.GetValue("indentWidth");
-    if (!indentWidthOptional.has_value()) {
-        Warningln("Can't find configuration options: indentWidth, built-in options will be used: indentWidth = 4");
-        return;
-    }
-    std::optional<int> indentWidth;
-    std::visit(
-        [&indentWidth](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, int>) {
-                indentWidth = value;
-            } else {
-                Warningln("Configuration options: indentWidth's type should be integer, "
-                          "Built-in options will be used: indentWidth = 4");
+    if (FileUtil::FileExist(configPath)) {
+        auto absConfigPath = FileUtil::GetAbsPath(configPath).value();
+        std::vector<std::string> warnings;
+        auto options = absConfigPath.empty() ? std::nullopt : ReadFormatConfig(absConfigPath, warnings);
+        if (options.has_value()) {
+            PrintProgress("Reading " + configType + " format configuration files...");
+            for (auto& warning : warnings) {
+                Warningln(warning);
             }
-        },
-        indentWidthOptional.value());
-    if (!indentWidth.has_value()) {
-        return;
-    }
-    if (*indentWidth < MIN_INDENT_WIDTH || *indentWidth > MAX_INDENT_WIDTH) {
-        Warningln("Configuration options: indentWidth is out of range [0, 8], "
-                  "Built-in options will be used: indentWidth = 4");
-        return;
+            return options;
+        } else {
+            Warningln("Failed to read " + configType + " format configuration files.");
+            return std::nullopt;
+        }
     }
-    options.indentWidth = *indentWidth;
+    Warningln(configType + " format configuration files not Exist");
+    return std::nullopt;
 }
 
-void SetOptionLineLength(TomlParser& parser, FormattingOptions& options)
+// Options when no configuration file applies to a file, those of the installation if it has some.
+FormattingOptions GetDefaultOptions()
 {
-    auto lineLimitLengthOptional = parser.GetValue("linelimitLength");
-    if (!lineLimitLengthOptional.has_value()) {
-        Warningln("Can't find configuration options: linelimitLength, "
-                  "built-in options will be used: linelimitLength = 120");
-        return;
-    }
-    std::optional<int> linelimitLength;
-    std::visit(
-        [&linelimitLength](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, int>) {
-                linelimitLength = value;
-            } else {
-                Warningln("Configuration options: linelimitLength's type should be integer, Built-in options will "
-                          "be used: linelimitLength = 120");
-            }
-        },
-        lineLimitLengthOptional.value());
-    if (!linelimitLength.has_value()) {
-        return;
-    }
-    if (*linelimitLength < MIN_LINE_LIMIT_LENGTH || *linelimitLength > MAX_LINE_LIMIT_LENGTH) {
-        Warningln("Configuration options: linelimitLength is out of range [1, 120], "
-                  "Built-in options will be used: linelimitLength = 120");
-        return;
+    auto cangjieHome = OptionContext::GetInstance().GetCangjieHome();
+    if (!cangjieHome.empty()) {
+        std::string defaultConfigPath = FileUtil::JoinPath(cangjieHome, "/tools/config/cangjie-format.toml");
+        auto defaultConfig = ReadConfigHelper(defaultConfigPath, "default");
+        if (defaultConfig.has_value()) {
+            return defaultConfig.value();
+        }
     }
-    options.lineLength = *linelimitLength;
-}
-
-void SetOptionLineBreakType(TomlParser& parser, FormattingOptions& options)
-{
-    auto lineBreakTypeOptional = parser.GetValue("lineBreakType");
-    if (!lineBreakTypeOptional.has_value()) {
-        Warningln("Can't find configuration options: lineBreakType, "
-                  "built-in options will be used: lineBreakType = \"LF\"");
-        return;
-    }
-    std::optional<std::string> lineBreakType;
-    std::visit(
-        [&lineBreakType](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, std::string>) {
-                lineBreakType = value;
-            } else {
-                Warningln(
-                    "Configuration options: lineBreakType's type should be string, "
-                    "Built-in options will be used: lineBreakType = \"LF\"");
-            }
-        },
-        lineBreakTypeOptional.value());
 
-    if (!lineBreakType.has_value()) {
-        return;
-    }
-    if (*lineBreakType != "CRLF" && *lineBreakType != "LF") {
-        Warningln("\"Configuration options: neither CRLF nor LF, "
-                  "Built-in options will be used: lineBreakType = \"LF\"");
-        return;
-    }
-    options.newLine = *lineBreakType == "CRLF" ? "\r\n" : "\n";
+    PrintProgress("Using built-in formatting options");
+    return FormattingOptions();
 }
 
-void SetOptionMethodChainning(TomlParser& parser, FormattingOptions& options)
+void ReportConfigRead(const std::string& configPath, const std::optional<FormattingOptions>& options,
+    const std::vector<std::string>& warnings)
 {
-    auto methodChainningOptional = parser.GetValue("allowMultiLineMethodChain");
-    if (!methodChainningOptional.has_value()) {
-        Warningln("Can't find configuration options: allowMultiLineMethodChain, "
-                  "built-in options will be used: allowMultiLineMethodChain = false");
-        return;
-    }
-    std::optional<bool> allowMultiLineMethodChain;
-    std::visit(
-        [&allowMultiLineMethodChain](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, bool>) {
-                allowMultiLineMethodChain = value;
-            } else {
-                Warningln("Configuration options: allowMultiLineMethodChain's type should be boolean, "
-                          "Built-in options will be used: allowMultiLineMethodChain = false");
-            }
-        },
-        methodChainningOptional.value());
-    if (!allowMultiLineMethodChain.has_value()) {
-        return;
+    if (!FileUtil::FileExist(configPath)) {
+        Warningln("Format configuration file " + configPath + " not Exist");
+    } else if (!options.has_value()) {
+        Warningln("Failed to read format configuration file " + configPath);
+    } else {
+        PrintProgress("Reading format configuration file " + configPath + "...");
+    }
+    for (auto& warning : warnings) {
+        Warningln(warning);
     }
-    options.allowMultiLineMethodChain = *allowMultiLineMethodChain;
 }
 
-void SetOptionMethodChainLevel(TomlParser& parser, FormattingOptions& options)
+/* Options of a file: those of -c if given, else of the nearest project configuration, else the default ones. A
+ * configuration file is parsed again only when it was modified, so a server does not read it for every request and a
+ * directory does not read it for every file. */
+FormattingOptions GetOptionsForFile(const std::string& filePath)
 {
-    auto methodChainningOptional = parser.GetValue("multipleLineMethodChainLevel");
-    if (!methodChainningOptional.has_value()) {
-        Warningln("Can't find configuration options: multipleLineMethodChainLevel, "
-                  "built-in options will be used: multipleLineMethodChainLevel = 5");
-        return;
-    }
-    std::optional<int> multipleLineMethodChainLevel;
-    std::visit(
-        [&multipleLineMethodChainLevel](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, int>) {
-                multipleLineMethodChainLevel = value;
-            } else {
-                Warningln("Configuration options: multipleLineMethodChainLevel's type should be integer, "
-                          "Built-in options will be used: multipleLineMethodChainLevel = 5");
-            }
-        },
-        methodChainningOptional.value());
-    if (!multipleLineMethodChainLevel.has_value()) {
-        return;
-    }
-    if (*multipleLineMethodChainLevel < MIN_METHOD_CHAIN_LEVEL ||
-        *multipleLineMethodChainLevel > MAX_METHOD_CHAIN_LEVEL) {
-        Warningln("Configuration options: multipleLineMethodChainLevel is out of range [2, 10], "
-                  "Built-in options will be used: multipleLineMethodChainLevel = 5");
-        return;
-    }
-    options.multipleLineMethodChainLevel = *multipleLineMethodChainLevel;
+    static ProjectConfigs configs(ReportConfigRead);
+    auto& configPath = OptionContext::GetInstance().GetConfigFilePath();
+    auto options = configPath.empty() ? configs.OptionsFor(filePath) : configs.OptionsOf(configPath);
+    if (options.has_value()) {
+        return options.value();
+    }
+    static const FormattingOptions defaultOptions = GetDefaultOptions();
+    return defaultOptions;
 }
 
-void SetOptionMultipleLineMethodChainOverLineLength(TomlParser& parser, FormattingOptions& options)
+void SetBinaryStdio()
 {
-    auto methodChainningOptional = parser.GetValue("multipleLineMethodChainOverLineLength");
-    if (!methodChainningOptional.has_value()) {
-        Warningln("Can't find configuration options: multipleLineMethodChainOverLineLength, "
-                  "built-in options will be used: multipleLineMethodChainOverLineLength = true");
-        return;
-    }
-    std::optional<bool> multipleLineMethodChainOverLineLength;
-    std::visit(
-        [&multipleLineMethodChainOverLineLength](auto&& value) {
-            using T = std::decay_t<decltype(value)>;
-            if constexpr (std::is_same_v<T, bool>) {
-                multipleLineMethodChainOverLineLength = value;
-            } else {
-                Warningln("Configuration options: multipleLineMethodChainOverLineLength's type should be boolean, "
-                          "Built-in options will be used: multipleLineMethodChainOverLineLength = true");
-            }
-        },
-        methodChainningOptional.value());
-    if (!multipleLineMethodChainOverLineLength.has_value()) {
-        return;
-    }
-    options.multipleLineMethodChainOverLineLength = *multipleLineMethodChainOverLineLength;
-}
-
-void SetFmtConfigOptions(TomlParser& parser, FormattingOptions& options)
-{
-    SetOptionIndentWidth(parser, options);
-    SetOptionLineLength(parser, options);
-    SetOptionLineBreakType(parser, options);
-    SetOptionMethodChainning(parser, options);
-    SetOptionMethodChainLevel(parser, options);
-    SetOptionMultipleLineMethodChainOverLineLength(parser, options);
+#ifdef _WIN32
+    // buffer lengths are counted in bytes, line breaks must not be translated
+    (void)_setmode(_fileno(stdin), _O_BINARY);
+    (void)_setmode(_fileno(stdout), _O_BINARY);
+#endif
 }
 
-std::optional<FormattingOptions> ReadConfigHelper(
-    TomlParser& parser, const std::string& configPath, FormattingOptions& options, const std::string& configType)
+int FormatStdin(const Region& region)
 {
-    if (FileUtil::FileExist(configPath)) {
-        auto absConfigPath = FileUtil::GetAbsPath(configPath).value();
-        if (!absConfigPath.empty() && parser.ReadFile(absConfigPath)) {
-            Println("Reading " + configType + " format configuration files...");
-            SetFmtConfigOptions(parser, options);
-            return options;
-        } else {
-            Warningln("Failed to read " + configType + " format configuration files.");
-            return std::nullopt;
-        }
-    }
-    Warningln(configType + " format configuration files not Exist");
-    return std::nullopt;
+    OptionContext& optionContext = OptionContext::GetInstance();
+    auto filePath = optionContext.GetAssumeFilename().empty() ? STDIN_FILE_NAME : optionContext.GetAssumeFilename();
+    SetBinaryStdio();
+    std::string rawCode((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+    auto formatted = FormatText(rawCode, filePath, region, GetOptionsForFile(filePath));
+    // an editor replacing its buffer with the output loses nothing when the code can't be formatted
+    const std::string& output = formatted ? formatted.value() : rawCode;
+    (void)std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+    (void)std::cout.flush();
+    return formatted ? OK : ERR;
 }
 
-FormattingOptions GetOptionsInfo(const std::string& configPath)
+int FormatBuffers(const Region& region)
 {
     OptionContext& optionContext = OptionContext::GetInstance();
-    FormattingOptions options;
-    TomlParser parser;
-
-    if (!configPath.empty()) {
-        auto customizedConfig = ReadConfigHelper(parser, configPath, options, "customized");
-        if (customizedConfig.has_value()) {
-            return customizedConfig.value();
-        }
+    if (!optionContext.GetFmtFilePath().empty() || !optionContext.GetFmtDirPath().empty() ||
+        !optionContext.GetFileOutputPath().empty() || !optionContext.GetDirOutputPath().empty() ||
+        optionContext.GetOutputMode() != OutputMode::WRITE) {
+        Errorln("Options --stdin and --server can not be used with -f, -d, -o, --check or --diff.");
+        return ERR;
     }
-
-    auto cangjieHome = optionContext.GetCangjieHome();
-    if (!cangjieHome.empty()) {
-        std::string defaultConfigPath = FileUtil::JoinPath(cangjieHome, "/tools/config/cangjie-format.toml");
-        auto defaultConfig = ReadConfigHelper(parser, defaultConfigPath, options, "default");
-        if (defaultConfig.has_value()) {
-            return defaultConfig.value();
-        }
+    if (!optionContext.GetServerMode()) {
+        return FormatStdin(region);
     }
-
-    Println("Using built-in formatting options");
-    return options;
+    if (optionContext.GetFromStdin() || !region.isWholeFile || !optionContext.GetAssumeFilename().empty()) {
+        Errorln("Option --server can not be used with --stdin, -l or --assume-filename, requests carry them.");
+        return ERR;
+    }
+    SetBinaryStdio();
+    return RunFormatServer(std::cin, std::cout, GetOptionsForFile);
 }
 
 int DoFormat(const Region& region)
@@ -375,33 +348,57 @@ int DoFormat(const Region& region)
     auto fmtDirPath = optionContext.GetFmtDirPath();
     auto fileOutputPath = optionContext.GetFileOutputPath();
     auto dirOutputPath = optionContext.GetDirOutputPath();
-    auto configPath = optionContext.GetConfigFilePath();
 
+    if (optionContext.GetFromStdin() || optionContext.GetServerMode()) {
+        return FormatBuffers(region);
+    }
+    if (!optionContext.GetAssumeFilename().empty()) {
+        Errorln("Option --assume-filename can only be used with --stdin.");
+        return ERR;
+    }
     if (fmtFilePath.empty() && fmtDirPath.empty()) {
         Errorf("Action has no specific file or directory to operate on.\n");
         PrintHelp();
         return ERR;
     }
-    Println("Formatting start...");
-    optionContext.SetConfigOptions(GetOptionsInfo(configPath));
+    auto mode = optionContext.GetOutputMode();
+    if (mode != OutputMode::WRITE && (!fileOutputPath.empty() || !dirOutputPath.empty())) {
+        Errorln("Option -o can not be used with --check or --diff.");
+        return ERR;
+    }
+    PrintProgress("Formatting start...");
+    auto cacheDir = optionContext.GetCacheDir().empty() ? FormatCache::DefaultDir() : optionContext.GetCacheDir();
+    if (!optionContext.GetUseCache()) {
+        cacheDir.clear();
+    }
     int result;
     if (!fmtDirPath.empty()) {
-        result = FmtDir(fmtDirPath, dirOutputPath);
-        Println("Formatting complete.");
+        auto jobs = optionContext.GetJobs();
+        if (jobs == 0) {
+            jobs = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        result = FmtDir(fmtDirPath, dirOutputPath, GetOptionsForFile, jobs, mode, cacheDir);
+        PrintProgress("Formatting complete.");
         return result;
     } else {
         if (fmtFilePath.size() < MINIMUM_CJ_FILE_NAME || !HasEnding(fmtFilePath, ".cj")) {
             Errorln("CangjieFormat only support Cangjie source code file!");
             ShowUsage();
-            Println("Formatting complete.");
+            PrintProgress("Formatting complete.");
             return ERR;
         }
         if (EditFileNameAndPath(fmtFilePath, fileOutputPath) == ERR) {
-            Println("Formatting complete.");
+            PrintProgress("Formatting complete.");
             return ERR;
         }
-        result = FmtFile(fmtFilePath, fileOutputPath, region);
-        Println("Formatting complete.");
+        auto options = GetOptionsForFile(fmtFilePath);
+        std::unique_ptr<FormatCache> cache;
+        if (!cacheDir.empty()) {
+            cache = std::make_unique<FormatCache>(cacheDir, options);
+            cache->Load();
+        }
+        result = FmtFile(fmtFilePath, fileOutputPath, region, options, mode, cache.get());
+        PrintProgress("Formatting complete.");
         return result;
     }
 }
@@ -435,6 +432,25 @@ int GetRegionFromArgs(Region& region, std::string optarg)
     return OK;
 }
 
+int GetJobsFromArgs(OptionContext& optionContext, const std::string& optarg)
+{
+    std::regex reg = std::regex("\\d+");
+    int jobs = 0;
+    if (std::regex_match(optarg, reg)) {
+        try {
+            jobs = std::stoi(optarg);
+        } catch (const std::out_of_range& e) {
+            jobs = 0;
+        }
+    }
+    if (jobs < 1 || jobs > MAX_JOBS) {
+        Errorln("Invalid jobs number, it should be an integer in the range [1, 1024].");
+        return ERR;
+    }
+    optionContext.SetJobs(static_cast<unsigned int>(jobs));
+    return OK;
+}
+
 int VerifydirOutputPath(const std::string& dirOutputPath)
 {
     std::regex reg = std::regex("[^*?\"<>|]*");
@@ -456,7 +472,17 @@ int ConfigureOutputArgs(const std::string& optarg, bool& isFile, OptionContext&
     return VerifydirOutputPath(optionContext.GetDirOutputPath());
 }
 
-int HandleOption(char ch, const char* optarg, bool& isFile, Region& region, OptionContext& optionContext)
+int SetOutputModeFromArgs(OptionContext& optionContext, OutputMode mode)
+{
+    if (optionContext.GetOutputMode() != OutputMode::WRITE && optionContext.GetOutputMode() != mode) {
+        Errorln("Options --check and --diff can not be used together.");
+        return ERR;
+    }
+    optionContext.SetOutputMode(mode);
+    return OK;
+}
+
+int HandleOption(int ch, const char* optarg, bool& isFile, Region& region, OptionContext& optionContext)
 {
     switch (ch) {
         case 'h':
@@ -483,7 +509,36 @@ int HandleOption(char ch, const char* optarg, bool& isFile, Region& region, Opti
         case 'c':
             optionContext.SetConfigFilePath(optarg);
             break;
+        case 'j':
+            return GetJobsFromArgs(optionContext, optarg);
+        case OPT_CHECK:
+            return SetOutputModeFromArgs(optionContext, OutputMode::CHECK);
+        case OPT_DIFF:
+            return SetOutputModeFromArgs(optionContext, OutputMode::DIFF);
+        case OPT_CACHE_DIR:
+            optionContext.SetCacheDir(optarg);
+            break;
+        case OPT_NO_CACHE:
+            optionContext.SetUseCache(false);
+            break;
+        case OPT_STDIN:
+            optionContext.SetFromStdin(true);
+            break;
+        case OPT_ASSUME_FILENAME:
+            optionContext.SetAssumeFilename(optarg);
+            break;
+        case OPT_SERVER:
+            optionContext.SetServerMode(true);
+            break;
+        case OPT_STATS:
+            FormatStats::GetInstance().SetEnabled(true);
+            break;
         default:
+            if (optopt == 0) {
+                // an unknown long option, getopt_long has already reported it by name
+                Error("Try: 'cjfmt -h' for more information.\n");
+                return ERR;
+            }
             Error("invalid option or option requires an argument: -", static_cast<char>(optopt), "\n",
                 "Try: 'cjfmt -h' for more information.\n");
             return ERR;
@@ -542,12 +597,27 @@ int main(int argc, char** argv, const char** envp)
     optionContext.SetCangjieHome(CheckAndSetCangjieHome(envp));
 
     int ch;
-    const std::string optString = "hvo:d:f:l:c:";
-    while ((ch = getopt(argc, argv, optString.c_str())) != -1) {
+    const std::string optString = "hvo:d:f:l:c:j:";
+    const struct option longOptions[] = {
+        {"check", no_argument, nullptr, OPT_CHECK},
+        {"diff", no_argument, nullptr, OPT_DIFF},
+        {"cache-dir", required_argument, nullptr, OPT_CACHE_DIR},
+        {"no-cache", no_argument, nullptr, OPT_NO_CACHE},
+        {"stdin", no_argument, nullptr, OPT_STDIN},
+        {"assume-filename", required_argument, nullptr, OPT_ASSUME_FILENAME},
+        {"server", no_argument, nullptr, OPT_SERVER},
+        {"stats", no_argument, nullptr, OPT_STATS},
+        {nullptr, 0, nullptr, 0},
+    };
+    while ((ch = getopt_long(argc, argv, optString.c_str(), longOptions, nullptr)) != -1) {
         int res = HandleOption(ch, optarg, isFile, region, optionContext);
         if (res != OK || ch == 'h' || ch == 'v') {
             return res;
         }
     }
-    return CheckArguments(argc, argv) ? DoFormat(region) : ERR;
+    int result = CheckArguments(argc, argv) ? DoFormat(region) : ERR;
+    if (FormatStats::GetInstance().IsEnabled()) {
+        FormatStats::GetInstance().PrintReport(std::cerr);
+    }
+    return result;
 }
@@ -0,0 +1,152 @@
+# Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+# This source file is part of the Cangjie project, licensed under Apache-2.0
+# with Runtime Library Exception.
+#
+# See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+
+"""generate a tree of Cangjie sources, time `cjfmt -d` on it with different job counts and fail when the speedup
+over one job falls short of near-linear"""
+
+import argparse
+import filecmp
+import multiprocessing
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+FILE_HEADER = """package bench.pkg{pkg}
+
+import std.collection.*
+"""
+
+# deliberately badly spaced so that every file has something to format
+CLASS_TEMPLATE = """
+// class {idx} of package {pkg}
+public class Item{idx}   {{
+    var values : ArrayList<Int64> = ArrayList<Int64>()
+    public init( size:Int64 ) {{
+        for (i in 0..size) {{ values.append(i*{idx}) }}
+    }}
+
+    /* sum of the values
+     * kept above a bound */
+    public func sum(bound: Int64): Int64 {{
+        var total = 0
+        for (v in values) {{ if (v > bound) {{ total += v }} else {{ total -= 1 }} }}
+        return total
+    }}
+
+    public func describe(): String {{
+        let parts = values.iterator().map({{ v => v.toString() }}).filter({{ s => s.size > 0 }}).toArray()
+        return "Item{idx}(" + parts.size.toString() + ")"
+    }}
+}}
+
+func helper{idx}(a: Int64, b: Int64, c: Int64, d: Int64, e: Int64, f: Int64, g: Int64, h: Int64): Int64 {{
+    match (a % 3) {{
+        case 0 => a + b + c + d
+        case 1 => e + f + g + h
+        case _ => a * h
+    }}
+}}
+"""
+
+
+def generate(root, packages, files_per_package, classes_per_file):
+    """write packages * files_per_package unformatted sources under root"""
+    for pkg in range(packages):
+        pkg_dir = os.path.join(root, "src", "pkg%d" % pkg)
+        os.makedirs(pkg_dir, exist_ok=True)
+        for idx in range(files_per_package):
+            text = FILE_HEADER.format(pkg=pkg) + "".join(
+                CLASS_TEMPLATE.format(pkg=pkg, idx=idx * classes_per_file + i) for i in range(classes_per_file))
+            with open(os.path.join(pkg_dir, "file%d.cj" % idx), "w") as out:
+                out.write(text)
+
+
+def run(cjfmt, src, out, jobs):
+    """format src into out with the given job count, return the wall time in seconds"""
+    shutil.rmtree(out, ignore_errors=True)
+    start = time.perf_counter()
+    # every run formats every file, the format cache would skip them after the first
+    proc = subprocess.run([cjfmt, "-d", src, "-o", out, "-j", str(jobs), "--no-cache"], stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE)
+    elapsed = time.perf_counter() - start
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr.decode(errors="replace"))
+        raise SystemExit("cjfmt -j %d failed with %d" % (jobs, proc.returncode))
+    return elapsed
+
+
+def same_tree(left, right):
+    """whether two output trees hold the same files with the same contents"""
+    cmp = filecmp.dircmp(left, right)
+    if cmp.left_only or cmp.right_only or cmp.funny_files:
+        return False
+    _, mismatch, errors = filecmp.cmpfiles(left, right, cmp.common_files, shallow=False)
+    if mismatch or errors:
+        return False
+    return all(same_tree(os.path.join(left, d), os.path.join(right, d)) for d in cmp.common_dirs)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("cjfmt", help="path of the cjfmt executable")
+    parser.add_argument("--packages", type=int, default=10)
+    parser.add_argument("--files", type=int, default=100, help="files per package")
+    parser.add_argument("--classes", type=int, default=4, help="classes per file")
+    cpus = multiprocessing.cpu_count()
+    parser.add_argument("--jobs", type=int, nargs="*",
+                        default=sorted({1, cpus} | {j for j in (2, 4, 8) if j < cpus}),
+                        help="job counts to time, the first one is the base of the speedup")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per job count, the fastest one counts")
+    parser.add_argument("--min-efficiency", type=float, default=0.6,
+                        help="fail when the speedup divided by the job count is lower, for job counts up to the "
+                             "number of CPUs; 0 only reports")
+    parser.add_argument("--keep", action="store_true", help="keep the generated tree")
+    args = parser.parse_args()
+
+    work = tempfile.mkdtemp(prefix="cjfmt_bench_")
+    try:
+        src = os.path.join(work, "tree")
+        generate(src, args.packages, args.files, args.classes)
+        count = args.packages * args.files
+        size = sum(os.path.getsize(os.path.join(d, f)) for d, _, fs in os.walk(src) for f in fs)
+        print("%d files, %.1f MiB" % (count, size / (1 << 20)))
+
+        baseline = None
+        base_time = None
+        slow = []
+        for jobs in args.jobs:
+            out = os.path.join(work, "out_j%d" % jobs)
+            elapsed = min(run(args.cjfmt, src, out, jobs) for _ in range(max(1, args.repeat)))
+            if baseline is None:
+                baseline = out
+                base_time = elapsed * args.jobs[0]
+            elif not same_tree(baseline, out):
+                raise SystemExit("output of -j %d differs from -j %d" % (jobs, args.jobs[0]))
+            speedup = base_time / elapsed
+            efficiency = speedup / jobs
+            print("-j %-4d %8.2fs %10.1f files/s %8.2f MiB/s  speedup %5.2f  efficiency %4.0f%%" %
+                  (jobs, elapsed, count / elapsed, size / (1 << 20) / elapsed, speedup, efficiency * 100))
+            if jobs <= cpus and efficiency < args.min_efficiency:
+                slow.append(jobs)
+        if slow:
+            raise SystemExit("speedup below %.0f%% of the job count with -j %s" %
+                             (args.min_efficiency * 100, ", ".join(str(j) for j in slow)))
+    finally:
+        if args.keep:
+            print("tree kept in " + work)
+        else:
+            shutil.rmtree(work, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,258 @@
+# Copyright (c) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+# This source file is part of the Cangjie project, licensed under Apache-2.0
+# with Runtime Library Exception.
+#
+# See https://cangjie-lang.cn/pages/LICENSE for license information.
+
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+
+"""format a corpus of worst-case shapes and real-world files one by one with `cjfmt --stats`, report the throughput
+and peak memory of each phase and fail on regressions"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from fmt_dir_bench import CLASS_TEMPLATE, FILE_HEADER
+
+PHASES = ["lex", "parse", "doc build", "print", "comments", "total"]
+
+
+def nested_lambdas(size):
+    """lambdas passed as the last argument of lambdas, size deep"""
+    body = "x0"
+    for i in range(size, 0, -1):
+        body = "apply(x%d, { x%d: Int64 => %s })" % (i - 1, i, body)
+    return "func nested(x0: Int64): Int64 {\n    %s\n}\n" % body
+
+
+def method_chain(size):
+    """one expression calling size methods in a row, with lambda arguments"""
+    calls = "".join(".map({ v => v + %d }).filter({ v => v %% %d != 0 })" % (i, i + 2) for i in range(size))
+    return "func chain(values: Array<Int64>) {\n    values.iterator()%s.toArray()\n}\n" % calls
+
+
+def array_literal(size):
+    """an array literal of size elements, some of them nested arrays"""
+    items = ", ".join("[%d, %d]" % (i, -i) if i % 7 == 0 else str(i) for i in range(size))
+    return "let table = [%s]\n" % items
+
+
+def nested_calls(size):
+    """calls nested size deep, each with several arguments"""
+    expr = "seed"
+    for i in range(size):
+        expr = "combine%d(%s, %d, \"s%d\", flag%d)" % (i % 5, expr, i, i, i % 3)
+    return "func calls(seed: Int64) {\n    %s\n}\n" % expr
+
+
+def long_conditions(size):
+    """a condition of size operands mixing binary operators and member accesses"""
+    operands = " && ".join("(item%d.value > %d || item%d.name.size == %d)" % (i, i, i, i) for i in range(size))
+    return "func check(): Bool {\n    if (%s) {\n        return true\n    }\n    false\n}\n" % operands
+
+
+def classes(size):
+    """the badly spaced classes of fmt_dir_bench, for realistic code"""
+    return "".join(CLASS_TEMPLATE.format(pkg=0, idx=i) for i in range(size))
+
+
+# name: (generator, size of the small case), each shape is also generated at twice that size
+SHAPES = {
+    "nested_lambdas": (nested_lambdas, 12),
+    "deep_lambdas": (nested_lambdas, 150),
+    "method_chain": (method_chain, 40),
+    "array_literal": (array_literal, 4000),
+    "nested_calls": (nested_calls, 24),
+    "deep_calls": (nested_calls, 300),
+    "long_conditions": (long_conditions, 150),
+    "classes": (classes, 200),
+}
+
+
+def generate(root, scale):
+    """write every shape at its size times scale and twice that, return the case names in order"""
+    os.makedirs(root, exist_ok=True)
+    names = []
+    for shape, (make, size) in SHAPES.items():
+        for factor in (1, 2):
+            name = "%s_x%d" % (shape, factor)
+            with open(os.path.join(root, name + ".cj"), "w") as out:
+                out.write(FILE_HEADER.format(pkg=0) + "\n" + make(size * scale * factor))
+            names.append(name)
+    return names
+
+
+def parse_stats(text):
+    """the phase table printed by --stats as {phase: {"seconds", "mib_per_s", "peak_mib"}}, and the other lines of
+    text, which are diagnostics"""
+    stats = {}
+    others = []
+    for line in text.splitlines():
+        if not line.strip() or line.startswith("files ") or line.startswith("phase "):
+            continue
+        for phase in PHASES:
+            values = line[len(phase):].split()
+            if line.startswith(phase + " ") and len(values) == 3:
+                stats[phase] = {"seconds": float(values[0]), "mib_per_s": float(values[1]),
+                                "peak_mib": float(values[2])}
+                break
+        else:
+            others.append(line)
+    return stats, others
+
+
+def run(cjfmt, path, timeout):
+    """format path in check mode, return its phase stats, None if cjfmt took longer than timeout seconds. Exits if
+    cjfmt did not format the file, the times of such a run say nothing about formatting"""
+    start = time.perf_counter()
+    try:
+        # --check writes nothing and exits with 1 when the file is not formatted, which is expected here
+        proc = subprocess.run([cjfmt, "-f", path, "--check", "--no-cache", "--stats"], stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    wall = time.perf_counter() - start
+    stderr = proc.stderr.decode(errors="replace")
+    stats, diagnostics = parse_stats(stderr)
+    # it also exits with 1 on syntax errors, a file that can't be parsed gets diagnostics and is neither turned into
+    # a Doc nor printed, while a file that would change is listed
+    problems = []
+    if diagnostics:
+        problems.append("printed diagnostics")
+    missing = [phase for phase in ("doc build", "print", "total") if phase not in stats]
+    if missing:
+        problems.append("ran no " + ", ".join(missing))
+    if proc.returncode == 1 and os.path.basename(path) not in proc.stdout.decode(errors="replace"):
+        problems.append("exited with 1 without listing the file")
+    elif proc.returncode not in (0, 1):
+        problems.append("exited with %d" % proc.returncode)
+    if problems:
+        sys.stderr.write(stderr)
+        raise SystemExit("cjfmt did not format %s: %s" % (path, "; ".join(problems)))
+    stats["wall"] = wall
+    return stats
+
+
+def formatted_size(cjfmt, path, timeout):
+    """bytes of the formatted path, the indentation of nested code makes it grow faster than the code itself"""
+    out = path[:-len(".cj")] + "_formatted.cj"
+    try:
+        subprocess.run([cjfmt, "-f", path, "-o", out, "--no-cache"], stdout=subprocess.DEVNULL,
+                       stderr=subprocess.DEVNULL, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return None
+    if not os.path.exists(out):
+        return None
+    size = os.path.getsize(out)
+    os.remove(out)
+    return size
+
+
+def check_growth(results, max_growth, min_seconds):
+    """names of the shapes whose time grows more than max_growth times when their formatted size doubles"""
+    failures = []
+    for shape in SHAPES:
+        small, large = results.get(shape + "_x1"), results.get(shape + "_x2")
+        if not small or not large:
+            continue
+        small_time, large_time = small["total"]["seconds"], large["total"]["seconds"]
+        # the output of deeply nested code grows with the square of its depth, it is what printing is linear in
+        size_growth = large["output"] / max(small["output"], 1) if small.get("output") and large.get("output") else 2
+        # short runs are mostly noise
+        if large_time >= min_seconds and large_time > max_growth * size_growth / 2 * max(small_time, 1e-6):
+            failures.append("%s: %.3fs -> %.3fs when the output grew %.1f times" %
+                            (shape, small_time, large_time, size_growth))
+    return failures
+
+
+def check_baseline(results, baseline, threshold):
+    """cases whose total throughput fell below threshold times that of the baseline"""
+    failures = []
+    for name, stats in results.items():
+        old = baseline.get(name)
+        if not stats or not old:
+            continue
+        if stats["total"]["mib_per_s"] < threshold * old["total"]["mib_per_s"]:
+            failures.append("%s: %.2f MiB/s, baseline %.2f MiB/s" %
+                            (name, stats["total"]["mib_per_s"], old["total"]["mib_per_s"]))
+    return failures
+
+
+def print_case(name, size, stats):
+    """one line per phase of a case"""
+    if stats is None:
+        print("%-22s %9d bytes  TIMEOUT" % (name, size))
+        return
+    print("%-22s %9d bytes  %.3fs wall" % (name, size, stats["wall"]))
+    for phase in PHASES:
+        values = stats.get(phase)
+        if values:
+            print("    %-10s %9.4fs %10.2f MiB/s %8.2f MiB" %
+                  (phase, values["seconds"], values["mib_per_s"], values["peak_mib"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("cjfmt", help="path of the cjfmt executable")
+    parser.add_argument("--corpus", nargs="*", default=[], help="directories of real-world .cj files to add")
+    parser.add_argument("--scale", type=int, default=1, help="multiplies the size of the generated shapes")
+    parser.add_argument("--timeout", type=float, default=60, help="seconds a file may take, more is a failure")
+    parser.add_argument("--max-growth", type=float, default=2.5,
+                        help="times the time of a shape may grow when its formatted size doubles, linear growth is 2 "
+                             "and quadratic growth 4")
+    parser.add_argument("--min-seconds", type=float, default=0.2,
+                        help="runs shorter than this are not checked for growth")
+    parser.add_argument("--baseline", help="JSON of an earlier run to compare the throughput with")
+    parser.add_argument("--threshold", type=float, default=0.8,
+                        help="fraction of the baseline throughput a case must keep")
+    parser.add_argument("--save", help="write the results as JSON, to be used as a baseline later")
+    parser.add_argument("--keep", action="store_true", help="keep the generated corpus")
+    args = parser.parse_args()
+
+    work = tempfile.mkdtemp(prefix="cjfmt_phase_bench_")
+    try:
+        shapes = generate(work, args.scale)
+        cases = [(name, os.path.join(work, name + ".cj")) for name in shapes]
+        for corpus in args.corpus:
+            for root, _, files in sorted(os.walk(corpus)):
+                cases += [(os.path.relpath(os.path.join(root, f), corpus), os.path.join(root, f))
+                          for f in sorted(files) if f.endswith(".cj")]
+
+        results = {}
+        failures = []
+        for name, path in cases:
+            stats = run(args.cjfmt, path, args.timeout)
+            print_case(name, os.path.getsize(path), stats)
+            results[name] = stats
+            if stats is None:
+                failures.append("%s: took more than %gs" % (name, args.timeout))
+            elif name in shapes:
+                stats["output"] = formatted_size(args.cjfmt, path, args.timeout)
+
+        failures += check_growth(results, args.max_growth, args.min_seconds)
+        if args.baseline:
+            with open(args.baseline) as inp:
+                failures += check_baseline(results, json.load(inp), args.threshold)
+        if args.save:
+            with open(args.save, "w") as out:
+                json.dump(results, out, indent=2, sort_keys=True)
+        if failures:
+            print("\nregressions:\n    " + "\n    ".join(failures))
+            raise SystemExit(1)
+    finally:
+        if args.keep:
+            print("corpus kept in " + work)
+        else:
+            shutil.rmtree(work, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()